@@ -0,0 +1,299 @@
+/*
+
+Copyright (c) 2014 Harm Hanemaaijer <fgenfb@yahoo.com>
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted, provided that the above
+copyright notice and this permission notice appear in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include "dstAffinity.h"
+
+static int dst_affinity_policy = DST_AFFINITY_NONE;
+static int dst_affinity_list[DST_AFFINITY_MAX_CPUS];
+static int dst_affinity_list_size = 0;
+// Set when DST_AFFINITY was valid; the application cannot change the policy then.
+static bool dst_affinity_overridden = false;
+static cpu_set_t dst_process_cpu_mask;
+static bool dst_process_cpu_mask_read = false;
+// The CPU order of the current policy, calculated on first use.
+static int *dst_affinity_cpu;
+static int dst_nu_affinity_cpus;
+static int dst_nu_available_cpus;
+static bool dst_affinity_order_valid = false;
+static pthread_mutex_t dst_affinity_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+class dstAffinityCPUInfo {
+public :
+	int cpu;
+	int package;
+	int core;
+	// The index of the CPU among the CPUs of its core in the process mask.
+	int sibling_index;
+	// The index of the core among the cores of its package in the process mask.
+	int core_index;
+};
+
+static int dstReadSysfsInt(int cpu, const char *name, int default_value) {
+	char filename[128];
+	sprintf(filename, "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+	FILE *f = fopen(filename, "r");
+	if (f == NULL)
+		return default_value;
+	int value;
+	if (fscanf(f, "%d", &value) != 1)
+		value = default_value;
+	fclose(f);
+	return value;
+}
+
+static void dstReadProcessCPUMask() {
+	CPU_ZERO(&dst_process_cpu_mask);
+	if (sched_getaffinity(0, sizeof(cpu_set_t), &dst_process_cpu_mask) != 0 ||
+	CPU_COUNT(&dst_process_cpu_mask) == 0) {
+		// Assume all CPUs can be used.
+		int nu_cpus = sysconf(_SC_NPROCESSORS_CONF);
+		for (int cpu = 0; cpu < nu_cpus && cpu < CPU_SETSIZE; cpu++)
+			CPU_SET(cpu, &dst_process_cpu_mask);
+	}
+	dst_process_cpu_mask_read = true;
+}
+
+static int dstCompareCompact(const void *p1, const void *p2) {
+	const dstAffinityCPUInfo *c1 = (const dstAffinityCPUInfo *)p1;
+	const dstAffinityCPUInfo *c2 = (const dstAffinityCPUInfo *)p2;
+	if (c1->package != c2->package)
+		return c1->package < c2->package ? - 1 : 1;
+	if (c1->core != c2->core)
+		return c1->core < c2->core ? - 1 : 1;
+	return c1->cpu - c2->cpu;
+}
+
+static int dstCompareScatter(const void *p1, const void *p2) {
+	const dstAffinityCPUInfo *c1 = (const dstAffinityCPUInfo *)p1;
+	const dstAffinityCPUInfo *c2 = (const dstAffinityCPUInfo *)p2;
+	if (c1->sibling_index != c2->sibling_index)
+		return c1->sibling_index - c2->sibling_index;
+	if (c1->core_index != c2->core_index)
+		return c1->core_index - c2->core_index;
+	if (c1->package != c2->package)
+		return c1->package < c2->package ? - 1 : 1;
+	return c1->cpu - c2->cpu;
+}
+
+// Calculate the CPU order of the current policy. Called with the mutex locked.
+
+static void dstCalculateAffinityOrder() {
+	if (!dst_process_cpu_mask_read)
+		dstReadProcessCPUMask();
+	delete [] dst_affinity_cpu;
+	dst_affinity_cpu = NULL;
+	dst_nu_affinity_cpus = 0;
+	dst_nu_available_cpus = CPU_COUNT(&dst_process_cpu_mask);
+	dst_affinity_order_valid = true;
+	if (dst_affinity_policy == DST_AFFINITY_NONE)
+		return;
+	dst_affinity_cpu = new int[dst_nu_available_cpus];
+	if (dst_affinity_policy == DST_AFFINITY_CPU_LIST) {
+		// Leave out CPUs that are not in the process mask, and duplicates.
+		for (int i = 0; i < dst_affinity_list_size; i++) {
+			int cpu = dst_affinity_list[i];
+			if (cpu < 0 || cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &dst_process_cpu_mask))
+				continue;
+			bool duplicate = false;
+			for (int j = 0; j < dst_nu_affinity_cpus; j++)
+				if (dst_affinity_cpu[j] == cpu)
+					duplicate = true;
+			if (!duplicate && dst_nu_affinity_cpus < dst_nu_available_cpus) {
+				dst_affinity_cpu[dst_nu_affinity_cpus] = cpu;
+				dst_nu_affinity_cpus++;
+			}
+		}
+		return;
+	}
+	dstAffinityCPUInfo *info = new dstAffinityCPUInfo[dst_nu_available_cpus];
+	int n = 0;
+	for (int cpu = 0; cpu < CPU_SETSIZE && n < dst_nu_available_cpus; cpu++)
+		if (CPU_ISSET(cpu, &dst_process_cpu_mask)) {
+			info[n].cpu = cpu;
+			// Without topology information, every CPU is a core of its own.
+			info[n].package = dstReadSysfsInt(cpu, "physical_package_id", 0);
+			info[n].core = dstReadSysfsInt(cpu, "core_id", cpu);
+			n++;
+		}
+	for (int i = 0; i < n; i++) {
+		info[i].sibling_index = 0;
+		info[i].core_index = 0;
+		for (int j = 0; j < i; j++)
+			if (info[j].package == info[i].package && info[j].core == info[i].core)
+				info[i].sibling_index++;
+	}
+	for (int i = 0; i < n; i++)
+		for (int j = 0; j < n; j++)
+			if (info[j].package == info[i].package && info[j].core < info[i].core &&
+			info[j].sibling_index == 0)
+				info[i].core_index++;
+	if (dst_affinity_policy == DST_AFFINITY_SCATTER)
+		qsort(info, n, sizeof(dstAffinityCPUInfo), dstCompareScatter);
+	else
+		qsort(info, n, sizeof(dstAffinityCPUInfo), dstCompareCompact);
+	for (int i = 0; i < n; i++)
+		if (dst_affinity_policy != DST_AFFINITY_PHYSICAL_CORES || info[i].sibling_index == 0) {
+			dst_affinity_cpu[dst_nu_affinity_cpus] = info[i].cpu;
+			dst_nu_affinity_cpus++;
+		}
+	delete [] info;
+}
+
+static void dstSetAffinityPolicyInternal(int policy, const int *cpu_list, int nu_cpus) {
+	dst_affinity_policy = policy;
+	dst_affinity_list_size = 0;
+	if (policy == DST_AFFINITY_CPU_LIST)
+		for (int i = 0; i < nu_cpus && i < DST_AFFINITY_MAX_CPUS; i++) {
+			dst_affinity_list[i] = cpu_list[i];
+			dst_affinity_list_size++;
+		}
+	dst_affinity_order_valid = false;
+}
+
+void dstSetAffinityPolicy(int policy, const int *cpu_list, int nu_cpus) {
+	pthread_mutex_lock(&dst_affinity_mutex);
+	if (!dst_affinity_overridden)
+		dstSetAffinityPolicyInternal(policy, cpu_list, nu_cpus);
+	pthread_mutex_unlock(&dst_affinity_mutex);
+}
+
+// Parse a policy name or a CPU list such as "0-3,8".
+
+static bool dstParseAffinityPolicy(const char *s, int& policy, int *cpu_list, int& nu_cpus) {
+	nu_cpus = 0;
+	if (strcmp(s, "none") == 0)
+		policy = DST_AFFINITY_NONE;
+	else if (strcmp(s, "compact") == 0)
+		policy = DST_AFFINITY_COMPACT;
+	else if (strcmp(s, "scatter") == 0)
+		policy = DST_AFFINITY_SCATTER;
+	else if (strcmp(s, "physical") == 0)
+		policy = DST_AFFINITY_PHYSICAL_CORES;
+	else {
+		policy = DST_AFFINITY_CPU_LIST;
+		while (*s != '\0') {
+			char *end;
+			long first = strtol(s, &end, 10);
+			if (end == s || first < 0)
+				return false;
+			long last = first;
+			s = end;
+			if (*s == '-') {
+				s++;
+				last = strtol(s, &end, 10);
+				if (end == s || last < first)
+					return false;
+				s = end;
+			}
+			for (long cpu = first; cpu <= last && nu_cpus < DST_AFFINITY_MAX_CPUS; cpu++) {
+				cpu_list[nu_cpus] = (int)cpu;
+				nu_cpus++;
+			}
+			if (*s == ',')
+				s++;
+			else if (*s != '\0')
+				return false;
+		}
+		if (nu_cpus == 0)
+			return false;
+	}
+	return true;
+}
+
+bool dstSetAffinityPolicyString(const char *s) {
+	int policy;
+	int *cpu_list = new int[DST_AFFINITY_MAX_CPUS];
+	int nu_cpus;
+	bool r = dstParseAffinityPolicy(s, policy, cpu_list, nu_cpus);
+	if (r)
+		dstSetAffinityPolicy(policy, cpu_list, nu_cpus);
+	delete [] cpu_list;
+	return r;
+}
+
+int dstGetAffinityPolicy() {
+	return dst_affinity_policy;
+}
+
+static const char *dst_affinity_policy_name[] = {
+	"none", "compact", "scatter", "physical", "CPU list"
+};
+
+const char *dstGetAffinityPolicyString(int policy) {
+	if (policy >= DST_AFFINITY_NONE && policy <= DST_AFFINITY_CPU_LIST)
+		return dst_affinity_policy_name[policy];
+	else
+		return "Unknown";
+}
+
+int dstGetAffinityCPU(int i) {
+	pthread_mutex_lock(&dst_affinity_mutex);
+	if (!dst_affinity_order_valid)
+		dstCalculateAffinityOrder();
+	int cpu = - 1;
+	if (dst_nu_affinity_cpus > 0)
+		cpu = dst_affinity_cpu[i % dst_nu_affinity_cpus];
+	pthread_mutex_unlock(&dst_affinity_mutex);
+	return cpu;
+}
+
+int dstGetNumberOfAffinityCPUs() {
+	pthread_mutex_lock(&dst_affinity_mutex);
+	if (!dst_affinity_order_valid)
+		dstCalculateAffinityOrder();
+	int n = (dst_nu_affinity_cpus > 0) ? dst_nu_affinity_cpus : dst_nu_available_cpus;
+	pthread_mutex_unlock(&dst_affinity_mutex);
+	return n;
+}
+
+bool dstIsCPUInProcessMask(int cpu) {
+	pthread_mutex_lock(&dst_affinity_mutex);
+	if (!dst_process_cpu_mask_read)
+		dstReadProcessCPUMask();
+	bool r = (cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &dst_process_cpu_mask));
+	pthread_mutex_unlock(&dst_affinity_mutex);
+	return r;
+}
+
+void dstInitializeAffinity() {
+	pthread_mutex_lock(&dst_affinity_mutex);
+	// Read the mask before any library thread is bound.
+	dstReadProcessCPUMask();
+	dst_affinity_order_valid = false;
+	const char *s = getenv("DST_AFFINITY");
+	if (s != NULL && !dst_affinity_overridden) {
+		int policy;
+		int *cpu_list = new int[DST_AFFINITY_MAX_CPUS];
+		int nu_cpus;
+		if (dstParseAffinityPolicy(s, policy, cpu_list, nu_cpus)) {
+			dstSetAffinityPolicyInternal(policy, cpu_list, nu_cpus);
+			dst_affinity_overridden = true;
+		}
+		else
+			printf("dstInit: Invalid DST_AFFINITY value \"%s\", ignored.\n", s);
+		delete [] cpu_list;
+	}
+	pthread_mutex_unlock(&dst_affinity_mutex);
+}
@@ -0,0 +1,77 @@
+/*
+
+Copyright (c) 2014 Harm Hanemaaijer <fgenfb@yahoo.com>
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted, provided that the above
+copyright notice and this permission notice appear in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef __DST_AFFINITY_H__
+#define __DST_AFFINITY_H__
+
+// CPU affinity of the library threads. An affinity policy orders the CPUs of the
+// process affinity mask (as returned by sched_getaffinity() when the library is
+// initialized); the main thread is bound to the first CPU of the order and worker i of
+// the task scheduler to CPU i + 1, wrapping around when there are more threads than
+// CPUs. CPUs outside the process mask are never used.
+//
+// Threads are not bound by default, so that independent processes using the library
+// do not all bind to the same CPUs. The policy is applied by dstInit(), which binds the
+// main thread and starts the worker pool, so it must be set before dstInit() is
+// called; running threads are not moved. The DST_AFFINITY environment variable overrides the policy set by the application (later
+// calls to set the policy are ignored); it can be "none", "compact", "scatter",
+// "physical" or a CPU list such as "0-3,8". When no CPU of an explicit list is in the
+// process mask, threads are not bound.
+
+#include <dstConfig.h>
+
+enum {
+	// Threads are not bound; the operating system may move them within the process
+	// mask (the default).
+	DST_AFFINITY_NONE = 0,
+	// Consecutive CPUs, with the hardware threads of a core next to each other.
+	DST_AFFINITY_COMPACT,
+	// One thread per core, alternating between packages (sockets), before the second
+	// hardware thread of any core is used.
+	DST_AFFINITY_SCATTER,
+	// Only the first hardware thread of each physical core.
+	DST_AFFINITY_PHYSICAL_CORES,
+	// An explicit list of CPUs, in the given order.
+	DST_AFFINITY_CPU_LIST
+};
+
+// Maximum number of CPUs in an explicit CPU list.
+#define DST_AFFINITY_MAX_CPUS 1024
+
+// Set the affinity policy, before dstInit(). cpu_list is only used with
+// DST_AFFINITY_CPU_LIST.
+DST_API void dstSetAffinityPolicy(int policy, const int *cpu_list = NULL, int nu_cpus = 0);
+// Set the affinity policy from a string in the format of DST_AFFINITY. Returns false
+// (leaving the policy unchanged) when the string is not valid.
+DST_API bool dstSetAffinityPolicyString(const char *s);
+DST_API int dstGetAffinityPolicy();
+DST_API const char *dstGetAffinityPolicyString(int policy);
+// The CPU to which library thread i (zero for the main thread) is bound under the
+// current policy, or -1 when it is not bound.
+DST_API int dstGetAffinityCPU(int i);
+// The number of CPUs that library threads are spread over: the length of the CPU
+// order of the policy, or the number of CPUs in the process mask with
+// DST_AFFINITY_NONE.
+DST_API int dstGetNumberOfAffinityCPUs();
+// Whether a CPU is in the process affinity mask.
+DST_API bool dstIsCPUInProcessMask(int cpu);
+// Read the process affinity mask and the DST_AFFINITY environment variable (internal,
+// called by dstInit()).
+DST_API void dstInitializeAffinity();
+
+#endif
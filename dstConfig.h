@@ -107,8 +107,8 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #ifndef DST_NO_SIMD
 
 #ifndef DST_FIXED_SIMD
-#define DST_FUNC_LOOKUP(f) dst_config.simd_funcs.f
-#define DST_FUNC_STREAM_LOOKUP(f) dst_config.simd_funcs_stream.f
+#define DST_FUNC_LOOKUP(f) dstGetContext()->simd_funcs->f
+#define DST_FUNC_STREAM_LOOKUP(f) dstGetContext()->simd_funcs_stream->f
 #endif
 #define DST_FUNC_LOOKUP_NO_SIMD(f) dst_simd_funcs_NoSIMD.f
 
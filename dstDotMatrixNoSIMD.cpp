@@ -282,12 +282,32 @@ float * DST_RESTRICT f3) {
 	*(Matrix4x3RM *)f3 = dstInlineMultiply(m, *(Matrix4x3RM *)f2);
 }
 
+void dstMatrixMultiplyMatrices4x3RMNoSIMD(int n, const float * DST_RESTRICT m1,
+const float * DST_RESTRICT m2, float * DST_RESTRICT m_result) {
+	for (int i = 0; i < n; i++)
+		((Matrix4x3RM *)m_result)[i] = dstInlineMultiply(((const Matrix4x3RM *)m1)[i],
+			((const Matrix4x3RM *)m2)[i]);
+}
+
 void dstMatrixMultiply4x4CM4x3RMNoSIMD(const float * DST_RESTRICT f1, const float * DST_RESTRICT f2,
 float * DST_RESTRICT f3) {
 	Matrix4D m = *(Matrix4D *)f1;
 	*(Matrix4D *)f3 = dstInlineMultiply(m, *(Matrix4x3RM *)f2);
 }
 
+void dstMatrixMultiply3x3CMNoSIMD(const float * DST_RESTRICT f1, const float * DST_RESTRICT f2,
+float * DST_RESTRICT f3) {
+	Matrix3D m = *(Matrix3D *)f1;
+	*(Matrix3D *)f3 = dstInlineMultiply(m, *(Matrix3D *)f2);
+}
+
+void dstMatrixMultiplyMatrices3x3CMNoSIMD(int n, const float * DST_RESTRICT m1,
+const float * DST_RESTRICT m2, float * DST_RESTRICT m_result) {
+	for (int i = 0; i < n; i++)
+		((Matrix3D *)m_result)[i] = dstInlineMultiply(((const Matrix3D *)m1)[i],
+			((const Matrix3D *)m2)[i]);
+}
+
 void dstMatrixMultiplyVectors1x4M4x4CMV4NoSIMD(
 const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
 	for (int i = 0; i < 4; i++) {
@@ -315,6 +335,78 @@ const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
 	}
 }
 
+// 2D affine transformation with a Matrix3D.
+
+void dstMatrixMultiplyVectors1xNM3x3CMV2NoSIMD(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++) {
+		Vector3D result = *((Matrix3D *)m) * Vector3D(v[i * 2], v[i * 2 + 1], 0.0f);
+		v_result[i * 2] = result.x;
+		v_result[i * 2 + 1] = result.y;
+	}
+}
+
+void dstMatrixMultiplyVectors1xNM3x3CMP2NoSIMD(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++) {
+		Vector3D result = *((Matrix3D *)m) * Vector3D(v[i * 2], v[i * 2 + 1], 1.0f);
+		v_result[i * 2] = result.x;
+		v_result[i * 2 + 1] = result.y;
+	}
+}
+
+void dstMatrixMultiplyVectors1xNM3x3CMV2SoANoSIMD(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++) {
+		Vector2D v2 = ((const Vector2DSoA4 *)v)[i >> 2].Get(i & 3);
+		Vector3D result = *((Matrix3D *)m) * Vector3D(v2.x, v2.y, 0.0f);
+		((Vector2DSoA4 *)v_result)[i >> 2].Set(i & 3, Vector2D(result.x, result.y));
+	}
+}
+
+void dstMatrixMultiplyVectors1xNM3x3CMP2SoANoSIMD(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++) {
+		Vector2D v2 = ((const Vector2DSoA4 *)v)[i >> 2].Get(i & 3);
+		Vector3D result = *((Matrix3D *)m) * Vector3D(v2.x, v2.y, 1.0f);
+		((Vector2DSoA4 *)v_result)[i >> 2].Set(i & 3, Vector2D(result.x, result.y));
+	}
+}
+
+void dstMatrixMultiplyVectors1xNMD4x4CMPD3NoSIMD(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++) {
+		VectorDouble4D result = *((MatrixDouble4D *)m) * ((const PointDouble3D *)v)[i];
+		((PointDouble3D *)v_result)[i] = PointDouble3D(result.x, result.y, result.z);
+	}
+}
+
+void dstMatrixMultiplyVectors1xNMD4x4CMPD3P3NoSIMD(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++) {
+		VectorDouble4D result = *((MatrixDouble4D *)m) * ((const PointDouble3D *)v)[i];
+		*(Point3D *)&v_result[i * 3] = Point3D(result.x, result.y, result.z);
+	}
+}
+
+void dstMatrixMultiplyNormalizeVectors1xNM4x3RMV3NoSIMD(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++) {
+		Vector3D result;
+		result = (*((Matrix4x3RM *)m) * (*((Vector3D *)&v[i * 3]))).GetVector3D();
+		*(Vector3D *)&v_result[i * 3] = result.Normalize();
+	}
+}
+
+void dstMatrixMultiplyNormalizeVectors1xNM4x3RMV3PNoSIMD(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++) {
+		Vector3DPadded result;
+		result = (*((Matrix4x3RM *)m) * (*((Vector3DPadded *)&v[i * 4]))).GetVector3D();
+		*(Vector3DPadded *)&v_result[i * 4] = result.Normalize();
+	}
+}
+
 void dstMatrixMultiplyVectors1xNM4x4CMP3PNoSIMD(int n,
 const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
 	for (int i = 0; i < n; i++) {
@@ -333,3 +425,303 @@ const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT
 	}
 }
 
+void dstMatrixMultiplyVectors1xNM4x4CMP3NoSIMD(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++) {
+		Point3D result;
+		result = (*((Matrix4D *)m) * (*((Point3D *)&v[i * 3]))).GetPoint3D();
+		*(Point3D *)&v_result[i * 3] = result;
+	}
+}
+
+void dstMatrixMultiplyVectors1xNM4x3RMV3NoSIMD(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++) {
+		Vector3D result;
+		result = (*((Matrix4x3RM *)m) * (*((Vector3D *)&v[i * 3]))).GetVector3D();
+		*(Vector3D *)&v_result[i * 3] = result;
+	}
+}
+
+void dstMatrixMultiplyVectors1xNM4x3RMP3NoSIMD(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++) {
+		Point3D result;
+		result = (*((Matrix4x3RM *)m) * (*((Point3D *)&v[i * 3]))).GetPoint3D();
+		*(Point3D *)&v_result[i * 3] = result;
+	}
+}
+
+void dstMatrixMultiplyVectors1xNM4x3RMV3PNoSIMD(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++) {
+		Vector3DPadded result;
+		result = (*((Matrix4x3RM *)m) * (*((Vector3DPadded *)&v[i * 4]))).GetVector3D();
+		*(Vector3DPadded *)&v_result[i * 4] = result;
+	}
+}
+
+void dstMatrixMultiplyVectors1xNM4x3RMP3PNoSIMD(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++) {
+		Point3DPadded result;
+		result = (*((Matrix4x3RM *)m) * (*((Point3DPadded *)&v[i * 4]))).GetPoint3D();
+		*(Point3DPadded *)&v_result[i * 4] = result;
+	}
+}
+
+
+// Batch matrix inversion and linear system solvers.
+
+void dstInvertMatrices4x4CMNoSIMD(int n, const float * DST_RESTRICT m,
+float * DST_RESTRICT m_result) {
+	for (int i = 0; i < n; i++)
+		((Matrix4D *)m_result)[i] = Inverse(((const Matrix4D *)m)[i]);
+}
+
+void dstInvertMatrices3x3CMNoSIMD(int n, const float * DST_RESTRICT m,
+float * DST_RESTRICT m_result) {
+	for (int i = 0; i < n; i++)
+		((Matrix3D *)m_result)[i] = Inverse(((const Matrix3D *)m)[i]);
+}
+
+void dstInvertMatrices4x3RMNoSIMD(int n, const float * DST_RESTRICT m,
+float * DST_RESTRICT m_result) {
+	for (int i = 0; i < n; i++)
+		((Matrix4x3RM *)m_result)[i] = AffineInverse(((const Matrix4x3RM *)m)[i]);
+}
+
+void dstInvertRigidMatrices4x3RMNoSIMD(int n, const float * DST_RESTRICT m,
+float * DST_RESTRICT m_result) {
+	for (int i = 0; i < n; i++)
+		((Matrix4x3RM *)m_result)[i] = RigidInverse(((const Matrix4x3RM *)m)[i]);
+}
+
+void dstSolveLinearSystems3x3CMV3NoSIMD(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++)
+		((Vector3D *)v_result)[i] = Inverse(((const Matrix3D *)m)[i]) *
+			((const Vector3D *)v)[i];
+}
+
+void dstSolveLinearSystems4x4CMV4NoSIMD(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++)
+		((Vector4D *)v_result)[i] = Inverse(((const Matrix4D *)m)[i]) *
+			((const Vector4D *)v)[i];
+}
+
+// Fused point projection (transform, perspective divide and viewport).
+
+static void dstProjectPoint(const dstProjectionViewport& pv, const Point3D& p,
+dstScreenVertex& result) {
+	Vector4D c = pv.projection * p;
+	uint32_t flags = 0;
+	if (c.x < - c.w)
+		flags |= DST_CLIP_LEFT;
+	if (c.x > c.w)
+		flags |= DST_CLIP_RIGHT;
+	if (c.y < - c.w)
+		flags |= DST_CLIP_BOTTOM;
+	if (c.y > c.w)
+		flags |= DST_CLIP_TOP;
+	if (c.z < - c.w)
+		flags |= DST_CLIP_NEAR;
+	if (c.z > c.w)
+		flags |= DST_CLIP_FAR;
+	float recip_w = 1.0f / c.w;
+	result.x = c.x * recip_w * pv.scale[0] + pv.offset[0];
+	result.y = c.y * recip_w * pv.scale[1] + pv.offset[1];
+	result.z = c.z * recip_w * pv.scale[2] + pv.offset[2];
+	result.clip_flags = flags;
+}
+
+static int dstRoundAndClamp(float f, float min_value, float max_value) {
+	return (int)lrintf(maxf(minf(f, max_value), min_value));
+}
+
+static void dstConvertScreenVertexInt16(const dstScreenVertex& v,
+dstScreenVertexInt16& result) {
+	result.x = (int16_t)dstRoundAndClamp(v.x, - 32768.0f, 32767.0f);
+	result.y = (int16_t)dstRoundAndClamp(v.y, - 32768.0f, 32767.0f);
+	result.z = (uint16_t)dstRoundAndClamp(v.z, 0.0f, 65535.0f);
+	result.clip_flags = (uint16_t)v.clip_flags;
+}
+
+void dstTransformAndProjectPointsP3NoSIMD(int n, const float * DST_RESTRICT params,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++)
+		dstProjectPoint(*(const dstProjectionViewport *)params, ((const Point3D *)v)[i],
+			((dstScreenVertex *)v_result)[i]);
+}
+
+void dstTransformAndProjectPointsP3PNoSIMD(int n, const float * DST_RESTRICT params,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++)
+		dstProjectPoint(*(const dstProjectionViewport *)params,
+			((const Point3DPadded *)v)[i], ((dstScreenVertex *)v_result)[i]);
+}
+
+void dstTransformAndProjectPointsP3Int16NoSIMD(int n, const float * DST_RESTRICT params,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++) {
+		dstScreenVertex sv;
+		dstProjectPoint(*(const dstProjectionViewport *)params, ((const Point3D *)v)[i], sv);
+		dstConvertScreenVertexInt16(sv, ((dstScreenVertexInt16 *)v_result)[i]);
+	}
+}
+
+void dstTransformAndProjectPointsP3PInt16NoSIMD(int n, const float * DST_RESTRICT params,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++) {
+		dstScreenVertex sv;
+		dstProjectPoint(*(const dstProjectionViewport *)params,
+			((const Point3DPadded *)v)[i], sv);
+		dstConvertScreenVertexInt16(sv, ((dstScreenVertexInt16 *)v_result)[i]);
+	}
+}
+
+// Quaternion functions.
+
+void dstMultiplyQuaternionsQNoSIMD(int n, const float * DST_RESTRICT q1,
+const float * DST_RESTRICT q2, float * DST_RESTRICT q_result) {
+	for (int i = 0; i < n; i++)
+		((Quaternion *)q_result)[i] = ((const Quaternion *)q1)[i] *
+			((const Quaternion *)q2)[i];
+}
+
+void dstMultiplyQuaternionsQSoANoSIMD(int n, const float * DST_RESTRICT q1,
+const float * DST_RESTRICT q2, float * DST_RESTRICT q_result) {
+	for (int i = 0; i < n; i++)
+		((QuaternionSoA4 *)q_result)[i >> 2].Set(i & 3,
+			((const QuaternionSoA4 *)q1)[i >> 2].Get(i & 3) *
+			((const QuaternionSoA4 *)q2)[i >> 2].Get(i & 3));
+}
+
+void dstNormalizeQuaternionsQNoSIMD(int n, const float * DST_RESTRICT q,
+float * DST_RESTRICT q_result) {
+	for (int i = 0; i < n; i++) {
+		Quaternion r = ((const Quaternion *)q)[i];
+		((Quaternion *)q_result)[i] = r.Normalize();
+	}
+}
+
+void dstNormalizeQuaternionsQSoANoSIMD(int n, const float * DST_RESTRICT q,
+float * DST_RESTRICT q_result) {
+	for (int i = 0; i < n; i++) {
+		Quaternion r = ((const QuaternionSoA4 *)q)[i >> 2].Get(i & 3);
+		((QuaternionSoA4 *)q_result)[i >> 2].Set(i & 3, r.Normalize());
+	}
+}
+
+void dstNlerpQuaternionsQNoSIMD(int n, const float * DST_RESTRICT q1,
+const float * DST_RESTRICT q2, const float * DST_RESTRICT t, float * DST_RESTRICT q_result) {
+	for (int i = 0; i < n; i++)
+		((Quaternion *)q_result)[i] = Nlerp(((const Quaternion *)q1)[i],
+			((const Quaternion *)q2)[i], t[i]);
+}
+
+void dstNlerpQuaternionsQSoANoSIMD(int n, const float * DST_RESTRICT q1,
+const float * DST_RESTRICT q2, const float * DST_RESTRICT t, float * DST_RESTRICT q_result) {
+	for (int i = 0; i < n; i++)
+		((QuaternionSoA4 *)q_result)[i >> 2].Set(i & 3,
+			Nlerp(((const QuaternionSoA4 *)q1)[i >> 2].Get(i & 3),
+			((const QuaternionSoA4 *)q2)[i >> 2].Get(i & 3), t[i]));
+}
+
+void dstSlerpQuaternionsQNoSIMD(int n, const float * DST_RESTRICT q1,
+const float * DST_RESTRICT q2, const float * DST_RESTRICT t, float * DST_RESTRICT q_result) {
+	for (int i = 0; i < n; i++)
+		((Quaternion *)q_result)[i] = Slerp(((const Quaternion *)q1)[i],
+			((const Quaternion *)q2)[i], t[i]);
+}
+
+void dstSlerpQuaternionsQSoANoSIMD(int n, const float * DST_RESTRICT q1,
+const float * DST_RESTRICT q2, const float * DST_RESTRICT t, float * DST_RESTRICT q_result) {
+	for (int i = 0; i < n; i++)
+		((QuaternionSoA4 *)q_result)[i >> 2].Set(i & 3,
+			Slerp(((const QuaternionSoA4 *)q1)[i >> 2].Get(i & 3),
+			((const QuaternionSoA4 *)q2)[i >> 2].Get(i & 3), t[i]));
+}
+
+void dstRotateVectorsQV3NoSIMD(int n, const float * DST_RESTRICT q,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++)
+		((Vector3D *)v_result)[i] = Rotate(((const Quaternion *)q)[i],
+			((const Vector3D *)v)[i]);
+}
+
+void dstRotateVectorsQV3PNoSIMD(int n, const float * DST_RESTRICT q,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	for (int i = 0; i < n; i++)
+		((Vector3DPadded *)v_result)[i] = Rotate(((const Quaternion *)q)[i],
+			((const Vector3DPadded *)v)[i]);
+}
+
+void dstConvertQuaternionsToMatrices3x3CMNoSIMD(int n, const float * DST_RESTRICT q,
+float * DST_RESTRICT m_result) {
+	for (int i = 0; i < n; i++)
+		((Matrix3D *)m_result)[i] = ((const Quaternion *)q)[i].GetRotationMatrix3D();
+}
+
+void dstConvertQuaternionsToMatrices4x3RMNoSIMD(int n, const float * DST_RESTRICT q,
+float * DST_RESTRICT m_result) {
+	for (int i = 0; i < n; i++)
+		((Matrix4x3RM *)m_result)[i] = ((const Quaternion *)q)[i].GetRotationMatrix4x3RM();
+}
+
+// Skinning and per-vertex matrix selection.
+
+static void dstTransformVertexNoSIMD(const Matrix4x3RM& m, const float * DST_RESTRICT p,
+const float * DST_RESTRICT v, float * DST_RESTRICT p_result, float * DST_RESTRICT v_result,
+bool normalize) {
+	float x = m.n[0][0] * p[0] + m.n[0][1] * p[1] + m.n[0][2] * p[2] + m.n[0][3];
+	float y = m.n[1][0] * p[0] + m.n[1][1] * p[1] + m.n[1][2] * p[2] + m.n[1][3];
+	float z = m.n[2][0] * p[0] + m.n[2][1] * p[1] + m.n[2][2] * p[2] + m.n[2][3];
+	p_result[0] = x;
+	p_result[1] = y;
+	p_result[2] = z;
+	p_result[3] = 1.0f;
+	if (v == NULL)
+		return;
+	Vector3D v_out(
+		m.n[0][0] * v[0] + m.n[0][1] * v[1] + m.n[0][2] * v[2],
+		m.n[1][0] * v[0] + m.n[1][1] * v[1] + m.n[1][2] * v[2],
+		m.n[2][0] * v[0] + m.n[2][1] * v[1] + m.n[2][2] * v[2]);
+	if (normalize)
+		v_out.Normalize();
+	v_result[0] = v_out.x;
+	v_result[1] = v_out.y;
+	v_result[2] = v_out.z;
+	v_result[3] = 0.0f;
+}
+
+void dstSkinVerticesM4x3RMP3PNoSIMD(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT f, const float * DST_RESTRICT p, const float * DST_RESTRICT v,
+float * DST_RESTRICT p_result, float * DST_RESTRICT v_result) {
+	const dstSkinInfluences *influences = (const dstSkinInfluences *)f;
+	const Matrix4x3RM *palette = (const Matrix4x3RM *)m;
+	for (int i = 0; i < n; i++) {
+		Matrix4x3RM blended;
+		for (int j = 0; j < 3; j++)
+			for (int k = 0; k < 4; k++) {
+				float sum = 0.0f;
+				for (int l = 0; l < 4; l++)
+					sum += influences[i].weight[l] *
+						palette[influences[i].index[l]].n[j][k];
+				blended.n[j][k] = sum;
+			}
+		dstTransformVertexNoSIMD(blended, &p[i * 4], v == NULL ? NULL : &v[i * 4],
+			&p_result[i * 4], v_result == NULL ? NULL : &v_result[i * 4], true);
+	}
+}
+
+void dstMatrixMultiplyVerticesIndexedM4x3RMP3PNoSIMD(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT f, const float * DST_RESTRICT p, const float * DST_RESTRICT v,
+float * DST_RESTRICT p_result, float * DST_RESTRICT v_result) {
+	const uint32_t *index = (const uint32_t *)f;
+	for (int i = 0; i < n; i++)
+		dstTransformVertexNoSIMD(((const Matrix4x3RM *)m)[index[i]], &p[i * 4],
+			v == NULL ? NULL : &v[i * 4], &p_result[i * 4],
+			v_result == NULL ? NULL : &v_result[i * 4], false);
+}
@@ -49,6 +49,8 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
 // Matrix3D class.
 
+#ifdef DST_NO_SIMD
+
 Matrix3D& Matrix3D::operator *=(const Matrix3D& __restrict__ m) __restrict__
 {
 	float t = n[0][0] * m.n[0][0] + n[1][0] * m.n[0][1] + n[2][0] * m.n[0][2];
@@ -72,6 +74,8 @@ Matrix3D& Matrix3D::operator *=(const Matrix3D& __restrict__ m) __restrict__
 	return (*this);
 }
 
+#endif
+
 Matrix3D& Matrix3D::operator *=(float t)
 {
 	n[0][0] *= t;
@@ -158,19 +162,20 @@ Matrix3D& Matrix3D::AssignScaling(float scaling) {
     return (*this);
 }
 
+Matrix3D dstMultiply(const Matrix3D& __restrict__ m1, const Matrix3D& __restrict__ m2)
+{
+	return dstInlineMultiply(m1, m2);
+}
+
+#ifdef DST_NO_SIMD
+
 Matrix3D operator *(const Matrix3D& __restrict__ m1, const Matrix3D& __restrict__ m2)
 {
-	return (Matrix3D(m1.n[0][0] * m2.n[0][0] + m1.n[1][0] * m2.n[0][1] + m1.n[2][0] * m2.n[0][2],
-					 m1.n[0][0] * m2.n[1][0] + m1.n[1][0] * m2.n[1][1] + m1.n[2][0] * m2.n[1][2],
-					 m1.n[0][0] * m2.n[2][0] + m1.n[1][0] * m2.n[2][1] + m1.n[2][0] * m2.n[2][2],
-					 m1.n[0][1] * m2.n[0][0] + m1.n[1][1] * m2.n[0][1] + m1.n[2][1] * m2.n[0][2],
-					 m1.n[0][1] * m2.n[1][0] + m1.n[1][1] * m2.n[1][1] + m1.n[2][1] * m2.n[1][2],
-					 m1.n[0][1] * m2.n[2][0] + m1.n[1][1] * m2.n[2][1] + m1.n[2][1] * m2.n[2][2],
-					 m1.n[0][2] * m2.n[0][0] + m1.n[1][2] * m2.n[0][1] + m1.n[2][2] * m2.n[0][2],
-					 m1.n[0][2] * m2.n[1][0] + m1.n[1][2] * m2.n[1][1] + m1.n[2][2] * m2.n[1][2],
-					 m1.n[0][2] * m2.n[2][0] + m1.n[1][2] * m2.n[2][1] + m1.n[2][2] * m2.n[2][2]));
+	return dstInlineMultiply(m1, m2);
 }
 
+#endif
+
 Matrix3D operator *(const Matrix3D& m, float t)
 {
 	return (Matrix3D(m.n[0][0] * t, m.n[1][0] * t, m.n[2][0] * t, m.n[0][1] * t, m.n[1][1] * t, m.n[2][1] * t, m.n[0][2] * t, m.n[1][2] * t, m.n[2][2] * t));
@@ -281,6 +286,8 @@ bool Matrix3D::RotationMatrixPreservesAABB() {
 
 // Matrix4D class
 
+#ifdef DST_NO_SIMD
+
 Matrix4D& Matrix4D::operator *=(const Matrix4D& __restrict__ m) __restrict__
 {
 	float x = n[0][0];
@@ -322,6 +329,8 @@ Matrix4D& Matrix4D::operator *=(const Matrix4D& __restrict__ m) __restrict__
 	return (*this);
 }
 
+#endif
+
 Matrix4D& Matrix4D::operator *=(const Matrix3D& __restrict__ m) __restrict__
 {
 	float x = n[0][0];
@@ -435,6 +444,8 @@ Matrix4D operator *(const Matrix4D& __restrict__ m1, const Matrix3D& __restrict_
 					 m1.n[3][3]));
 }
 
+#ifdef DST_NO_SIMD
+
 Vector4D operator *(const Matrix4D& m, const Vector4D& v)
 {
 	return (Vector4D(m.n[0][0] * v.x + m.n[1][0] * v.y + m.n[2][0] * v.z + m.n[3][0] * v.w,
@@ -443,6 +454,8 @@ Vector4D operator *(const Matrix4D& m, const Vector4D& v)
 					 m.n[0][3] * v.x + m.n[1][3] * v.y + m.n[2][3] * v.z + m.n[3][3] * v.w));
 }
 
+#endif
+
 Vector4D operator *(const Vector4D& v, const Matrix4D& m)
 {
 	return (Vector4D(m.n[0][0] * v.x + m.n[0][1] * v.y + m.n[0][2] * v.z + m.n[0][3] * v.w,
@@ -451,6 +464,8 @@ Vector4D operator *(const Vector4D& v, const Matrix4D& m)
 					 m.n[3][0] * v.x + m.n[3][1] * v.y + m.n[3][2] * v.z + m.n[3][3] * v.w));
 }
 
+#ifdef DST_NO_SIMD
+
 Vector4D operator *(const Matrix4D& m, const Vector3D& v)
 {
 	return (Vector4D(m.n[0][0] * v.x + m.n[1][0] * v.y + m.n[2][0] * v.z,
@@ -459,6 +474,8 @@ Vector4D operator *(const Matrix4D& m, const Vector3D& v)
 					 m.n[0][3] * v.x + m.n[1][3] * v.y + m.n[2][3] * v.z));
 }
 
+#endif
+
 Vector4D operator *(const Vector3D& v, const Matrix4D& m)
 {
 	return (Vector4D(m.n[0][0] * v.x + m.n[0][1] * v.y + m.n[0][2] * v.z,
@@ -467,6 +484,8 @@ Vector4D operator *(const Vector3D& v, const Matrix4D& m)
 					 m.n[3][0] * v.x + m.n[3][1] * v.y + m.n[3][2] * v.z));
 }
 
+#ifdef DST_NO_SIMD
+
 Vector4D operator *(const Matrix4D& m, const Point3D& p)
 {
 	return (Vector4D(m.n[0][0] * p.x + m.n[1][0] * p.y + m.n[2][0] * p.z + m.n[3][0],
@@ -475,6 +494,8 @@ Vector4D operator *(const Matrix4D& m, const Point3D& p)
 					 m.n[0][3] * p.x + m.n[1][3] * p.y + m.n[2][3] * p.z + m.n[3][3]));
 }
 
+#endif
+
 Vector4D operator *(const Point3D& p, const Matrix4D& m)
 {
 	return (Vector4D(m.n[0][0] * p.x + m.n[0][1] * p.y + m.n[0][2] * p.z + m.n[0][3],
@@ -695,6 +716,8 @@ Matrix4x3RM& Matrix4x3RM::AssignScaling(float scaling) {
     return (*this);
 }
 
+#ifdef DST_NO_SIMD
+
 Matrix4x3RM& Matrix4x3RM::operator *=(const Matrix4x3RM& __restrict__ m) __restrict__
 {
 	float x = Get(0, 0);
@@ -713,7 +736,7 @@ Matrix4x3RM& Matrix4x3RM::operator *=(const Matrix4x3RM& __restrict__ m) __restr
 	n[1][0] = x * m.Get(0, 0) + y * m.Get(0, 1) + z * m.Get(0, 2);
 	n[1][1] = x * m.Get(1, 0) + y * m.Get(1, 1) + z * m.Get(1, 2);
 	n[1][2] = x * m.Get(2, 0) + y * m.Get(2, 1) + z * m.Get(2, 2);
-	n[1][3] = x * m.Get(3, 0) + y * m.Get(3, 1) + z * m.Get(3, 2);
+	n[1][3] = x * m.Get(3, 0) + y * m.Get(3, 1) + z * m.Get(3, 2) + w;
 
 	x = Get(0, 2);
 	y = Get(1, 2);
@@ -727,6 +750,8 @@ Matrix4x3RM& Matrix4x3RM::operator *=(const Matrix4x3RM& __restrict__ m) __restr
 	return (*this);
 }
 
+#endif
+
 Matrix4x3RM dstMultiply(const Matrix4x3RM& __restrict__ m1, const Matrix4x3RM& __restrict__ m2) {
     return dstInlineMultiply(m1, m2);
 }
@@ -748,6 +773,8 @@ Matrix4D operator *(const Matrix4D& __restrict__ m1, const Matrix4x3RM& __restri
 
 #endif
 
+#ifdef DST_NO_SIMD
+
 Vector4D operator *(const Matrix4x3RM&  __restrict__ m, const Vector4D& __restrict__ v)
 {
     return Vector4D(
@@ -775,6 +802,7 @@ Vector4D operator *(const Matrix4x3RM& __restrict__ m, const Point3D& __restrict
         1.0f);
 }
 
+#endif
 
 bool operator ==(const Matrix4x3RM& m1, const Matrix4x3RM& m2)
 {
@@ -802,6 +830,26 @@ Matrix4D Inverse(const Matrix4x3RM& m)
 	return Inverse(m2);
 }
 
+Matrix4x3RM AffineInverse(const Matrix4x3RM& m)
+{
+	Matrix3D a = Inverse(Matrix3D(m(0,0), m(0,1), m(0,2), m(1,0), m(1,1), m(1,2),
+		m(2,0), m(2,1), m(2,2)));
+	Vector3D t = - (a * Vector3D(m(0,3), m(1,3), m(2,3)));
+	return (Matrix4x3RM(a(0,0), a(0,1), a(0,2), t.x,
+		a(1,0), a(1,1), a(1,2), t.y,
+		a(2,0), a(2,1), a(2,2), t.z));
+}
+
+Matrix4x3RM RigidInverse(const Matrix4x3RM& m)
+{
+	return (Matrix4x3RM(m(0,0), m(1,0), m(2,0),
+		- (m(0,0) * m(0,3) + m(1,0) * m(1,3) + m(2,0) * m(2,3)),
+		m(0,1), m(1,1), m(2,1),
+		- (m(0,1) * m(0,3) + m(1,1) * m(1,3) + m(2,1) * m(2,3)),
+		m(0,2), m(1,2), m(2,2),
+		- (m(0,2) * m(0,3) + m(1,2) * m(1,3) + m(2,2) * m(2,3))));
+}
+
 Matrix4D Transpose(const Matrix4x3RM& m)
 {
 	return (Matrix4D(m(0,0), m(1,0), m(2,0), 0.0f,
@@ -810,6 +858,217 @@ Matrix4D Transpose(const Matrix4x3RM& m)
 		m(0,3), m(1,3), m(2,3), 1.0f));
 }
 
+// The rows of the inverse transpose of a 3x3 matrix are the cross products of pairs of
+// its rows divided by the determinant.
+
+static Matrix4x3RM NormalMatrixFromRows(const Vector3D& r0, const Vector3D& r1,
+const Vector3D& r2) {
+	Vector3D c0 = Cross(r1, r2);
+	Vector3D c1 = Cross(r2, r0);
+	Vector3D c2 = Cross(r0, r1);
+	float f = 1.0f / Dot(r0, c0);
+	return (Matrix4x3RM(c0.x * f, c0.y * f, c0.z * f, 0.0f,
+		c1.x * f, c1.y * f, c1.z * f, 0.0f,
+		c2.x * f, c2.y * f, c2.z * f, 0.0f));
+}
+
+Matrix4x3RM NormalMatrix(const Matrix4x3RM& m)
+{
+	return NormalMatrixFromRows(Vector3D(m(0,0), m(0,1), m(0,2)),
+		Vector3D(m(1,0), m(1,1), m(1,2)), Vector3D(m(2,0), m(2,1), m(2,2)));
+}
+
+Matrix4x3RM NormalMatrix(const Matrix4D& m)
+{
+	return NormalMatrixFromRows(Vector3D(m(0,0), m(0,1), m(0,2)),
+		Vector3D(m(1,0), m(1,1), m(1,2)), Vector3D(m(2,0), m(2,1), m(2,2)));
+}
+
+// Normal matrix cache.
+
+const Matrix4x3RM& dstNormalMatrixCache::Lookup(const Matrix4x3RM& k) {
+	for (int i = 0; i < nu_entries; i++)
+		if (memcmp(&key[i], &k, sizeof(Matrix4x3RM)) == 0)
+			return normal_matrix[i];
+	int i = next_entry;
+	key[i] = k;
+	normal_matrix[i] = NormalMatrix(k);
+	next_entry = (next_entry + 1) % DST_NORMAL_MATRIX_CACHE_SIZE;
+	if (nu_entries < DST_NORMAL_MATRIX_CACHE_SIZE)
+		nu_entries++;
+	return normal_matrix[i];
+}
+
+// The key is the upper-left 3x3 part with zero translation, so that matrices that only
+// differ in translation share an entry.
+
+const Matrix4x3RM& dstNormalMatrixCache::GetNormalMatrix(const Matrix4x3RM& m) {
+	return Lookup(Matrix4x3RM(m(0,0), m(0,1), m(0,2), 0.0f,
+		m(1,0), m(1,1), m(1,2), 0.0f,
+		m(2,0), m(2,1), m(2,2), 0.0f));
+}
+
+const Matrix4x3RM& dstNormalMatrixCache::GetNormalMatrix(const Matrix4D& m) {
+	return Lookup(Matrix4x3RM(m(0,0), m(0,1), m(0,2), 0.0f,
+		m(1,0), m(1,1), m(1,2), 0.0f,
+		m(2,0), m(2,1), m(2,2), 0.0f));
+}
+
+
+// MatrixDouble4D class.
+
+Matrix4D MatrixDouble4D::GetMatrix4D() const
+{
+	Matrix4D m;
+	for (int i = 0; i < 4; i++)
+		for (int j = 0; j < 4; j++)
+			m.n[i][j] = (float)n[i][j];
+	return m;
+}
+
+MatrixDouble4D& MatrixDouble4D::operator *=(const MatrixDouble4D& m)
+{
+	*this = (*this) * m;
+	return (*this);
+}
+
+MatrixDouble4D& MatrixDouble4D::SetIdentity(void)
+{
+	for (int i = 0; i < 4; i++)
+		for (int j = 0; j < 4; j++)
+			n[i][j] = i == j ? 1.0 : 0.0;
+	return (*this);
+}
+
+MatrixDouble4D& MatrixDouble4D::AssignTranslation(const VectorDouble3D& translation) {
+    Set(1.0, 0, 0, translation.x,
+        0, 1.0, 0, translation.y,
+        0, 0, 1.0, translation.z,
+        0, 0, 0, 1.0);
+    return (*this);
+}
+
+MatrixDouble4D operator *(const MatrixDouble4D& __restrict__ m1,
+const MatrixDouble4D& __restrict__ m2)
+{
+	MatrixDouble4D m3;
+	for (int i = 0; i < 4; i++)
+		for (int j = 0; j < 4; j++)
+			m3.n[i][j] = m1.n[0][j] * m2.n[i][0] + m1.n[1][j] * m2.n[i][1] +
+				m1.n[2][j] * m2.n[i][2] + m1.n[3][j] * m2.n[i][3];
+	return m3;
+}
+
+VectorDouble4D operator *(const MatrixDouble4D& m, const VectorDouble4D& v)
+{
+	return (VectorDouble4D(m.n[0][0] * v.x + m.n[1][0] * v.y + m.n[2][0] * v.z + m.n[3][0] * v.w,
+		m.n[0][1] * v.x + m.n[1][1] * v.y + m.n[2][1] * v.z + m.n[3][1] * v.w,
+		m.n[0][2] * v.x + m.n[1][2] * v.y + m.n[2][2] * v.z + m.n[3][2] * v.w,
+		m.n[0][3] * v.x + m.n[1][3] * v.y + m.n[2][3] * v.z + m.n[3][3] * v.w));
+}
+
+VectorDouble4D operator *(const MatrixDouble4D& m, const PointDouble3D& p)
+{
+	return (VectorDouble4D(m.n[0][0] * p.x + m.n[1][0] * p.y + m.n[2][0] * p.z + m.n[3][0],
+		m.n[0][1] * p.x + m.n[1][1] * p.y + m.n[2][1] * p.z + m.n[3][1],
+		m.n[0][2] * p.x + m.n[1][2] * p.y + m.n[2][2] * p.z + m.n[3][2],
+		m.n[0][3] * p.x + m.n[1][3] * p.y + m.n[2][3] * p.z + m.n[3][3]));
+}
+
+
+// Quaternion functions.
+
+Quaternion& Quaternion::operator *=(const Quaternion& q)
+{
+	(*this) = (*this) * q;
+	return (*this);
+}
+
+Quaternion& Quaternion::operator *=(float t)
+{
+	x *= t;
+	y *= t;
+	z *= t;
+	w *= t;
+	return (*this);
+}
+
+Quaternion& Quaternion::SetIdentity(void)
+{
+	return Set(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+Quaternion& Quaternion::AssignRotationAlongAxis(const Vector3D& axis, float angle)
+{
+	float s = sinf(angle * 0.5f);
+	return Set(axis.x * s, axis.y * s, axis.z * s, cosf(angle * 0.5f));
+}
+
+Quaternion& Quaternion::Normalize(void)
+{
+	return ((*this) *= 1.0f / sqrtf(Dot(*this, *this)));
+}
+
+Matrix3D Quaternion::GetRotationMatrix3D(void) const
+{
+	return (Matrix3D(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - w * z),
+		2.0f * (x * z + w * y),
+		2.0f * (x * y + w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z - w * x),
+		2.0f * (x * z - w * y), 2.0f * (y * z + w * x), 1.0f - 2.0f * (x * x + y * y)));
+}
+
+Matrix4x3RM Quaternion::GetRotationMatrix4x3RM(void) const
+{
+	return (Matrix4x3RM(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - w * z),
+		2.0f * (x * z + w * y), 0.0f,
+		2.0f * (x * y + w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z - w * x), 0.0f,
+		2.0f * (x * z - w * y), 2.0f * (y * z + w * x), 1.0f - 2.0f * (x * x + y * y),
+		0.0f));
+}
+
+Quaternion operator *(const Quaternion& q1, const Quaternion& q2)
+{
+	return (Quaternion(
+		q1.w * q2.x + q1.x * q2.w + q1.y * q2.z - q1.z * q2.y,
+		q1.w * q2.y - q1.x * q2.z + q1.y * q2.w + q1.z * q2.x,
+		q1.w * q2.z + q1.x * q2.y - q1.y * q2.x + q1.z * q2.w,
+		q1.w * q2.w - q1.x * q2.x - q1.y * q2.y - q1.z * q2.z));
+}
+
+Vector3D Rotate(const Quaternion& q, const Vector3D& v)
+{
+	// v' = v + w * t + u x t, with u the vector part of q and t = 2 * (u x v).
+	const Vector3D& u = q.GetVectorPart();
+	Vector3D t = 2.0f * Cross(u, v);
+	return (v + q.w * t + Cross(u, t));
+}
+
+Quaternion Nlerp(const Quaternion& q1, const Quaternion& q2, float t)
+{
+	float s = (Dot(q1, q2) < 0.0f) ? - t : t;
+	Quaternion q((1.0f - t) * q1.x + s * q2.x, (1.0f - t) * q1.y + s * q2.y,
+		(1.0f - t) * q1.z + s * q2.z, (1.0f - t) * q1.w + s * q2.w);
+	return (q.Normalize());
+}
+
+Quaternion Slerp(const Quaternion& q1, const Quaternion& q2, float t)
+{
+	float c = Dot(q1, q2);
+	float sign = 1.0f;
+	if (c < 0.0f) {
+		c = - c;
+		sign = - 1.0f;
+	}
+	// Fall back to linear interpolation when the angle is very small.
+	if (c > 0.9999f)
+		return (Nlerp(q1, q2, t));
+	float angle = acosf(c);
+	float inv_sin = 1.0f / sinf(angle);
+	float c1 = sinf((1.0f - t) * angle) * inv_sin;
+	float c2 = sign * sinf(t * angle) * inv_sin;
+	return (Quaternion(c1 * q1.x + c2 * q2.x, c1 * q1.y + c2 * q2.y,
+		c1 * q1.z + c2 * q2.z, c1 * q1.w + c2 * q2.w));
+}
 
 // Additional member functions for debugging.
 
@@ -854,6 +1113,19 @@ char *Matrix4D::GetString() const {
     return s;
 }
 
+char *MatrixDouble4D::GetString() const {
+    char *s = new char[256];
+    sprintf(s, "MatrixDouble4D( ");
+    for (int i = 0; i < 4; i++) {
+        VectorDouble4D V = GetRow(i);
+        char rowstr[128];
+        sprintf(rowstr, "(%.15G, %.15G, %.15G, %.15G) ", V.x, V.y, V.z, V.w);
+        strcat(s, rowstr);
+    }
+    strcat(s, ")");
+    return s;
+}
+
 char *Matrix4x3RM::GetString() const {
     char *s = new char[256];
     sprintf(s, "Matrix4x3RM( ");
@@ -871,4 +1143,8 @@ char *Matrix4x3RM::GetString() const {
     return s;
 }
 
-
+char *Quaternion::GetString() const {
+    char *s = new char[128];
+    sprintf(s, "Quaternion(%.10G, %.10G, %.10G, %.10G)", x, y, z, w);
+    return s;
+}
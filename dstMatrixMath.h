@@ -127,6 +127,8 @@ class DST_API Matrix3D
 		// Return text respresentation. To be freed with delete [].
 		char *GetString() const;
 
+		// dstMultiply is a non-SIMD multiplication function.
+		friend DST_API Matrix3D dstMultiply(const Matrix3D& m1, const Matrix3D& m2);
 		friend DST_API Matrix3D operator *(const Matrix3D& m1, const Matrix3D& m2);
 		friend DST_API Matrix3D operator *(const Matrix3D& m, float t);
 		friend DST_API Matrix3D operator /(const Matrix3D& m, float t);
@@ -411,6 +413,10 @@ class DST_API Matrix4D
 } DST_ALIGNED(16);
 
 DST_API Matrix4D Inverse(const Matrix4x3RM& m);
+// Inverse of an affine transformation, without promotion to Matrix4D. RigidInverse
+// requires the 3x3 part to be a rotation matrix and uses its transpose.
+DST_API Matrix4x3RM AffineInverse(const Matrix4x3RM& m);
+DST_API Matrix4x3RM RigidInverse(const Matrix4x3RM& m);
 DST_API Matrix4D Transpose(const Matrix4x3RM& m);
 
 DST_API float Determinant(const Matrix4D& m);
@@ -418,8 +424,242 @@ DST_API Matrix4D Inverse(const Matrix4D& m);
 DST_API Matrix4D Adjugate(const Matrix4D& m);
 DST_API Matrix4D Transpose(const Matrix4D& m);
 
+// Normal matrix (inverse transpose of the upper-left 3x3 part) of a transformation,
+// returned as a Matrix4x3RM with zero translation.
+DST_API Matrix4x3RM NormalMatrix(const Matrix4x3RM& m);
+DST_API Matrix4x3RM NormalMatrix(const Matrix4D& m);
+
+// Double-precision 4x4 matrix, stored in column-major order like Matrix4D. Intended for
+// world-space transformations of coordinates that exceed float precision.
+
+class DST_API MatrixDouble4D
+{
+	public:
+
+		double	n[4][4];
+
+	public:
+
+		MatrixDouble4D() {}
+
+		MatrixDouble4D(double n00, double n01, double n02, double n03, double n10,
+		double n11, double n12, double n13, double n20, double n21, double n22, double n23,
+		double n30, double n31, double n32, double n33) {
+			Set(n00, n01, n02, n03, n10, n11, n12, n13, n20, n21, n22, n23, n30, n31, n32, n33);
+		}
+
+		explicit MatrixDouble4D(const Matrix4D& m) {
+			for (int i = 0; i < 4; i++)
+				for (int j = 0; j < 4; j++)
+					n[i][j] = m.n[i][j];
+		}
+
+		// Set row-by-row, column-by-column (second element is first row, second column.
+		MatrixDouble4D& Set(double n00, double n01, double n02, double n03, double n10,
+		double n11, double n12, double n13, double n20, double n21, double n22, double n23,
+		double n30, double n31, double n32, double n33) {
+			n[0][0] = n00;
+			n[1][0] = n01;
+			n[2][0] = n02;
+			n[3][0] = n03;
+			n[0][1] = n10;
+			n[1][1] = n11;
+			n[2][1] = n12;
+			n[3][1] = n13;
+			n[0][2] = n20;
+			n[1][2] = n21;
+			n[2][2] = n22;
+			n[3][2] = n23;
+			n[0][3] = n30;
+			n[1][3] = n31;
+			n[2][3] = n32;
+			n[3][3] = n33;
+			return (*this);
+		}
+
+		// Return element at row i, column j.
+		double& operator ()(int i, int j)
+		{
+			return (n[j][i]);
+		}
+
+		const double& operator ()(int i, int j) const
+		{
+			return (n[j][i]);
+		}
+
+		const double& Get(int column, int row) const {
+			return (n[column][row]);
+		}
+
+ 		// Get row j.
+		VectorDouble4D GetRow(int j) const
+		{
+			return (VectorDouble4D(n[0][j], n[1][j], n[2][j], n[3][j]));
+		}
+
+		// Conversion to single precision.
+		Matrix4D GetMatrix4D() const;
+
+		MatrixDouble4D& operator *=(const MatrixDouble4D& m);
+
+		MatrixDouble4D& SetIdentity(void);
+		MatrixDouble4D& AssignTranslation(const VectorDouble3D& translation);
+		// Return text respresentation. To be freed with delete [].
+		char *GetString() const;
+
+		friend DST_API MatrixDouble4D operator *(const MatrixDouble4D& m1,
+			const MatrixDouble4D& m2);
+		friend DST_API VectorDouble4D operator *(const MatrixDouble4D& m,
+			const VectorDouble4D& v);
+		friend DST_API VectorDouble4D operator *(const MatrixDouble4D& m,
+			const PointDouble3D& p);
+} DST_ALIGNED(16);
+
+// Quaternion class, stored as (x, y, z, w) with w the scalar part. Unit quaternions
+// represent rotations; the conversion and rotation functions assume a unit quaternion.
+
+class DST_API Quaternion
+{
+	public:
+
+		float	x;
+		float	y;
+		float	z;
+		float	w;
+
+	public:
+
+		Quaternion() {}
+
+		Quaternion(float a, float b, float c, float s)
+		{
+			x = a;
+			y = b;
+			z = c;
+			w = s;
+		}
+
+		Quaternion(const Vector3D& v, float s)
+		{
+			x = v.x;
+			y = v.y;
+			z = v.z;
+			w = s;
+		}
+
+		Quaternion& Set(float a, float b, float c, float s)
+		{
+			x = a;
+			y = b;
+			z = c;
+			w = s;
+			return (*this);
+		}
+
+		const Vector3D& GetVectorPart(void) const
+		{
+			return (*reinterpret_cast<const Vector3D *>(&x));
+		}
+
+		Quaternion& operator *=(const Quaternion& q);
+		Quaternion& operator *=(float t);
+
+		Quaternion& SetIdentity(void);
+		// The axis must be normalized.
+		Quaternion& AssignRotationAlongAxis(const Vector3D& axis, float angle);
+		Quaternion& Normalize(void);
+		Matrix3D GetRotationMatrix3D(void) const;
+		Matrix4x3RM GetRotationMatrix4x3RM(void) const;
+		// Return text respresentation. To be freed with delete [].
+		char *GetString() const;
+
+		friend DST_API Quaternion operator *(const Quaternion& q1, const Quaternion& q2);
+} DST_ALIGNED(16);
+
+inline Quaternion operator *(const Quaternion& q, float t)
+{
+	return (Quaternion(q.x * t, q.y * t, q.z * t, q.w * t));
+}
+
+inline Quaternion operator *(float t, const Quaternion& q)
+{
+	return (q * t);
+}
+
+inline float Dot(const Quaternion& q1, const Quaternion& q2)
+{
+	return (q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w);
+}
+
+inline Quaternion Conjugate(const Quaternion& q)
+{
+	return (Quaternion(- q.x, - q.y, - q.z, q.w));
+}
+
+// Rotate a vector using a unit quaternion (equivalent to q * v * Conjugate(q)).
+DST_API Vector3D Rotate(const Quaternion& q, const Vector3D& v);
+// Normalized linear and spherical linear interpolation between unit quaternions along
+// the shortest arc.
+DST_API Quaternion Nlerp(const Quaternion& q1, const Quaternion& q2, float t);
+DST_API Quaternion Slerp(const Quaternion& q1, const Quaternion& q2, float t);
+
+// Four quaternions in SoA (structure of arrays) form. Arrays of QuaternionSoA4 can be
+// processed by the batch functions without transposition; the array for n quaternions
+// consists of (n + 3) / 4 elements.
+
+class QuaternionSoA4
+{
+	public:
+
+		float	x[4];
+		float	y[4];
+		float	z[4];
+		float	w[4];
+
+	public:
+
+		Quaternion Get(int i) const
+		{
+			return (Quaternion(x[i], y[i], z[i], w[i]));
+		}
+
+		QuaternionSoA4& Set(int i, const Quaternion& q)
+		{
+			x[i] = q.x;
+			y[i] = q.y;
+			z[i] = q.z;
+			w[i] = q.w;
+			return (*this);
+		}
+} DST_ALIGNED(16);
+
+DST_INLINE_ONLY void dstConvertQuaternionsToSoA(int n, const Quaternion * DST_RESTRICT q,
+QuaternionSoA4 * DST_RESTRICT q_soa) {
+	for (int i = 0; i < n; i++)
+		q_soa[i >> 2].Set(i & 3, q[i]);
+}
+
+DST_INLINE_ONLY void dstConvertQuaternionsFromSoA(int n, const QuaternionSoA4 * DST_RESTRICT q_soa,
+Quaternion * DST_RESTRICT q) {
+	for (int i = 0; i < n; i++)
+		q[i] = q_soa[i >> 2].Get(i & 3);
+}
+
 // Inline multiplication functions.
 
+DST_INLINE_ONLY Matrix3D dstInlineMultiply(const Matrix3D& m1, const Matrix3D& m2) {
+	return (Matrix3D(m1.n[0][0] * m2.n[0][0] + m1.n[1][0] * m2.n[0][1] + m1.n[2][0] * m2.n[0][2],
+		m1.n[0][0] * m2.n[1][0] + m1.n[1][0] * m2.n[1][1] + m1.n[2][0] * m2.n[1][2],
+		m1.n[0][0] * m2.n[2][0] + m1.n[1][0] * m2.n[2][1] + m1.n[2][0] * m2.n[2][2],
+		m1.n[0][1] * m2.n[0][0] + m1.n[1][1] * m2.n[0][1] + m1.n[2][1] * m2.n[0][2],
+		m1.n[0][1] * m2.n[1][0] + m1.n[1][1] * m2.n[1][1] + m1.n[2][1] * m2.n[1][2],
+		m1.n[0][1] * m2.n[2][0] + m1.n[1][1] * m2.n[2][1] + m1.n[2][1] * m2.n[2][2],
+		m1.n[0][2] * m2.n[0][0] + m1.n[1][2] * m2.n[0][1] + m1.n[2][2] * m2.n[0][2],
+		m1.n[0][2] * m2.n[1][0] + m1.n[1][2] * m2.n[1][1] + m1.n[2][2] * m2.n[1][2],
+		m1.n[0][2] * m2.n[2][0] + m1.n[1][2] * m2.n[2][1] + m1.n[2][2] * m2.n[2][2]));
+}
+
 DST_INLINE_ONLY Matrix4x3RM dstInlineMultiply(const Matrix4x3RM& m1, const Matrix4x3RM& m2) {
 	return Matrix4x3RM(
 		m1.Get(0, 0) * m2.Get(0, 0) + m1.Get(1, 0) * m2.Get(0, 1) + m1.Get(2, 0) * m2.Get(0, 2),
@@ -483,6 +723,85 @@ DST_INLINE_ONLY Matrix4D dstInlineMultiply(const Matrix4D& m1, const Matrix4D& m
 		m1.n[0][3] * m2.n[3][0] + m1.n[1][3] * m2.n[3][1] + m1.n[2][3] * m2.n[3][2] + m1.n[3][3] * m2.n[3][3]));
 }
 
+// Parameters for transforming points to screen space in a single pass: a projection
+// (or model-view-projection) matrix followed by the perspective divide and a
+// viewport mapping of normalized device coordinates, similar to glViewport and
+// glDepthRange.
+
+class DST_API dstProjectionViewport {
+public :
+	Matrix4D projection;
+	// Screen coordinate = normalized device coordinate * scale + offset.
+	float scale[4];
+	float offset[4];
+
+	dstProjectionViewport() { }
+	dstProjectionViewport(const Matrix4D& m, float x, float y, float width, float height,
+	float depth_near = 0.0f, float depth_far = 1.0f) {
+		projection = m;
+		SetViewport(x, y, width, height, depth_near, depth_far);
+	}
+
+	void SetViewport(float x, float y, float width, float height, float depth_near = 0.0f,
+	float depth_far = 1.0f) {
+		scale[0] = width * 0.5f;
+		scale[1] = height * 0.5f;
+		scale[2] = (depth_far - depth_near) * 0.5f;
+		scale[3] = 0.0f;
+		offset[0] = x + width * 0.5f;
+		offset[1] = y + height * 0.5f;
+		offset[2] = (depth_far + depth_near) * 0.5f;
+		offset[3] = 0.0f;
+	}
+} DST_ALIGNED(16);
+
+// Projected vertex with floating point screen coordinates.
+
+class dstScreenVertex {
+public :
+	float x, y, z;
+	uint32_t clip_flags;
+} DST_ALIGNED(16);
+
+// Projected vertex with 16-bit integer screen coordinates (rounded to the nearest
+// integer with saturation). The depth range should be set so that z is within
+// [0, 65535], for example using depth_near = 0.0f and depth_far = 65535.0f.
+
+class dstScreenVertexInt16 {
+public :
+	int16_t x, y;
+	uint16_t z;
+	uint16_t clip_flags;
+};
+
+// Small cache of normal matrices, keyed on the upper-left 3x3 part of the model
+// matrix, so that transforming several normal arrays with the same transformation
+// only calculates the inverse transpose once. Entries are replaced round-robin.
+// A cache must not be shared between threads.
+
+#define DST_NORMAL_MATRIX_CACHE_SIZE 4
+
+class DST_API dstNormalMatrixCache {
+private :
+	Matrix4x3RM key[DST_NORMAL_MATRIX_CACHE_SIZE];
+	Matrix4x3RM normal_matrix[DST_NORMAL_MATRIX_CACHE_SIZE];
+	int nu_entries;
+	int next_entry;
+
+	const Matrix4x3RM& Lookup(const Matrix4x3RM& k);
+
+public :
+	dstNormalMatrixCache() {
+		Clear();
+	}
+	void Clear() {
+		nu_entries = 0;
+		next_entry = 0;
+	}
+	const Matrix4x3RM& GetNormalMatrix(const Matrix4x3RM& m);
+	const Matrix4x3RM& GetNormalMatrix(const Matrix4D& m);
+};
+
 // Matrix functions with optional SIMD support.
 // All matrices must be aligned on a 16-byte boundary.
 
@@ -502,6 +821,67 @@ const Matrix4x3RM & DST_RESTRICT m2, Matrix4D & DST_RESTRICT result) {
 		(float *)&result);
 }
 
+// Matrix3D is not aligned.
+
+DST_INLINE_ONLY void dstMatrixMultiply(const Matrix3D & DST_RESTRICT m1,
+const Matrix3D & DST_RESTRICT m2, Matrix3D & DST_RESTRICT result) {
+	DST_FUNC_LOOKUP(dstMatrixMultiply3x3CM)((const float *)&m1, (const float *)&m2,
+		(float *)&result);
+}
+
+// Multiply arrays of matrices pairwise (m_result[i] = m1[i] * m2[i]).
+
+DST_INLINE_ONLY void dstMatrixMultiplyMatrices(int n, const Matrix4x3RM * DST_RESTRICT m1,
+const Matrix4x3RM * DST_RESTRICT m2, Matrix4x3RM * DST_RESTRICT m_result) {
+	DST_FUNC_LOOKUP(dstMatrixMultiplyMatrices4x3RM)(n, (const float *)m1, (const float *)m2,
+		(float *)m_result);
+}
+
+DST_INLINE_ONLY void dstMatrixMultiplyMatrices(int n, const Matrix3D * DST_RESTRICT m1,
+const Matrix3D * DST_RESTRICT m2, Matrix3D * DST_RESTRICT m_result) {
+	DST_FUNC_LOOKUP(dstMatrixMultiplyMatrices3x3CM)(n, (const float *)m1, (const float *)m2,
+		(float *)m_result);
+}
+
+// Invert an array of matrices. For Matrix4x3RM, dstInvertMatrices handles general affine
+// transformations while dstInvertRigidMatrices requires the 3x3 part to be a rotation.
+// Matrix4D and Matrix4x3RM arrays must be aligned on a 16-byte boundary.
+
+DST_INLINE_ONLY void dstInvertMatrices(int n, const Matrix4D * DST_RESTRICT m,
+Matrix4D * DST_RESTRICT m_result) {
+	DST_FUNC_LOOKUP(dstInvertMatrices4x4CM)(n, (const float *)m, (float *)m_result);
+}
+
+DST_INLINE_ONLY void dstInvertMatrices(int n, const Matrix3D * DST_RESTRICT m,
+Matrix3D * DST_RESTRICT m_result) {
+	DST_FUNC_LOOKUP(dstInvertMatrices3x3CM)(n, (const float *)m, (float *)m_result);
+}
+
+DST_INLINE_ONLY void dstInvertMatrices(int n, const Matrix4x3RM * DST_RESTRICT m,
+Matrix4x3RM * DST_RESTRICT m_result) {
+	DST_FUNC_LOOKUP(dstInvertMatrices4x3RM)(n, (const float *)m, (float *)m_result);
+}
+
+DST_INLINE_ONLY void dstInvertRigidMatrices(int n, const Matrix4x3RM * DST_RESTRICT m,
+Matrix4x3RM * DST_RESTRICT m_result) {
+	DST_FUNC_LOOKUP(dstInvertRigidMatrices4x3RM)(n, (const float *)m, (float *)m_result);
+}
+
+// Solve an array of linear systems m[i] * x[i] = v[i]. For the 4x4 version, the
+// Vector4D arrays must be aligned on a 16-byte boundary.
+
+DST_INLINE_ONLY void dstSolveLinearSystems(int n, const Matrix3D * DST_RESTRICT m,
+const Vector3D * DST_RESTRICT v, Vector3D * DST_RESTRICT x) {
+	DST_FUNC_LOOKUP(dstSolveLinearSystems3x3CMV3)(n, (const float *)m, (const float *)v,
+		(float *)x);
+}
+
+DST_INLINE_ONLY void dstSolveLinearSystems(int n, const Matrix4D * DST_RESTRICT m,
+const Vector4D * DST_RESTRICT v, Vector4D * DST_RESTRICT x) {
+	DST_FUNC_LOOKUP(dstSolveLinearSystems4x4CMV4)(n, (const float *)m, (const float *)v,
+		(float *)x);
+}
+
 // Multiply a constant matrix with an array of vectors.
 
 DST_INLINE_ONLY void dstMatrixMultiplyVectors1x4(const Matrix4D & DST_RESTRICT m,
@@ -518,24 +898,320 @@ const Vector4D * DST_RESTRICT v1, Vector4D * DST_RESTRICT v2) {
 
 DST_INLINE_ONLY void dstMatrixMultiplyVectors1x4(const Matrix4D & DST_RESTRICT m,
 const Point3DPadded * DST_RESTRICT v1, Point3DPadded * DST_RESTRICT v2) {
-	// Not yet SIMD-accelerated.
-	DST_FUNC_LOOKUP_NO_SIMD(dstMatrixMultiplyVectors1x4M4x4CMP3P)((const float *)&m,
+	DST_FUNC_LOOKUP(dstMatrixMultiplyVectors1x4M4x4CMP3P)((const float *)&m,
 		(const float *)v1, (float *)v2);
 }
 
 DST_INLINE_ONLY void dstMatrixMultiplyVectors1xN(int n, const Matrix4D & DST_RESTRICT m,
 const Point3DPadded * DST_RESTRICT v1, Point3DPadded * DST_RESTRICT v2) {
-	// Not yet SIMD-accelerated.
-	DST_FUNC_LOOKUP_NO_SIMD(dstMatrixMultiplyVectors1xNM4x4CMP3P)(n, (const float *)&m,
+	DST_FUNC_LOOKUP(dstMatrixMultiplyVectors1xNM4x4CMP3P)(n, (const float *)&m,
+		(const float *)v1, (float *)v2);
+}
+
+// For arrays of packed three-float vectors (Vector3D and Point3D), the arrays must be
+// aligned on a 16-byte boundary.
+
+DST_INLINE_ONLY void dstMatrixMultiplyVectors1xN(int n, const Matrix4D & DST_RESTRICT m,
+const Vector3D * DST_RESTRICT v1, Vector3D * DST_RESTRICT v2) {
+	DST_FUNC_LOOKUP(dstMatrixMultiplyVectors1xNM4x4CMV3)(n, (const float *)&m,
 		(const float *)v1, (float *)v2);
 }
 
 DST_INLINE_ONLY void dstMatrixMultiplyVectors1xN(int n, const Matrix4D & DST_RESTRICT m,
+const Point3D * DST_RESTRICT v1, Point3D * DST_RESTRICT v2) {
+	DST_FUNC_LOOKUP(dstMatrixMultiplyVectors1xNM4x4CMP3)(n, (const float *)&m,
+		(const float *)v1, (float *)v2);
+}
+
+DST_INLINE_ONLY void dstMatrixMultiplyVectors1xN(int n, const Matrix4x3RM & DST_RESTRICT m,
 const Vector3D * DST_RESTRICT v1, Vector3D * DST_RESTRICT v2) {
-	// Not yet SIMD-accelerated.
-	DST_FUNC_LOOKUP_NO_SIMD(dstMatrixMultiplyVectors1xNM4x4CMV3)(n, (const float *)&m,
+	DST_FUNC_LOOKUP(dstMatrixMultiplyVectors1xNM4x3RMV3)(n, (const float *)&m,
+		(const float *)v1, (float *)v2);
+}
+
+DST_INLINE_ONLY void dstMatrixMultiplyVectors1xN(int n, const Matrix4x3RM & DST_RESTRICT m,
+const Point3D * DST_RESTRICT v1, Point3D * DST_RESTRICT v2) {
+	DST_FUNC_LOOKUP(dstMatrixMultiplyVectors1xNM4x3RMP3)(n, (const float *)&m,
+		(const float *)v1, (float *)v2);
+}
+
+DST_INLINE_ONLY void dstMatrixMultiplyVectors1xN(int n, const Matrix4x3RM & DST_RESTRICT m,
+const Vector3DPadded * DST_RESTRICT v1, Vector3DPadded * DST_RESTRICT v2) {
+	DST_FUNC_LOOKUP(dstMatrixMultiplyVectors1xNM4x3RMV3P)(n, (const float *)&m,
+		(const float *)v1, (float *)v2);
+}
+
+DST_INLINE_ONLY void dstMatrixMultiplyVectors1xN(int n, const Matrix4x3RM & DST_RESTRICT m,
+const Point3DPadded * DST_RESTRICT v1, Point3DPadded * DST_RESTRICT v2) {
+	DST_FUNC_LOOKUP(dstMatrixMultiplyVectors1xNM4x3RMP3P)(n, (const float *)&m,
+		(const float *)v1, (float *)v2);
+}
+
+// Transform arrays of 2D vectors or points with a Matrix3D used as a 2D affine
+// transformation (the third row is assumed to be (0.0f, 0.0f, 1.0f)). Points are
+// translated, vectors are not. Interleaved arrays (Vector2D, Point2D) must be aligned
+// on a 16-byte boundary; SoA arrays are aligned by definition and may be written up to
+// the end of the last four-element block.
+
+DST_INLINE_ONLY void dstMatrixMultiplyVectors1xN(int n, const Matrix3D& m,
+const Vector2D * DST_RESTRICT v1, Vector2D * DST_RESTRICT v2) {
+	DST_FUNC_LOOKUP(dstMatrixMultiplyVectors1xNM3x3CMV2)(n, (const float *)&m,
+		(const float *)v1, (float *)v2);
+}
+
+DST_INLINE_ONLY void dstMatrixMultiplyVectors1xN(int n, const Matrix3D& m,
+const Point2D * DST_RESTRICT v1, Point2D * DST_RESTRICT v2) {
+	DST_FUNC_LOOKUP(dstMatrixMultiplyVectors1xNM3x3CMP2)(n, (const float *)&m,
+		(const float *)v1, (float *)v2);
+}
+
+DST_INLINE_ONLY void dstMatrixMultiplyVectors1xN(int n, const Matrix3D& m,
+const Vector2DSoA4 * DST_RESTRICT v1, Vector2DSoA4 * DST_RESTRICT v2) {
+	DST_FUNC_LOOKUP(dstMatrixMultiplyVectors1xNM3x3CMV2SoA)(n, (const float *)&m,
+		(const float *)v1, (float *)v2);
+}
+
+DST_INLINE_ONLY void dstMatrixMultiplyVectors1xN(int n, const Matrix3D& m,
+const Point2DSoA4 * DST_RESTRICT v1, Point2DSoA4 * DST_RESTRICT v2) {
+	DST_FUNC_LOOKUP(dstMatrixMultiplyVectors1xNM3x3CMP2SoA)(n, (const float *)&m,
+		(const float *)v1, (float *)v2);
+}
+
+// Multiply a double-precision matrix with an array of double-precision points.
+
+DST_INLINE_ONLY void dstMatrixMultiplyVectors1xN(int n, const MatrixDouble4D& m,
+const PointDouble3D * DST_RESTRICT v1, PointDouble3D * DST_RESTRICT v2) {
+	DST_FUNC_LOOKUP(dstMatrixMultiplyVectors1xNMD4x4CMPD3)(n, (const float *)&m,
 		(const float *)v1, (float *)v2);
 }
 
+// Transform double-precision points relative to origin (typically the camera position)
+// and write single-precision points, in a single pass. The subtraction of the origin
+// is performed on the translation of the matrix in double precision, which requires
+// the bottom row of the matrix to be (0, 0, 0, 1). The destination array must be
+// 16-byte aligned.
+
+DST_INLINE_ONLY void dstMatrixMultiplyVectors1xN(int n, const MatrixDouble4D& m,
+const PointDouble3D& origin, const PointDouble3D * DST_RESTRICT v1,
+Point3D * DST_RESTRICT v2) {
+	MatrixDouble4D m_relative = m;
+	m_relative.n[3][0] -= origin.x;
+	m_relative.n[3][1] -= origin.y;
+	m_relative.n[3][2] -= origin.z;
+	DST_FUNC_LOOKUP(dstMatrixMultiplyVectors1xNMD4x4CMPD3P3)(n, (const float *)&m_relative,
+		(const float *)v1, (float *)v2);
+}
+
+// Multiply a normal matrix (the translation is ignored) with an array of vectors and
+// normalize the results in the same pass. Alignment requirements are the same as for
+// dstMatrixMultiplyVectors1xN.
+
+DST_INLINE_ONLY void dstMatrixMultiplyNormalizeVectors1xN(int n,
+const Matrix4x3RM & DST_RESTRICT m, const Vector3D * DST_RESTRICT v1,
+Vector3D * DST_RESTRICT v2) {
+	DST_FUNC_LOOKUP(dstMatrixMultiplyNormalizeVectors1xNM4x3RMV3)(n, (const float *)&m,
+		(const float *)v1, (float *)v2);
+}
+
+DST_INLINE_ONLY void dstMatrixMultiplyNormalizeVectors1xN(int n,
+const Matrix4x3RM & DST_RESTRICT m, const Vector3DPadded * DST_RESTRICT v1,
+Vector3DPadded * DST_RESTRICT v2) {
+	DST_FUNC_LOOKUP(dstMatrixMultiplyNormalizeVectors1xNM4x3RMV3P)(n, (const float *)&m,
+		(const float *)v1, (float *)v2);
+}
+
+// Transform an array of normals with the inverse transpose of the model matrix m and
+// renormalize. When a cache is given, the normal matrix is looked up in (or added to)
+// the cache instead of being calculated for every call.
+
+DST_INLINE_ONLY void dstTransformNormals(int n, const Matrix4x3RM& m,
+const Vector3D * DST_RESTRICT v1, Vector3D * DST_RESTRICT v2,
+dstNormalMatrixCache *cache = NULL) {
+	if (cache != NULL)
+		dstMatrixMultiplyNormalizeVectors1xN(n, cache->GetNormalMatrix(m), v1, v2);
+	else
+		dstMatrixMultiplyNormalizeVectors1xN(n, NormalMatrix(m), v1, v2);
+}
+
+DST_INLINE_ONLY void dstTransformNormals(int n, const Matrix4x3RM& m,
+const Vector3DPadded * DST_RESTRICT v1, Vector3DPadded * DST_RESTRICT v2,
+dstNormalMatrixCache *cache = NULL) {
+	if (cache != NULL)
+		dstMatrixMultiplyNormalizeVectors1xN(n, cache->GetNormalMatrix(m), v1, v2);
+	else
+		dstMatrixMultiplyNormalizeVectors1xN(n, NormalMatrix(m), v1, v2);
+}
+
+DST_INLINE_ONLY void dstTransformNormals(int n, const Matrix4D& m,
+const Vector3D * DST_RESTRICT v1, Vector3D * DST_RESTRICT v2,
+dstNormalMatrixCache *cache = NULL) {
+	if (cache != NULL)
+		dstMatrixMultiplyNormalizeVectors1xN(n, cache->GetNormalMatrix(m), v1, v2);
+	else
+		dstMatrixMultiplyNormalizeVectors1xN(n, NormalMatrix(m), v1, v2);
+}
+
+DST_INLINE_ONLY void dstTransformNormals(int n, const Matrix4D& m,
+const Vector3DPadded * DST_RESTRICT v1, Vector3DPadded * DST_RESTRICT v2,
+dstNormalMatrixCache *cache = NULL) {
+	if (cache != NULL)
+		dstMatrixMultiplyNormalizeVectors1xN(n, cache->GetNormalMatrix(m), v1, v2);
+	else
+		dstMatrixMultiplyNormalizeVectors1xN(n, NormalMatrix(m), v1, v2);
+}
+
+// Transform an array of points with a projection matrix, calculate clip flags, and
+// map to screen coordinates after the perspective divide. The source and destination
+// arrays must be aligned on a 16-byte boundary. Points with a w coordinate of zero or
+// less after projection (behind the viewer) have undefined screen coordinates; they
+// can be recognized by the clip flags.
+
+DST_INLINE_ONLY void dstTransformAndProjectPoints(int n, const dstProjectionViewport& pv,
+const Point3D * DST_RESTRICT p, dstScreenVertex * DST_RESTRICT result) {
+	DST_FUNC_LOOKUP(dstTransformAndProjectPointsP3)(n, (const float *)&pv,
+		(const float *)p, (float *)result);
+}
+
+DST_INLINE_ONLY void dstTransformAndProjectPoints(int n, const dstProjectionViewport& pv,
+const Point3DPadded * DST_RESTRICT p, dstScreenVertex * DST_RESTRICT result) {
+	DST_FUNC_LOOKUP(dstTransformAndProjectPointsP3P)(n, (const float *)&pv,
+		(const float *)p, (float *)result);
+}
+
+DST_INLINE_ONLY void dstTransformAndProjectPoints(int n, const dstProjectionViewport& pv,
+const Point3D * DST_RESTRICT p, dstScreenVertexInt16 * DST_RESTRICT result) {
+	DST_FUNC_LOOKUP(dstTransformAndProjectPointsP3Int16)(n, (const float *)&pv,
+		(const float *)p, (float *)result);
+}
+
+DST_INLINE_ONLY void dstTransformAndProjectPoints(int n, const dstProjectionViewport& pv,
+const Point3DPadded * DST_RESTRICT p, dstScreenVertexInt16 * DST_RESTRICT result) {
+	DST_FUNC_LOOKUP(dstTransformAndProjectPointsP3PInt16)(n, (const float *)&pv,
+		(const float *)p, (float *)result);
+}
+
+// Quaternion batch functions. Quaternion and QuaternionSoA4 arrays must be aligned on a
+// 16-byte boundary. The functions that return rotations (all except multiplication)
+// expect unit quaternions.
+
+DST_INLINE_ONLY void dstMultiplyQuaternions(int n, const Quaternion * DST_RESTRICT q1,
+const Quaternion * DST_RESTRICT q2, Quaternion * DST_RESTRICT q_result) {
+	DST_FUNC_LOOKUP(dstMultiplyQuaternionsQ)(n, (const float *)q1, (const float *)q2,
+		(float *)q_result);
+}
+
+DST_INLINE_ONLY void dstMultiplyQuaternions(int n, const QuaternionSoA4 * DST_RESTRICT q1,
+const QuaternionSoA4 * DST_RESTRICT q2, QuaternionSoA4 * DST_RESTRICT q_result) {
+	DST_FUNC_LOOKUP(dstMultiplyQuaternionsQSoA)(n, (const float *)q1, (const float *)q2,
+		(float *)q_result);
+}
+
+DST_INLINE_ONLY void dstNormalizeQuaternions(int n, const Quaternion * DST_RESTRICT q,
+Quaternion * DST_RESTRICT q_result) {
+	DST_FUNC_LOOKUP(dstNormalizeQuaternionsQ)(n, (const float *)q, (float *)q_result);
+}
+
+DST_INLINE_ONLY void dstNormalizeQuaternions(int n, const QuaternionSoA4 * DST_RESTRICT q,
+QuaternionSoA4 * DST_RESTRICT q_result) {
+	DST_FUNC_LOOKUP(dstNormalizeQuaternionsQSoA)(n, (const float *)q, (float *)q_result);
+}
+
+// Interpolate between q1[i] and q2[i] with interpolation factor t[i] (within [0, 1]).
+// dstSlerpQuaternions uses a polynomial approximation (maximum error about 1E-6).
+
+DST_INLINE_ONLY void dstNlerpQuaternions(int n, const Quaternion * DST_RESTRICT q1,
+const Quaternion * DST_RESTRICT q2, const float * DST_RESTRICT t,
+Quaternion * DST_RESTRICT q_result) {
+	DST_FUNC_LOOKUP(dstNlerpQuaternionsQ)(n, (const float *)q1, (const float *)q2, t,
+		(float *)q_result);
+}
+
+DST_INLINE_ONLY void dstNlerpQuaternions(int n, const QuaternionSoA4 * DST_RESTRICT q1,
+const QuaternionSoA4 * DST_RESTRICT q2, const float * DST_RESTRICT t,
+QuaternionSoA4 * DST_RESTRICT q_result) {
+	DST_FUNC_LOOKUP(dstNlerpQuaternionsQSoA)(n, (const float *)q1, (const float *)q2, t,
+		(float *)q_result);
+}
+
+DST_INLINE_ONLY void dstSlerpQuaternions(int n, const Quaternion * DST_RESTRICT q1,
+const Quaternion * DST_RESTRICT q2, const float * DST_RESTRICT t,
+Quaternion * DST_RESTRICT q_result) {
+	DST_FUNC_LOOKUP(dstSlerpQuaternionsQ)(n, (const float *)q1, (const float *)q2, t,
+		(float *)q_result);
+}
+
+DST_INLINE_ONLY void dstSlerpQuaternions(int n, const QuaternionSoA4 * DST_RESTRICT q1,
+const QuaternionSoA4 * DST_RESTRICT q2, const float * DST_RESTRICT t,
+QuaternionSoA4 * DST_RESTRICT q_result) {
+	DST_FUNC_LOOKUP(dstSlerpQuaternionsQSoA)(n, (const float *)q1, (const float *)q2, t,
+		(float *)q_result);
+}
+
+// Rotate v[i] by q[i]. For Vector3D, the arrays must be aligned on a 16-byte boundary.
+
+DST_INLINE_ONLY void dstRotateVectors(int n, const Quaternion * DST_RESTRICT q,
+const Vector3D * DST_RESTRICT v, Vector3D * DST_RESTRICT v_result) {
+	DST_FUNC_LOOKUP(dstRotateVectorsQV3)(n, (const float *)q, (const float *)v,
+		(float *)v_result);
+}
+
+DST_INLINE_ONLY void dstRotateVectors(int n, const Quaternion * DST_RESTRICT q,
+const Vector3DPadded * DST_RESTRICT v, Vector3DPadded * DST_RESTRICT v_result) {
+	DST_FUNC_LOOKUP(dstRotateVectorsQV3P)(n, (const float *)q, (const float *)v,
+		(float *)v_result);
+}
+
+// Convert quaternions to rotation matrices. The translation of Matrix4x3RM is set to zero.
+
+DST_INLINE_ONLY void dstConvertQuaternionsToMatrices(int n, const Quaternion * DST_RESTRICT q,
+Matrix3D * DST_RESTRICT m_result) {
+	DST_FUNC_LOOKUP(dstConvertQuaternionsToMatrices3x3CM)(n, (const float *)q,
+		(float *)m_result);
+}
+
+DST_INLINE_ONLY void dstConvertQuaternionsToMatrices(int n, const Quaternion * DST_RESTRICT q,
+Matrix4x3RM * DST_RESTRICT m_result) {
+	DST_FUNC_LOOKUP(dstConvertQuaternionsToMatrices4x3RM)(n, (const float *)q,
+		(float *)m_result);
+}
+
+// Bone influences of a vertex for linear blend skinning: up to four indices into the
+// bone palette with corresponding weights, which should add up to 1.0f. Unused
+// influences must have a weight of 0.0f and a valid index (such as 0).
+
+class DST_API dstSkinInfluences {
+public :
+	float weight[4];
+	uint16_t index[4];
+};
+
+// Linear blend skinning. Every vertex is transformed with the weighted sum of the
+// bone matrices selected by its influences. Normals are optional (v and v_result may
+// be NULL); they are transformed without translation and normalized. The position
+// and normal arrays must be aligned on a 16-byte boundary. Large arrays are split
+// over threads, and the function returns when all threads have finished.
+
+DST_INLINE_ONLY void dstSkinVertices(int n, const Matrix4x3RM * DST_RESTRICT palette,
+const dstSkinInfluences * DST_RESTRICT influences, const Point3DPadded * DST_RESTRICT p,
+Point3DPadded * DST_RESTRICT p_result, const Vector3DPadded * DST_RESTRICT v = NULL,
+Vector3DPadded * DST_RESTRICT v_result = NULL) {
+	DST_FUNC_LOOKUP(dstSkinVerticesM4x3RMP3P)(n, (const float *)palette,
+		(const float *)influences, (const float *)p, (const float *)v, (float *)p_result,
+		(float *)v_result);
+}
+
+// Instanced geometry: transform every vertex with the matrix selected by its matrix
+// index. Normals are optional and are transformed without translation (they are not
+// normalized). Alignment requirements are the same as for dstSkinVertices.
+
+DST_INLINE_ONLY void dstMatrixMultiplyVerticesIndexed(int n, const Matrix4x3RM * DST_RESTRICT m,
+const uint32_t * DST_RESTRICT matrix_index, const Point3DPadded * DST_RESTRICT p,
+Point3DPadded * DST_RESTRICT p_result, const Vector3DPadded * DST_RESTRICT v = NULL,
+Vector3DPadded * DST_RESTRICT v_result = NULL) {
+	DST_FUNC_LOOKUP(dstMatrixMultiplyVerticesIndexedM4x3RMP3P)(n, (const float *)m,
+		(const float *)matrix_index, (const float *)p, (const float *)v, (float *)p_result,
+		(float *)v_result);
+}
+
 #endif // __defined(__DST_MATRIX_MATH_H__)
 
@@ -19,36 +19,110 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #ifndef DST_NO_SIMD
 
 #include "dstMatrixMath.h"
+#include "dstSIMD.h"
+#include "dstSIMDMatrix.h"
 
 // Non-inline member funtions for Matrix3D, Matrix4D and Matrix4x3RM classes
-// that use SIMD. SIMD functions are taken advantage of for the following multiplications:
-// - Matrix4 * Matrix4
-// - Matix4x3RM * Matrix4x3RM
+// that use SIMD. SIMD functions are taken advantage of for the following operations:
+// - Matrix4D * Matrix4D and Matrix4D *= Matrix4D
+// - Matix4x3RM * Matrix4x3RM and Matrix4x3RM *= Matrix4x3RM
 // - Matrix4D * Matrix4x3RM
+// - Matrix3D * Matrix3D and Matrix3D *= Matrix3D
+// - Matrix4D and Matrix4x3RM * Vector4D, Vector3D and Point3D
 //
 // When DST_NO_SIMD is defined, these member function will be defined as regular C++
-// functions in sreMatrixMath.cpp.
+// functions in dstMatrixMath.cpp.
 //
-// Because of the nested function call from a table lookup, this is not very efficient unless
-// DST_FIXED_SIMD is defined.
+// The Matrix4D and Matrix4x3RM classes are 16-byte aligned (Matrix3D is loaded
+// without alignment requirements), so the inline SIMD functions from
+// dstSIMDMatrix.h are called directly instead of through a table lookup. They are
+// compiled with the baseline SIMD level of the library (SSE2 on x86-64), which is
+// sufficient for these small operations.
+
+static DST_INLINE_ONLY Vector4D dstGetVector4D(__simd128_float m_v) {
+	float f[4] DST_ALIGNED(16);
+	simd128_store_float(f, m_v);
+	return Vector4D(f[0], f[1], f[2], f[3]);
+}
 
 Matrix4D operator *(const Matrix4D& DST_RESTRICT m1, const Matrix4D& DST_RESTRICT m2) {
 	Matrix4D m3;
-	DST_FUNC_LOOKUP(dstMatrixMultiply4x4CM)((const float *)&m1, (const float *)&m2, (float *)&m3);
+	dstInlineMatrixMultiply4x4CM((const float *)&m1, (const float *)&m2, (float *)&m3);
 	return m3;
 }
 
 Matrix4x3RM operator *(const Matrix4x3RM& DST_RESTRICT m1, const Matrix4x3RM& DST_RESTRICT m2) {
 	Matrix4x3RM m3;
-	DST_FUNC_LOOKUP(dstMatrixMultiply4x3RM)((const float *)&m1, (const float *)&m2, (float *)&m3);
+	dstInlineMatrixMultiply4x3RM((const float *)&m1, (const float *)&m2, (float *)&m3);
 	return m3;
 }
 
 Matrix4D operator *(const Matrix4D& DST_RESTRICT m1, const Matrix4x3RM& DST_RESTRICT m2) {
 	Matrix4D m3;
-	DST_FUNC_LOOKUP(dstMatrixMultiply4x4CM4x3RM)((const float *)&m1, (const float *)&m2, (float *)&m3);
+	dstInlineMatrixMultiply4x4CM4x3RM((const float *)&m1, (const float *)&m2, (float *)&m3);
 	return m3;
 }
 
-#endif
+Matrix3D operator *(const Matrix3D& DST_RESTRICT m1, const Matrix3D& DST_RESTRICT m2) {
+	Matrix3D m3;
+	dstInlineMatrixMultiply3x3CM((const float *)&m1, (const float *)&m2, (float *)&m3);
+	return m3;
+}
+
+// The result is calculated into a temporary matrix so that the operand may be
+// the matrix itself.
+
+Matrix3D& Matrix3D::operator *=(const Matrix3D& m) {
+	Matrix3D m3;
+	dstInlineMatrixMultiply3x3CM((const float *)this, (const float *)&m, (float *)&m3);
+	*this = m3;
+	return (*this);
+}
+
+Matrix4D& Matrix4D::operator *=(const Matrix4D& m) {
+	Matrix4D m3;
+	dstInlineMatrixMultiply4x4CM((const float *)this, (const float *)&m, (float *)&m3);
+	*this = m3;
+	return (*this);
+}
+
+Matrix4x3RM& Matrix4x3RM::operator *=(const Matrix4x3RM& m) {
+	Matrix4x3RM m3;
+	dstInlineMatrixMultiply4x3RM((const float *)this, (const float *)&m, (float *)&m3);
+	*this = m3;
+	return (*this);
+}
 
+// Matrix-vector multiplication. Vector4D, Vector3D and Point3D are not aligned.
+
+Vector4D operator *(const Matrix4D& m, const Vector4D& v) {
+	return dstGetVector4D(dstInlineMatrixMultiplyVector4x4CM((const float *)&m,
+		simd128_load_unaligned_float(&v.x)));
+}
+
+Vector4D operator *(const Matrix4D& m, const Vector3D& v) {
+	return dstGetVector4D(dstInlineMatrixMultiplyVector4x4CM((const float *)&m,
+		simd128_set_float(v.x, v.y, v.z, 0.0f)));
+}
+
+Vector4D operator *(const Matrix4D& m, const Point3D& p) {
+	return dstGetVector4D(dstInlineMatrixMultiplyVector4x4CM((const float *)&m,
+		simd128_set_float(p.x, p.y, p.z, 1.0f)));
+}
+
+Vector4D operator *(const Matrix4x3RM& m, const Vector4D& v) {
+	return dstGetVector4D(dstInlineMatrixMultiplyVector4x3RM((const float *)&m,
+		simd128_load_unaligned_float(&v.x)));
+}
+
+Vector4D operator *(const Matrix4x3RM& m, const Vector3D& v) {
+	return dstGetVector4D(dstInlineMatrixMultiplyVector4x3RM((const float *)&m,
+		simd128_set_float(v.x, v.y, v.z, 0.0f)));
+}
+
+Vector4D operator *(const Matrix4x3RM& m, const Point3D& p) {
+	return dstGetVector4D(dstInlineMatrixMultiplyVector4x3RM((const float *)&m,
+		simd128_set_float(p.x, p.y, p.z, 1.0f)));
+}
+
+#endif
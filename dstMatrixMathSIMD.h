@@ -31,16 +31,16 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
 static DST_INLINE_ONLY void SIMDMatrixMultiply(const Matrix4D& __restrict m1,
 const Matrix4D& __restrict__ m2, Matrix4D& __restrict m3) {
-    simd_matrix_multiply_4x4CM_float(&m1.n[0][0], &m2.n[0][0], &m3.n[0][0]);
+    dstInlineMatrixMultiply4x4CM(&m1.n[0][0], &m2.n[0][0], &m3.n[0][0]);
 }
 
 // Multiply 4x3 (4 rows, 3 rows) matrices in row-major order (different from
 // other matrices which are in column-major order).
 // The fourth row is implicitly defined as (0.0f, 0.0f, 0.0f, 1.0f).
 
-static DST_INLINE_ONLY void SIMDMatrixMultiply(const MatrixTransform& __restrict m1,
-const MatrixTransform& __restrict__ m2, MatrixTransform& __restrict m3) {
-    simd_matrix_multiply_4x3RM_float(&m1.n[0][0], &m2.n[0][0], &m3.n[0][0]);
+static DST_INLINE_ONLY void SIMDMatrixMultiply(const Matrix4x3RM& __restrict m1,
+const Matrix4x3RM& __restrict__ m2, Matrix4x3RM& __restrict m3) {
+    dstInlineMatrixMultiply4x3RM(&m1.n[0][0], &m2.n[0][0], &m3.n[0][0]);
 }
 
 // Multiply 4x4 and 4x3 (4 rows, 3 columns) matrices. The 4x3 matrix is in row-major
@@ -48,8 +48,8 @@ const MatrixTransform& __restrict__ m2, MatrixTransform& __restrict m3) {
 // The fourth row of the 4x3 matrix is implicitly defined as (0.0f, 0.0f, 0.0f, 1.0f).
 
 static DST_INLINE_ONLY void SIMDMatrixMultiply(const Matrix4D& __restrict m1,
-const MatrixTransform& __restrict__ m2, Matrix4D& __restrict m3) {
-    simd_matrix_multiply_4x4CM_4x3RM_float(&m1.n[0][0], &m2.n[0][0], &m3.n[0][0]);
+const Matrix4x3RM& __restrict__ m2, Matrix4D& __restrict m3) {
+    dstInlineMatrixMultiply4x4CM4x3RM(&m1.n[0][0], &m2.n[0][0], &m3.n[0][0]);
 }
 
 // Data type for using SIMD to multiply a specific matrix with one or more vertices.
@@ -57,12 +57,8 @@ const MatrixTransform& __restrict__ m2, Matrix4D& __restrict m3) {
 class Matrix4DSIMD : public SIMDMatrix4x4 {
 public :
     void Set(const Matrix4D& m) {
-        // Load columns, then transpose to rows.
-        m_row0 = simd128_load_float(&m.n[0][0]);
-        m_row1 = simd128_load_float(&m.n[1][0]);
-        m_row2 = simd128_load_float(&m.n[2][0]);
-        m_row3 = simd128_load_float(&m.n[3][0]);
-        simd128_transpose4_float(m_row0, m_row1, m_row2, m_row3);
+        // Matrix4D is already in column-major format.
+        SetCM(&m.n[0][0]);
     }
     DST_INLINE_ONLY Vector4D Multiply(const __simd128_float m_v) const {
         __simd128_float m_result;
@@ -104,43 +100,9 @@ __simd128_float& m_result_3) {
     __simd128_float m_v_z = simd128_load(&v_source_p[2]);
     __simd128_float m_v_w = simd128_load(&v_source_p[3]);
     simd128_transpose4_float(m_v_x, m_v_y, m_v_z, m_v_w);
-    __simd128_float m_mul0, m_mul1, m_mul2, m_mul3;
-    // Process the x coordinates.
-    m_mul0 = simd128_mul_float(simd128_replicate_float(m.m_row0, 0), m_v_x);
-    m_mul1 = simd128_mul_float(simd128_replicate_float(m.m_row0, 1), m_v_y);
-    m_mul2 = simd128_mul_float(simd128_replicate_float(m.m_row0, 2), m_v_z);
-    m_mul3 = simd128_mul_float(simd128_replicate_float(m.m_row0, 3), m_v_w);
-    __simd128_float m_result_x =
-        simd128_add_float(
-            simd128_add_float(m_mul0, m_mul1),
-            simd128_add_float(m_mul2, m_mul3));
-    // Process the y coordinates.
-    m_mul0 = simd128_mul_float(simd128_replicate_float(m.m_row1, 0), m_v_x);
-    m_mul1 = simd128_mul_float(simd128_replicate_float(m.m_row1, 1), m_v_y);
-    m_mul2 = simd128_mul_float(simd128_replicate_float(m.m_row1, 2), m_v_z);
-    m_mul3 = simd128_mul_float(simd128_replicate_float(m.m_row1, 3), m_v_w);
-    __simd128_float m_result_y =
-        simd128_add_float(
-            simd128_add_float(m_mul0, m_mul1),
-            simd128_add_float(m_mul2, m_mul3));
-    // Process the z coordinates.
-    m_mul0 = simd128_mul_float(simd128_replicate_float(m.m_row2, 0), m_v_x);
-    m_mul1 = simd128_mul_float(simd128_replicate_float(m.m_row2, 1), m_v_y);
-    m_mul2 = simd128_mul_float(simd128_replicate_float(m.m_row2, 2), m_v_z);
-    m_mul3 = simd128_mul_float(simd128_replicate_float(m.m_row2, 3), m_v_w);
-    __simd128_float m_result_z =
-        simd128_add_float(
-            simd128_add_float(m_mul0, m_mul1),
-            simd128_add_float(m_mul2, m_mul3));
-    // Process the w coordinates.
-    m_mul0 = simd128_mul_float(simd128_replicate_float(m.m_row3, 0), m_v_x);
-    m_mul1 = simd128_mul_float(simd128_replicate_float(m.m_row3, 1), m_v_y);
-    m_mul2 = simd128_mul_float(simd128_replicate_float(m.m_row3, 2), m_v_z);
-    m_mul3 = simd128_mul_float(simd128_replicate_float(m.m_row3, 3), m_v_w);
-    __simd128_float m_result_w =
-        simd128_add_float(
-            simd128_add_float(m_mul0, m_mul1),
-            simd128_add_float(m_mul2, m_mul3));
+    __simd128_float m_result_x, m_result_y, m_result_z, m_result_w;
+    m.MultiplyFourVectors4Transposed(m_v_x, m_v_y, m_v_z, m_v_w,
+        m_result_x, m_result_y, m_result_z, m_result_w);
     // Transpose results so that each vector holds multiplication product.
     simd128_transpose4to4_float(m_result_x, m_result_y, m_result_z, m_result_w,
         m_result_0, m_result_1, m_result_2, m_result_3); 
@@ -180,43 +142,9 @@ __simd128_float& m_result_3) {
     // Make sure the last component of each vector is set to 1.0f (i.e. m_v_w must
     // be all 1.0f), because the source vectors are points.
     m_v_w = simd128_set_same_float(1.0f);
-    __simd128_float m_mul0, m_mul1, m_mul2, m_mul3;
-    // Process the x coordinates.
-    m_mul0 = simd128_mul_float(simd128_replicate_float(m.m_row0, 0), m_v_x);
-    m_mul1 = simd128_mul_float(simd128_replicate_float(m.m_row0, 1), m_v_y);
-    m_mul2 = simd128_mul_float(simd128_replicate_float(m.m_row0, 2), m_v_z);
-    m_mul3 = simd128_mul_float(simd128_replicate_float(m.m_row0, 3), m_v_w);
-    __simd128_float m_result_x =
-        simd128_add_float(
-            simd128_add_float(m_mul0, m_mul1),
-            simd128_add_float(m_mul2, m_mul3));
-    // Process the y coordinates.
-    m_mul0 = simd128_mul_float(simd128_replicate_float(m.m_row1, 0), m_v_x);
-    m_mul1 = simd128_mul_float(simd128_replicate_float(m.m_row1, 1), m_v_y);
-    m_mul2 = simd128_mul_float(simd128_replicate_float(m.m_row1, 2), m_v_z);
-    m_mul3 = simd128_mul_float(simd128_replicate_float(m.m_row1, 3), m_v_w);
-    __simd128_float m_result_y =
-        simd128_add_float(
-            simd128_add_float(m_mul0, m_mul1),
-            simd128_add_float(m_mul2, m_mul3));
-    // Process the z coordinates.
-    m_mul0 = simd128_mul_float(simd128_replicate_float(m.m_row2, 0), m_v_x);
-    m_mul1 = simd128_mul_float(simd128_replicate_float(m.m_row2, 1), m_v_y);
-    m_mul2 = simd128_mul_float(simd128_replicate_float(m.m_row2, 2), m_v_z);
-    m_mul3 = simd128_mul_float(simd128_replicate_float(m.m_row2, 3), m_v_w);
-    __simd128_float m_result_z =
-        simd128_add_float(
-            simd128_add_float(m_mul0, m_mul1),
-            simd128_add_float(m_mul2, m_mul3));
-    // Process the w coordinates.
-    m_mul0 = simd128_mul_float(simd128_replicate_float(m.m_row3, 0), m_v_x);
-    m_mul1 = simd128_mul_float(simd128_replicate_float(m.m_row3, 1), m_v_y);
-    m_mul2 = simd128_mul_float(simd128_replicate_float(m.m_row3, 2), m_v_z);
-    m_mul3 = simd128_mul_float(simd128_replicate_float(m.m_row3, 3), m_v_w);
-    __simd128_float m_result_w =
-        simd128_add_float(
-            simd128_add_float(m_mul0, m_mul1),
-            simd128_add_float(m_mul2, m_mul3));
+    __simd128_float m_result_x, m_result_y, m_result_z, m_result_w;
+    m.MultiplyFourVectors4Transposed(m_v_x, m_v_y, m_v_z, m_v_w,
+        m_result_x, m_result_y, m_result_z, m_result_w);
     // Transpose results so that each result vector holds multiplication product.
     simd128_transpose4to4_float(m_result_x, m_result_y, m_result_z, m_result_w,
         m_result_0, m_result_1, m_result_2, m_result_3); 
@@ -240,11 +168,9 @@ const Point3D *p_source_p, Point3D *p_result_p) {
 
 class MatrixTransformSIMD : public SIMDMatrix4x3 {
 public :
-    void Set(const MatrixTransform& m) {
-        // MatrixTransform is already in row-major format.
-        m_row0 = simd128_load_float(&m.n[0][0]);
-        m_row1 = simd128_load_float(&m.n[1][0]);
-        m_row2 = simd128_load_float(&m.n[2][0]);
+    void Set(const Matrix4x3RM& m) {
+        // Matrix4x3RM is in row-major format.
+        SetRM(&m.n[0][0]);
     }
     DST_INLINE_ONLY Vector3D Multiply(const __simd128_float m_v) const {
         __simd128_float m_result;
@@ -290,31 +216,9 @@ const Vector3D *v_source_p, Vector3D *v_result_p) {
     // Transpose four three-float vectors, and store result in m_v_x, m_v_y and m_v_z.
     __simd128_float m_v_x, m_v_y, m_v_z;
     simd128_transpose4to3_float(m_v0, m_v1, m_v2, m_v3, m_v_x, m_v_y, m_v_z);
-    __simd128_float m_mul0, m_mul1, m_mul2;
-    // Process the x coordinates.
-    m_mul0 = simd128_mul_float(simd128_replicate_float(m.m_row0, 0), m_v_x);
-    m_mul1 = simd128_mul_float(simd128_replicate_float(m.m_row0, 1), m_v_y);
-    m_mul2 = simd128_mul_float(simd128_replicate_float(m.m_row0, 2), m_v_z);
-    __simd128_float m_result_x =
-        simd128_add_float(
-            simd128_add_float(m_mul0, m_mul1),
-            m_mul2);
-    // Process the y coordinates.
-    m_mul0 = simd128_mul_float(simd128_replicate_float(m.m_row1, 0), m_v_x);
-    m_mul1 = simd128_mul_float(simd128_replicate_float(m.m_row1, 1), m_v_y);
-    m_mul2 = simd128_mul_float(simd128_replicate_float(m.m_row1, 2), m_v_z);
-    __simd128_float m_result_y =
-        simd128_add_float(
-            simd128_add_float(m_mul0, m_mul1),
-            m_mul2);
-    // Process the z coordinates.
-    m_mul0 = simd128_mul_float(simd128_replicate_float(m.m_row2, 0), m_v_x);
-    m_mul1 = simd128_mul_float(simd128_replicate_float(m.m_row2, 1), m_v_y);
-    m_mul2 = simd128_mul_float(simd128_replicate_float(m.m_row2, 2), m_v_z);
-    __simd128_float m_result_z =
-        simd128_add_float(
-            simd128_add_float(m_mul0, m_mul1),
-            m_mul2);
+    __simd128_float m_result_x, m_result_y, m_result_z;
+    m.MultiplyFourVectors3Transposed(m_v_x, m_v_y, m_v_z, false,
+        m_result_x, m_result_y, m_result_z);
     // Transpose results so that each vector holds multiplication product.
     __simd128_float m_result_v0, m_result_v1, m_result_v2, m_result_v3;
     simd128_transpose3to4_float(m_result_x, m_result_y, m_result_z,
@@ -28,11 +28,16 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include <sys/mman.h>
 
 
+// Allocate memory for n elements with the given alignment (a power of two that is a
+// multiple of sizeof(void *)). No constructors are run. Returns NULL when the memory
+// cannot be allocated.
+
 template <class T>
 static inline T *dstNewAligned(size_t n, size_t alignment) {
-   T *buffer;
-   posix_memalign((void **)&buffer, alignment, n * sizeof(T));
-   return buffer;
+	void *buffer = NULL;
+	if (posix_memalign(&buffer, alignment, n * sizeof(T)) != 0)
+		return NULL;
+	return (T *)buffer;
 }
 
 template <class T>
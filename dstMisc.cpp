@@ -26,12 +26,18 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
 #include "dstCpuInfo.h"
 #include "dstVectorMath.h"
+#include "dstThreadingModel.h"
+#include "dstAffinity.h"
 
 
 // Configuration variables.
 
 dstConfig dst_config;
 
+#if !defined(DST_NO_SIMD) && !defined(DST_FIXED_SIMD)
+static void dstSetDefaultSIMDType(int simd_type);
+#endif
+
 // Intialization.
 
 static const char *simd_name_table[] = {
@@ -170,22 +176,34 @@ void dstInit() {
 #if !defined(DST_NO_SIMD) && !defined(DST_FIXED_SIMD)
 	// The SIMD type has been autodetected and can be changed.
 	// Initialize the function pointers.
-	dstSetSIMDType(dst_config.simd_type);
-#endif
-
-	dst_config.nu_cpus = sysconf(_SC_NPROCESSORS_CONF);
-	// Make the main library thread execute on CPU 0.
-	cpu_set_t cpu_set;
-	CPU_ZERO(&cpu_set);
-	CPU_SET(0, &cpu_set);
-	sched_setaffinity(0, sizeof(cpu_set_t), &cpu_set);
-	dst_config.main_thread_cpu = 0;
+	dstSetDefaultSIMDType(dst_config.simd_type);
+#endif
+
+	// Only the CPUs in the process affinity mask are used.
+	dstInitializeAffinity();
+	dst_config.nu_cpus = dstGetNumberOfAffinityCPUs();
+	// Bind the main library thread to the first CPU of the affinity policy (it stays
+	// unbound with the default policy).
+	dst_config.main_thread_cpu = dstGetAffinityCPU(0);
+	if (dst_config.main_thread_cpu >= 0) {
+		cpu_set_t cpu_set;
+		CPU_ZERO(&cpu_set);
+		CPU_SET(dst_config.main_thread_cpu, &cpu_set);
+		sched_setaffinity(0, sizeof(cpu_set_t), &cpu_set);
+	}
 
 	dst_config.max_threads_per_function = dst_config.nu_cpus;
 	if (dst_config.max_threads_per_function > 1)
-		dst_config.flags |= DST_FLAG_THREADING;
-	dst_config.nu_tasks = 0;
+		dst_config.flags |= DST_FLAG_THREADING | DST_FLAG_ADAPTIVE_THREADING;
+	dst_threading_model.Initialize(dst_config.max_threads_per_function);
 	dst_config.max_tasks = 1;
+	// The context of the calling thread may have been created before the defaults
+	// were set.
+	dstGetContext()->Initialize();
+	// Create the worker thread pool. The main thread executes queued work while it
+	// waits for completion, so one worker less than the number of CPUs is used, starting
+	// at the CPU after the main thread's.
+	dst_config.task_scheduler.Start(maxi(dst_config.nu_cpus - 1, 1), 1);
 
 	printf("dstInit: Processor name: %s\n", cpuinfo->processor_name);
 	printf("dstInit: Processor SIMD features: ");
@@ -200,6 +218,12 @@ void dstInit() {
 		);
 	printf("dstInit: Max level of multi-threading per function: %d\n",
 		dst_config.max_threads_per_function);
+	printf("dstInit: Number of worker threads: %d\n",
+		dst_config.task_scheduler.GetNumberOfWorkers());
+	printf("dstInit: CPU affinity: %s (%d CPUs)\n",
+		dstGetAffinityPolicyString(dstGetAffinityPolicy()), dst_config.nu_cpus);
+	printf("dstInit: Number of NUMA nodes: %d\n",
+		dst_config.task_scheduler.GetNumberOfNodes());
 }
 
 
@@ -314,8 +338,9 @@ static const dstSIMDFuncs *dst_simd_funcs_stream_table[] = {
 };
 #endif
 
-void dstSetSIMDType(int simd_type) {
 #if !defined(DST_NO_SIMD) && !defined(DST_FIXED_SIMD)
+
+static void dstSetDefaultSIMDType(int simd_type) {
 	dst_config.simd_type = simd_type;
 	dst_config.simd_funcs = *dst_simd_funcs_table[simd_type];
 	dst_config.simd_funcs_stream = *dst_simd_funcs_stream_table[simd_type];
@@ -323,6 +348,22 @@ void dstSetSIMDType(int simd_type) {
 		dst_config.flags &= (~DST_FLAG_SIMD_ENABLED);
 	else
 		dst_config.flags |= DST_FLAG_SIMD_ENABLED;
+}
+
+#endif
+
+// The SIMD type functions only affect the current context.
+
+void dstSetSIMDType(int simd_type) {
+#if !defined(DST_NO_SIMD) && !defined(DST_FIXED_SIMD)
+	dstContext *context = dstGetContext();
+	context->simd_type = simd_type;
+	context->simd_funcs = dst_simd_funcs_table[simd_type];
+	context->simd_funcs_stream = dst_simd_funcs_stream_table[simd_type];
+	if (simd_type == DST_SIMD_NONE)
+		context->flags &= (~DST_FLAG_SIMD_ENABLED);
+	else
+		context->flags |= DST_FLAG_SIMD_ENABLED;
 
 #endif
 }
@@ -330,19 +371,79 @@ void dstSetSIMDType(int simd_type) {
 void dstSetStreamingSIMDType(int simd_type) {
 #if !defined(DST_NO_SIMD) && !defined(DST_FIXED_SIMD)
 	dstSetSIMDType(simd_type);
-	dst_config.simd_funcs = *dst_simd_funcs_stream_table[simd_type];
-	dst_config.simd_funcs_stream = *dst_simd_funcs_stream_table[simd_type];
+	dstContext *context = dstGetContext();
+	context->simd_funcs = dst_simd_funcs_stream_table[simd_type];
+	context->simd_funcs_stream = dst_simd_funcs_stream_table[simd_type];
 #endif
 }
 
 void dstSetNonStreamingSIMDType(int simd_type) {
 #if !defined(DST_NO_SIMD) && !defined(DST_FIXED_SIMD)
 	dstSetSIMDType(simd_type);
-	dst_config.simd_funcs = *dst_simd_funcs_table[simd_type];
-	dst_config.simd_funcs_stream = *dst_simd_funcs_table[simd_type];
+	dstContext *context = dstGetContext();
+	context->simd_funcs = dst_simd_funcs_table[simd_type];
+	context->simd_funcs_stream = dst_simd_funcs_table[simd_type];
 #endif
 }
 
+// Contexts.
+
+__thread dstContext *dst_current_context = NULL;
+// The default context of the calling thread, freed when the thread exits.
+static __thread dstContext *dst_thread_context = NULL;
+static pthread_key_t dst_thread_context_key;
+static pthread_once_t dst_thread_context_key_once = PTHREAD_ONCE_INIT;
+
+dstContext::dstContext() {
+	Initialize();
+}
+
+void dstContext::Initialize() {
+	flags = dst_config.flags;
+	simd_type = dst_config.simd_type;
+	max_threads_per_function = dst_config.max_threads_per_function;
+	fixed_nu_threads = dst_config.fixed_nu_threads;
+	simd_funcs = &dst_config.simd_funcs;
+	simd_funcs_stream = &dst_config.simd_funcs_stream;
+	task_scheduler = &dst_config.task_scheduler;
+	nu_tasks = 0;
+	max_tasks = dst_config.max_tasks;
+}
+
+void dstContext::Sync() {
+	for (uint32_t i = 0; i < pending_group_array.Size(); i++)
+		task_scheduler->WaitUntilGroupFinished(pending_group_array.Get(i));
+	pending_group_array.Truncate(0);
+	nu_tasks = 0;
+}
+
+static void dstDestroyThreadContext(void *data) {
+	dstContext *context = (dstContext *)data;
+	context->Sync();
+	delete context;
+}
+
+static void dstCreateThreadContextKey() {
+	pthread_key_create(&dst_thread_context_key, dstDestroyThreadContext);
+}
+
+dstContext *dstCreateThreadContext() {
+	if (dst_thread_context == NULL) {
+		dst_thread_context = new dstContext;
+		pthread_once(&dst_thread_context_key_once, dstCreateThreadContextKey);
+		pthread_setspecific(dst_thread_context_key, dst_thread_context);
+	}
+	dst_current_context = dst_thread_context;
+	return dst_thread_context;
+}
+
+void dstSetContext(dstContext *context) {
+	if (context == NULL)
+		dstCreateThreadContext();
+	else
+		dst_current_context = context;
+}
+
 
 // Default random number generator.
 
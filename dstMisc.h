@@ -26,6 +26,28 @@ enum {
 	DST_FLAG_SIMD_256 = 0x2,
 	DST_FLAG_THREADING = 0x4,
 	DST_FLAG_FIXED_NU_THREADS = 0x8,
+	// Let the self-calibrating threading cost model choose the number of threads
+	// (see dstThreadingModel.h).
+	DST_FLAG_ADAPTIVE_THREADING = 0x10,
+	// Queue the work of multi-threaded functions with high priority, so that it is
+	// started before the queued work of contexts without this flag.
+	DST_FLAG_HIGH_PRIORITY = 0x20,
+	// Divide the work of multi-threaded functions in guided mode: threads take chunks of
+	// decreasing size from a shared counter, so that a slow or busy core does not delay
+	// the whole call.
+	DST_FLAG_DYNAMIC_SCHEDULING = 0x40,
+};
+
+// Clip flags set by dstTransformAndProjectPoints, determined in clip space before the
+// perspective divide.
+
+enum {
+	DST_CLIP_LEFT = 0x1,
+	DST_CLIP_RIGHT = 0x2,
+	DST_CLIP_BOTTOM = 0x4,
+	DST_CLIP_TOP = 0x8,
+	DST_CLIP_NEAR = 0x10,
+	DST_CLIP_FAR = 0x20
 };
 
 enum {
@@ -118,6 +140,11 @@ public :
 	void (*dstMatrixMultiply4x4CM)(const float *f1, const float *f2, float *f3);
 	void (*dstMatrixMultiply4x3RM)(const float *f1, const float *f2, float *f3);
 	void (*dstMatrixMultiply4x4CM4x3RM)(const float *f1, const float *f2, float *f3);
+	void (*dstMatrixMultiplyMatrices4x3RM)(int n, const float *m1, const float *m2,
+		float *m_result);
+	void (*dstMatrixMultiply3x3CM)(const float *f1, const float *f2, float *f3);
+	void (*dstMatrixMultiplyMatrices3x3CM)(int n, const float *m1, const float *m2,
+		float *m_result);
 
 	void (*dstMatrixMultiplyVectors1x4M4x4CMV4)(const float *m, const float *v, float *v_result);
 	void (*dstMatrixMultiplyVectors1xNM4x4CMV4)(int n, const float *m, const float *v,
@@ -128,6 +155,80 @@ public :
 		float *v_result);
 	void (*dstMatrixMultiplyVectors1xNM4x4CMV3)(int n, const float *m, const float *v,
 		float *v_result);
+	void (*dstMatrixMultiplyVectors1xNM4x4CMP3)(int n, const float *m, const float *v,
+		float *v_result);
+	void (*dstMatrixMultiplyVectors1xNM4x3RMV3)(int n, const float *m, const float *v,
+		float *v_result);
+	void (*dstMatrixMultiplyVectors1xNM4x3RMP3)(int n, const float *m, const float *v,
+		float *v_result);
+	void (*dstMatrixMultiplyVectors1xNM4x3RMV3P)(int n, const float *m, const float *v,
+		float *v_result);
+	void (*dstMatrixMultiplyVectors1xNM4x3RMP3P)(int n, const float *m, const float *v,
+		float *v_result);
+	void (*dstMatrixMultiplyVectors1xNM3x3CMV2)(int n, const float *m, const float *v,
+		float *v_result);
+	void (*dstMatrixMultiplyVectors1xNM3x3CMP2)(int n, const float *m, const float *v,
+		float *v_result);
+	void (*dstMatrixMultiplyVectors1xNM3x3CMV2SoA)(int n, const float *m, const float *v,
+		float *v_result);
+	void (*dstMatrixMultiplyVectors1xNM3x3CMP2SoA)(int n, const float *m, const float *v,
+		float *v_result);
+	void (*dstMatrixMultiplyVectors1xNMD4x4CMPD3)(int n, const float *m, const float *v,
+		float *v_result);
+	void (*dstMatrixMultiplyVectors1xNMD4x4CMPD3P3)(int n, const float *m, const float *v,
+		float *v_result);
+	void (*dstMatrixMultiplyNormalizeVectors1xNM4x3RMV3)(int n, const float *m, const float *v,
+		float *v_result);
+	void (*dstMatrixMultiplyNormalizeVectors1xNM4x3RMV3P)(int n, const float *m, const float *v,
+		float *v_result);
+
+	// Batch matrix inversion and linear system solvers.
+	void (*dstInvertMatrices4x4CM)(int n, const float *m, float *m_result);
+	void (*dstInvertMatrices3x3CM)(int n, const float *m, float *m_result);
+	void (*dstInvertMatrices4x3RM)(int n, const float *m, float *m_result);
+	void (*dstInvertRigidMatrices4x3RM)(int n, const float *m, float *m_result);
+	void (*dstSolveLinearSystems3x3CMV3)(int n, const float *m, const float *v,
+		float *v_result);
+	void (*dstSolveLinearSystems4x4CMV4)(int n, const float *m, const float *v,
+		float *v_result);
+
+	// Fused point projection (transform, perspective divide and viewport).
+	void (*dstTransformAndProjectPointsP3)(int n, const float *params, const float *v,
+		float *v_result);
+	void (*dstTransformAndProjectPointsP3P)(int n, const float *params, const float *v,
+		float *v_result);
+	void (*dstTransformAndProjectPointsP3Int16)(int n, const float *params, const float *v,
+		float *v_result);
+	void (*dstTransformAndProjectPointsP3PInt16)(int n, const float *params, const float *v,
+		float *v_result);
+
+	// Quaternion functions.
+	void (*dstMultiplyQuaternionsQ)(int n, const float *q1, const float *q2,
+		float *q_result);
+	void (*dstMultiplyQuaternionsQSoA)(int n, const float *q1, const float *q2,
+		float *q_result);
+	void (*dstNormalizeQuaternionsQ)(int n, const float *q, float *q_result);
+	void (*dstNormalizeQuaternionsQSoA)(int n, const float *q, float *q_result);
+	void (*dstNlerpQuaternionsQ)(int n, const float *q1, const float *q2,
+		const float *t, float *q_result);
+	void (*dstNlerpQuaternionsQSoA)(int n, const float *q1, const float *q2,
+		const float *t, float *q_result);
+	void (*dstSlerpQuaternionsQ)(int n, const float *q1, const float *q2,
+		const float *t, float *q_result);
+	void (*dstSlerpQuaternionsQSoA)(int n, const float *q1, const float *q2,
+		const float *t, float *q_result);
+	void (*dstRotateVectorsQV3)(int n, const float *q, const float *v,
+		float *v_result);
+	void (*dstRotateVectorsQV3P)(int n, const float *q, const float *v,
+		float *v_result);
+	void (*dstConvertQuaternionsToMatrices3x3CM)(int n, const float *q, float *m_result);
+	void (*dstConvertQuaternionsToMatrices4x3RM)(int n, const float *q, float *m_result);
+
+	// Skinning and per-vertex matrix selection.
+	void (*dstSkinVerticesM4x3RMP3P)(int n, const float *m, const float *f, const float *p,
+		const float *v, float *p_result, float *v_result);
+	void (*dstMatrixMultiplyVerticesIndexedM4x3RMP3P)(int n, const float *m, const float *f,
+		const float *p, const float *v, float *p_result, float *v_result);
 };
 
 extern const dstSIMDFuncs dst_simd_funcs_NoSIMD;
@@ -166,6 +267,9 @@ extern const dstSIMDFuncs dst_simd_funcs_AVX_SSE4_FMA4;
 extern const dstSIMDFuncs dst_simd_funcs_AVX_FMA;
 #endif
 
+// Global configuration. The flags, SIMD type, function tables, thread settings and
+// maximum number of tasks are the defaults for new contexts (see dstContext).
+
 class DST_API dstConfig {
 public :
 	// Global configuration flags.
@@ -174,9 +278,9 @@ public :
 	uint32_t simd_type;
 	// All SIMD features that are supported by the current CPU.
 	uint32_t simd_cpu_flags;
-	// Number of CPU cores.
+	// Number of CPUs used by the library (see dstGetNumberOfAffinityCPUs()).
 	uint32_t nu_cpus;
-	// The logical CPU on which the main library thread is running.
+	// The logical CPU to which the main library thread is bound (-1 when not bound).
 	int main_thread_cpu;
 	// The maximum number of threads to use in a CPU-intensive function.
 	int max_threads_per_function;
@@ -186,7 +290,6 @@ public :
 	dstSIMDFuncs simd_funcs;
 	dstSIMDFuncs simd_funcs_stream;
 	dstTaskScheduler task_scheduler;
-	int nu_tasks;
 	int max_tasks;
 };
 
@@ -194,6 +297,59 @@ extern DST_API dstConfig dst_config;
 
 DST_API void dstInit();
 
+// Library state of an application thread. Each thread has its own default context,
+// created from the defaults in dst_config when the thread first uses the library, so
+// that threads can change flags, SIMD type and thread settings and call multi-threaded
+// functions concurrently without affecting each other. An application can also create
+// contexts of its own and select them with dstSetContext(). Functions executed by the
+// worker threads use the default context of the worker.
+
+class DST_API dstContext {
+public :
+	uint32_t flags;
+	uint32_t simd_type;
+	int max_threads_per_function;
+	int fixed_nu_threads;
+	// Function tables.
+	const dstSIMDFuncs *simd_funcs;
+	const dstSIMDFuncs *simd_funcs_stream;
+	// Scheduler used by multi-threaded functions.
+	dstTaskScheduler *task_scheduler;
+	// Multi-threaded calls that have not been waited for (see dstSetMaxNumberOfTasks()).
+	int nu_tasks;
+	int max_tasks;
+	dstIntArray pending_group_array;
+
+	// Initialize from the defaults in dst_config.
+	dstContext();
+	void Initialize();
+	// Wait for all pending multi-threaded calls made with this context.
+	void Sync();
+	// Task flags for work queued on behalf of this context.
+	inline int GetTaskFlags() const {
+		return (flags & DST_FLAG_HIGH_PRIORITY) ? DST_TASK_FLAG_PRIORITY_HIGH : 0;
+	}
+};
+
+extern DST_API __thread dstContext *dst_current_context
+	__attribute__ ((tls_model ("initial-exec")));
+
+DST_API dstContext *dstCreateThreadContext();
+
+// Return the current context of the calling thread.
+
+static DST_INLINE_ONLY dstContext *dstGetContext() {
+	dstContext *context = dst_current_context;
+	if (__builtin_expect(context == NULL, 0))
+		context = dstCreateThreadContext();
+	return context;
+}
+
+// Select the current context of the calling thread. NULL selects the thread's default
+// context.
+
+DST_API void dstSetContext(dstContext *context);
+
 static DST_INLINE_ONLY bool dstCheckFlag(uint32_t flag) {
 #ifdef DST_FIXED_SIMD
 	// When SIMD is guaranteed, just return true.
@@ -209,7 +365,7 @@ static DST_INLINE_ONLY bool dstCheckFlag(uint32_t flag) {
 	if (flag == DST_FLAG_SIMD_256)
 		return true;
 #endif
-	return (dst_config.flags & flag) != 0;
+	return (dstGetContext()->flags & flag) != 0;
 }
 
 static DST_INLINE_ONLY bool dstCheckSIMDCPUFlag(uint32_t flag) {
@@ -283,19 +439,19 @@ static DST_INLINE_ONLY bool dstCheckSIMDCPUFlag(uint32_t flag) {
 }
 
 static DST_INLINE_ONLY void dstSetFlags(uint32_t flags) {
-	dst_config.flags = flags;
+	dstGetContext()->flags = flags;
 }
 
 static DST_INLINE_ONLY uint32_t dstGetFlags() {
-	return dst_config.flags;
+	return dstGetContext()->flags;
 }
 
 static DST_INLINE_ONLY void dstSetFlag(uint32_t flag) {
-	dst_config.flags |= flag;
+	dstGetContext()->flags |= flag;
 }
 
 static DST_INLINE_ONLY void dstClearFlag(uint32_t flag) {
-	dst_config.flags &= (~flag);
+	dstGetContext()->flags &= (~flag);
 }
 
 DST_API void dstSetSIMDType(int simd_type);
@@ -305,7 +461,7 @@ DST_API void dstSetStreamingSIMDType(int simd_type);
 DST_API void dstSetNonStreamingSIMDType(int simd_type);
 
 static DST_INLINE_ONLY int dstGetSIMDType() {
-	return dst_config.simd_type;
+	return dstGetContext()->simd_type;
 }
 
 DST_API const char *dstGetSIMDTypeString(int simd_type);
@@ -319,19 +475,27 @@ DST_API const char *dstGetSIMDTypeString(int simd_type);
 // Get hint about number of threads to use for operation on N elements, each with a given relative
 // cost. A cost of one per element roughly corresponds to a simple operation that adds up all elements
 // of an array of floats. A four vector dot product calculation with two arrays has a cost of roughly 64
-// per element. This always returns a power of two.
+// per element. This static estimate is only used when the threading cost model is disabled or
+// cannot measure the call (see dstThreadingModel.h), and as its starting point.
 
 static DST_INLINE_ONLY int dstGetNumberOfThreadsHint(uint32_t n, uint32_t cost) {
-	if (dst_config.flags & DST_FLAG_FIXED_NU_THREADS)
-		return dst_config.fixed_nu_threads;
+	dstContext *context = dstGetContext();
+	if (context->flags & DST_FLAG_FIXED_NU_THREADS)
+		return context->fixed_nu_threads;
 	int nu_threads = mini(128, 1 + (uint64_t)n * cost / DST_TWO_THREADS_COST_THRESHOLD);
-	return mini(nu_threads, dst_config.max_threads_per_function);
+	return mini(nu_threads, context->max_threads_per_function);
 }
 
 // Set fixed number of threads. The DST_FLAG_FIXED_NU_THREADS flag is not set.
 
 static DST_INLINE_ONLY void dstSetFixedNumberOfThreads(int nu_threads) {
-	dst_config.fixed_nu_threads = nu_threads;
+	dstGetContext()->fixed_nu_threads = nu_threads;
+}
+
+// Set the maximum number of threads used by a single function.
+
+static DST_INLINE_ONLY void dstSetMaxNumberOfThreadsPerFunction(int nu_threads) {
+	dstGetContext()->max_threads_per_function = nu_threads;
 }
 
 // Set the maximum number of tasks that will be queued at any one time. When equal to one, no
@@ -339,12 +503,47 @@ static DST_INLINE_ONLY void dstSetFixedNumberOfThreads(int nu_threads) {
 // threads.
 
 static DST_INLINE_ONLY void dstSetMaxNumberOfTasks(int max_tasks) {
-	dst_config.max_tasks = max_tasks;
+	dstGetContext()->max_tasks = max_tasks;
 }
 
+// Wait for the multi-threaded calls of the current context that have not been waited for.
+
 static DST_INLINE_ONLY void dstSyncTasks() {
-	if (dst_config.max_tasks > 1)
-		dst_config.task_scheduler.WaitUntilFinished();
+	dstGetContext()->Sync();
+}
+
+// Keep the worker threads spinning between back-to-back multi-threaded calls, reducing
+// the latency of each call at the cost of busy CPUs. Calls may be nested.
+
+static DST_INLINE_ONLY void dstBeginParallelRegion() {
+	dstGetContext()->task_scheduler->BeginParallelRegion();
+}
+
+static DST_INLINE_ONLY void dstEndParallelRegion() {
+	dstGetContext()->task_scheduler->EndParallelRegion();
+}
+
+// Asynchronous mode. Multi-threaded dot product and matrix-vector functions called
+// between dstBeginAsync() and dstEndAsync() return as soon as their work has been
+// queued; dstEndAsync() returns a handle to all of it. The arrays passed to the
+// functions (and vectors or matrices passed by reference) must remain valid until
+// the handle is done. Other functions are executed synchronously.
+
+static DST_INLINE_ONLY void dstBeginAsync() {
+	dstGetContext()->task_scheduler->BeginAsync();
+}
+
+static DST_INLINE_ONLY dstTaskHandle dstEndAsync() {
+	return dstGetContext()->task_scheduler->EndAsync();
+}
+
+// Call f() (for example a lambda calling library functions) in asynchronous mode.
+
+template <class F>
+static DST_INLINE_ONLY dstTaskHandle dstRunAsync(const F& f) {
+	dstBeginAsync();
+	f();
+	return dstEndAsync();
 }
 
 #endif
@@ -0,0 +1,177 @@
+/*
+
+Copyright (c) 2014 Harm Hanemaaijer <fgenfb@yahoo.com>
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted, provided that the above
+copyright notice and this permission notice appear in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "dstNUMA.h"
+#include "dstMisc.h"
+#include "dstThread.h"
+
+static dstNUMATopology dst_numa_topology;
+static pthread_once_t dst_numa_topology_once = PTHREAD_ONCE_INIT;
+
+// Parse a sysfs CPU list such as "0-3,8-11" and assign the CPUs to a node.
+
+static void dstAssignCPUList(dstNUMATopology *topology, const char *s, int node) {
+	while (*s != '\0' && *s != '\n') {
+		char *end;
+		int first = strtol(s, &end, 10);
+		if (end == s)
+			return;
+		int last = first;
+		s = end;
+		if (*s == '-') {
+			s++;
+			last = strtol(s, &end, 10);
+			if (end == s)
+				return;
+			s = end;
+		}
+		for (int cpu = first; cpu <= last; cpu++)
+			if (cpu >= 0 && cpu < topology->nu_cpus) {
+				topology->cpu_node[cpu] = node;
+				topology->node_nu_cpus[node]++;
+			}
+		if (*s == ',')
+			s++;
+	}
+}
+
+void dstNUMATopology::Detect() {
+	nu_cpus = sysconf(_SC_NPROCESSORS_CONF);
+	cpu_node = new int[nu_cpus];
+	for (int i = 0; i < nu_cpus; i++)
+		cpu_node[i] = 0;
+	nu_nodes = 0;
+	// Node numbers are not necessarily contiguous.
+	for (int id = 0; id < 1024 && nu_nodes < DST_MAX_NUMA_NODES; id++) {
+		char filename[64];
+		sprintf(filename, "/sys/devices/system/node/node%d/cpulist", id);
+		FILE *f = fopen(filename, "r");
+		if (f == NULL)
+			continue;
+		char s[4096];
+		if (fgets(s, sizeof(s), f) != NULL) {
+			node_id[nu_nodes] = id;
+			node_nu_cpus[nu_nodes] = 0;
+			dstAssignCPUList(this, s, nu_nodes);
+			// Memory-only nodes do not get workers.
+			if (node_nu_cpus[nu_nodes] > 0)
+				nu_nodes++;
+		}
+		fclose(f);
+	}
+	if (nu_nodes == 0) {
+		// No NUMA information; use a single node.
+		nu_nodes = 1;
+		node_id[0] = 0;
+		node_nu_cpus[0] = nu_cpus;
+		for (int i = 0; i < nu_cpus; i++)
+			cpu_node[i] = 0;
+	}
+}
+
+static void dstDetectNUMATopology() {
+	dst_numa_topology.Detect();
+}
+
+const dstNUMATopology *dstGetNUMATopology() {
+	pthread_once(&dst_numa_topology_once, dstDetectNUMATopology);
+	return &dst_numa_topology;
+}
+
+// First-touch allocation.
+
+class dstNUMATouchData {
+public :
+	char *p;
+	size_t n;
+	size_t element_size;
+	size_t page_size;
+};
+
+// Zero the pages of the part of the range owned by a node. The part boundaries are
+// rounded to page boundaries, so that every page is touched exactly once.
+
+static void dstNUMATouchRange(const dstNUMATouchData *data, const dstNUMATopology *topology,
+int node) {
+	size_t size = data->n * data->element_size;
+	size_t start = (uint64_t)data->n * node / topology->nu_nodes * data->element_size;
+	size_t end = (uint64_t)data->n * (node + 1) / topology->nu_nodes * data->element_size;
+	start = (start + data->page_size / 2) / data->page_size * data->page_size;
+	if (node == topology->nu_nodes - 1)
+		end = size;
+	else
+		end = (end + data->page_size / 2) / data->page_size * data->page_size;
+	if (end > start)
+		memset(data->p + start, 0, end - start);
+}
+
+static void dstNUMATouchThread(dstThreadData *thread_data) {
+	const dstNUMATouchData *data = (const dstNUMATouchData *)thread_data->user_data;
+	dstNUMATouchRange(data, dstGetNUMATopology(), thread_data->subdivision.index);
+}
+
+void *dstAllocateNUMALocal(size_t n, size_t element_size) {
+	size_t size = n * element_size;
+	if (size == 0)
+		size = 1;
+	// Anonymous mappings are not backed by pages until they are touched.
+	void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, - 1, 0);
+	if (p == MAP_FAILED)
+		return NULL;
+	const dstNUMATopology *topology = dstGetNUMATopology();
+	dstTaskScheduler *scheduler = dstGetContext()->task_scheduler;
+	if (topology->nu_nodes == 1 || scheduler->GetNumberOfNodes() == 1)
+		// Pages are placed on first use.
+		return p;
+	dstNUMATouchData data;
+	data.p = (char *)p;
+	data.n = n;
+	data.element_size = element_size;
+	data.page_size = sysconf(_SC_PAGESIZE);
+	volatile int nu_pending = 0;
+	for (int node = 0; node < topology->nu_nodes; node++) {
+		if (scheduler->GetNumberOfWorkers(node) == 0) {
+			// No worker on the node; touch the part from the calling thread.
+			dstNUMATouchRange(&data, topology, node);
+			continue;
+		}
+		dstThreadData thread_data;
+		thread_data.user_data = &data;
+		thread_data.subdivision.start_index = 0;
+		thread_data.subdivision.nu_elements = 0;
+		thread_data.subdivision.index = node;
+		__sync_fetch_and_add(&nu_pending, 1);
+		scheduler->QueueWorkItemOnNode(node, DST_TASK_FLAG_NODE_BOUND, dstNUMATouchThread,
+			thread_data, &nu_pending);
+	}
+	scheduler->WaitUntilZero(&nu_pending);
+	return p;
+}
+
+void dstFreeNUMALocal(void *p, size_t n, size_t element_size) {
+	size_t size = n * element_size;
+	if (size == 0)
+		size = 1;
+	munmap(p, size);
+}
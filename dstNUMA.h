@@ -0,0 +1,82 @@
+/*
+
+Copyright (c) 2014 Harm Hanemaaijer <fgenfb@yahoo.com>
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted, provided that the above
+copyright notice and this permission notice appear in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef __DST_NUMA_H__
+#define __DST_NUMA_H__
+
+// NUMA topology and first-touch allocation. The topology is read from sysfs; when it
+// is not available, all CPUs are assumed to be on a single node.
+//
+// The element range [0, n) of an array is divided into equal contiguous parts, one
+// per node, in node order. The task scheduler queues each subdivision of a task group
+// on a worker of the node that owns the middle element of the subdivision, and
+// dstNewNUMALocal() touches the pages of each part from a worker of the owning node,
+// so that with the default first-touch policy the pages are placed on that node.
+
+#include <stddef.h>
+
+// Defined before the other includes, because dstThread.h depends on it.
+#define DST_MAX_NUMA_NODES 64
+
+#include <dstConfig.h>
+
+class DST_API dstNUMATopology {
+public :
+	int nu_nodes;
+	int nu_cpus;
+	// The (dense) node index of each logical CPU.
+	int *cpu_node;
+	// The operating system node number of each node.
+	int node_id[DST_MAX_NUMA_NODES];
+	int node_nu_cpus[DST_MAX_NUMA_NODES];
+
+	void Detect();
+	inline int GetNodeOfCPU(int cpu) const {
+		if (cpu < 0 || cpu >= nu_cpus)
+			return 0;
+		return cpu_node[cpu];
+	}
+	// The node that owns element index i of a range of n elements.
+	inline int GetNodeOfElement(uint64_t i, uint64_t n) const {
+		if (nu_nodes == 1 || n == 0)
+			return 0;
+		return mini((int)(i * nu_nodes / n), nu_nodes - 1);
+	}
+};
+
+// Return the NUMA topology, which is detected on first use.
+DST_API const dstNUMATopology *dstGetNUMATopology();
+
+// Allocate memory for n elements of the given size, and touch the part owned by each
+// node from a worker thread on that node. The memory is page-aligned and zeroed, and
+// must be freed with dstFreeNUMALocal().
+DST_API void *dstAllocateNUMALocal(size_t n, size_t element_size);
+DST_API void dstFreeNUMALocal(void *p, size_t n, size_t element_size);
+
+template <class T>
+static inline T *dstNewNUMALocal(size_t n) {
+	return (T *)dstAllocateNUMALocal(n, sizeof(T));
+}
+
+template <class T>
+static inline void dstDeleteNUMALocal(T *p, size_t n) {
+	dstFreeNUMALocal(p, n, sizeof(T));
+}
+
+#endif
+
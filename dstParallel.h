@@ -0,0 +1,154 @@
+/*
+
+Copyright (c) 2014 Harm Hanemaaijer <fgenfb@yahoo.com>
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted, provided that the above
+copyright notice and this permission notice appear in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef __DST_PARALLEL_H__
+#define __DST_PARALLEL_H__
+
+// Parallel loop templates built on the task scheduler. The range [0, n) is split
+// into aligned chunks with the same semantics as dstTaskDivisionData, and the chunks
+// are executed by the worker pool, with the calling thread helping. The functor is
+// passed by reference to the tasks and the call waits until all chunks have finished,
+// so nothing is allocated per call.
+//
+// dstParallelFor(n, grain, alignment, f) calls f(start, end) for each chunk.
+//
+// dstParallelReduce(n, grain, alignment, identity, map, combine) calls
+// map(start, end) for each chunk, returning a partial result of type T, and
+// combines the partial results in order of increasing start index, starting with
+// identity. dstParallelReduce(n, identity, map, combine) uses a default grain size
+// and an alignment of one element. T must be default-constructible and assignable,
+// since the partial results are kept in an array on the stack.
+//
+// With DST_FLAG_DYNAMIC_SCHEDULING, dstParallelFor() divides the range in guided mode
+// (see dstTaskDivisionData), with grain as the minimum chunk size. dstParallelReduce()
+// always uses equal chunks, since the partial results are combined in range order.
+//
+// grain is the minimum number of elements per chunk. When threading is disabled
+// (DST_FLAG_THREADING), or the range is not larger than grain, the functor is
+// called on the calling thread for the whole range.
+
+#include <dstConfig.h>
+#include <dstMisc.h>
+#include <dstThread.h>
+
+// Upper limit on the number of chunks (equal to the upper limit on the number of threads
+// used by dstGetNumberOfThreadsHint).
+#define DST_PARALLEL_MAX_CHUNKS 128
+// Default grain size of dstParallelReduce.
+#define DST_PARALLEL_DEFAULT_GRAIN 4096
+
+// Determine the number of chunks for a range of n elements, given the minimum number of
+// elements per chunk. Limited by the maximum (or fixed) number of threads.
+
+static DST_INLINE_ONLY int dstGetNumberOfParallelChunks(uint32_t n, uint32_t grain) {
+	if (!dstCheckFlag(DST_FLAG_THREADING) || grain == 0)
+		return 1;
+	dstContext *context = dstGetContext();
+	int max_chunks = context->max_threads_per_function;
+	if (context->flags & DST_FLAG_FIXED_NU_THREADS)
+		max_chunks = context->fixed_nu_threads;
+	max_chunks = mini(max_chunks, DST_PARALLEL_MAX_CHUNKS);
+	uint32_t nu_chunks = n / grain;
+	if (nu_chunks < 1)
+		return 1;
+	return mini(nu_chunks, max_chunks);
+}
+
+template <class F>
+static void dstParallelForThread(dstThreadData *thread_data) {
+	const F *f = (const F *)thread_data->user_data;
+	uint32_t start_index = thread_data->subdivision.start_index;
+	(*f)(start_index, start_index + thread_data->subdivision.nu_elements);
+}
+
+template <class F>
+static void dstParallelFor(uint32_t n, uint32_t grain, uint32_t alignment, const F& f) {
+	int nu_chunks = dstGetNumberOfParallelChunks(n, grain);
+	if (nu_chunks <= 1) {
+		if (n > 0)
+			f(0, n);
+		return;
+	}
+	dstTaskDivisionData division;
+	division.size = n;
+	division.nu_subdivisions = nu_chunks;
+	division.alignment = alignment;
+	dstContext *context = dstGetContext();
+	if (context->flags & DST_FLAG_DYNAMIC_SCHEDULING) {
+		division.mode = DST_TASK_DIVISION_GUIDED;
+		division.min_chunk_size = grain;
+	}
+	dstTaskScheduler *scheduler = context->task_scheduler;
+	int group_index = scheduler->AddSubdividedTaskGroup(context->GetTaskFlags(),
+		dstParallelForThread <F>, (const void *)&f, division);
+	scheduler->WaitUntilGroupFinished(group_index);
+}
+
+template <class T, class M>
+class dstParallelReduceData {
+public :
+	const M *map;
+	T *partial;
+};
+
+template <class T, class M>
+static void dstParallelReduceThread(dstThreadData *thread_data) {
+	const dstParallelReduceData <T, M> *data =
+		(const dstParallelReduceData <T, M> *)thread_data->user_data;
+	uint32_t start_index = thread_data->subdivision.start_index;
+	data->partial[thread_data->subdivision.index] = (*data->map)(start_index,
+		start_index + thread_data->subdivision.nu_elements);
+}
+
+template <class T, class M, class C>
+static T dstParallelReduce(uint32_t n, uint32_t grain, uint32_t alignment, const T& identity,
+const M& map, const C& combine) {
+	int nu_chunks = dstGetNumberOfParallelChunks(n, grain);
+	if (nu_chunks <= 1) {
+		if (n == 0)
+			return identity;
+		return combine(identity, map(0, n));
+	}
+	// Chunks with zero elements are not executed, so initialize all partial results.
+	T partial[DST_PARALLEL_MAX_CHUNKS];
+	for (int i = 0; i < nu_chunks; i++)
+		partial[i] = identity;
+	dstParallelReduceData <T, M> data;
+	data.map = &map;
+	data.partial = partial;
+	dstTaskDivisionData division;
+	division.size = n;
+	division.nu_subdivisions = nu_chunks;
+	division.alignment = alignment;
+	dstContext *context = dstGetContext();
+	dstTaskScheduler *scheduler = context->task_scheduler;
+	int group_index = scheduler->AddSubdividedTaskGroup(context->GetTaskFlags(),
+		dstParallelReduceThread <T, M>, (const void *)&data, division);
+	scheduler->WaitUntilGroupFinished(group_index);
+	T result = identity;
+	for (int i = 0; i < nu_chunks; i++)
+		result = combine(result, partial[i]);
+	return result;
+}
+
+template <class T, class M, class C>
+static T dstParallelReduce(uint32_t n, const T& identity, const M& map, const C& combine) {
+	return dstParallelReduce(n, DST_PARALLEL_DEFAULT_GRAIN, 1, identity, map, combine);
+}
+
+#endif
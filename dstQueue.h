@@ -135,5 +135,188 @@ typedef dstSmallQueue <double> dstSmallDoubleQueue;
 typedef dstSmallQueue <uint32_t> dstSmallUnsignedIntQueue;
 typedef dstSmallQueue <void *> dstSmallPointerQueue;
 
+// Lock-free bounded ring queues for producer/consumer pipelines. The capacity is
+// rounded up to a power of two and is fixed; Enqueue() returns false when the queue
+// is full and Dequeue() returns false when it is empty, without blocking. The
+// producer and consumer positions are kept on separate cache lines. Elements are
+// copied with plain assignment.
+
+// Queue for a single producer thread and a single consumer thread.
+
+template <class T>
+class DST_API dstSPSCQueue {
+private :
+	T *elements;
+	uint32_t mask;
+	// Consumer position, and the consumer's copy of the producer position.
+	volatile uint32_t head DST_ALIGNED(DST_LINE_SIZE);
+	uint32_t cached_tail;
+	// Producer position, and the producer's copy of the consumer position.
+	volatile uint32_t tail DST_ALIGNED(DST_LINE_SIZE);
+	uint32_t cached_head;
+
+public :
+	dstSPSCQueue() {
+		elements = NULL;
+		mask = 0;
+		head = tail = cached_head = cached_tail = 0;
+	}
+	explicit dstSPSCQueue(uint32_t capacity) {
+		elements = NULL;
+		Initialize(capacity);
+	}
+	~dstSPSCQueue() {
+		Destroy();
+	}
+	void Initialize(uint32_t capacity) {
+		uint32_t n = 1;
+		while (n < capacity)
+			n *= 2;
+		elements = new T[n];
+		mask = n - 1;
+		head = tail = cached_head = cached_tail = 0;
+	}
+	void Destroy() {
+		delete [] elements;
+		elements = NULL;
+	}
+	inline uint32_t Capacity() const {
+		return mask + 1;
+	}
+	// The size is exact only when called by the producer or consumer.
+	inline uint32_t Size() const {
+		return tail - head;
+	}
+	inline bool IsEmpty() const {
+		return Size() == 0;
+	}
+	bool Enqueue(const T& v) {
+		uint32_t t = tail;
+		if (t - cached_head > mask) {
+			cached_head = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+			if (t - cached_head > mask)
+				return false;
+		}
+		elements[t & mask] = v;
+		__atomic_store_n(&tail, t + 1, __ATOMIC_RELEASE);
+		return true;
+	}
+	bool Dequeue(T& v) {
+		uint32_t h = head;
+		if (h == cached_tail) {
+			cached_tail = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+			if (h == cached_tail)
+				return false;
+		}
+		v = elements[h & mask];
+		__atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);
+		return true;
+	}
+};
+
+// Queue for any number of producer and consumer threads. Each slot has a sequence
+// number that tells whether it is ready to be written or read for a given position,
+// so that producers and consumers only contend on their own position counter.
+
+template <class T>
+class DST_API dstMPMCQueueSlot {
+public :
+	volatile uint32_t sequence;
+	T element;
+};
+
+template <class T>
+class DST_API dstMPMCQueue {
+private :
+	dstMPMCQueueSlot <T> *slots;
+	uint32_t mask;
+	volatile uint32_t enqueue_position DST_ALIGNED(DST_LINE_SIZE);
+	volatile uint32_t dequeue_position DST_ALIGNED(DST_LINE_SIZE);
+
+public :
+	dstMPMCQueue() {
+		slots = NULL;
+		mask = 0;
+		enqueue_position = dequeue_position = 0;
+	}
+	explicit dstMPMCQueue(uint32_t capacity) {
+		slots = NULL;
+		Initialize(capacity);
+	}
+	~dstMPMCQueue() {
+		Destroy();
+	}
+	void Initialize(uint32_t capacity) {
+		uint32_t n = 1;
+		while (n < capacity)
+			n *= 2;
+		slots = new dstMPMCQueueSlot <T>[n];
+		for (uint32_t i = 0; i < n; i++)
+			slots[i].sequence = i;
+		mask = n - 1;
+		enqueue_position = dequeue_position = 0;
+	}
+	void Destroy() {
+		delete [] slots;
+		slots = NULL;
+	}
+	inline uint32_t Capacity() const {
+		return mask + 1;
+	}
+	// Approximate when other threads use the queue at the same time.
+	inline uint32_t Size() const {
+		return enqueue_position - dequeue_position;
+	}
+	inline bool IsEmpty() const {
+		return Size() == 0;
+	}
+	bool Enqueue(const T& v) {
+		uint32_t position = enqueue_position;
+		dstMPMCQueueSlot <T> *slot;
+		for (;;) {
+			slot = &slots[position & mask];
+			uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+			int32_t difference = (int32_t)(sequence - position);
+			if (difference == 0) {
+				if (__sync_bool_compare_and_swap(&enqueue_position, position,
+				position + 1))
+					break;
+				position = enqueue_position;
+			}
+			else if (difference < 0)
+				// The slot still holds an element from the previous round.
+				return false;
+			else
+				position = enqueue_position;
+		}
+		slot->element = v;
+		__atomic_store_n(&slot->sequence, position + 1, __ATOMIC_RELEASE);
+		return true;
+	}
+	bool Dequeue(T& v) {
+		uint32_t position = dequeue_position;
+		dstMPMCQueueSlot <T> *slot;
+		for (;;) {
+			slot = &slots[position & mask];
+			uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+			int32_t difference = (int32_t)(sequence - (position + 1));
+			if (difference == 0) {
+				if (__sync_bool_compare_and_swap(&dequeue_position, position,
+				position + 1))
+					break;
+				position = dequeue_position;
+			}
+			else if (difference < 0)
+				// The slot has not been written yet.
+				return false;
+			else
+				position = dequeue_position;
+		}
+		v = slot->element;
+		__atomic_store_n(&slot->sequence, position + mask + 1, __ATOMIC_RELEASE);
+		return true;
+	}
+};
+
 #endif
 
@@ -404,6 +404,60 @@ __simd128_float m_v) {
                 simd128_horizontal_add2_float(m_mul2, m_zeros));
 }
 
+// Multiply a matrix, given as four columns, with a four-component vector. Each component
+// of the vector is replicated and multiplied with the corresponding column, which avoids
+// the horizontal additions required by the row-based version.
+
+static DST_INLINE_ONLY __simd128_float simd128_multiply_matrix4x4CM_vector4(
+__simd128_float m_column0, __simd128_float m_column1, __simd128_float m_column2,
+__simd128_float m_column3, __simd128_float m_v) {
+        return simd128_add_float(
+            simd128_add_float(
+                simd128_mul_float(m_column0, simd128_replicate_float(m_v, 0)),
+                simd128_mul_float(m_column1, simd128_replicate_float(m_v, 1))),
+            simd128_add_float(
+                simd128_mul_float(m_column2, simd128_replicate_float(m_v, 2)),
+                simd128_mul_float(m_column3, simd128_replicate_float(m_v, 3))));
+}
+
+// Multiply four vectors, stored in transposed form (similar coordinates in a single
+// vector), with a matrix given as four columns. The results are also in transposed form.
+
+static DST_INLINE_ONLY void simd128_multiply_matrix4x4CM_vectors4_transposed(
+__simd128_float m_column0, __simd128_float m_column1, __simd128_float m_column2,
+__simd128_float m_column3, __simd128_float m_v_x, __simd128_float m_v_y,
+__simd128_float m_v_z, __simd128_float m_v_w, __simd128_float& m_result_x,
+__simd128_float& m_result_y, __simd128_float& m_result_z, __simd128_float& m_result_w) {
+        m_result_x = simd128_add_float(
+            simd128_add_float(
+                simd128_mul_float(simd128_replicate_float(m_column0, 0), m_v_x),
+                simd128_mul_float(simd128_replicate_float(m_column1, 0), m_v_y)),
+            simd128_add_float(
+                simd128_mul_float(simd128_replicate_float(m_column2, 0), m_v_z),
+                simd128_mul_float(simd128_replicate_float(m_column3, 0), m_v_w)));
+        m_result_y = simd128_add_float(
+            simd128_add_float(
+                simd128_mul_float(simd128_replicate_float(m_column0, 1), m_v_x),
+                simd128_mul_float(simd128_replicate_float(m_column1, 1), m_v_y)),
+            simd128_add_float(
+                simd128_mul_float(simd128_replicate_float(m_column2, 1), m_v_z),
+                simd128_mul_float(simd128_replicate_float(m_column3, 1), m_v_w)));
+        m_result_z = simd128_add_float(
+            simd128_add_float(
+                simd128_mul_float(simd128_replicate_float(m_column0, 2), m_v_x),
+                simd128_mul_float(simd128_replicate_float(m_column1, 2), m_v_y)),
+            simd128_add_float(
+                simd128_mul_float(simd128_replicate_float(m_column2, 2), m_v_z),
+                simd128_mul_float(simd128_replicate_float(m_column3, 2), m_v_w)));
+        m_result_w = simd128_add_float(
+            simd128_add_float(
+                simd128_mul_float(simd128_replicate_float(m_column0, 3), m_v_x),
+                simd128_mul_float(simd128_replicate_float(m_column1, 3), m_v_y)),
+            simd128_add_float(
+                simd128_mul_float(simd128_replicate_float(m_column2, 3), m_v_z),
+                simd128_mul_float(simd128_replicate_float(m_column3, 3), m_v_w)));
+}
+
 #endif // !defined(DST_NO_SIMD)
 
 #endif // defined(__DST_SIMD_H__)
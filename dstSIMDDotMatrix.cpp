@@ -23,10 +23,11 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include <stdint.h>
 #include <math.h>
 
+#include "dstMisc.h"
 #include "dstSIMD.h"
 #include "dstSIMDDot.h"
 #include "dstSIMDMatrix.h"
-#include "dstMisc.h"
+#include "dstThreadingModel.h"
 
 #ifdef DST_SIMD_MODE_STREAM
 // Support multi-threading in streaming store versions of SIMD functions.
@@ -41,6 +42,7 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
 #ifdef DST_MULTI_THREADING
 #include "dstThread.h"
+#include "dstParallel.h"
 #endif
 
 #ifndef DST_NO_SIMD
@@ -62,6 +64,11 @@ const float * DST_RESTRICT m2, float * DST_RESTRICT m3) {
     dstInlineMatrixMultiply4x4CM4x3RM(m1, m2, m3);
 }
 
+void SIMD_FUNC(dstMatrixMultiply3x3CM)(const float * DST_RESTRICT m1,
+const float * DST_RESTRICT m2, float * DST_RESTRICT m3) {
+    dstInlineMatrixMultiply3x3CM(m1, m2, m3);
+}
+
 
 // Multiply matrix with vectors.
 
@@ -70,21 +77,11 @@ const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
 	dstInlineMatrixMultiplyVectors1x4M4x4CMV4(m, v, v_result);
 }
 
-void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x4CMV4)(int n, const float * DST_RESTRICT m,
-const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
-	dstInlineMatrixMultiplyVectors1xNM4x4CMV4(n, m, v, v_result);
-}
-
 void SIMD_FUNC(dstMatrixMultiplyVectors1x4M4x4CMP3P)(const float * DST_RESTRICT m,
 const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
 	dstInlineMatrixMultiplyVectors1x4M4x4CMP3P(m, v, v_result);
 }
 
-void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x4CMP3P)(int n, const float * DST_RESTRICT m,
-const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
-	dstInlineMatrixMultiplyVectors1xNM4x4CMP3P(n, m, v, v_result);
-}
-
 // Dot products (4x4).
 
 void SIMD_FUNC(dstCalculateFourDotProductsV4)(
@@ -117,9 +114,10 @@ static void dstCalculateDotProductsThread(dstThreadData *thread_data) {
 	uint32_t alignment_and_sizes = (uint32_t)(uint64_t)user_data[4];
 	uint32_t size_f1 = (alignment_and_sizes >> 8) & 0xFF;
 	uint32_t size_f2 = (alignment_and_sizes >> 16) & 0xFF;
+	uint32_t size_dot = (alignment_and_sizes >> 24) & 0xFF;
 	f1 += thread_data->subdivision.start_index * size_f1;
 	f2 += thread_data->subdivision.start_index * size_f2;
-	dot += thread_data->subdivision.start_index;
+	dot += thread_data->subdivision.start_index * size_dot;
 //	printf("Task begin start_index = %d, n = %d, sizes %d/%d\n",
 //		thread_data->subdivision.start_index,
 //		thread_data->subdivision.nu_elements,
@@ -134,16 +132,31 @@ static void dstCalculateDotProductsThread(dstThreadData *thread_data) {
 
 static void dstSubdivideDotProductFunction(int nu_threads,
 const void (*dot_product_func)(int n, const float * DST_RESTRICT f1, const float * DST_RESTRICT f2,
-float * DST_RESTRICT dot), uint32_t alignment_and_sizes, int n, const float * DST_RESTRICT f1,
-const float * DST_RESTRICT f2, float * DST_RESTRICT dot) {
+float * DST_RESTRICT dot), int cost, uint32_t alignment_and_sizes, int n,
+const float * DST_RESTRICT f1, const float * DST_RESTRICT f2, float * DST_RESTRICT dot) {
 	uint32_t alignment = alignment_and_sizes & 0xFF;
 	dstTaskDivisionData division;
 	division.size = n;
 	division.nu_subdivisions = nu_threads;
 	// Alignment in terms of number of elements.
 	division.alignment = alignment;
+	dstContext *context = dstGetContext();
+	if ((context->flags & DST_FLAG_DYNAMIC_SCHEDULING) && nu_threads > 1)
+		// Chunks of at least a cache line of results.
+		division.SetDynamicMode(DST_TASK_DIVISION_GUIDED,
+			((alignment_and_sizes >> 24) & 0xFF) * sizeof(float), cost);
 //	printf("Number of threads hint: %d\n", nu_threads);
-	void **user_data = (void **)malloc(sizeof(void *) * 5);
+	// When the group is waited for below, the parameter block can live on the stack.
+	// Otherwise (asynchronous or deferred groups) it outlives the call and has to be
+	// allocated, which is why these functions do not use dstParallelFor().
+	void *local_user_data[5];
+	dstTaskHandleState *async_state = dstGetAsyncTaskHandleState();
+	bool wait = (async_state == NULL && context->nu_tasks + 1 >= context->max_tasks);
+	void **user_data;
+	if (wait)
+		user_data = local_user_data;
+	else
+		user_data = (void **)malloc(sizeof(void *) * 5);
 	user_data[0] = (void *)f1;
 	user_data[1] = (void *)f2;
 	user_data[2] = dot;
@@ -151,23 +164,74 @@ const float * DST_RESTRICT f2, float * DST_RESTRICT dot) {
 	user_data[4] = (void *)(uint64_t)alignment_and_sizes;
 #define USE_TASK_GROUP
 #ifdef USE_TASK_GROUP
-	int group_index = dst_config.task_scheduler.AddSubdividedTaskGroup(0,
-		dstCalculateDotProductsThread, (void *)user_data, division);
-	dst_config.nu_tasks++;
-	if (dst_config.nu_tasks >= dst_config.max_tasks) {
-		// Wait for all tasks to finish.
-		dst_config.task_scheduler.WaitUntilGroupFinished(group_index);
-		dst_config.nu_tasks = 0;
+	if (async_state != NULL) {
+		// Attach the group to the asynchronous task handle of the calling thread.
+		context->task_scheduler->AddSubdividedTaskGroupAsync(async_state,
+			DST_TASK_FLAG_FREE_USER_DATA | context->GetTaskFlags(),
+			dstCalculateDotProductsThread,
+			(void *)user_data, division);
+		return;
+	}
+	// Otherwise, the parameter block is freed by the scheduler when the last
+	// subdivision has finished.
+	int group_index = context->task_scheduler->AddSubdividedTaskGroup(
+		(wait ? 0 : DST_TASK_FLAG_FREE_USER_DATA) | context->GetTaskFlags(),
+		dstCalculateDotProductsThread,
+		(void *)user_data, division);
+	if (wait) {
+		// Wait for this group and all earlier groups of the context to finish.
+		context->task_scheduler->WaitUntilGroupFinished(group_index);
+		context->Sync();
+	}
+	else {
+		context->pending_group_array.Add(group_index);
+		context->nu_tasks++;
 	}
 #else
 	for (int i = 0; i < nu_threads; i++) {
 		division.index = (uint32_t)i;
-		dst_config.task_scheduler.AddTask(0, dstCalculateDotProductsThread,
+		context->task_scheduler->AddTask(0, dstCalculateDotProductsThread,
 			(void *)user_data, division);
 	}
-	dst_config.task_scheduler.WaitUntilFinished();
-#endif
+	context->task_scheduler->WaitUntilFinished();
 	free(user_data);
+#endif
+}
+
+// Whether the threading cost model decides the number of threads of a call on n
+// elements. The duration of the call must be measurable, so the call has to be waited
+// for.
+
+static DST_INLINE_ONLY bool dstUseThreadingModel(int n) {
+	if (n < DST_THREADING_MODEL_MIN_SIZE)
+		return false;
+	dstContext *context = dstGetContext();
+	return (context->flags & (DST_FLAG_ADAPTIVE_THREADING | DST_FLAG_FIXED_NU_THREADS)) ==
+		DST_FLAG_ADAPTIVE_THREADING && context->max_tasks <= 1 &&
+		dstGetAsyncTaskHandleState() == NULL;
+}
+
+// Execute a dot product function with the number of threads chosen by the threading
+// cost model, and feed the measured duration back into the model.
+
+static bool dstDotProductFunctionAdaptive(const void (*dot_product_func)(
+int n, const float * DST_RESTRICT f1, const float * DST_RESTRICT f2,
+float * DST_RESTRICT dot), int cost, int alignment, int n, const float * DST_RESTRICT f1,
+const float * DST_RESTRICT f2, float * DST_RESTRICT dot) {
+	dstThreadingModelKernel *kernel = dst_threading_model.GetKernel(
+		(const void *)dot_product_func, cost);
+	if (kernel == NULL)
+		return false;
+	int candidate = kernel->ChooseCandidate(n, dstGetContext()->max_threads_per_function);
+	int nu_threads = dst_threading_model.candidate_nu_threads[candidate];
+	uint64_t start_time = dstGetCurrentTimeNSec();
+	if (nu_threads == 1)
+		dot_product_func(n, f1, f2, dot);
+	else
+		dstSubdivideDotProductFunction(nu_threads, dot_product_func, cost, alignment,
+			n, f1, f2, dot);
+	kernel->Update(n, candidate, dstGetCurrentTimeNSec() - start_time);
+	return true;
 }
 
 static DST_INLINE_ONLY bool dstDotProductFunctionMultiThreadCheck(const void (*dot_product_func)(
@@ -175,13 +239,22 @@ int n, const float * DST_RESTRICT f1, const float * DST_RESTRICT f2,
 float * DST_RESTRICT dot), int cost, int alignment, int n, const float * DST_RESTRICT f1,
 const float * DST_RESTRICT f2, float * DST_RESTRICT dot) {
 	if (dstCheckFlag(DST_FLAG_THREADING)) {
+		if (dstUseThreadingModel(n) && dstDotProductFunctionAdaptive(dot_product_func, cost,
+		alignment, n, f1, f2, dot))
+			return true;
 		int nu_threads = dstGetNumberOfThreadsHint(n, cost);
 		if (nu_threads > 1) {
-			dstSubdivideDotProductFunction(nu_threads, dot_product_func, alignment,
+			dstSubdivideDotProductFunction(nu_threads, dot_product_func, cost, alignment,
 				n, f1, f2, dot);
 			return true;
 		}
 	}
+	// In asynchronous mode, the work is always queued, even when it is not split up.
+	if (dstGetAsyncTaskHandleState() != NULL) {
+		dstSubdivideDotProductFunction(1, dot_product_func, cost, alignment, n, f1, f2,
+			dot);
+		return true;
+	}
 	return false;
 }
 
@@ -190,16 +263,797 @@ const float * DST_RESTRICT f2, float * DST_RESTRICT dot) {
 	if (r) \
 		return;
 
+// Functions that multiply a single matrix with an array of vectors have the same
+// signature as dot product functions, with the matrix taking the place of f1 (with
+// an element size of zero) and the result vectors taking the place of dot.
+
+#define MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(func, cost, alignment) \
+	bool r = dstDotProductFunctionMultiThreadCheck(func, cost, alignment, n, m, v, v_result); \
+	if (r) \
+		return;
+
+// Functions that process an array of matrices (such as batch inversion) pass NULL
+// in place of f2.
+
+#define MATRIX_FUNC_MULTI_THREAD_CHECK(func, cost, alignment) \
+	bool r = dstDotProductFunctionMultiThreadCheck(func, cost, alignment, n, m, NULL, \
+		m_result); \
+	if (r) \
+		return;
+
+// Functions that process arrays of the same length (such as quaternion multiplication)
+// pass the arrays explicitly.
+
+#define ARRAY_FUNC_MULTI_THREAD_CHECK(func, cost, alignment, f1, f2, f_result) \
+	bool r = dstDotProductFunctionMultiThreadCheck(func, cost, alignment, n, f1, f2, \
+		f_result); \
+	if (r) \
+		return;
+
 #else
 
 #define DOT_PRODUCT_FUNC_MULTI_THREAD_CHECK(func, cost, alignment)
+#define MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(func, cost, alignment)
+#define MATRIX_FUNC_MULTI_THREAD_CHECK(func, cost, alignment)
+#define ARRAY_FUNC_MULTI_THREAD_CHECK(func, cost, alignment, f1, f2, f_result)
 
 #endif
 
 // Create integer with information about alignment in terms of number of elements and
-// size of each element of f1 and f2 in terms of floats.
+// size of each element of f1, f2 and dot in terms of floats.
 #define ALIGNMENT_AND_SIZES(alignment, size_f1, size_f2) \
-	((uint32_t)alignment | ((uint32_t)size_f1 << 8) | ((uint32_t)size_f2 << 16))
+	((uint32_t)alignment | ((uint32_t)size_f1 << 8) | ((uint32_t)size_f2 << 16) | \
+	((uint32_t)1 << 24))
+
+// Similar, for matrix-vector functions (the matrix is constant, the source and result
+// vectors may differ in size).
+#define ALIGNMENT_AND_SIZES_MATRIX_VECTOR(alignment, size_v, size_result) \
+	((uint32_t)alignment | ((uint32_t)size_v << 16) | ((uint32_t)size_result << 24))
+
+// Similar, for functions that process an array of matrices, optionally with an
+// array of vectors of the same size as the result vectors (linear system solvers).
+#define ALIGNMENT_AND_SIZES_MATRIX(alignment, size_m, size_result) \
+	((uint32_t)alignment | ((uint32_t)size_m << 8) | ((uint32_t)size_result << 24))
+#define ALIGNMENT_AND_SIZES_MATRIX_SOLVE(alignment, size_m, size_v) \
+	((uint32_t)alignment | ((uint32_t)size_m << 8) | ((uint32_t)size_v << 16) | \
+	((uint32_t)size_v << 24))
+// Similar, with explicit sizes for all three arrays.
+#define ALIGNMENT_AND_SIZES_ARRAYS(alignment, size_f1, size_f2, size_result) \
+	((uint32_t)alignment | ((uint32_t)size_f1 << 8) | ((uint32_t)size_f2 << 16) | \
+	((uint32_t)size_result << 24))
+
+// Multiply a single matrix with an array of vectors. Alignment is four elements so that
+// every thread starts at a 16-byte aligned vector, also for packed three-float vectors.
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyVectors1xNM4x4CMV4(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNM4x4CMV4(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x4CMV4)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyVectors1xNM4x4CMV4, 96,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 4, 4));
+	dstInlineMatrixMultiplyVectors1xNM4x4CMV4(n, m, v, v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyVectors1xNM4x4CMP3P(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNM4x4CMP3P(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x4CMP3P)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyVectors1xNM4x4CMP3P, 96,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 4, 4));
+	dstInlineMatrixMultiplyVectors1xNM4x4CMP3P(n, m, v, v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyVectors1xNM4x4CMV3(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNM4x4CMV3(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x4CMV3)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyVectors1xNM4x4CMV3, 80,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 3, 3));
+	dstInlineMatrixMultiplyVectors1xNM4x4CMV3(n, m, v, v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyVectors1xNM4x4CMP3(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNM4x4CMP3(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x4CMP3)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyVectors1xNM4x4CMP3, 80,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 3, 3));
+	dstInlineMatrixMultiplyVectors1xNM4x4CMP3(n, m, v, v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyVectors1xNM4x3RMV3(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNM4x3RMV3(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x3RMV3)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyVectors1xNM4x3RMV3, 80,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 3, 3));
+	dstInlineMatrixMultiplyVectors1xNM4x3RMV3(n, m, v, v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyVectors1xNM4x3RMP3(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNM4x3RMP3(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x3RMP3)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyVectors1xNM4x3RMP3, 80,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 3, 3));
+	dstInlineMatrixMultiplyVectors1xNM4x3RMP3(n, m, v, v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyVectors1xNM4x3RMV3P(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNM4x3RMV3P(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x3RMV3P)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyVectors1xNM4x3RMV3P, 80,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 4, 4));
+	dstInlineMatrixMultiplyVectors1xNM4x3RMV3P(n, m, v, v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyVectors1xNM4x3RMP3P(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNM4x3RMP3P(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x3RMP3P)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyVectors1xNM4x3RMP3P, 80,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 4, 4));
+	dstInlineMatrixMultiplyVectors1xNM4x3RMP3P(n, m, v, v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyNormalizeVectors1xNM4x3RMV3(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyNormalizeVectors1xNM4x3RMV3(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyNormalizeVectors1xNM4x3RMV3)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyNormalizeVectors1xNM4x3RMV3,
+		112, ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 3, 3));
+	dstInlineMatrixMultiplyNormalizeVectors1xNM4x3RMV3(n, m, v, v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyNormalizeVectors1xNM4x3RMV3P(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyNormalizeVectors1xNM4x3RMV3P(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyNormalizeVectors1xNM4x3RMV3P)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyNormalizeVectors1xNM4x3RMV3P,
+		112, ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 4, 4));
+	dstInlineMatrixMultiplyNormalizeVectors1xNM4x3RMV3P(n, m, v, v_result);
+}
+
+// Transform arrays of 2D vectors and points. Alignment is four elements, which is
+// also the SoA block size.
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyVectors1xNM3x3CMV2(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNM3x3CMV2(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyVectors1xNM3x3CMV2)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyVectors1xNM3x3CMV2, 32,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 2, 2));
+	dstInlineMatrixMultiplyVectors1xNM3x3CMV2(n, m, v, v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyVectors1xNM3x3CMP2(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNM3x3CMP2(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyVectors1xNM3x3CMP2)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyVectors1xNM3x3CMP2, 32,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 2, 2));
+	dstInlineMatrixMultiplyVectors1xNM3x3CMP2(n, m, v, v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyVectors1xNM3x3CMV2SoA(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNM3x3CMV2SoA(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyVectors1xNM3x3CMV2SoA)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyVectors1xNM3x3CMV2SoA, 32,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 2, 2));
+	dstInlineMatrixMultiplyVectors1xNM3x3CMV2SoA(n, m, v, v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyVectors1xNM3x3CMP2SoA(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNM3x3CMP2SoA(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyVectors1xNM3x3CMP2SoA)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyVectors1xNM3x3CMP2SoA, 32,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 2, 2));
+	dstInlineMatrixMultiplyVectors1xNM3x3CMP2SoA(n, m, v, v_result);
+}
+
+// Transform arrays of double-precision points with a MatrixDouble4D. The element sizes
+// passed to the multi-threading check are expressed in floats; a PointDouble3D occupies
+// six.
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyVectors1xNMD4x4CMPD3(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNMD4x4CMPD3(n, (const double *)m, (const double *)v,
+		(double *)v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyVectors1xNMD4x4CMPD3)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyVectors1xNMD4x4CMPD3, 128,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(2, 6, 6));
+	dstInlineMatrixMultiplyVectors1xNMD4x4CMPD3(n, (const double *)m, (const double *)v,
+		(double *)v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyVectors1xNMD4x4CMPD3P3(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNMD4x4CMPD3P3(n, (const double *)m, (const double *)v,
+		v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyVectors1xNMD4x4CMPD3P3)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyVectors1xNMD4x4CMPD3P3, 128,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 6, 3));
+	dstInlineMatrixMultiplyVectors1xNMD4x4CMPD3P3(n, (const double *)m, (const double *)v,
+		v_result);
+}
+
+// Multiply arrays of matrices pairwise.
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyMatrices4x3RM(int n,
+const float * DST_RESTRICT m1, const float * DST_RESTRICT m2, float * DST_RESTRICT m_result) {
+	for (int i = 0; i < n; i++)
+		dstInlineMatrixMultiply4x3RM(&m1[i * 12], &m2[i * 12], &m_result[i * 12]);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyMatrices4x3RM(int n, const float * DST_RESTRICT m1,
+const float * DST_RESTRICT m2, float * DST_RESTRICT m_result) {
+	dstInlineMatrixMultiplyMatrices4x3RM(n, m1, m2, m_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyMatrices4x3RM)(int n, const float * DST_RESTRICT m1,
+const float * DST_RESTRICT m2, float * DST_RESTRICT m_result) {
+	ARRAY_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyMatrices4x3RM, 96,
+		ALIGNMENT_AND_SIZES_ARRAYS(1, 12, 12, 12), m1, m2, m_result);
+	dstInlineMatrixMultiplyMatrices4x3RM(n, m1, m2, m_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMatrixMultiplyMatrices3x3CM(int n, const float * DST_RESTRICT m1,
+const float * DST_RESTRICT m2, float * DST_RESTRICT m_result) {
+	dstInlineMatrixMultiplyMatrices3x3CM(n, m1, m2, m_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstMatrixMultiplyMatrices3x3CM)(int n, const float * DST_RESTRICT m1,
+const float * DST_RESTRICT m2, float * DST_RESTRICT m_result) {
+	ARRAY_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyMatrices3x3CM, 64,
+		ALIGNMENT_AND_SIZES_ARRAYS(1, 9, 9, 9), m1, m2, m_result);
+	dstInlineMatrixMultiplyMatrices3x3CM(n, m1, m2, m_result);
+}
+
+// Batch matrix inversion and linear system solvers. Alignment is four elements so
+// that every thread starts at a 16-byte aligned matrix.
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineInvertMatrices4x4CM(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT unused, float * DST_RESTRICT m_result) {
+	dstInlineInvertMatrices4x4CM(n, m, m_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstInvertMatrices4x4CM)(int n, const float * DST_RESTRICT m,
+float * DST_RESTRICT m_result) {
+	MATRIX_FUNC_MULTI_THREAD_CHECK(dstNonInlineInvertMatrices4x4CM, 400,
+		ALIGNMENT_AND_SIZES_MATRIX(4, 16, 16));
+	dstInlineInvertMatrices4x4CM(n, m, m_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineInvertMatrices3x3CM(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT unused, float * DST_RESTRICT m_result) {
+	dstInlineInvertMatrices3x3CM(n, m, m_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstInvertMatrices3x3CM)(int n, const float * DST_RESTRICT m,
+float * DST_RESTRICT m_result) {
+	MATRIX_FUNC_MULTI_THREAD_CHECK(dstNonInlineInvertMatrices3x3CM, 160,
+		ALIGNMENT_AND_SIZES_MATRIX(4, 9, 9));
+	dstInlineInvertMatrices3x3CM(n, m, m_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineInvertMatrices4x3RM(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT unused, float * DST_RESTRICT m_result) {
+	dstInlineInvertMatrices4x3RM(n, m, m_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstInvertMatrices4x3RM)(int n, const float * DST_RESTRICT m,
+float * DST_RESTRICT m_result) {
+	MATRIX_FUNC_MULTI_THREAD_CHECK(dstNonInlineInvertMatrices4x3RM, 200,
+		ALIGNMENT_AND_SIZES_MATRIX(4, 12, 12));
+	dstInlineInvertMatrices4x3RM(n, m, m_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineInvertRigidMatrices4x3RM(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT unused, float * DST_RESTRICT m_result) {
+	dstInlineInvertRigidMatrices4x3RM(n, m, m_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstInvertRigidMatrices4x3RM)(int n, const float * DST_RESTRICT m,
+float * DST_RESTRICT m_result) {
+	MATRIX_FUNC_MULTI_THREAD_CHECK(dstNonInlineInvertRigidMatrices4x3RM, 80,
+		ALIGNMENT_AND_SIZES_MATRIX(4, 12, 12));
+	dstInlineInvertRigidMatrices4x3RM(n, m, m_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineSolveLinearSystems3x3CMV3(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineSolveLinearSystems3x3CMV3(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstSolveLinearSystems3x3CMV3)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineSolveLinearSystems3x3CMV3, 200,
+		ALIGNMENT_AND_SIZES_MATRIX_SOLVE(4, 9, 3));
+	dstInlineSolveLinearSystems3x3CMV3(n, m, v, v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineSolveLinearSystems4x4CMV4(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineSolveLinearSystems4x4CMV4(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstSolveLinearSystems4x4CMV4)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineSolveLinearSystems4x4CMV4, 480,
+		ALIGNMENT_AND_SIZES_MATRIX_SOLVE(4, 16, 4));
+	dstInlineSolveLinearSystems4x4CMV4(n, m, v, v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineTransformAndProjectPointsP3(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineTransformAndProjectPointsP3(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstTransformAndProjectPointsP3)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineTransformAndProjectPointsP3, 40,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 3, 4));
+	dstInlineTransformAndProjectPointsP3(n, m, v, v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineTransformAndProjectPointsP3P(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineTransformAndProjectPointsP3P(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstTransformAndProjectPointsP3P)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineTransformAndProjectPointsP3P, 40,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 4, 4));
+	dstInlineTransformAndProjectPointsP3P(n, m, v, v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineTransformAndProjectPointsP3Int16(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineTransformAndProjectPointsP3Int16(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstTransformAndProjectPointsP3Int16)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineTransformAndProjectPointsP3Int16, 48,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 3, 2));
+	dstInlineTransformAndProjectPointsP3Int16(n, m, v, v_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineTransformAndProjectPointsP3PInt16(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineTransformAndProjectPointsP3PInt16(n, m, v, v_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstTransformAndProjectPointsP3PInt16)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	MATRIX_VECTOR_FUNC_MULTI_THREAD_CHECK(dstNonInlineTransformAndProjectPointsP3PInt16, 48,
+		ALIGNMENT_AND_SIZES_MATRIX_VECTOR(4, 4, 2));
+	dstInlineTransformAndProjectPointsP3PInt16(n, m, v, v_result);
+}
+
+// Quaternion functions.
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMultiplyQuaternionsQ(int n, const float * DST_RESTRICT f1,
+const float * DST_RESTRICT f2, float * DST_RESTRICT f_result) {
+	dstInlineMultiplyQuaternions(n, f1, f2, f_result, false);
+}
+
+#endif
+
+void SIMD_FUNC(dstMultiplyQuaternionsQ)(int n, const float * DST_RESTRICT q1,
+const float * DST_RESTRICT q2, float * DST_RESTRICT q_result) {
+	ARRAY_FUNC_MULTI_THREAD_CHECK(dstNonInlineMultiplyQuaternionsQ, 64,
+		ALIGNMENT_AND_SIZES_ARRAYS(4, 4, 4, 4), q1, q2, q_result);
+	dstInlineMultiplyQuaternions(n, q1, q2, q_result, false);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineMultiplyQuaternionsQSoA(int n, const float * DST_RESTRICT f1,
+const float * DST_RESTRICT f2, float * DST_RESTRICT f_result) {
+	dstInlineMultiplyQuaternions(n, f1, f2, f_result, true);
+}
+
+#endif
+
+void SIMD_FUNC(dstMultiplyQuaternionsQSoA)(int n, const float * DST_RESTRICT q1,
+const float * DST_RESTRICT q2, float * DST_RESTRICT q_result) {
+	ARRAY_FUNC_MULTI_THREAD_CHECK(dstNonInlineMultiplyQuaternionsQSoA, 64,
+		ALIGNMENT_AND_SIZES_ARRAYS(4, 4, 4, 4), q1, q2, q_result);
+	dstInlineMultiplyQuaternions(n, q1, q2, q_result, true);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineNormalizeQuaternionsQ(int n, const float * DST_RESTRICT f1,
+const float * DST_RESTRICT unused, float * DST_RESTRICT f_result) {
+	dstInlineNormalizeQuaternions(n, f1, f_result, false);
+}
+
+#endif
+
+void SIMD_FUNC(dstNormalizeQuaternionsQ)(int n, const float * DST_RESTRICT q,
+float * DST_RESTRICT q_result) {
+	ARRAY_FUNC_MULTI_THREAD_CHECK(dstNonInlineNormalizeQuaternionsQ, 48,
+		ALIGNMENT_AND_SIZES_ARRAYS(4, 4, 0, 4), q, NULL, q_result);
+	dstInlineNormalizeQuaternions(n, q, q_result, false);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineNormalizeQuaternionsQSoA(int n, const float * DST_RESTRICT f1,
+const float * DST_RESTRICT unused, float * DST_RESTRICT f_result) {
+	dstInlineNormalizeQuaternions(n, f1, f_result, true);
+}
+
+#endif
+
+void SIMD_FUNC(dstNormalizeQuaternionsQSoA)(int n, const float * DST_RESTRICT q,
+float * DST_RESTRICT q_result) {
+	ARRAY_FUNC_MULTI_THREAD_CHECK(dstNonInlineNormalizeQuaternionsQSoA, 48,
+		ALIGNMENT_AND_SIZES_ARRAYS(4, 4, 0, 4), q, NULL, q_result);
+	dstInlineNormalizeQuaternions(n, q, q_result, true);
+}
+
+// Interpolation functions take four arrays, which the multi-threading interface does not
+// support, so they always run in the calling thread.
+
+void SIMD_FUNC(dstNlerpQuaternionsQ)(int n, const float * DST_RESTRICT q1,
+const float * DST_RESTRICT q2, const float * DST_RESTRICT t, float * DST_RESTRICT q_result) {
+	dstInlineInterpolateQuaternions(n, q1, q2, t, q_result, false, false);
+}
+
+void SIMD_FUNC(dstNlerpQuaternionsQSoA)(int n, const float * DST_RESTRICT q1,
+const float * DST_RESTRICT q2, const float * DST_RESTRICT t, float * DST_RESTRICT q_result) {
+	dstInlineInterpolateQuaternions(n, q1, q2, t, q_result, true, false);
+}
+
+void SIMD_FUNC(dstSlerpQuaternionsQ)(int n, const float * DST_RESTRICT q1,
+const float * DST_RESTRICT q2, const float * DST_RESTRICT t, float * DST_RESTRICT q_result) {
+	dstInlineInterpolateQuaternions(n, q1, q2, t, q_result, false, true);
+}
+
+void SIMD_FUNC(dstSlerpQuaternionsQSoA)(int n, const float * DST_RESTRICT q1,
+const float * DST_RESTRICT q2, const float * DST_RESTRICT t, float * DST_RESTRICT q_result) {
+	dstInlineInterpolateQuaternions(n, q1, q2, t, q_result, true, true);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineRotateVectorsQV3(int n, const float * DST_RESTRICT f1,
+const float * DST_RESTRICT f2, float * DST_RESTRICT f_result) {
+	dstInlineRotateVectors(n, f1, f2, f_result, false);
+}
+
+#endif
+
+void SIMD_FUNC(dstRotateVectorsQV3)(int n, const float * DST_RESTRICT q,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	ARRAY_FUNC_MULTI_THREAD_CHECK(dstNonInlineRotateVectorsQV3, 80,
+		ALIGNMENT_AND_SIZES_ARRAYS(4, 4, 3, 3), q, v, v_result);
+	dstInlineRotateVectors(n, q, v, v_result, false);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineRotateVectorsQV3P(int n, const float * DST_RESTRICT f1,
+const float * DST_RESTRICT f2, float * DST_RESTRICT f_result) {
+	dstInlineRotateVectors(n, f1, f2, f_result, true);
+}
+
+#endif
+
+void SIMD_FUNC(dstRotateVectorsQV3P)(int n, const float * DST_RESTRICT q,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	ARRAY_FUNC_MULTI_THREAD_CHECK(dstNonInlineRotateVectorsQV3P, 72,
+		ALIGNMENT_AND_SIZES_ARRAYS(4, 4, 4, 4), q, v, v_result);
+	dstInlineRotateVectors(n, q, v, v_result, true);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineConvertQuaternionsToMatrices3x3CM(int n, const float * DST_RESTRICT f1,
+const float * DST_RESTRICT unused, float * DST_RESTRICT f_result) {
+	dstInlineConvertQuaternionsToMatrices3x3CM(n, f1, f_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstConvertQuaternionsToMatrices3x3CM)(int n, const float * DST_RESTRICT q,
+float * DST_RESTRICT m_result) {
+	ARRAY_FUNC_MULTI_THREAD_CHECK(dstNonInlineConvertQuaternionsToMatrices3x3CM, 72,
+		ALIGNMENT_AND_SIZES_ARRAYS(4, 4, 0, 9), q, NULL, m_result);
+	dstInlineConvertQuaternionsToMatrices3x3CM(n, q, m_result);
+}
+
+#ifdef DST_MULTI_THREADING
+
+static const void dstNonInlineConvertQuaternionsToMatrices4x3RM(int n, const float * DST_RESTRICT f1,
+const float * DST_RESTRICT unused, float * DST_RESTRICT f_result) {
+	dstInlineConvertQuaternionsToMatrices4x3RM(n, f1, f_result);
+}
+
+#endif
+
+void SIMD_FUNC(dstConvertQuaternionsToMatrices4x3RM)(int n, const float * DST_RESTRICT q,
+float * DST_RESTRICT m_result) {
+	ARRAY_FUNC_MULTI_THREAD_CHECK(dstNonInlineConvertQuaternionsToMatrices4x3RM, 64,
+		ALIGNMENT_AND_SIZES_ARRAYS(4, 4, 0, 12), q, NULL, m_result);
+	dstInlineConvertQuaternionsToMatrices4x3RM(n, q, m_result);
+}
+
+// Skinning and per-vertex matrix selection. These functions have separate position
+// and normal streams in addition to the per-vertex influence or index stream, so
+// they are subdivided over threads with a dedicated helper. The vertex streams have
+// four floats per element; v and v_result may be NULL.
+
+typedef void (*dstVertexMatrixFuncType)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT f, const float * DST_RESTRICT p, const float * DST_RESTRICT v,
+float * DST_RESTRICT p_result, float * DST_RESTRICT v_result);
+
+#ifdef DST_MULTI_THREADING
+
+static bool dstVertexMatrixFunctionMultiThreadCheck(dstVertexMatrixFuncType func, int cost,
+uint32_t size_f, int n, const float * DST_RESTRICT m, const float * DST_RESTRICT f,
+const float * DST_RESTRICT p, const float * DST_RESTRICT v, float * DST_RESTRICT p_result,
+float * DST_RESTRICT v_result) {
+	if (!dstCheckFlag(DST_FLAG_THREADING))
+		return false;
+	dstThreadingModelKernel *kernel = NULL;
+	int candidate = 0;
+	int nu_threads;
+	uint64_t start_time = 0;
+	if (dstUseThreadingModel(n))
+		kernel = dst_threading_model.GetKernel((const void *)func, cost);
+	if (kernel != NULL) {
+		candidate = kernel->ChooseCandidate(n, dstGetContext()->max_threads_per_function);
+		nu_threads = dst_threading_model.candidate_nu_threads[candidate];
+		start_time = dstGetCurrentTimeNSec();
+	}
+	else {
+		nu_threads = dstGetNumberOfThreadsHint(n, cost);
+		if (nu_threads <= 1)
+			return false;
+	}
+	if (nu_threads == 1)
+		func(n, m, f, p, v, p_result, v_result);
+	else
+		// Keep each subdivision a multiple of four vertices.
+		dstParallelFor(n, n / nu_threads, 4, [=](uint32_t start_index, uint32_t end_index) {
+			func(end_index - start_index, m, f + start_index * size_f, p + start_index * 4,
+				v == NULL ? NULL : v + start_index * 4, p_result + start_index * 4,
+				v == NULL ? NULL : v_result + start_index * 4);
+		});
+	if (kernel != NULL)
+		kernel->Update(n, candidate, dstGetCurrentTimeNSec() - start_time);
+	return true;
+}
+
+#define VERTEX_MATRIX_FUNC_MULTI_THREAD_CHECK(func, cost, size_f) \
+	bool r = dstVertexMatrixFunctionMultiThreadCheck(func, cost, size_f, n, m, f, p, v, \
+		p_result, v_result); \
+	if (r) \
+		return;
+
+static void dstNonInlineSkinVerticesM4x3RMP3P(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT f, const float * DST_RESTRICT p, const float * DST_RESTRICT v,
+float * DST_RESTRICT p_result, float * DST_RESTRICT v_result) {
+	if (v == NULL)
+		dstInlineSkinVerticesM4x3RMP3P(n, m, f, p, v, p_result, v_result, false);
+	else
+		dstInlineSkinVerticesM4x3RMP3P(n, m, f, p, v, p_result, v_result, true);
+}
+
+static void dstNonInlineMatrixMultiplyVerticesIndexedM4x3RMP3P(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT f, const float * DST_RESTRICT p,
+const float * DST_RESTRICT v, float * DST_RESTRICT p_result, float * DST_RESTRICT v_result) {
+	if (v == NULL)
+		dstInlineMatrixMultiplyVerticesIndexedM4x3RMP3P(n, m, f, p, v, p_result, v_result,
+			false);
+	else
+		dstInlineMatrixMultiplyVerticesIndexedM4x3RMP3P(n, m, f, p, v, p_result, v_result,
+			true);
+}
+
+#else
+
+#define VERTEX_MATRIX_FUNC_MULTI_THREAD_CHECK(func, cost, size_f)
+
+#endif
+
+// The influence stream has six floats per vertex.
+
+void SIMD_FUNC(dstSkinVerticesM4x3RMP3P)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT f, const float * DST_RESTRICT p, const float * DST_RESTRICT v,
+float * DST_RESTRICT p_result, float * DST_RESTRICT v_result) {
+	VERTEX_MATRIX_FUNC_MULTI_THREAD_CHECK(dstNonInlineSkinVerticesM4x3RMP3P,
+		v == NULL ? 192 : 320, 6);
+	if (v == NULL)
+		dstInlineSkinVerticesM4x3RMP3P(n, m, f, p, v, p_result, v_result, false);
+	else
+		dstInlineSkinVerticesM4x3RMP3P(n, m, f, p, v, p_result, v_result, true);
+}
+
+// The matrix index stream has one 32-bit integer per vertex.
+
+void SIMD_FUNC(dstMatrixMultiplyVerticesIndexedM4x3RMP3P)(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT f, const float * DST_RESTRICT p, const float * DST_RESTRICT v,
+float * DST_RESTRICT p_result, float * DST_RESTRICT v_result) {
+	VERTEX_MATRIX_FUNC_MULTI_THREAD_CHECK(dstNonInlineMatrixMultiplyVerticesIndexedM4x3RMP3P,
+		v == NULL ? 96 : 160, 1);
+	if (v == NULL)
+		dstInlineMatrixMultiplyVerticesIndexedM4x3RMP3P(n, m, f, p, v, p_result, v_result,
+			false);
+	else
+		dstInlineMatrixMultiplyVerticesIndexedM4x3RMP3P(n, m, f, p, v, p_result, v_result,
+			true);
+}
 
 // Dot products (NxN).
 
@@ -45,11 +45,55 @@ const dstSIMDFuncs SIMD_VAR(dst_simd_funcs_) = {
 	SIMD_FUNC(dstMatrixMultiply4x4CM),
 	SIMD_FUNC(dstMatrixMultiply4x3RM),
 	SIMD_FUNC(dstMatrixMultiply4x4CM4x3RM),
+	SIMD_FUNC(dstMatrixMultiplyMatrices4x3RM),
+	SIMD_FUNC(dstMatrixMultiply3x3CM),
+	SIMD_FUNC(dstMatrixMultiplyMatrices3x3CM),
 
 	SIMD_FUNC(dstMatrixMultiplyVectors1x4M4x4CMV4),
 	SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x4CMV4),
 	SIMD_FUNC(dstMatrixMultiplyVectors1x4M4x4CMP3P),
 	SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x4CMP3P),
-	dstMatrixMultiplyVectors1xNM4x4CMV3NoSIMD,
+	SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x4CMV3),
+	SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x4CMP3),
+	SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x3RMV3),
+	SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x3RMP3),
+	SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x3RMV3P),
+	SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x3RMP3P),
+	SIMD_FUNC(dstMatrixMultiplyVectors1xNM3x3CMV2),
+	SIMD_FUNC(dstMatrixMultiplyVectors1xNM3x3CMP2),
+	SIMD_FUNC(dstMatrixMultiplyVectors1xNM3x3CMV2SoA),
+	SIMD_FUNC(dstMatrixMultiplyVectors1xNM3x3CMP2SoA),
+	SIMD_FUNC(dstMatrixMultiplyVectors1xNMD4x4CMPD3),
+	SIMD_FUNC(dstMatrixMultiplyVectors1xNMD4x4CMPD3P3),
+	SIMD_FUNC(dstMatrixMultiplyNormalizeVectors1xNM4x3RMV3),
+	SIMD_FUNC(dstMatrixMultiplyNormalizeVectors1xNM4x3RMV3P),
+
+	SIMD_FUNC(dstInvertMatrices4x4CM),
+	SIMD_FUNC(dstInvertMatrices3x3CM),
+	SIMD_FUNC(dstInvertMatrices4x3RM),
+	SIMD_FUNC(dstInvertRigidMatrices4x3RM),
+	SIMD_FUNC(dstSolveLinearSystems3x3CMV3),
+	SIMD_FUNC(dstSolveLinearSystems4x4CMV4),
+
+	SIMD_FUNC(dstTransformAndProjectPointsP3),
+	SIMD_FUNC(dstTransformAndProjectPointsP3P),
+	SIMD_FUNC(dstTransformAndProjectPointsP3Int16),
+	SIMD_FUNC(dstTransformAndProjectPointsP3PInt16),
+
+	SIMD_FUNC(dstMultiplyQuaternionsQ),
+	SIMD_FUNC(dstMultiplyQuaternionsQSoA),
+	SIMD_FUNC(dstNormalizeQuaternionsQ),
+	SIMD_FUNC(dstNormalizeQuaternionsQSoA),
+	SIMD_FUNC(dstNlerpQuaternionsQ),
+	SIMD_FUNC(dstNlerpQuaternionsQSoA),
+	SIMD_FUNC(dstSlerpQuaternionsQ),
+	SIMD_FUNC(dstSlerpQuaternionsQSoA),
+	SIMD_FUNC(dstRotateVectorsQV3),
+	SIMD_FUNC(dstRotateVectorsQV3P),
+	SIMD_FUNC(dstConvertQuaternionsToMatrices3x3CM),
+	SIMD_FUNC(dstConvertQuaternionsToMatrices4x3RM),
+
+	SIMD_FUNC(dstSkinVerticesM4x3RMP3P),
+	SIMD_FUNC(dstMatrixMultiplyVerticesIndexedM4x3RMP3P),
 };
 
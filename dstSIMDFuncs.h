@@ -67,6 +67,11 @@ DST_API void dstGetIndicesWithMinAndMaxDotProductNx1V4NoSIMD(int nu_vertices, co
 DST_API void dstMatrixMultiply4x4CMNoSIMD(const float *f1, const float *f2, float *f3);
 DST_API void dstMatrixMultiply4x3RMNoSIMD(const float *f1, const float *f2, float *f3);
 DST_API void dstMatrixMultiply4x4CM4x3RMNoSIMD(const float *f1, const float *f2, float *f3);
+DST_API void dstMatrixMultiplyMatrices4x3RMNoSIMD(int n, const float *m1, const float *m2,
+	float *m_result);
+DST_API void dstMatrixMultiply3x3CMNoSIMD(const float *f1, const float *f2, float *f3);
+DST_API void dstMatrixMultiplyMatrices3x3CMNoSIMD(int n, const float *m1, const float *m2,
+	float *m_result);
 
 DST_API void dstMatrixMultiplyVectors1x4M4x4CMV4NoSIMD(const float *m, const float *v, float *v_result);
 DST_API void dstMatrixMultiplyVectors1xNM4x4CMV4NoSIMD(int n, const float *m, const float *v,
@@ -77,6 +82,79 @@ DST_API void dstMatrixMultiplyVectors1xNM4x4CMP3PNoSIMD(int n, const float *m, c
 	float *v_result);
 DST_API void dstMatrixMultiplyVectors1xNM4x4CMV3NoSIMD(int n, const float *m, const float *v,
 	float *v_result);
+DST_API void dstMatrixMultiplyVectors1xNM4x4CMP3NoSIMD(int n, const float *m, const float *v,
+	float *v_result);
+DST_API void dstMatrixMultiplyVectors1xNM4x3RMV3NoSIMD(int n, const float *m, const float *v,
+	float *v_result);
+DST_API void dstMatrixMultiplyVectors1xNM4x3RMP3NoSIMD(int n, const float *m, const float *v,
+	float *v_result);
+DST_API void dstMatrixMultiplyVectors1xNM4x3RMV3PNoSIMD(int n, const float *m, const float *v,
+	float *v_result);
+DST_API void dstMatrixMultiplyVectors1xNM4x3RMP3PNoSIMD(int n, const float *m, const float *v,
+	float *v_result);
+DST_API void dstMatrixMultiplyVectors1xNM3x3CMV2NoSIMD(int n, const float *m, const float *v,
+	float *v_result);
+DST_API void dstMatrixMultiplyVectors1xNM3x3CMP2NoSIMD(int n, const float *m, const float *v,
+	float *v_result);
+DST_API void dstMatrixMultiplyVectors1xNM3x3CMV2SoANoSIMD(int n, const float *m, const float *v,
+	float *v_result);
+DST_API void dstMatrixMultiplyVectors1xNM3x3CMP2SoANoSIMD(int n, const float *m, const float *v,
+	float *v_result);
+DST_API void dstMatrixMultiplyVectors1xNMD4x4CMPD3NoSIMD(int n, const float *m, const float *v,
+	float *v_result);
+DST_API void dstMatrixMultiplyVectors1xNMD4x4CMPD3P3NoSIMD(int n, const float *m, const float *v,
+	float *v_result);
+DST_API void dstMatrixMultiplyNormalizeVectors1xNM4x3RMV3NoSIMD(int n, const float *m,
+	const float *v, float *v_result);
+DST_API void dstMatrixMultiplyNormalizeVectors1xNM4x3RMV3PNoSIMD(int n, const float *m,
+	const float *v, float *v_result);
+
+DST_API void dstInvertMatrices4x4CMNoSIMD(int n, const float *m, float *m_result);
+DST_API void dstInvertMatrices3x3CMNoSIMD(int n, const float *m, float *m_result);
+DST_API void dstInvertMatrices4x3RMNoSIMD(int n, const float *m, float *m_result);
+DST_API void dstInvertRigidMatrices4x3RMNoSIMD(int n, const float *m, float *m_result);
+DST_API void dstSolveLinearSystems3x3CMV3NoSIMD(int n, const float *m, const float *v,
+	float *v_result);
+DST_API void dstSolveLinearSystems4x4CMV4NoSIMD(int n, const float *m, const float *v,
+	float *v_result);
+
+// Fused point projection (transform, perspective divide and viewport).
+
+DST_API void dstTransformAndProjectPointsP3NoSIMD(int n, const float *params, const float *v,
+	float *v_result);
+DST_API void dstTransformAndProjectPointsP3PNoSIMD(int n, const float *params, const float *v,
+	float *v_result);
+DST_API void dstTransformAndProjectPointsP3Int16NoSIMD(int n, const float *params, const float *v,
+	float *v_result);
+DST_API void dstTransformAndProjectPointsP3PInt16NoSIMD(int n, const float *params, const float *v,
+	float *v_result);
+
+// Quaternion functions.
+
+DST_API void dstMultiplyQuaternionsQNoSIMD(int n, const float *q1, const float *q2,
+	float *q_result);
+DST_API void dstMultiplyQuaternionsQSoANoSIMD(int n, const float *q1, const float *q2,
+	float *q_result);
+DST_API void dstNormalizeQuaternionsQNoSIMD(int n, const float *q, float *q_result);
+DST_API void dstNormalizeQuaternionsQSoANoSIMD(int n, const float *q, float *q_result);
+DST_API void dstNlerpQuaternionsQNoSIMD(int n, const float *q1, const float *q2,
+	const float *t, float *q_result);
+DST_API void dstNlerpQuaternionsQSoANoSIMD(int n, const float *q1, const float *q2,
+	const float *t, float *q_result);
+DST_API void dstSlerpQuaternionsQNoSIMD(int n, const float *q1, const float *q2,
+	const float *t, float *q_result);
+DST_API void dstSlerpQuaternionsQSoANoSIMD(int n, const float *q1, const float *q2,
+	const float *t, float *q_result);
+DST_API void dstRotateVectorsQV3NoSIMD(int n, const float *q, const float *v,
+	float *v_result);
+DST_API void dstRotateVectorsQV3PNoSIMD(int n, const float *q, const float *v,
+	float *v_result);
+DST_API void dstConvertQuaternionsToMatrices3x3CMNoSIMD(int n, const float *q, float *m_result);
+DST_API void dstConvertQuaternionsToMatrices4x3RMNoSIMD(int n, const float *q, float *m_result);
+DST_API void dstSkinVerticesM4x3RMP3PNoSIMD(int n, const float *m, const float *f,
+	const float *p, const float *v, float *p_result, float *v_result);
+DST_API void dstMatrixMultiplyVerticesIndexedM4x3RMP3PNoSIMD(int n, const float *m,
+	const float *f, const float *p, const float *v, float *p_result, float *v_result);
 
 // SIMD variant.
 
@@ -127,6 +205,11 @@ DST_API void SIMD_FUNC(dstGetIndicesWithMinAndMaxDotProductNx1V4)(int nu_vertice
 DST_API void SIMD_FUNC(dstMatrixMultiply4x4CM)(const float *f1, const float *f2, float *f3);
 DST_API void SIMD_FUNC(dstMatrixMultiply4x3RM)(const float *f1, const float *f2, float *f3);
 DST_API void SIMD_FUNC(dstMatrixMultiply4x4CM4x3RM)(const float *f1, const float *f2, float *f3);
+DST_API void SIMD_FUNC(dstMatrixMultiplyMatrices4x3RM)(int n, const float * DST_RESTRICT m1,
+	const float * DST_RESTRICT m2, float * DST_RESTRICT m_result);
+DST_API void SIMD_FUNC(dstMatrixMultiply3x3CM)(const float *f1, const float *f2, float *f3);
+DST_API void SIMD_FUNC(dstMatrixMultiplyMatrices3x3CM)(int n, const float * DST_RESTRICT m1,
+	const float * DST_RESTRICT m2, float * DST_RESTRICT m_result);
 
 DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1x4M4x4CMV4)(const float *m, const float *v,
 	float *v_result);
@@ -136,6 +219,95 @@ DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1x4M4x4CMP3P)(const float *m, con
 	float *v_result);
 DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x4CMP3P)(int n, const float *m, const float *v,
 	float *v_result);
-// dstMatrixMultiplyVectors1xNM4x4CMV3 not yet implemented.
+DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x4CMV3)(int n, const float * DST_RESTRICT m,
+	const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x4CMP3)(int n, const float * DST_RESTRICT m,
+	const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x3RMV3)(int n, const float * DST_RESTRICT m,
+	const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x3RMP3)(int n, const float * DST_RESTRICT m,
+	const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x3RMV3P)(int n, const float * DST_RESTRICT m,
+	const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x3RMP3P)(int n, const float * DST_RESTRICT m,
+	const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1xNM3x3CMV2)(int n, const float * DST_RESTRICT m,
+	const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1xNM3x3CMP2)(int n, const float * DST_RESTRICT m,
+	const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1xNM3x3CMV2SoA)(int n,
+	const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1xNM3x3CMP2SoA)(int n,
+	const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1xNMD4x4CMPD3)(int n,
+	const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1xNMD4x4CMPD3P3)(int n,
+	const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstMatrixMultiplyNormalizeVectors1xNM4x3RMV3)(int n,
+	const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstMatrixMultiplyNormalizeVectors1xNM4x3RMV3P)(int n,
+	const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+
+// Batch matrix inversion and linear system solvers.
+
+DST_API void SIMD_FUNC(dstInvertMatrices4x4CM)(int n, const float * DST_RESTRICT m,
+	float * DST_RESTRICT m_result);
+DST_API void SIMD_FUNC(dstInvertMatrices3x3CM)(int n, const float * DST_RESTRICT m,
+	float * DST_RESTRICT m_result);
+DST_API void SIMD_FUNC(dstInvertMatrices4x3RM)(int n, const float * DST_RESTRICT m,
+	float * DST_RESTRICT m_result);
+DST_API void SIMD_FUNC(dstInvertRigidMatrices4x3RM)(int n, const float * DST_RESTRICT m,
+	float * DST_RESTRICT m_result);
+DST_API void SIMD_FUNC(dstSolveLinearSystems3x3CMV3)(int n, const float * DST_RESTRICT m,
+	const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstSolveLinearSystems4x4CMV4)(int n, const float * DST_RESTRICT m,
+	const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+
+// Fused point projection (transform, perspective divide and viewport).
+
+DST_API void SIMD_FUNC(dstTransformAndProjectPointsP3)(int n, const float * DST_RESTRICT params,
+	const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstTransformAndProjectPointsP3P)(int n, const float * DST_RESTRICT params,
+	const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstTransformAndProjectPointsP3Int16)(int n, const float * DST_RESTRICT params,
+	const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstTransformAndProjectPointsP3PInt16)(int n, const float * DST_RESTRICT params,
+	const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+
+// Quaternion functions.
+
+DST_API void SIMD_FUNC(dstMultiplyQuaternionsQ)(int n, const float * DST_RESTRICT q1,
+	const float * DST_RESTRICT q2, float * DST_RESTRICT q_result);
+DST_API void SIMD_FUNC(dstMultiplyQuaternionsQSoA)(int n, const float * DST_RESTRICT q1,
+	const float * DST_RESTRICT q2, float * DST_RESTRICT q_result);
+DST_API void SIMD_FUNC(dstNormalizeQuaternionsQ)(int n, const float * DST_RESTRICT q,
+	float * DST_RESTRICT q_result);
+DST_API void SIMD_FUNC(dstNormalizeQuaternionsQSoA)(int n, const float * DST_RESTRICT q,
+	float * DST_RESTRICT q_result);
+DST_API void SIMD_FUNC(dstNlerpQuaternionsQ)(int n, const float * DST_RESTRICT q1,
+	const float * DST_RESTRICT q2, const float * DST_RESTRICT t, float * DST_RESTRICT q_result);
+DST_API void SIMD_FUNC(dstNlerpQuaternionsQSoA)(int n, const float * DST_RESTRICT q1,
+	const float * DST_RESTRICT q2, const float * DST_RESTRICT t, float * DST_RESTRICT q_result);
+DST_API void SIMD_FUNC(dstSlerpQuaternionsQ)(int n, const float * DST_RESTRICT q1,
+	const float * DST_RESTRICT q2, const float * DST_RESTRICT t, float * DST_RESTRICT q_result);
+DST_API void SIMD_FUNC(dstSlerpQuaternionsQSoA)(int n, const float * DST_RESTRICT q1,
+	const float * DST_RESTRICT q2, const float * DST_RESTRICT t, float * DST_RESTRICT q_result);
+DST_API void SIMD_FUNC(dstRotateVectorsQV3)(int n, const float * DST_RESTRICT q,
+	const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstRotateVectorsQV3P)(int n, const float * DST_RESTRICT q,
+	const float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstConvertQuaternionsToMatrices3x3CM)(int n, const float * DST_RESTRICT q,
+	float * DST_RESTRICT m_result);
+DST_API void SIMD_FUNC(dstConvertQuaternionsToMatrices4x3RM)(int n, const float * DST_RESTRICT q,
+	float * DST_RESTRICT m_result);
+
+// Skinning and per-vertex matrix selection.
+
+DST_API void SIMD_FUNC(dstSkinVerticesM4x3RMP3P)(int n, const float * DST_RESTRICT m,
+	const float * DST_RESTRICT f, const float * DST_RESTRICT p, const float * DST_RESTRICT v,
+	float * DST_RESTRICT p_result, float * DST_RESTRICT v_result);
+DST_API void SIMD_FUNC(dstMatrixMultiplyVerticesIndexedM4x3RMP3P)(int n,
+	const float * DST_RESTRICT m, const float * DST_RESTRICT f, const float * DST_RESTRICT p,
+	const float * DST_RESTRICT v, float * DST_RESTRICT p_result, float * DST_RESTRICT v_result);
 
 
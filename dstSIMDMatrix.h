@@ -19,8 +19,8 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #ifndef __DST_SIMD_MATRIX_H__
 #define __DST_SIMD_MATRIX_H__
 
-// This file is included by dstSIMD.h. When including that file directly, DST_SIMD_MODE
-// must be set to the SIMD type, which will be appended to exported function names.
+// This file only defines inline functions and requires dstSIMD.h to be included first.
+// The exported (non-inline) versions of the functions are declared in dstSIMDFuncs.h.
 
 // The following SIMD functions for matrix multiplication have been implemented.
 //
@@ -53,13 +53,15 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 //
 // The following class is for a 4x4 matrix and can be initialized with matrices
 // (float arrays) in both row-major or column-major format. It can subsequently be used to
-// multiply the matrix with one or more vertices.
+// multiply the matrix with one or more vertices. The matrix is held as columns, so that
+// vectors are multiplied with broadcast multiply-add operations; methods that process
+// four or eight vectors at once write the results in transposed form.
 //
 // class SIMDMatrix4x4;
 //
 // The following class is for a 4x3 matrix and can be initialized with matrices
 // (float arrays) in both row-major or column-major format. It requires
-// simd128_transpose4to3_float and simd_transpose3to4_float.
+// simd_transpose3to4_float.
 //
 // class SIMDMatrix4x3;
 //
@@ -77,9 +79,6 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 // SIMD 4x4 float matrix multiplication for matrices in column-major order.
 // Requires 16-byte alignment of the matrices.
 
-DST_API void SIMD_FUNC(dstMatrixMultiply4x4CM)(const float * DST_RESTRICT m1,
-const float * DST_RESTRICT m2, float * DST_RESTRICT m3);
-
 static DST_INLINE_ONLY void dstInlineMatrixMultiply4x4CM(const float * DST_RESTRICT m1,
 const float * DST_RESTRICT m2, float * DST_RESTRICT m3) {
     // m.n[column][row]
@@ -122,9 +121,6 @@ const float * DST_RESTRICT m2, float * DST_RESTRICT m3) {
 // Multiply 4x3 (3 rows, 4 columns) matrices in row-major order. The fourth
 // row is implicitly defined as (0.0f, 0.0f, 0.0f, 1.0f).
 
-void SIMD_FUNC(dstMatrixMultiply4x3RM)(const float * DST_RESTRICT m1,
-const float * DST_RESTRICT m2, float * DST_RESTRICT m3);
-
 static DST_INLINE_ONLY void dstInlineMatrixMultiply4x3RM(const float * DST_RESTRICT m1,
 const float * DST_RESTRICT m2, float * DST_RESTRICT m3) {
     __simd128_float row0 = simd128_load_float(&m2[0]);
@@ -155,9 +151,6 @@ const float * DST_RESTRICT m2, float * DST_RESTRICT m3) {
 // Multiply 4x4 (column-major) and 4x3 (4 rows, 3 rows, row-major order) matrices.
 // The fourth row of the 4x3 matrix is implicitly defined as (0.0f, 0.0f, 0.0f, 1.0f).
 
-DST_API void SIMD_FUNC(dstMatrixMultiplyVectors4x4CM4x3RM)(const float * DST_RESTRICT m1,
-const float * DST_RESTRICT m2, float * DST_RESTRICT m3);
-
 static DST_INLINE_ONLY void dstInlineMatrixMultiply4x4CM4x3RM(
 const float * DST_RESTRICT m1, const float * DST_RESTRICT m2, float * DST_RESTRICT m3) {
     __simd128_float col0 = simd128_load_float(&m1[0]);
@@ -198,13 +191,68 @@ const float * DST_RESTRICT m1, const float * DST_RESTRICT m2, float * DST_RESTRI
     simd128_store_float(&m3[3 * 4], result_col3);
 }
 
-// Multiply a single matrix with an array of vertices.
+// Multiply 3x3 matrices in column-major order (Matrix3D). The matrices are not
+// aligned and are accessed without reading or writing beyond the nine elements.
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiply3x3CM(const float * DST_RESTRICT m1,
+const float * DST_RESTRICT m2, float * DST_RESTRICT m3) {
+    __simd128_float col0_m1 = simd128_load3_float(&m1[0]);
+    __simd128_float col1_m1 = simd128_load3_float(&m1[3]);
+    __simd128_float col2_m1 = simd128_load3_float(&m1[6]);
+    for (int i = 0; i < 3; i++) {
+        __simd128_float result_col = simd128_add_float(
+            simd128_add_float(
+                simd128_mul_float(simd128_set_same_float(m2[i * 3]), col0_m1),
+                simd128_mul_float(simd128_set_same_float(m2[i * 3 + 1]), col1_m1)),
+            simd128_mul_float(simd128_set_same_float(m2[i * 3 + 2]), col2_m1));
+        simd128_store3_float(&m3[i * 3], result_col);
+    }
+}
 
-DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x4CMV4)(int n, const float * DST_RESTRICT m,
-float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyMatrices3x3CM(int n,
+const float * DST_RESTRICT m1, const float * DST_RESTRICT m2, float * DST_RESTRICT m_result) {
+    for (int i = 0; i < n; i++)
+        dstInlineMatrixMultiply3x3CM(&m1[i * 9], &m2[i * 9], &m_result[i * 9]);
+}
+
+// Multiply a 4x4 matrix (column-major) with a single four-component vector. Each
+// component of the vector is replicated and multiplied with the corresponding column,
+// so that no horizontal addition is required.
+
+static DST_INLINE_ONLY __simd128_float dstInlineMatrixMultiplyVector4x4CM(
+const float * DST_RESTRICT m, __simd128_float m_v) {
+    return simd128_add_float(
+        simd128_add_float(
+            simd128_mul_float(simd128_load_float(&m[0]), simd128_replicate_float(m_v, 0)),
+            simd128_mul_float(simd128_load_float(&m[4]), simd128_replicate_float(m_v, 1))),
+        simd128_add_float(
+            simd128_mul_float(simd128_load_float(&m[8]), simd128_replicate_float(m_v, 2)),
+            simd128_mul_float(simd128_load_float(&m[12]), simd128_replicate_float(m_v, 3)))
+        );
+}
+
+// Multiply a 4x3 matrix (row-major) with a single four-component vector. The fourth
+// row of the matrix is implicitly (0.0f, 0.0f, 0.0f, 1.0f), so that the fourth
+// component of the result is equal to the fourth component of the vector.
+
+static DST_INLINE_ONLY __simd128_float dstInlineMatrixMultiplyVector4x3RM(
+const float * DST_RESTRICT m, __simd128_float m_v) {
+    __simd128_float m_column0, m_column1, m_column2, m_column3;
+    simd128_transpose3to4_float(simd128_load_float(&m[0]), simd128_load_float(&m[4]),
+        simd128_load_float(&m[8]), m_column0, m_column1, m_column2, m_column3);
+    // The fourth component of each column is 0.0f, except for the last column.
+    m_column3 = simd128_set_last_float(m_column3, 1.0f);
+    return simd128_add_float(
+        simd128_add_float(
+            simd128_mul_float(m_column0, simd128_replicate_float(m_v, 0)),
+            simd128_mul_float(m_column1, simd128_replicate_float(m_v, 1))),
+        simd128_add_float(
+            simd128_mul_float(m_column2, simd128_replicate_float(m_v, 2)),
+            simd128_mul_float(m_column3, simd128_replicate_float(m_v, 3)))
+        );
+}
 
-DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1x4M4x4CMV4)(const float * DST_RESTRICT m,
-float * DST_RESTRICT v, float * DST_RESTRICT v_result);
+// Multiply a single matrix with an array of vertices.
 
 static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1x4M4x4CMV4(
 __simd128_float m_column0, __simd128_float m_column1, __simd128_float m_column2, __simd128_float m_column3,
@@ -295,27 +343,16 @@ const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT
 	for (; i + 3 < n; i += 4)
 		dstInlineMatrixMultiplyVectors1x4M4x4CMV4(m_column0, m_column1, m_column2, m_column3,
 			&v[i * 4], &v_result[i * 4]);
-	if (i < n) {
-                __simd128_float m_row0, m_row1, m_row2, m_row3;
-		simd128_transpose4to4_float(m_column0, m_column1, m_column2, m_column3,
-			m_row0, m_row1, m_row2, m_row3); 
-		for (; i < n; i++) {
-			__simd128_float m_v = simd128_load_float(&v[i * 4]);
-			__simd128_float m_result = simd128_multiply_matrix4x4_vector4(
-				m_row0, m_row1, m_row2, m_row3, m_v);
-			simd128_store_float(&v_result[i * 4], m_result);
-		}
+	for (; i < n; i++) {
+		__simd128_float m_v = simd128_load_float(&v[i * 4]);
+		__simd128_float m_result = simd128_multiply_matrix4x4CM_vector4(
+			m_column0, m_column1, m_column2, m_column3, m_v);
+		simd128_store_float(&v_result[i * 4], m_result);
 	}
 }
 
 // Multiply a 4x4 matrix with an array of points (Point3DPadded).
 
-DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1xNM4x4CMP3P)(int n, const float * DST_RESTRICT m,
-float * DST_RESTRICT v, float * DST_RESTRICT v_result);
-
-DST_API void SIMD_FUNC(dstMatrixMultiplyVectors1x4M4x4CMP3P)(const float * DST_RESTRICT m,
-float * DST_RESTRICT v, float * DST_RESTRICT v_result);
-
 static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1x4M4x4CMP3P(
 __simd128_float m_column0, __simd128_float m_column1, __simd128_float m_column2, __simd128_float m_column3,
 const float *v, __simd128_float& m_result_0, __simd128_float& m_result_1, __simd128_float& m_result_2,
@@ -407,60 +444,1595 @@ const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT
 	for (; i + 3 < n; i += 4)
 		dstInlineMatrixMultiplyVectors1x4M4x4CMP3P(m_column0, m_column1, m_column2, m_column3,
 			&v[i * 4], &v_result[i * 4]);
+	for (; i < n; i++) {
+		// Load the point vector and make sure the w component is 1.0f.
+		__simd128_float m_v = simd128_set_last_float(
+			simd128_load_float(&v[i * 4]), 1.0f);
+		__simd128_float m_result = simd128_multiply_matrix4x4CM_vector4(
+			m_column0, m_column1, m_column2, m_column3, m_v);
+		simd128_store_float(&v_result[i * 4], m_result);
+	}
+}
+
+// Multiply a matrix with arrays of three-float vectors or points. These functions
+// work with the first three rows of the matrix (row-major, with the translation
+// in the fourth component of each row), so that they can be used both with 4x4
+// column-major matrices (after transposition) and 4x3 row-major matrices. Only the
+// x, y and z coordinates of the result are calculated.
+//
+// For packed formats (Vector3D, Point3D), the source and destination arrays must be
+// 16-byte aligned. For padded formats (Vector3DPadded, Point3DPadded), every vector is
+// 16-byte aligned.
+
+// Calculate the transformed x, y and z coordinates of four vectors, given the
+// coordinates of the source vectors stored in transposed form (similar coordinates in
+// a single vector). When translate is true, the source vectors are regarded as points
+// with an implicit w component of 1.0f.
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectorsTransposed4x3(
+__simd128_float m_row0, __simd128_float m_row1, __simd128_float m_row2,
+__simd128_float m_v_x, __simd128_float m_v_y, __simd128_float m_v_z, const bool translate,
+__simd128_float& m_result_x, __simd128_float& m_result_y, __simd128_float& m_result_z) {
+    m_result_x = simd128_add_float(
+        simd128_mul_float(simd128_replicate_float(m_row0, 0), m_v_x),
+        simd128_add_float(
+            simd128_mul_float(simd128_replicate_float(m_row0, 1), m_v_y),
+            simd128_mul_float(simd128_replicate_float(m_row0, 2), m_v_z)));
+    m_result_y = simd128_add_float(
+        simd128_mul_float(simd128_replicate_float(m_row1, 0), m_v_x),
+        simd128_add_float(
+            simd128_mul_float(simd128_replicate_float(m_row1, 1), m_v_y),
+            simd128_mul_float(simd128_replicate_float(m_row1, 2), m_v_z)));
+    m_result_z = simd128_add_float(
+        simd128_mul_float(simd128_replicate_float(m_row2, 0), m_v_x),
+        simd128_add_float(
+            simd128_mul_float(simd128_replicate_float(m_row2, 1), m_v_y),
+            simd128_mul_float(simd128_replicate_float(m_row2, 2), m_v_z)));
+    if (translate) {
+        m_result_x = simd128_add_float(m_result_x, simd128_replicate_float(m_row0, 3));
+        m_result_y = simd128_add_float(m_result_y, simd128_replicate_float(m_row1, 3));
+        m_result_z = simd128_add_float(m_result_z, simd128_replicate_float(m_row2, 3));
+    }
+}
+
+// Multiply with a single vector, using the columns of the matrix. The first three
+// components of m_v are used; the fourth component of the result is undefined unless
+// the fourth component of each column is defined.
+
+static DST_INLINE_ONLY __simd128_float dstInlineMatrixMultiplyVectorColumns4x3(
+__simd128_float m_column0, __simd128_float m_column1, __simd128_float m_column2,
+__simd128_float m_column3, __simd128_float m_v, const bool translate) {
+    __simd128_float m_result = simd128_add_float(
+        simd128_mul_float(m_column0, simd128_replicate_float(m_v, 0)),
+        simd128_add_float(
+            simd128_mul_float(m_column1, simd128_replicate_float(m_v, 1)),
+            simd128_mul_float(m_column2, simd128_replicate_float(m_v, 2))));
+    if (translate)
+        m_result = simd128_add_float(m_result, m_column3);
+    return m_result;
+}
+
+// Packed three-float vectors (Vector3D or Point3D).
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1xNRowsV3(int n,
+__simd128_float m_row0, __simd128_float m_row1, __simd128_float m_row2, const bool translate,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	int i = 0;
+	for (; i + 3 < n; i += 4) {
+		// Load four packed vectors and transpose.
+		__simd128_float m_v_x, m_v_y, m_v_z;
+		simd128_unpack3to4_and_transpose4to3_float(
+			simd128_load_float(&v[i * 3]),
+			simd128_load_float(&v[i * 3 + 4]),
+			simd128_load_float(&v[i * 3 + 8]),
+			m_v_x, m_v_y, m_v_z);
+		__simd128_float m_result_x, m_result_y, m_result_z;
+		dstInlineMatrixMultiplyVectorsTransposed4x3(m_row0, m_row1, m_row2,
+			m_v_x, m_v_y, m_v_z, translate, m_result_x, m_result_y, m_result_z);
+		// Transpose back and store in packed format.
+		__simd128_float m_result_0, m_result_1, m_result_2;
+		simd128_transpose3to4_and_pack4to3_float(m_result_x, m_result_y, m_result_z,
+			m_result_0, m_result_1, m_result_2);
+		simd128_store_float(&v_result[i * 3], m_result_0);
+		simd128_store_float(&v_result[i * 3 + 4], m_result_1);
+		simd128_store_float(&v_result[i * 3 + 8], m_result_2);
+	}
+	if (i < n) {
+		__simd128_float m_column0, m_column1, m_column2, m_column3;
+		simd128_transpose3to4_float(m_row0, m_row1, m_row2,
+			m_column0, m_column1, m_column2, m_column3);
+		for (; i < n; i++) {
+			__simd128_float m_v = simd128_load3_float(&v[i * 3]);
+			__simd128_float m_result = dstInlineMatrixMultiplyVectorColumns4x3(
+				m_column0, m_column1, m_column2, m_column3, m_v, translate);
+			simd128_store3_float(&v_result[i * 3], m_result);
+		}
+	}
+}
+
+// Padded three-float vectors (Vector3DPadded or Point3DPadded). The w component
+// of the result is set to 0.0f for vectors and 1.0f for points.
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1xNRowsV3P(int n,
+__simd128_float m_row0, __simd128_float m_row1, __simd128_float m_row2, const bool translate,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	__simd128_float m_result_w = simd128_set_same_float(translate ? 1.0f : 0.0f);
+	int i = 0;
+	for (; i + 3 < n; i += 4) {
+		__simd128_float m_v_x = simd128_load_float(&v[i * 4]);
+		__simd128_float m_v_y = simd128_load_float(&v[i * 4 + 4]);
+		__simd128_float m_v_z = simd128_load_float(&v[i * 4 + 8]);
+		__simd128_float m_v_w = simd128_load_float(&v[i * 4 + 12]);
+		simd128_transpose4_float(m_v_x, m_v_y, m_v_z, m_v_w);
+		__simd128_float m_result_x, m_result_y, m_result_z;
+		dstInlineMatrixMultiplyVectorsTransposed4x3(m_row0, m_row1, m_row2,
+			m_v_x, m_v_y, m_v_z, translate, m_result_x, m_result_y, m_result_z);
+		__simd128_float m_result_0, m_result_1, m_result_2, m_result_3;
+		simd128_transpose4to4_float(m_result_x, m_result_y, m_result_z, m_result_w,
+			m_result_0, m_result_1, m_result_2, m_result_3);
+		simd128_store_float(&v_result[i * 4], m_result_0);
+		simd128_store_float(&v_result[i * 4 + 4], m_result_1);
+		simd128_store_float(&v_result[i * 4 + 8], m_result_2);
+		simd128_store_float(&v_result[i * 4 + 12], m_result_3);
+	}
 	if (i < n) {
-                __simd128_float m_row0, m_row1, m_row2, m_row3;
-		simd128_transpose4to4_float(m_column0, m_column1, m_column2, m_column3,
-			m_row0, m_row1, m_row2, m_row3); 
+		__simd128_float m_column0, m_column1, m_column2, m_column3;
+		simd128_transpose3to4_float(m_row0, m_row1, m_row2,
+			m_column0, m_column1, m_column2, m_column3);
 		for (; i < n; i++) {
-			// Load the point vector and make sure the w component is 1.0f.
-			__simd128_float m_v = simd128_set_last_float(
-				simd128_load_float(&v[i * 4]), 1.0f);
-			__simd128_float m_result = simd128_multiply_matrix4x4_vector4(
-				m_row0, m_row1, m_row2, m_row3, m_v);
+			__simd128_float m_v = simd128_load_float(&v[i * 4]);
+			// The fourth component of each column is 0.0f.
+			__simd128_float m_result = dstInlineMatrixMultiplyVectorColumns4x3(
+				m_column0, m_column1, m_column2, m_column3, m_v, translate);
+			if (translate)
+				m_result = simd128_set_last_float(m_result, 1.0f);
 			simd128_store_float(&v_result[i * 4], m_result);
 		}
 	}
 }
 
+// Multiply a 4x4 matrix (column-major) with an array of three-float vectors or points.
+
+static DST_INLINE_ONLY void dstInlineGetRowsMatrix4x4CM(const float * DST_RESTRICT m,
+__simd128_float& m_row0, __simd128_float& m_row1, __simd128_float& m_row2) {
+	__simd128_float m_row3;
+	simd128_transpose4to4_float(
+		simd128_load_float(&m[0]), simd128_load_float(&m[4]),
+		simd128_load_float(&m[8]), simd128_load_float(&m[12]),
+		m_row0, m_row1, m_row2, m_row3);
+}
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1xNM4x4CMV3(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	__simd128_float m_row0, m_row1, m_row2;
+	dstInlineGetRowsMatrix4x4CM(m, m_row0, m_row1, m_row2);
+	dstInlineMatrixMultiplyVectors1xNRowsV3(n, m_row0, m_row1, m_row2, false, v, v_result);
+}
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1xNM4x4CMP3(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	__simd128_float m_row0, m_row1, m_row2;
+	dstInlineGetRowsMatrix4x4CM(m, m_row0, m_row1, m_row2);
+	dstInlineMatrixMultiplyVectors1xNRowsV3(n, m_row0, m_row1, m_row2, true, v, v_result);
+}
+
+// Multiply a 4x3 matrix (row-major) with an array of three-float vectors or points.
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1xNM4x3RMV3(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNRowsV3(n, simd128_load_float(&m[0]),
+		simd128_load_float(&m[4]), simd128_load_float(&m[8]), false, v, v_result);
+}
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1xNM4x3RMP3(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNRowsV3(n, simd128_load_float(&m[0]),
+		simd128_load_float(&m[4]), simd128_load_float(&m[8]), true, v, v_result);
+}
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1xNM4x3RMV3P(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNRowsV3P(n, simd128_load_float(&m[0]),
+		simd128_load_float(&m[4]), simd128_load_float(&m[8]), false, v, v_result);
+}
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1xNM4x3RMP3P(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+	dstInlineMatrixMultiplyVectors1xNRowsV3P(n, simd128_load_float(&m[0]),
+		simd128_load_float(&m[4]), simd128_load_float(&m[8]), true, v, v_result);
+}
+
+// Batch matrix inversion and small linear system solvers.
+//
+// Four matrices are processed at a time in "transposed" form: every SIMD register
+// holds the same element of four different matrices, so that the cofactor
+// calculations are performed with vertical operations only. When n is not a multiple
+// of four, the remaining matrices are padded by repeating the last matrix.
+//
+// As with the scalar Inverse() functions, singular matrices are not detected and
+// result in infinite or NaN values.
+
+static DST_INLINE_ONLY __simd128_float dstInlineDeterminant2x2(__simd128_float m_a,
+__simd128_float m_b, __simd128_float m_c, __simd128_float m_d) {
+    return simd128_sub_float(simd128_mul_float(m_a, m_d), simd128_mul_float(m_b, m_c));
+}
+
+// Calculate x * p - y * q + z * r.
+
+static DST_INLINE_ONLY __simd128_float dstInlineCofactorSum3(
+__simd128_float m_x, __simd128_float m_p, __simd128_float m_y, __simd128_float m_q,
+__simd128_float m_z, __simd128_float m_r) {
+    return simd128_add_float(
+        simd128_sub_float(simd128_mul_float(m_x, m_p), simd128_mul_float(m_y, m_q)),
+        simd128_mul_float(m_z, m_r));
+}
+
+// Invert four 3x3 matrices in transposed form. m_a[i * 3 + j] contains the element at
+// row i, column j of each matrix; the inverse is written to m_b in the same format.
+
+static DST_INLINE_ONLY void dstInlineInvertMatricesTransposed3x3(const __simd128_float *m_a,
+__simd128_float *m_b) {
+    __simd128_float m_c00 = dstInlineDeterminant2x2(m_a[4], m_a[5], m_a[7], m_a[8]);
+    __simd128_float m_c01 = dstInlineDeterminant2x2(m_a[5], m_a[3], m_a[8], m_a[6]);
+    __simd128_float m_c02 = dstInlineDeterminant2x2(m_a[3], m_a[4], m_a[6], m_a[7]);
+    __simd128_float m_det = simd128_add_float(
+        simd128_add_float(simd128_mul_float(m_a[0], m_c00), simd128_mul_float(m_a[1], m_c01)),
+        simd128_mul_float(m_a[2], m_c02));
+    __simd128_float m_inv_det = simd128_div_float(simd128_set_same_float(1.0f), m_det);
+    m_b[0] = simd128_mul_float(m_c00, m_inv_det);
+    m_b[1] = simd128_mul_float(dstInlineDeterminant2x2(m_a[2], m_a[1], m_a[8], m_a[7]), m_inv_det);
+    m_b[2] = simd128_mul_float(dstInlineDeterminant2x2(m_a[1], m_a[2], m_a[4], m_a[5]), m_inv_det);
+    m_b[3] = simd128_mul_float(m_c01, m_inv_det);
+    m_b[4] = simd128_mul_float(dstInlineDeterminant2x2(m_a[0], m_a[2], m_a[6], m_a[8]), m_inv_det);
+    m_b[5] = simd128_mul_float(dstInlineDeterminant2x2(m_a[2], m_a[0], m_a[5], m_a[3]), m_inv_det);
+    m_b[6] = simd128_mul_float(m_c02, m_inv_det);
+    m_b[7] = simd128_mul_float(dstInlineDeterminant2x2(m_a[1], m_a[0], m_a[7], m_a[6]), m_inv_det);
+    m_b[8] = simd128_mul_float(dstInlineDeterminant2x2(m_a[0], m_a[1], m_a[3], m_a[4]), m_inv_det);
+}
+
+// Invert four 4x4 matrices in transposed form. m_a[i * 4 + j] contains the element at
+// row i, column j of each matrix. The inverse is calculated from the 2x2 sub-determinants
+// of the first two and last two rows.
+
+static DST_INLINE_ONLY void dstInlineInvertMatricesTransposed4x4(const __simd128_float *m_a,
+__simd128_float *m_b) {
+    __simd128_float m_s0 = dstInlineDeterminant2x2(m_a[0], m_a[1], m_a[4], m_a[5]);
+    __simd128_float m_s1 = dstInlineDeterminant2x2(m_a[0], m_a[2], m_a[4], m_a[6]);
+    __simd128_float m_s2 = dstInlineDeterminant2x2(m_a[0], m_a[3], m_a[4], m_a[7]);
+    __simd128_float m_s3 = dstInlineDeterminant2x2(m_a[1], m_a[2], m_a[5], m_a[6]);
+    __simd128_float m_s4 = dstInlineDeterminant2x2(m_a[1], m_a[3], m_a[5], m_a[7]);
+    __simd128_float m_s5 = dstInlineDeterminant2x2(m_a[2], m_a[3], m_a[6], m_a[7]);
+    __simd128_float m_c0 = dstInlineDeterminant2x2(m_a[8], m_a[9], m_a[12], m_a[13]);
+    __simd128_float m_c1 = dstInlineDeterminant2x2(m_a[8], m_a[10], m_a[12], m_a[14]);
+    __simd128_float m_c2 = dstInlineDeterminant2x2(m_a[8], m_a[11], m_a[12], m_a[15]);
+    __simd128_float m_c3 = dstInlineDeterminant2x2(m_a[9], m_a[10], m_a[13], m_a[14]);
+    __simd128_float m_c4 = dstInlineDeterminant2x2(m_a[9], m_a[11], m_a[13], m_a[15]);
+    __simd128_float m_c5 = dstInlineDeterminant2x2(m_a[10], m_a[11], m_a[14], m_a[15]);
+    // det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0
+    __simd128_float m_det = simd128_add_float(
+        dstInlineCofactorSum3(m_s0, m_c5, m_s1, m_c4, m_s2, m_c3),
+        dstInlineCofactorSum3(m_s3, m_c2, m_s4, m_c1, m_s5, m_c0));
+    __simd128_float m_inv_det = simd128_div_float(simd128_set_same_float(1.0f), m_det);
+    __simd128_float m_neg_inv_det = simd128_sub_float(simd128_set_zero_float(), m_inv_det);
+    m_b[0] = simd128_mul_float(dstInlineCofactorSum3(m_a[5], m_c5, m_a[6], m_c4, m_a[7], m_c3),
+        m_inv_det);
+    m_b[1] = simd128_mul_float(dstInlineCofactorSum3(m_a[1], m_c5, m_a[2], m_c4, m_a[3], m_c3),
+        m_neg_inv_det);
+    m_b[2] = simd128_mul_float(dstInlineCofactorSum3(m_a[13], m_s5, m_a[14], m_s4, m_a[15], m_s3),
+        m_inv_det);
+    m_b[3] = simd128_mul_float(dstInlineCofactorSum3(m_a[9], m_s5, m_a[10], m_s4, m_a[11], m_s3),
+        m_neg_inv_det);
+    m_b[4] = simd128_mul_float(dstInlineCofactorSum3(m_a[4], m_c5, m_a[6], m_c2, m_a[7], m_c1),
+        m_neg_inv_det);
+    m_b[5] = simd128_mul_float(dstInlineCofactorSum3(m_a[0], m_c5, m_a[2], m_c2, m_a[3], m_c1),
+        m_inv_det);
+    m_b[6] = simd128_mul_float(dstInlineCofactorSum3(m_a[12], m_s5, m_a[14], m_s2, m_a[15], m_s1),
+        m_neg_inv_det);
+    m_b[7] = simd128_mul_float(dstInlineCofactorSum3(m_a[8], m_s5, m_a[10], m_s2, m_a[11], m_s1),
+        m_inv_det);
+    m_b[8] = simd128_mul_float(dstInlineCofactorSum3(m_a[4], m_c4, m_a[5], m_c2, m_a[7], m_c0),
+        m_inv_det);
+    m_b[9] = simd128_mul_float(dstInlineCofactorSum3(m_a[0], m_c4, m_a[1], m_c2, m_a[3], m_c0),
+        m_neg_inv_det);
+    m_b[10] = simd128_mul_float(dstInlineCofactorSum3(m_a[12], m_s4, m_a[13], m_s2, m_a[15], m_s0),
+        m_inv_det);
+    m_b[11] = simd128_mul_float(dstInlineCofactorSum3(m_a[8], m_s4, m_a[9], m_s2, m_a[11], m_s0),
+        m_neg_inv_det);
+    m_b[12] = simd128_mul_float(dstInlineCofactorSum3(m_a[4], m_c3, m_a[5], m_c1, m_a[6], m_c0),
+        m_neg_inv_det);
+    m_b[13] = simd128_mul_float(dstInlineCofactorSum3(m_a[0], m_c3, m_a[1], m_c1, m_a[2], m_c0),
+        m_inv_det);
+    m_b[14] = simd128_mul_float(dstInlineCofactorSum3(m_a[12], m_s3, m_a[13], m_s1, m_a[14], m_s0),
+        m_neg_inv_det);
+    m_b[15] = simd128_mul_float(dstInlineCofactorSum3(m_a[8], m_s3, m_a[9], m_s1, m_a[10], m_s0),
+        m_inv_det);
+}
+
+// Gather element i of up to four consecutive matrices of the given size (in floats).
+// When less than four matrices are available, the last one is repeated.
+
+static DST_INLINE_ONLY __simd128_float dstInlineGatherMatrixElement(int nu_matrices, int size,
+const float * DST_RESTRICT m, int i) {
+    int j1 = nu_matrices > 1 ? size : 0;
+    int j2 = nu_matrices > 2 ? size * 2 : j1;
+    int j3 = nu_matrices > 3 ? size * 3 : j2;
+    return simd128_set_float(m[i], m[j1 + i], m[j2 + i], m[j3 + i]);
+}
+
+static DST_INLINE_ONLY void dstInlineScatterMatrixElement(int nu_matrices, int size,
+__simd128_float m_v, float * DST_RESTRICT m, int i) {
+    float f[4] DST_ALIGNED(16);
+    simd128_store_float(f, m_v);
+    for (int j = 0; j < nu_matrices; j++)
+        m[j * size + i] = f[j];
+}
+
+// Copy up to four matrices to a temporary 16-byte aligned buffer, repeating the last
+// matrix when less than four are available.
+
+static DST_INLINE_ONLY void dstInlineCopyMatricesPadded(int nu_matrices, int size,
+const float * DST_RESTRICT m, float * DST_RESTRICT m_copy) {
+    for (int j = 0; j < 4; j++) {
+        const float *m_source = &m[(j < nu_matrices ? j : nu_matrices - 1) * size];
+        for (int i = 0; i < size; i++)
+            m_copy[j * size + i] = m_source[i];
+    }
+}
+
+// Load four 4x4 matrices (column-major, 16-byte aligned) in transposed form.
+
+static DST_INLINE_ONLY void dstInlineLoadMatricesTransposed4x4CM(const float * DST_RESTRICT m,
+__simd128_float *m_a) {
+    for (int j = 0; j < 4; j++) {
+        __simd128_float m_col0 = simd128_load_float(&m[j * 4]);
+        __simd128_float m_col1 = simd128_load_float(&m[16 + j * 4]);
+        __simd128_float m_col2 = simd128_load_float(&m[32 + j * 4]);
+        __simd128_float m_col3 = simd128_load_float(&m[48 + j * 4]);
+        simd128_transpose4_float(m_col0, m_col1, m_col2, m_col3);
+        m_a[j] = m_col0;
+        m_a[4 + j] = m_col1;
+        m_a[8 + j] = m_col2;
+        m_a[12 + j] = m_col3;
+    }
+}
+
+static DST_INLINE_ONLY void dstInlineStoreMatricesTransposed4x4CM(const __simd128_float *m_b,
+float * DST_RESTRICT m) {
+    for (int j = 0; j < 4; j++) {
+        __simd128_float m_col0 = m_b[j];
+        __simd128_float m_col1 = m_b[4 + j];
+        __simd128_float m_col2 = m_b[8 + j];
+        __simd128_float m_col3 = m_b[12 + j];
+        simd128_transpose4_float(m_col0, m_col1, m_col2, m_col3);
+        simd128_store_float(&m[j * 4], m_col0);
+        simd128_store_float(&m[16 + j * 4], m_col1);
+        simd128_store_float(&m[32 + j * 4], m_col2);
+        simd128_store_float(&m[48 + j * 4], m_col3);
+    }
+}
+
+// Invert an array of 4x4 matrices (column-major). The matrices must be 16-byte aligned.
+
+static DST_INLINE_ONLY void dstInlineInvertFourMatrices4x4CM(const float * DST_RESTRICT m,
+float * DST_RESTRICT m_result) {
+    __simd128_float m_a[16], m_b[16];
+    dstInlineLoadMatricesTransposed4x4CM(m, m_a);
+    dstInlineInvertMatricesTransposed4x4(m_a, m_b);
+    dstInlineStoreMatricesTransposed4x4CM(m_b, m_result);
+}
+
+static DST_INLINE_ONLY void dstInlineInvertMatrices4x4CM(int n, const float * DST_RESTRICT m,
+float * DST_RESTRICT m_result) {
+    int i = 0;
+    for (; i + 3 < n; i += 4)
+        dstInlineInvertFourMatrices4x4CM(&m[i * 16], &m_result[i * 16]);
+    if (i < n) {
+        float m_copy[64] DST_ALIGNED(16);
+        float m_copy_result[64] DST_ALIGNED(16);
+        dstInlineCopyMatricesPadded(n - i, 16, &m[i * 16], m_copy);
+        dstInlineInvertFourMatrices4x4CM(m_copy, m_copy_result);
+        for (int j = 0; j < (n - i) * 16; j++)
+            m_result[i * 16 + j] = m_copy_result[j];
+    }
+}
+
+// Invert an array of 3x3 matrices (column-major). Because of the size of a 3x3 matrix,
+// no alignment is required; elements are gathered and scattered individually.
+
+static DST_INLINE_ONLY void dstInlineInvertMatrices3x3CM(int n, const float * DST_RESTRICT m,
+float * DST_RESTRICT m_result) {
+    for (int i = 0; i < n; i += 4) {
+        int nu_matrices = n - i < 4 ? n - i : 4;
+        __simd128_float m_a[9], m_b[9];
+        // Element (row r, column c) is stored at c * 3 + r.
+        for (int r = 0; r < 3; r++)
+            for (int c = 0; c < 3; c++)
+                m_a[r * 3 + c] = dstInlineGatherMatrixElement(nu_matrices, 9, &m[i * 9],
+                    c * 3 + r);
+        dstInlineInvertMatricesTransposed3x3(m_a, m_b);
+        for (int r = 0; r < 3; r++)
+            for (int c = 0; c < 3; c++)
+                dstInlineScatterMatrixElement(nu_matrices, 9, m_b[r * 3 + c], &m_result[i * 9],
+                    c * 3 + r);
+    }
+}
+
+// Invert an array of 4x3 matrices (row-major) representing general affine
+// transformations. The 3x3 part is inverted and the translation becomes
+// -inverse(A) * t. The matrices must be 16-byte aligned.
+
+static DST_INLINE_ONLY void dstInlineInvertFourMatrices4x3RM(const float * DST_RESTRICT m,
+float * DST_RESTRICT m_result) {
+    __simd128_float m_a[9], m_b[9], m_t[3];
+    for (int r = 0; r < 3; r++) {
+        __simd128_float m_row0 = simd128_load_float(&m[r * 4]);
+        __simd128_float m_row1 = simd128_load_float(&m[12 + r * 4]);
+        __simd128_float m_row2 = simd128_load_float(&m[24 + r * 4]);
+        __simd128_float m_row3 = simd128_load_float(&m[36 + r * 4]);
+        simd128_transpose4_float(m_row0, m_row1, m_row2, m_row3);
+        m_a[r * 3] = m_row0;
+        m_a[r * 3 + 1] = m_row1;
+        m_a[r * 3 + 2] = m_row2;
+        m_t[r] = m_row3;
+    }
+    dstInlineInvertMatricesTransposed3x3(m_a, m_b);
+    for (int r = 0; r < 3; r++) {
+        __simd128_float m_row0 = m_b[r * 3];
+        __simd128_float m_row1 = m_b[r * 3 + 1];
+        __simd128_float m_row2 = m_b[r * 3 + 2];
+        __simd128_float m_row3 = simd128_sub_float(simd128_set_zero_float(),
+            simd128_add_float(
+                simd128_add_float(simd128_mul_float(m_row0, m_t[0]),
+                    simd128_mul_float(m_row1, m_t[1])),
+                simd128_mul_float(m_row2, m_t[2])));
+        simd128_transpose4_float(m_row0, m_row1, m_row2, m_row3);
+        simd128_store_float(&m_result[r * 4], m_row0);
+        simd128_store_float(&m_result[12 + r * 4], m_row1);
+        simd128_store_float(&m_result[24 + r * 4], m_row2);
+        simd128_store_float(&m_result[36 + r * 4], m_row3);
+    }
+}
+
+static DST_INLINE_ONLY void dstInlineInvertMatrices4x3RM(int n, const float * DST_RESTRICT m,
+float * DST_RESTRICT m_result) {
+    int i = 0;
+    for (; i + 3 < n; i += 4)
+        dstInlineInvertFourMatrices4x3RM(&m[i * 12], &m_result[i * 12]);
+    if (i < n) {
+        float m_copy[48] DST_ALIGNED(16);
+        float m_copy_result[48] DST_ALIGNED(16);
+        dstInlineCopyMatricesPadded(n - i, 12, &m[i * 12], m_copy);
+        dstInlineInvertFourMatrices4x3RM(m_copy, m_copy_result);
+        for (int j = 0; j < (n - i) * 12; j++)
+            m_result[i * 12 + j] = m_copy_result[j];
+    }
+}
+
+// Invert an array of 4x3 matrices (row-major) representing rigid transformations
+// (rotation and translation only). The inverse rotation is the transpose, and the
+// translation becomes -transpose(R) * t. The matrices must be 16-byte aligned.
+
+static DST_INLINE_ONLY void dstInlineInvertRigidMatrices4x3RM(int n, const float * DST_RESTRICT m,
+float * DST_RESTRICT m_result) {
+    for (int i = 0; i < n; i++) {
+        __simd128_float m_row0 = simd128_load_float(&m[i * 12]);
+        __simd128_float m_row1 = simd128_load_float(&m[i * 12 + 4]);
+        __simd128_float m_row2 = simd128_load_float(&m[i * 12 + 8]);
+        __simd128_float m_column0, m_column1, m_column2, m_t;
+        simd128_transpose3to4_float(m_row0, m_row1, m_row2,
+            m_column0, m_column1, m_column2, m_t);
+        // The fourth component of each row is ignored by the final transpose.
+        __simd128_float m_t_inv = simd128_sub_float(simd128_set_zero_float(),
+            simd128_add_float(
+                simd128_add_float(
+                    simd128_mul_float(m_row0, simd128_replicate_float(m_t, 0)),
+                    simd128_mul_float(m_row1, simd128_replicate_float(m_t, 1))),
+                simd128_mul_float(m_row2, simd128_replicate_float(m_t, 2))));
+        __simd128_float m_result_row0, m_result_row1, m_result_row2;
+        simd128_transpose4to3_float(m_row0, m_row1, m_row2, m_t_inv,
+            m_result_row0, m_result_row1, m_result_row2);
+        simd128_store_float(&m_result[i * 12], m_result_row0);
+        simd128_store_float(&m_result[i * 12 + 4], m_result_row1);
+        simd128_store_float(&m_result[i * 12 + 8], m_result_row2);
+    }
+}
+
+// Solve an array of 3x3 linear systems m * x = v, with m a 3x3 matrix (column-major)
+// and v and x three-float vectors. No alignment is required.
+
+static DST_INLINE_ONLY void dstInlineSolveLinearSystems3x3CMV3(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+    for (int i = 0; i < n; i += 4) {
+        int nu_matrices = n - i < 4 ? n - i : 4;
+        __simd128_float m_a[9], m_b[9], m_v[3];
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 3; c++)
+                m_a[r * 3 + c] = dstInlineGatherMatrixElement(nu_matrices, 9, &m[i * 9],
+                    c * 3 + r);
+            m_v[r] = dstInlineGatherMatrixElement(nu_matrices, 3, &v[i * 3], r);
+        }
+        dstInlineInvertMatricesTransposed3x3(m_a, m_b);
+        for (int r = 0; r < 3; r++) {
+            __simd128_float m_x = simd128_add_float(
+                simd128_add_float(simd128_mul_float(m_b[r * 3], m_v[0]),
+                    simd128_mul_float(m_b[r * 3 + 1], m_v[1])),
+                simd128_mul_float(m_b[r * 3 + 2], m_v[2]));
+            dstInlineScatterMatrixElement(nu_matrices, 3, m_x, &v_result[i * 3], r);
+        }
+    }
+}
+
+// Solve an array of 4x4 linear systems m * x = v, with m a 4x4 matrix (column-major)
+// and v and x four-float vectors. The matrices and vectors must be 16-byte aligned.
+
+static DST_INLINE_ONLY void dstInlineSolveFourLinearSystems4x4CMV4(const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+    __simd128_float m_a[16], m_b[16];
+    dstInlineLoadMatricesTransposed4x4CM(m, m_a);
+    dstInlineInvertMatricesTransposed4x4(m_a, m_b);
+    __simd128_float m_v0 = simd128_load_float(&v[0]);
+    __simd128_float m_v1 = simd128_load_float(&v[4]);
+    __simd128_float m_v2 = simd128_load_float(&v[8]);
+    __simd128_float m_v3 = simd128_load_float(&v[12]);
+    simd128_transpose4_float(m_v0, m_v1, m_v2, m_v3);
+    __simd128_float m_x[4];
+    for (int r = 0; r < 4; r++)
+        m_x[r] = simd128_add_float(
+            simd128_add_float(simd128_mul_float(m_b[r * 4], m_v0),
+                simd128_mul_float(m_b[r * 4 + 1], m_v1)),
+            simd128_add_float(simd128_mul_float(m_b[r * 4 + 2], m_v2),
+                simd128_mul_float(m_b[r * 4 + 3], m_v3)));
+    simd128_transpose4_float(m_x[0], m_x[1], m_x[2], m_x[3]);
+    simd128_store_float(&v_result[0], m_x[0]);
+    simd128_store_float(&v_result[4], m_x[1]);
+    simd128_store_float(&v_result[8], m_x[2]);
+    simd128_store_float(&v_result[12], m_x[3]);
+}
+
+static DST_INLINE_ONLY void dstInlineSolveLinearSystems4x4CMV4(int n, const float * DST_RESTRICT m,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+    int i = 0;
+    for (; i + 3 < n; i += 4)
+        dstInlineSolveFourLinearSystems4x4CMV4(&m[i * 16], &v[i * 4], &v_result[i * 4]);
+    if (i < n) {
+        float m_copy[64] DST_ALIGNED(16);
+        float v_copy[16] DST_ALIGNED(16);
+        float v_copy_result[16] DST_ALIGNED(16);
+        dstInlineCopyMatricesPadded(n - i, 16, &m[i * 16], m_copy);
+        dstInlineCopyMatricesPadded(n - i, 4, &v[i * 4], v_copy);
+        dstInlineSolveFourLinearSystems4x4CMV4(m_copy, v_copy, v_copy_result);
+        for (int j = 0; j < (n - i) * 4; j++)
+            v_result[i * 4 + j] = v_copy_result[j];
+    }
+}
+
+// Transform points with a 4x4 projection matrix (column-major), calculate clip flags,
+// perform the perspective divide and apply the viewport transformation in a single
+// pass. The parameter array has the layout of dstProjectionViewport (the 16 matrix
+// elements followed by the four-float viewport scale and offset vectors).
+
+// Calculate screen coordinates and clip flags of four points stored in transposed form.
+
+static DST_INLINE_ONLY void dstInlineProjectPointsTransposed(const __simd128_float *m_row,
+__simd128_float m_scale, __simd128_float m_offset,
+__simd128_float m_v_x, __simd128_float m_v_y, __simd128_float m_v_z,
+__simd128_float& m_screen_x, __simd128_float& m_screen_y, __simd128_float& m_screen_z,
+__simd128_int& m_flags) {
+    __simd128_float m_clip_x, m_clip_y, m_clip_z;
+    dstInlineMatrixMultiplyVectorsTransposed4x3(m_row[0], m_row[1], m_row[2],
+        m_v_x, m_v_y, m_v_z, true, m_clip_x, m_clip_y, m_clip_z);
+    __simd128_float m_clip_w = simd128_add_float(
+        simd128_add_float(
+            simd128_mul_float(simd128_replicate_float(m_row[3], 0), m_v_x),
+            simd128_mul_float(simd128_replicate_float(m_row[3], 1), m_v_y)),
+        simd128_add_float(
+            simd128_mul_float(simd128_replicate_float(m_row[3], 2), m_v_z),
+            simd128_replicate_float(m_row[3], 3)));
+    // Determine the clip flags (-w <= x, y, z <= w is inside).
+    __simd128_float m_clip_neg_w = simd128_sub_float(simd128_set_zero_float(), m_clip_w);
+    m_flags = simd128_or_int(
+        simd128_or_int(
+            simd128_and_int(simd128_cmplt_float(m_clip_x, m_clip_neg_w),
+                simd128_set_same_int32(DST_CLIP_LEFT)),
+            simd128_and_int(simd128_cmpgt_float(m_clip_x, m_clip_w),
+                simd128_set_same_int32(DST_CLIP_RIGHT))),
+        simd128_or_int(
+            simd128_and_int(simd128_cmplt_float(m_clip_y, m_clip_neg_w),
+                simd128_set_same_int32(DST_CLIP_BOTTOM)),
+            simd128_and_int(simd128_cmpgt_float(m_clip_y, m_clip_w),
+                simd128_set_same_int32(DST_CLIP_TOP))));
+    m_flags = simd128_or_int(m_flags, simd128_or_int(
+        simd128_and_int(simd128_cmplt_float(m_clip_z, m_clip_neg_w),
+            simd128_set_same_int32(DST_CLIP_NEAR)),
+        simd128_and_int(simd128_cmpgt_float(m_clip_z, m_clip_w),
+            simd128_set_same_int32(DST_CLIP_FAR))));
+    // Approximate reciprocal of w, refined with one Newton-Raphson iteration
+    // (r' = r * (2 - w * r)).
+    __simd128_float m_recip_w = simd128_approximate_reciprocal_float(m_clip_w);
+    m_recip_w = simd128_sub_float(simd128_add_float(m_recip_w, m_recip_w),
+        simd128_mul_float(m_clip_w, simd128_mul_float(m_recip_w, m_recip_w)));
+    m_screen_x = simd128_add_float(simd128_mul_float(simd128_mul_float(m_clip_x, m_recip_w),
+        simd128_replicate_float(m_scale, 0)), simd128_replicate_float(m_offset, 0));
+    m_screen_y = simd128_add_float(simd128_mul_float(simd128_mul_float(m_clip_y, m_recip_w),
+        simd128_replicate_float(m_scale, 1)), simd128_replicate_float(m_offset, 1));
+    m_screen_z = simd128_add_float(simd128_mul_float(simd128_mul_float(m_clip_z, m_recip_w),
+        simd128_replicate_float(m_scale, 2)), simd128_replicate_float(m_offset, 2));
+}
+
+// Store four projected vertices as dstScreenVertexInt16 (32 bytes, 16-byte aligned).
+// x and y are saturated to the int16 range, z to the uint16 range.
+
+static DST_INLINE_ONLY void dstInlineStoreScreenVerticesInt16(__simd128_float m_screen_x,
+__simd128_float m_screen_y, __simd128_float m_screen_z, __simd128_int m_flags,
+float * DST_RESTRICT v_result) {
+    __simd128_float m_min_int16 = simd128_set_same_float(- 32768.0f);
+    __simd128_float m_max_int16 = simd128_set_same_float(32767.0f);
+    __simd128_int m_x = simd128_convert_float_int32(
+        simd128_min_float(simd128_max_float(m_screen_x, m_min_int16), m_max_int16));
+    __simd128_int m_y = simd128_convert_float_int32(
+        simd128_min_float(simd128_max_float(m_screen_y, m_min_int16), m_max_int16));
+    __simd128_int m_z = simd128_convert_float_int32(
+        simd128_min_float(simd128_max_float(m_screen_z, simd128_set_zero_float()),
+        simd128_set_same_float(65535.0f)));
+    // Packing with signed saturation: bias the unsigned z values and clip flags
+    // into the signed range and flip the sign bit back afterwards.
+    __simd128_int m_bias = simd128_set_same_int32(32768);
+    __simd128_int m_xy = simd128_convert_int32_int16_saturate(m_x, m_y);
+    __simd128_int m_zf = simd128_xor_int(
+        simd128_convert_int32_int16_saturate(simd128_sub_int32(m_z, m_bias),
+            simd128_sub_int32(m_flags, m_bias)),
+        simd128_set_same_int32(0x80008000));
+    // m_xy contains x0 x1 x2 x3 y0 y1 y2 y3, m_zf contains z0 z1 z2 z3 f0 f1 f2 f3.
+    __simd128_int m_xz = simd128_interleave_low_int16(m_xy, m_zf);
+    __simd128_int m_yf = simd128_interleave_high_int16(m_xy, m_zf);
+    simd128_store_int((int *)&v_result[0], simd128_interleave_low_int16(m_xz, m_yf));
+    simd128_store_int((int *)&v_result[4], simd128_interleave_high_int16(m_xz, m_yf));
+}
+
+// Process four points. When padded is false, the source points are packed three-float
+// points (48 bytes); otherwise they are Point3DPadded. When int16 is false, the result
+// is stored as dstScreenVertex (64 bytes), otherwise as dstScreenVertexInt16 (32 bytes).
+
+static DST_INLINE_ONLY void dstInlineTransformAndProjectFourPoints(const __simd128_float *m_row,
+__simd128_float m_scale, __simd128_float m_offset, const bool padded, const bool int16,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+    __simd128_float m_v_x, m_v_y, m_v_z;
+    if (padded) {
+        m_v_x = simd128_load_float(&v[0]);
+        m_v_y = simd128_load_float(&v[4]);
+        m_v_z = simd128_load_float(&v[8]);
+        __simd128_float m_v_w = simd128_load_float(&v[12]);
+        simd128_transpose4_float(m_v_x, m_v_y, m_v_z, m_v_w);
+    }
+    else
+        simd128_unpack3to4_and_transpose4to3_float(simd128_load_float(&v[0]),
+            simd128_load_float(&v[4]), simd128_load_float(&v[8]), m_v_x, m_v_y, m_v_z);
+    __simd128_float m_screen_x, m_screen_y, m_screen_z;
+    __simd128_int m_flags;
+    dstInlineProjectPointsTransposed(m_row, m_scale, m_offset, m_v_x, m_v_y, m_v_z,
+        m_screen_x, m_screen_y, m_screen_z, m_flags);
+    if (int16) {
+        dstInlineStoreScreenVerticesInt16(m_screen_x, m_screen_y, m_screen_z, m_flags,
+            v_result);
+        return;
+    }
+    __simd128_float m_result_0, m_result_1, m_result_2, m_result_3;
+    simd128_transpose4to4_float(m_screen_x, m_screen_y, m_screen_z,
+        simd128_cast_int_float(m_flags), m_result_0, m_result_1, m_result_2, m_result_3);
+    simd128_store_float(&v_result[0], m_result_0);
+    simd128_store_float(&v_result[4], m_result_1);
+    simd128_store_float(&v_result[8], m_result_2);
+    simd128_store_float(&v_result[12], m_result_3);
+}
+
+static DST_INLINE_ONLY void dstInlineTransformAndProjectPoints(int n,
+const float * DST_RESTRICT params, const bool padded, const bool int16,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+    __simd128_float m_row[4];
+    simd128_transpose4to4_float(
+        simd128_load_float(&params[0]), simd128_load_float(&params[4]),
+        simd128_load_float(&params[8]), simd128_load_float(&params[12]),
+        m_row[0], m_row[1], m_row[2], m_row[3]);
+    __simd128_float m_scale = simd128_load_float(&params[16]);
+    __simd128_float m_offset = simd128_load_float(&params[20]);
+    const int source_size = padded ? 4 : 3;
+    const int result_size = int16 ? 2 : 4;
+    int i = 0;
+    for (; i + 3 < n; i += 4)
+        dstInlineTransformAndProjectFourPoints(m_row, m_scale, m_offset, padded, int16,
+            &v[i * source_size], &v_result[i * result_size]);
+    if (i < n) {
+        float v_copy[16] DST_ALIGNED(16);
+        float v_copy_result[16] DST_ALIGNED(16);
+        dstInlineCopyMatricesPadded(n - i, source_size, &v[i * source_size], v_copy);
+        dstInlineTransformAndProjectFourPoints(m_row, m_scale, m_offset, padded, int16,
+            v_copy, v_copy_result);
+        for (int j = 0; j < (n - i) * result_size; j++)
+            v_result[i * result_size + j] = v_copy_result[j];
+    }
+}
+
+static DST_INLINE_ONLY void dstInlineTransformAndProjectPointsP3(int n,
+const float * DST_RESTRICT params, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+    dstInlineTransformAndProjectPoints(n, params, false, false, v, v_result);
+}
+
+static DST_INLINE_ONLY void dstInlineTransformAndProjectPointsP3P(int n,
+const float * DST_RESTRICT params, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+    dstInlineTransformAndProjectPoints(n, params, true, false, v, v_result);
+}
+
+static DST_INLINE_ONLY void dstInlineTransformAndProjectPointsP3Int16(int n,
+const float * DST_RESTRICT params, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+    dstInlineTransformAndProjectPoints(n, params, false, true, v, v_result);
+}
+
+static DST_INLINE_ONLY void dstInlineTransformAndProjectPointsP3PInt16(int n,
+const float * DST_RESTRICT params, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+    dstInlineTransformAndProjectPoints(n, params, true, true, v, v_result);
+}
+
+// Quaternion functions. Quaternions are stored as (x, y, z, w) with w the scalar part.
+// The kernels operate on four quaternions at a time in SoA form (m_q[0] holding the x
+// components, m_q[1] the y components etc.). Arrays of Quaternion (AoS) are transposed
+// when loading and storing, while arrays of QuaternionSoA4 are used directly.
+
+static DST_INLINE_ONLY void dstInlineLoadFourQuaternions(const float * DST_RESTRICT q,
+const bool soa, __simd128_float *m_q) {
+    m_q[0] = simd128_load_float(&q[0]);
+    m_q[1] = simd128_load_float(&q[4]);
+    m_q[2] = simd128_load_float(&q[8]);
+    m_q[3] = simd128_load_float(&q[12]);
+    if (!soa)
+        simd128_transpose4_float(m_q[0], m_q[1], m_q[2], m_q[3]);
+}
+
+static DST_INLINE_ONLY void dstInlineStoreFourQuaternions(const __simd128_float *m_q,
+const bool soa, float * DST_RESTRICT q) {
+    __simd128_float m_q0 = m_q[0];
+    __simd128_float m_q1 = m_q[1];
+    __simd128_float m_q2 = m_q[2];
+    __simd128_float m_q3 = m_q[3];
+    if (!soa)
+        simd128_transpose4_float(m_q0, m_q1, m_q2, m_q3);
+    simd128_store_float(&q[0], m_q0);
+    simd128_store_float(&q[4], m_q1);
+    simd128_store_float(&q[8], m_q2);
+    simd128_store_float(&q[12], m_q3);
+}
+
+static DST_INLINE_ONLY __simd128_float dstInlineDotQuaternionsSoA(const __simd128_float *m_q1,
+const __simd128_float *m_q2) {
+    return simd128_add_float(
+        simd128_add_float(simd128_mul_float(m_q1[0], m_q2[0]), simd128_mul_float(m_q1[1], m_q2[1])),
+        simd128_add_float(simd128_mul_float(m_q1[2], m_q2[2]), simd128_mul_float(m_q1[3], m_q2[3])));
+}
+
+static DST_INLINE_ONLY void dstInlineMultiplyQuaternionsSoA(const __simd128_float *m_q1,
+const __simd128_float *m_q2, __simd128_float *m_result) {
+    m_result[0] = simd128_add_float(
+        simd128_add_float(simd128_mul_float(m_q1[3], m_q2[0]), simd128_mul_float(m_q1[0], m_q2[3])),
+        simd128_sub_float(simd128_mul_float(m_q1[1], m_q2[2]), simd128_mul_float(m_q1[2], m_q2[1])));
+    m_result[1] = simd128_add_float(
+        simd128_sub_float(simd128_mul_float(m_q1[3], m_q2[1]), simd128_mul_float(m_q1[0], m_q2[2])),
+        simd128_add_float(simd128_mul_float(m_q1[1], m_q2[3]), simd128_mul_float(m_q1[2], m_q2[0])));
+    m_result[2] = simd128_add_float(
+        simd128_add_float(simd128_mul_float(m_q1[3], m_q2[2]), simd128_mul_float(m_q1[0], m_q2[1])),
+        simd128_sub_float(simd128_mul_float(m_q1[2], m_q2[3]), simd128_mul_float(m_q1[1], m_q2[0])));
+    m_result[3] = simd128_sub_float(
+        simd128_sub_float(simd128_mul_float(m_q1[3], m_q2[3]), simd128_mul_float(m_q1[0], m_q2[0])),
+        simd128_add_float(simd128_mul_float(m_q1[1], m_q2[1]), simd128_mul_float(m_q1[2], m_q2[2])));
+}
+
+// Normalize using the approximate reciprocal square root, refined with one Newton-Raphson
+// iteration (r' = r * (1.5 - 0.5 * d * r * r)).
+
+static DST_INLINE_ONLY void dstInlineNormalizeQuaternionsSoA(const __simd128_float *m_q,
+__simd128_float *m_result) {
+    __simd128_float m_d = dstInlineDotQuaternionsSoA(m_q, m_q);
+    __simd128_float m_r = simd128_approximate_reciprocal_sqrt_float(m_d);
+    m_r = simd128_mul_float(m_r, simd128_sub_float(simd128_set_same_float(1.5f),
+        simd128_mul_float(simd128_mul_float(simd128_set_same_float(0.5f), m_d),
+        simd128_mul_float(m_r, m_r))));
+    for (int i = 0; i < 4; i++)
+        m_result[i] = simd128_mul_float(m_q[i], m_r);
+}
+
+// Negate q2 where the dot product with q1 is negative, so that interpolation follows the
+// shortest arc. Returns the absolute value of the dot product.
+
+static DST_INLINE_ONLY __simd128_float dstInlineAlignQuaternionsSoA(const __simd128_float *m_q1,
+__simd128_float *m_q2) {
+    __simd128_float m_dot = dstInlineDotQuaternionsSoA(m_q1, m_q2);
+    __simd128_int m_sign = simd128_and_int(simd128_cast_float_int(m_dot),
+        simd128_set_same_int32(0x80000000));
+    for (int i = 0; i < 4; i++)
+        m_q2[i] = simd128_cast_int_float(simd128_xor_int(simd128_cast_float_int(m_q2[i]),
+            m_sign));
+    return simd128_cast_int_float(simd128_xor_int(simd128_cast_float_int(m_dot), m_sign));
+}
+
+static DST_INLINE_ONLY void dstInlineNlerpQuaternionsSoA(const __simd128_float *m_q1,
+__simd128_float *m_q2, __simd128_float m_t, __simd128_float *m_result) {
+    dstInlineAlignQuaternionsSoA(m_q1, m_q2);
+    __simd128_float m_lerp[4];
+    for (int i = 0; i < 4; i++)
+        m_lerp[i] = simd128_add_float(m_q1[i],
+            simd128_mul_float(m_t, simd128_sub_float(m_q2[i], m_q1[i])));
+    dstInlineNormalizeQuaternionsSoA(m_lerp, m_result);
+}
+
+// Calculate the slerp coefficient sin(t * angle) / sin(angle) for cos(angle) = x within
+// [0, 1], using the polynomial approximation by D. Eberly ("A Fast and Accurate Algorithm
+// for Computing SLERP"), with m_x_minus_one = x - 1.0f.
+
+static DST_INLINE_ONLY __simd128_float dstInlineSlerpCoefficient(__simd128_float m_t,
+__simd128_float m_x_minus_one) {
+    // Twelve terms, with the last term scaled by mu to minimize the maximum error
+    // (about 7E-7).
+    const float mu = 1.8937207f;
+    float u[12], v[12];
+    for (int i = 0; i < 12; i++) {
+        u[i] = 1.0f / ((i + 1) * (2 * i + 3));
+        v[i] = (float)(i + 1) / (2 * i + 3);
+    }
+    u[11] *= mu;
+    v[11] *= mu;
+    __simd128_float m_t_squared = simd128_mul_float(m_t, m_t);
+    __simd128_float m_one = simd128_set_same_float(1.0f);
+    __simd128_float m_c = m_one;
+    for (int i = 11; i >= 0; i--) {
+        __simd128_float m_b = simd128_mul_float(simd128_sub_float(
+            simd128_mul_float(simd128_set_same_float(u[i]), m_t_squared),
+            simd128_set_same_float(v[i])), m_x_minus_one);
+        m_c = simd128_add_float(m_one, simd128_mul_float(m_b, m_c));
+    }
+    return simd128_mul_float(m_t, m_c);
+}
+
+static DST_INLINE_ONLY void dstInlineSlerpQuaternionsSoA(const __simd128_float *m_q1,
+__simd128_float *m_q2, __simd128_float m_t, __simd128_float *m_result) {
+    __simd128_float m_x_minus_one = simd128_sub_float(dstInlineAlignQuaternionsSoA(m_q1, m_q2),
+        simd128_set_same_float(1.0f));
+    __simd128_float m_c1 = dstInlineSlerpCoefficient(
+        simd128_sub_float(simd128_set_same_float(1.0f), m_t), m_x_minus_one);
+    __simd128_float m_c2 = dstInlineSlerpCoefficient(m_t, m_x_minus_one);
+    for (int i = 0; i < 4; i++)
+        m_result[i] = simd128_add_float(simd128_mul_float(m_c1, m_q1[i]),
+            simd128_mul_float(m_c2, m_q2[i]));
+}
+
+// Rotate vectors stored in transposed form (m_v[0] holding the x coordinates etc.).
+// v' = v + w * t + u x t, with u the vector part of q and t = 2 * (u x v).
+
+static DST_INLINE_ONLY void dstInlineCrossProductsTransposed(const __simd128_float *m_a,
+const __simd128_float *m_b, __simd128_float *m_result) {
+    m_result[0] = simd128_sub_float(simd128_mul_float(m_a[1], m_b[2]),
+        simd128_mul_float(m_a[2], m_b[1]));
+    m_result[1] = simd128_sub_float(simd128_mul_float(m_a[2], m_b[0]),
+        simd128_mul_float(m_a[0], m_b[2]));
+    m_result[2] = simd128_sub_float(simd128_mul_float(m_a[0], m_b[1]),
+        simd128_mul_float(m_a[1], m_b[0]));
+}
+
+static DST_INLINE_ONLY void dstInlineRotateVectorsSoA(const __simd128_float *m_q,
+const __simd128_float *m_v, __simd128_float *m_result) {
+    __simd128_float m_t[3], m_u_cross_t[3];
+    dstInlineCrossProductsTransposed(m_q, m_v, m_t);
+    for (int i = 0; i < 3; i++)
+        m_t[i] = simd128_add_float(m_t[i], m_t[i]);
+    dstInlineCrossProductsTransposed(m_q, m_t, m_u_cross_t);
+    for (int i = 0; i < 3; i++)
+        m_result[i] = simd128_add_float(simd128_add_float(m_v[i],
+            simd128_mul_float(m_q[3], m_t[i])), m_u_cross_t[i]);
+}
+
+// Calculate the elements of the rotation matrices (m_m[row * 3 + column]).
+
+static DST_INLINE_ONLY void dstInlineQuaternionsToMatricesSoA(const __simd128_float *m_q,
+__simd128_float *m_m) {
+    __simd128_float m_one = simd128_set_same_float(1.0f);
+    __simd128_float m_x2 = simd128_add_float(m_q[0], m_q[0]);
+    __simd128_float m_y2 = simd128_add_float(m_q[1], m_q[1]);
+    __simd128_float m_z2 = simd128_add_float(m_q[2], m_q[2]);
+    __simd128_float m_xx2 = simd128_mul_float(m_q[0], m_x2);
+    __simd128_float m_yy2 = simd128_mul_float(m_q[1], m_y2);
+    __simd128_float m_zz2 = simd128_mul_float(m_q[2], m_z2);
+    __simd128_float m_xy2 = simd128_mul_float(m_q[0], m_y2);
+    __simd128_float m_xz2 = simd128_mul_float(m_q[0], m_z2);
+    __simd128_float m_yz2 = simd128_mul_float(m_q[1], m_z2);
+    __simd128_float m_wx2 = simd128_mul_float(m_q[3], m_x2);
+    __simd128_float m_wy2 = simd128_mul_float(m_q[3], m_y2);
+    __simd128_float m_wz2 = simd128_mul_float(m_q[3], m_z2);
+    m_m[0] = simd128_sub_float(m_one, simd128_add_float(m_yy2, m_zz2));
+    m_m[1] = simd128_sub_float(m_xy2, m_wz2);
+    m_m[2] = simd128_add_float(m_xz2, m_wy2);
+    m_m[3] = simd128_add_float(m_xy2, m_wz2);
+    m_m[4] = simd128_sub_float(m_one, simd128_add_float(m_xx2, m_zz2));
+    m_m[5] = simd128_sub_float(m_yz2, m_wx2);
+    m_m[6] = simd128_sub_float(m_xz2, m_wy2);
+    m_m[7] = simd128_add_float(m_yz2, m_wx2);
+    m_m[8] = simd128_sub_float(m_one, simd128_add_float(m_xx2, m_yy2));
+}
+
+// Batch functions. For AoS arrays, the last group of less than four quaternions is
+// processed using a padded copy; QuaternionSoA4 arrays always consist of complete groups.
+
+static DST_INLINE_ONLY void dstInlineMultiplyQuaternions(int n, const float * DST_RESTRICT q1,
+const float * DST_RESTRICT q2, float * DST_RESTRICT q_result, const bool soa) {
+    int i = 0;
+    for (; i + 3 < n || (soa && i < n); i += 4) {
+        __simd128_float m_q1[4], m_q2[4], m_result[4];
+        dstInlineLoadFourQuaternions(&q1[i * 4], soa, m_q1);
+        dstInlineLoadFourQuaternions(&q2[i * 4], soa, m_q2);
+        dstInlineMultiplyQuaternionsSoA(m_q1, m_q2, m_result);
+        dstInlineStoreFourQuaternions(m_result, soa, &q_result[i * 4]);
+    }
+    if (i < n) {
+        float q1_copy[16] DST_ALIGNED(16);
+        float q2_copy[16] DST_ALIGNED(16);
+        float q_copy_result[16] DST_ALIGNED(16);
+        dstInlineCopyMatricesPadded(n - i, 4, &q1[i * 4], q1_copy);
+        dstInlineCopyMatricesPadded(n - i, 4, &q2[i * 4], q2_copy);
+        dstInlineMultiplyQuaternions(4, q1_copy, q2_copy, q_copy_result, false);
+        for (int j = 0; j < (n - i) * 4; j++)
+            q_result[i * 4 + j] = q_copy_result[j];
+    }
+}
+
+static DST_INLINE_ONLY void dstInlineNormalizeQuaternions(int n, const float * DST_RESTRICT q,
+float * DST_RESTRICT q_result, const bool soa) {
+    int i = 0;
+    for (; i + 3 < n || (soa && i < n); i += 4) {
+        __simd128_float m_q[4], m_result[4];
+        dstInlineLoadFourQuaternions(&q[i * 4], soa, m_q);
+        dstInlineNormalizeQuaternionsSoA(m_q, m_result);
+        dstInlineStoreFourQuaternions(m_result, soa, &q_result[i * 4]);
+    }
+    if (i < n) {
+        float q_copy[16] DST_ALIGNED(16);
+        float q_copy_result[16] DST_ALIGNED(16);
+        dstInlineCopyMatricesPadded(n - i, 4, &q[i * 4], q_copy);
+        dstInlineNormalizeQuaternions(4, q_copy, q_copy_result, false);
+        for (int j = 0; j < (n - i) * 4; j++)
+            q_result[i * 4 + j] = q_copy_result[j];
+    }
+}
+
+// Nlerp (slerp is false) or slerp (slerp is true).
+
+static DST_INLINE_ONLY void dstInlineInterpolateQuaternions(int n, const float * DST_RESTRICT q1,
+const float * DST_RESTRICT q2, const float * DST_RESTRICT t, float * DST_RESTRICT q_result,
+const bool soa, const bool slerp) {
+    int i = 0;
+    for (; i + 3 < n || (soa && i < n); i += 4) {
+        __simd128_float m_q1[4], m_q2[4], m_result[4];
+        dstInlineLoadFourQuaternions(&q1[i * 4], soa, m_q1);
+        dstInlineLoadFourQuaternions(&q2[i * 4], soa, m_q2);
+        __simd128_float m_t;
+        if (i + 3 < n)
+            m_t = simd128_set_float(t[i], t[i + 1], t[i + 2], t[i + 3]);
+        else
+            m_t = dstInlineGatherMatrixElement(n - i, 1, &t[i], 0);
+        if (slerp)
+            dstInlineSlerpQuaternionsSoA(m_q1, m_q2, m_t, m_result);
+        else
+            dstInlineNlerpQuaternionsSoA(m_q1, m_q2, m_t, m_result);
+        dstInlineStoreFourQuaternions(m_result, soa, &q_result[i * 4]);
+    }
+    if (i < n) {
+        float q1_copy[16] DST_ALIGNED(16);
+        float q2_copy[16] DST_ALIGNED(16);
+        float t_copy[4];
+        float q_copy_result[16] DST_ALIGNED(16);
+        dstInlineCopyMatricesPadded(n - i, 4, &q1[i * 4], q1_copy);
+        dstInlineCopyMatricesPadded(n - i, 4, &q2[i * 4], q2_copy);
+        dstInlineCopyMatricesPadded(n - i, 1, &t[i], t_copy);
+        dstInlineInterpolateQuaternions(4, q1_copy, q2_copy, t_copy, q_copy_result, false,
+            slerp);
+        for (int j = 0; j < (n - i) * 4; j++)
+            q_result[i * 4 + j] = q_copy_result[j];
+    }
+}
+
+// Rotate packed (Vector3D, padded is false) or padded (Vector3DPadded) vectors.
+
+static DST_INLINE_ONLY void dstInlineRotateFourVectors(const float * DST_RESTRICT q,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result, const bool padded) {
+    __simd128_float m_q[4], m_v[4], m_result[4];
+    dstInlineLoadFourQuaternions(q, false, m_q);
+    if (padded)
+        dstInlineLoadFourQuaternions(v, false, m_v);
+    else
+        simd128_unpack3to4_and_transpose4to3_float(simd128_load_float(&v[0]),
+            simd128_load_float(&v[4]), simd128_load_float(&v[8]), m_v[0], m_v[1], m_v[2]);
+    dstInlineRotateVectorsSoA(m_q, m_v, m_result);
+    if (padded) {
+        m_result[3] = simd128_set_zero_float();
+        dstInlineStoreFourQuaternions(m_result, false, v_result);
+    }
+    else {
+        __simd128_float m_result_0, m_result_1, m_result_2;
+        simd128_transpose3to4_and_pack4to3_float(m_result[0], m_result[1], m_result[2],
+            m_result_0, m_result_1, m_result_2);
+        simd128_store_float(&v_result[0], m_result_0);
+        simd128_store_float(&v_result[4], m_result_1);
+        simd128_store_float(&v_result[8], m_result_2);
+    }
+}
+
+static DST_INLINE_ONLY void dstInlineRotateVectors(int n, const float * DST_RESTRICT q,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result, const bool padded) {
+    const int size = padded ? 4 : 3;
+    int i = 0;
+    for (; i + 3 < n; i += 4)
+        dstInlineRotateFourVectors(&q[i * 4], &v[i * size], &v_result[i * size], padded);
+    if (i < n) {
+        float q_copy[16] DST_ALIGNED(16);
+        float v_copy[16] DST_ALIGNED(16);
+        float v_copy_result[16] DST_ALIGNED(16);
+        dstInlineCopyMatricesPadded(n - i, 4, &q[i * 4], q_copy);
+        dstInlineCopyMatricesPadded(n - i, size, &v[i * size], v_copy);
+        dstInlineRotateFourVectors(q_copy, v_copy, v_copy_result, padded);
+        for (int j = 0; j < (n - i) * size; j++)
+            v_result[i * size + j] = v_copy_result[j];
+    }
+}
+
+static DST_INLINE_ONLY void dstInlineConvertQuaternionsToMatrices3x3CM(int n,
+const float * DST_RESTRICT q, float * DST_RESTRICT m_result) {
+    for (int i = 0; i < n; i += 4) {
+        int nu_matrices = n - i < 4 ? n - i : 4;
+        __simd128_float m_q[4], m_m[9];
+        for (int j = 0; j < 4; j++)
+            m_q[j] = dstInlineGatherMatrixElement(nu_matrices, 4, &q[i * 4], j);
+        dstInlineQuaternionsToMatricesSoA(m_q, m_m);
+        // Matrix3D is stored in column-major order.
+        for (int r = 0; r < 3; r++)
+            for (int c = 0; c < 3; c++)
+                dstInlineScatterMatrixElement(nu_matrices, 9, m_m[r * 3 + c], &m_result[i * 9],
+                    c * 3 + r);
+    }
+}
+
+static DST_INLINE_ONLY void dstInlineConvertFourQuaternionsToMatrices4x3RM(
+const float * DST_RESTRICT q, float * DST_RESTRICT m_result) {
+    __simd128_float m_q[4], m_m[9];
+    dstInlineLoadFourQuaternions(q, false, m_q);
+    dstInlineQuaternionsToMatricesSoA(m_q, m_m);
+    __simd128_float m_zeros = simd128_set_zero_float();
+    for (int r = 0; r < 3; r++) {
+        // Transpose to obtain row r of each of the four matrices.
+        __simd128_float m_row[4];
+        simd128_transpose4to4_float(m_m[r * 3], m_m[r * 3 + 1], m_m[r * 3 + 2], m_zeros,
+            m_row[0], m_row[1], m_row[2], m_row[3]);
+        for (int j = 0; j < 4; j++)
+            simd128_store_float(&m_result[j * 12 + r * 4], m_row[j]);
+    }
+}
+
+static DST_INLINE_ONLY void dstInlineConvertQuaternionsToMatrices4x3RM(int n,
+const float * DST_RESTRICT q, float * DST_RESTRICT m_result) {
+    int i = 0;
+    for (; i + 3 < n; i += 4)
+        dstInlineConvertFourQuaternionsToMatrices4x3RM(&q[i * 4], &m_result[i * 12]);
+    if (i < n) {
+        float q_copy[16] DST_ALIGNED(16);
+        float m_copy_result[48] DST_ALIGNED(16);
+        dstInlineCopyMatricesPadded(n - i, 4, &q[i * 4], q_copy);
+        dstInlineConvertFourQuaternionsToMatrices4x3RM(q_copy, m_copy_result);
+        for (int j = 0; j < (n - i) * 12; j++)
+            m_result[i * 12 + j] = m_copy_result[j];
+    }
+}
+
+// Transform arrays of 2D vectors or points with a 3x3 column-major matrix (Matrix3D)
+// used as a 2D affine transformation; the third row of the matrix is ignored.
+
+// Interleaved (x, y) pairs, 16-byte aligned. Each register holds two vectors; the
+// matrix columns are duplicated accordingly.
+
+static DST_INLINE_ONLY __simd128_float dstInlineMatrixMultiplyTwoVectors2D(
+__simd128_float m_col0, __simd128_float m_col1, __simd128_float m_col2,
+__simd128_float m_v, const bool translate) {
+    __simd128_float m_result = simd128_add_float(
+        simd128_mul_float(simd128_select_float(m_v, 0, 0, 2, 2), m_col0),
+        simd128_mul_float(simd128_select_float(m_v, 1, 1, 3, 3), m_col1));
+    if (translate)
+        m_result = simd128_add_float(m_result, m_col2);
+    return m_result;
+}
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1xNM3x3CM2D(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result,
+const bool translate) {
+    __simd128_float m_col0 = simd128_set_float(m[0], m[1], m[0], m[1]);
+    __simd128_float m_col1 = simd128_set_float(m[3], m[4], m[3], m[4]);
+    __simd128_float m_col2 = simd128_set_float(m[6], m[7], m[6], m[7]);
+    int i = 0;
+    for (; i + 3 < n; i += 4) {
+        __simd128_float m_result0 = dstInlineMatrixMultiplyTwoVectors2D(m_col0, m_col1, m_col2,
+            simd128_load_float(&v[i * 2]), translate);
+        __simd128_float m_result1 = dstInlineMatrixMultiplyTwoVectors2D(m_col0, m_col1, m_col2,
+            simd128_load_float(&v[i * 2 + 4]), translate);
+        simd128_store_float(&v_result[i * 2], m_result0);
+        simd128_store_float(&v_result[i * 2 + 4], m_result1);
+    }
+    for (; i < n; i += 2) {
+        float v_temp[4] DST_ALIGNED(16);
+        float v_result_temp[4] DST_ALIGNED(16);
+        int nu_left = n - i < 2 ? n - i : 2;
+        for (int j = 0; j < 4; j++)
+            v_temp[j] = j < nu_left * 2 ? v[i * 2 + j] : 0.0f;
+        simd128_store_float(v_result_temp, dstInlineMatrixMultiplyTwoVectors2D(m_col0,
+            m_col1, m_col2, simd128_load_float(v_temp), translate));
+        for (int j = 0; j < nu_left * 2; j++)
+            v_result[i * 2 + j] = v_result_temp[j];
+    }
+}
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1xNM3x3CMV2(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+    dstInlineMatrixMultiplyVectors1xNM3x3CM2D(n, m, v, v_result, false);
+}
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1xNM3x3CMP2(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+    dstInlineMatrixMultiplyVectors1xNM3x3CM2D(n, m, v, v_result, true);
+}
+
+// SoA form, four x coordinates followed by four y coordinates. Complete blocks of four
+// are processed, so the last block of the result is written in full.
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1xNM3x3CM2DSoA(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result,
+const bool translate) {
+    __simd128_float m_00 = simd128_set_same_float(m[0]);
+    __simd128_float m_10 = simd128_set_same_float(m[1]);
+    __simd128_float m_01 = simd128_set_same_float(m[3]);
+    __simd128_float m_11 = simd128_set_same_float(m[4]);
+    __simd128_float m_02 = simd128_set_same_float(m[6]);
+    __simd128_float m_12 = simd128_set_same_float(m[7]);
+    for (int i = 0; i < n; i += 4) {
+        __simd128_float m_x = simd128_load_float(&v[i * 2]);
+        __simd128_float m_y = simd128_load_float(&v[i * 2 + 4]);
+        __simd128_float m_result_x = simd128_add_float(simd128_mul_float(m_x, m_00),
+            simd128_mul_float(m_y, m_01));
+        __simd128_float m_result_y = simd128_add_float(simd128_mul_float(m_x, m_10),
+            simd128_mul_float(m_y, m_11));
+        if (translate) {
+            m_result_x = simd128_add_float(m_result_x, m_02);
+            m_result_y = simd128_add_float(m_result_y, m_12);
+        }
+        simd128_store_float(&v_result[i * 2], m_result_x);
+        simd128_store_float(&v_result[i * 2 + 4], m_result_y);
+    }
+}
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1xNM3x3CMV2SoA(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+    dstInlineMatrixMultiplyVectors1xNM3x3CM2DSoA(n, m, v, v_result, false);
+}
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1xNM3x3CMP2SoA(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+    dstInlineMatrixMultiplyVectors1xNM3x3CM2DSoA(n, m, v, v_result, true);
+}
+
+// Multiply a normal matrix (4x3 row-major, translation ignored) with arrays of vectors
+// and normalize the results in the same pass. The normalization uses the approximate
+// reciprocal square root with one Newton-Raphson iteration.
+
+static DST_INLINE_ONLY void dstInlineNormalizeVectorsTransposed(__simd128_float& m_x,
+__simd128_float& m_y, __simd128_float& m_z) {
+    __simd128_float m_d = simd128_add_float(simd128_mul_float(m_x, m_x),
+        simd128_add_float(simd128_mul_float(m_y, m_y), simd128_mul_float(m_z, m_z)));
+    __simd128_float m_r = simd128_approximate_reciprocal_sqrt_float(m_d);
+    m_r = simd128_mul_float(m_r, simd128_sub_float(simd128_set_same_float(1.5f),
+        simd128_mul_float(simd128_mul_float(simd128_set_same_float(0.5f), m_d),
+        simd128_mul_float(m_r, m_r))));
+    m_x = simd128_mul_float(m_x, m_r);
+    m_y = simd128_mul_float(m_y, m_r);
+    m_z = simd128_mul_float(m_z, m_r);
+}
+
+// Process four packed vectors at v (12 floats, 16-byte aligned).
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyNormalizeVectors4RowsV3(
+__simd128_float m_row0, __simd128_float m_row1, __simd128_float m_row2,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+    __simd128_float m_v_x, m_v_y, m_v_z;
+    simd128_unpack3to4_and_transpose4to3_float(simd128_load_float(&v[0]),
+        simd128_load_float(&v[4]), simd128_load_float(&v[8]), m_v_x, m_v_y, m_v_z);
+    __simd128_float m_result_x, m_result_y, m_result_z;
+    dstInlineMatrixMultiplyVectorsTransposed4x3(m_row0, m_row1, m_row2,
+        m_v_x, m_v_y, m_v_z, false, m_result_x, m_result_y, m_result_z);
+    dstInlineNormalizeVectorsTransposed(m_result_x, m_result_y, m_result_z);
+    __simd128_float m_result_0, m_result_1, m_result_2;
+    simd128_transpose3to4_and_pack4to3_float(m_result_x, m_result_y, m_result_z,
+        m_result_0, m_result_1, m_result_2);
+    simd128_store_float(&v_result[0], m_result_0);
+    simd128_store_float(&v_result[4], m_result_1);
+    simd128_store_float(&v_result[8], m_result_2);
+}
+
+// Process four padded vectors at v (16 floats). The w component of the result is 0.0f.
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyNormalizeVectors4RowsV3P(
+__simd128_float m_row0, __simd128_float m_row1, __simd128_float m_row2,
+const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+    __simd128_float m_v_x = simd128_load_float(&v[0]);
+    __simd128_float m_v_y = simd128_load_float(&v[4]);
+    __simd128_float m_v_z = simd128_load_float(&v[8]);
+    __simd128_float m_v_w = simd128_load_float(&v[12]);
+    simd128_transpose4_float(m_v_x, m_v_y, m_v_z, m_v_w);
+    __simd128_float m_result_x, m_result_y, m_result_z;
+    dstInlineMatrixMultiplyVectorsTransposed4x3(m_row0, m_row1, m_row2,
+        m_v_x, m_v_y, m_v_z, false, m_result_x, m_result_y, m_result_z);
+    dstInlineNormalizeVectorsTransposed(m_result_x, m_result_y, m_result_z);
+    __simd128_float m_result_0, m_result_1, m_result_2, m_result_3;
+    simd128_transpose4to4_float(m_result_x, m_result_y, m_result_z, simd128_set_zero_float(),
+        m_result_0, m_result_1, m_result_2, m_result_3);
+    simd128_store_float(&v_result[0], m_result_0);
+    simd128_store_float(&v_result[4], m_result_1);
+    simd128_store_float(&v_result[8], m_result_2);
+    simd128_store_float(&v_result[12], m_result_3);
+}
+
+// The remaining vectors (fewer than four) are copied into a temporary buffer that is
+// padded with unit vectors.
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyNormalizeVectors1xNM4x3RMV3(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+    __simd128_float m_row0 = simd128_load_float(&m[0]);
+    __simd128_float m_row1 = simd128_load_float(&m[4]);
+    __simd128_float m_row2 = simd128_load_float(&m[8]);
+    int i = 0;
+    for (; i + 3 < n; i += 4)
+        dstInlineMatrixMultiplyNormalizeVectors4RowsV3(m_row0, m_row1, m_row2,
+            &v[i * 3], &v_result[i * 3]);
+    if (i < n) {
+        float v_temp[12] DST_ALIGNED(16);
+        float v_result_temp[12] DST_ALIGNED(16);
+        for (int j = 0; j < 12; j++)
+            v_temp[j] = 1.0f;
+        for (int j = 0; j < (n - i) * 3; j++)
+            v_temp[j] = v[i * 3 + j];
+        dstInlineMatrixMultiplyNormalizeVectors4RowsV3(m_row0, m_row1, m_row2,
+            v_temp, v_result_temp);
+        for (int j = 0; j < (n - i) * 3; j++)
+            v_result[i * 3 + j] = v_result_temp[j];
+    }
+}
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyNormalizeVectors1xNM4x3RMV3P(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT v, float * DST_RESTRICT v_result) {
+    __simd128_float m_row0 = simd128_load_float(&m[0]);
+    __simd128_float m_row1 = simd128_load_float(&m[4]);
+    __simd128_float m_row2 = simd128_load_float(&m[8]);
+    int i = 0;
+    for (; i + 3 < n; i += 4)
+        dstInlineMatrixMultiplyNormalizeVectors4RowsV3P(m_row0, m_row1, m_row2,
+            &v[i * 4], &v_result[i * 4]);
+    if (i < n) {
+        float v_temp[16] DST_ALIGNED(16);
+        float v_result_temp[16] DST_ALIGNED(16);
+        for (int j = 0; j < 16; j++)
+            v_temp[j] = 1.0f;
+        for (int j = 0; j < (n - i) * 4; j++)
+            v_temp[j] = v[i * 4 + j];
+        dstInlineMatrixMultiplyNormalizeVectors4RowsV3P(m_row0, m_row1, m_row2,
+            v_temp, v_result_temp);
+        for (int j = 0; j < (n - i) * 4; j++)
+            v_result[i * 4 + j] = v_result_temp[j];
+    }
+}
+
+// Multiply a double-precision 4x4 matrix (column-major, 16-byte aligned) with an
+// array of double-precision points (PointDouble3D). Each column is held in two
+// __simd128_double registers and each point coordinate is broadcast, so that no
+// horizontal operations are required.
+
+static DST_INLINE_ONLY void dstInlineLoadColumnsMatrixDouble4x4CM(const double * DST_RESTRICT m,
+__simd128_double *m_column_xy, __simd128_double *m_column_zw) {
+    for (int i = 0; i < 4; i++) {
+        m_column_xy[i] = simd128_load_double(&m[i * 4]);
+        m_column_zw[i] = simd128_load_double(&m[i * 4 + 2]);
+    }
+}
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyPointDouble3(
+const __simd128_double *m_column_xy, const __simd128_double *m_column_zw,
+const double * DST_RESTRICT p, __simd128_double& m_result_xy, __simd128_double& m_result_zw) {
+    __simd128_double m_x = simd128_load_same_double(&p[0]);
+    __simd128_double m_y = simd128_load_same_double(&p[1]);
+    __simd128_double m_z = simd128_load_same_double(&p[2]);
+    m_result_xy = simd128_add_double(
+        simd128_add_double(simd128_mul_double(m_column_xy[0], m_x),
+            simd128_mul_double(m_column_xy[1], m_y)),
+        simd128_add_double(simd128_mul_double(m_column_xy[2], m_z), m_column_xy[3]));
+    m_result_zw = simd128_add_double(
+        simd128_add_double(simd128_mul_double(m_column_zw[0], m_x),
+            simd128_mul_double(m_column_zw[1], m_y)),
+        simd128_add_double(simd128_mul_double(m_column_zw[2], m_z), m_column_zw[3]));
+}
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1xNMD4x4CMPD3(int n,
+const double * DST_RESTRICT m, const double * DST_RESTRICT p, double * DST_RESTRICT p_result) {
+    __simd128_double m_column_xy[4], m_column_zw[4];
+    dstInlineLoadColumnsMatrixDouble4x4CM(m, m_column_xy, m_column_zw);
+    for (int i = 0; i < n; i++) {
+        __simd128_double m_result_xy, m_result_zw;
+        dstInlineMatrixMultiplyPointDouble3(m_column_xy, m_column_zw, &p[i * 3],
+            m_result_xy, m_result_zw);
+        simd128_store_unaligned_double(&p_result[i * 3], m_result_xy);
+        simd128_store_first_double(&p_result[i * 3 + 2], m_result_zw);
+    }
+}
+
+// Mixed precision: transform double-precision points and write single-precision
+// points (Point3D). The translation of the matrix is expected to already be relative
+// to the desired origin (such as the camera position), so that the conversion to float
+// happens after the large components have cancelled out.
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVectors1xNMD4x4CMPD3P3(int n,
+const double * DST_RESTRICT m, const double * DST_RESTRICT p, float * DST_RESTRICT p_result) {
+    __simd128_double m_column_xy[4], m_column_zw[4];
+    dstInlineLoadColumnsMatrixDouble4x4CM(m, m_column_xy, m_column_zw);
+    for (int i = 0; i < n; i++) {
+        __simd128_double m_result_xy, m_result_zw;
+        dstInlineMatrixMultiplyPointDouble3(m_column_xy, m_column_zw, &p[i * 3],
+            m_result_xy, m_result_zw);
+        __simd128_float m_result = simd128_merge_float(
+            simd128_convert_double_float(m_result_xy),
+            simd128_convert_double_float(m_result_zw), 0, 1, 0, 1);
+        simd128_store3_float(&p_result[i * 3], m_result);
+    }
+}
+
+// Linear blend skinning and per-vertex matrix selection (instanced geometry). Every
+// vertex is transformed with its own 4x3 row-major matrix. Four vertices are processed
+// at a time; the rows of the four matrices are transposed so that the vertices, which
+// are also transposed, can be transformed with multiply-add operations only.
+//
+// Positions (Point3DPadded) and normals (Vector3DPadded) occupy four floats and must
+// be 16-byte aligned. The influence stream (dstSkinInfluences) has six floats per
+// vertex: four weights followed by four 16-bit bone indices. The matrix index stream of
+// the instanced variant has one 32-bit unsigned integer per vertex.
+
+// Transform four vectors in transposed form, given the three rows of the matrix of each
+// vector (m_row[j * 3 + r] is row r of the matrix of vector j).
+
+static DST_INLINE_ONLY void dstInlineMultiplyFourMatrices4x3RowsTransposed(
+const __simd128_float *m_row, __simd128_float m_v_x, __simd128_float m_v_y,
+__simd128_float m_v_z, const bool translate, __simd128_float& m_result_x,
+__simd128_float& m_result_y, __simd128_float& m_result_z) {
+    __simd128_float m_result[3];
+    for (int r = 0; r < 3; r++) {
+        // m_c0 holds the first element of row r of each of the four matrices, etc.
+        __simd128_float m_c0, m_c1, m_c2, m_c3;
+        simd128_transpose4to4_float(m_row[r], m_row[3 + r], m_row[6 + r], m_row[9 + r],
+            m_c0, m_c1, m_c2, m_c3);
+        m_result[r] = simd128_add_float(
+            simd128_add_float(simd128_mul_float(m_c0, m_v_x), simd128_mul_float(m_c1, m_v_y)),
+            simd128_mul_float(m_c2, m_v_z));
+        if (translate)
+            m_result[r] = simd128_add_float(m_result[r], m_c3);
+    }
+    m_result_x = m_result[0];
+    m_result_y = m_result[1];
+    m_result_z = m_result[2];
+}
+
+// Blend the bone matrices selected by the influences of a single vertex.
+
+static DST_INLINE_ONLY void dstInlineBlendMatrices4x3RM(const float * DST_RESTRICT palette,
+const float * DST_RESTRICT influence, __simd128_float *m_row) {
+    const uint16_t *index = (const uint16_t *)&influence[4];
+    const float *m = &palette[index[0] * 12];
+    __simd128_float m_weight = simd128_set_same_float(influence[0]);
+    m_row[0] = simd128_mul_float(simd128_load_float(&m[0]), m_weight);
+    m_row[1] = simd128_mul_float(simd128_load_float(&m[4]), m_weight);
+    m_row[2] = simd128_mul_float(simd128_load_float(&m[8]), m_weight);
+    for (int k = 1; k < 4; k++) {
+        m = &palette[index[k] * 12];
+        m_weight = simd128_set_same_float(influence[k]);
+        m_row[0] = simd128_add_float(m_row[0],
+            simd128_mul_float(simd128_load_float(&m[0]), m_weight));
+        m_row[1] = simd128_add_float(m_row[1],
+            simd128_mul_float(simd128_load_float(&m[4]), m_weight));
+        m_row[2] = simd128_add_float(m_row[2],
+            simd128_mul_float(simd128_load_float(&m[8]), m_weight));
+    }
+}
+
+// Transform four padded positions and optionally four padded normals with the given
+// matrix rows. Normals are transformed without translation and, when normalize is true,
+// normalized. The w component of the results is 1.0f for positions and 0.0f for normals.
+
+static DST_INLINE_ONLY void dstInlineTransformFourVerticesRows(const __simd128_float *m_row,
+const float * DST_RESTRICT p, const float * DST_RESTRICT v, float * DST_RESTRICT p_result,
+float * DST_RESTRICT v_result, const bool normals, const bool normalize) {
+    __simd128_float m_v_x = simd128_load_float(&p[0]);
+    __simd128_float m_v_y = simd128_load_float(&p[4]);
+    __simd128_float m_v_z = simd128_load_float(&p[8]);
+    __simd128_float m_v_w = simd128_load_float(&p[12]);
+    simd128_transpose4_float(m_v_x, m_v_y, m_v_z, m_v_w);
+    __simd128_float m_result_x, m_result_y, m_result_z;
+    dstInlineMultiplyFourMatrices4x3RowsTransposed(m_row, m_v_x, m_v_y, m_v_z, true,
+        m_result_x, m_result_y, m_result_z);
+    __simd128_float m_result_0, m_result_1, m_result_2, m_result_3;
+    simd128_transpose4to4_float(m_result_x, m_result_y, m_result_z,
+        simd128_set_same_float(1.0f), m_result_0, m_result_1, m_result_2, m_result_3);
+    simd128_store_float(&p_result[0], m_result_0);
+    simd128_store_float(&p_result[4], m_result_1);
+    simd128_store_float(&p_result[8], m_result_2);
+    simd128_store_float(&p_result[12], m_result_3);
+    if (!normals)
+        return;
+    m_v_x = simd128_load_float(&v[0]);
+    m_v_y = simd128_load_float(&v[4]);
+    m_v_z = simd128_load_float(&v[8]);
+    m_v_w = simd128_load_float(&v[12]);
+    simd128_transpose4_float(m_v_x, m_v_y, m_v_z, m_v_w);
+    dstInlineMultiplyFourMatrices4x3RowsTransposed(m_row, m_v_x, m_v_y, m_v_z, false,
+        m_result_x, m_result_y, m_result_z);
+    if (normalize)
+        dstInlineNormalizeVectorsTransposed(m_result_x, m_result_y, m_result_z);
+    simd128_transpose4to4_float(m_result_x, m_result_y, m_result_z,
+        simd128_set_zero_float(), m_result_0, m_result_1, m_result_2, m_result_3);
+    simd128_store_float(&v_result[0], m_result_0);
+    simd128_store_float(&v_result[4], m_result_1);
+    simd128_store_float(&v_result[8], m_result_2);
+    simd128_store_float(&v_result[12], m_result_3);
+}
+
+static DST_INLINE_ONLY void dstInlineSkinFourVerticesM4x3RMP3P(const float * DST_RESTRICT palette,
+const float * DST_RESTRICT influences, const float * DST_RESTRICT p,
+const float * DST_RESTRICT v, float * DST_RESTRICT p_result, float * DST_RESTRICT v_result,
+const bool normals) {
+    __simd128_float m_row[12];
+    for (int j = 0; j < 4; j++)
+        dstInlineBlendMatrices4x3RM(palette, &influences[j * 6], &m_row[j * 3]);
+    dstInlineTransformFourVerticesRows(m_row, p, v, p_result, v_result, normals, true);
+}
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyFourVerticesIndexedM4x3RMP3P(
+const float * DST_RESTRICT m, const float * DST_RESTRICT indices, const float * DST_RESTRICT p,
+const float * DST_RESTRICT v, float * DST_RESTRICT p_result, float * DST_RESTRICT v_result,
+const bool normals) {
+    const uint32_t *index = (const uint32_t *)indices;
+    __simd128_float m_row[12];
+    for (int j = 0; j < 4; j++) {
+        const float *m_j = &m[index[j] * 12];
+        m_row[j * 3] = simd128_load_float(&m_j[0]);
+        m_row[j * 3 + 1] = simd128_load_float(&m_j[4]);
+        m_row[j * 3 + 2] = simd128_load_float(&m_j[8]);
+    }
+    dstInlineTransformFourVerticesRows(m_row, p, v, p_result, v_result, normals, false);
+}
+
+// The remaining vertices (fewer than four) are copied into temporary buffers, padded
+// with influences/indices that select the first matrix.
+
+static DST_INLINE_ONLY void dstInlineSkinVerticesM4x3RMP3P(int n, const float * DST_RESTRICT palette,
+const float * DST_RESTRICT influences, const float * DST_RESTRICT p, const float * DST_RESTRICT v,
+float * DST_RESTRICT p_result, float * DST_RESTRICT v_result, const bool normals) {
+    int i = 0;
+    for (; i + 3 < n; i += 4)
+        dstInlineSkinFourVerticesM4x3RMP3P(palette, &influences[i * 6], &p[i * 4],
+            normals ? &v[i * 4] : NULL, &p_result[i * 4],
+            normals ? &v_result[i * 4] : NULL, normals);
+    if (i < n) {
+        float influences_temp[24];
+        float p_temp[16] DST_ALIGNED(16);
+        float v_temp[16] DST_ALIGNED(16);
+        float p_result_temp[16] DST_ALIGNED(16);
+        float v_result_temp[16] DST_ALIGNED(16);
+        for (int j = 0; j < 4; j++) {
+            influences_temp[j * 6] = 1.0f;
+            influences_temp[j * 6 + 1] = 0.0f;
+            influences_temp[j * 6 + 2] = 0.0f;
+            influences_temp[j * 6 + 3] = 0.0f;
+            // Four zero bone indices.
+            influences_temp[j * 6 + 4] = 0.0f;
+            influences_temp[j * 6 + 5] = 0.0f;
+        }
+        for (int j = 0; j < 16; j++) {
+            p_temp[j] = 0.0f;
+            v_temp[j] = 1.0f;
+        }
+        // Copy as integers so that the bone indices are preserved exactly.
+        for (int j = 0; j < (n - i) * 6; j++)
+            ((uint32_t *)influences_temp)[j] = ((const uint32_t *)influences)[i * 6 + j];
+        for (int j = 0; j < (n - i) * 4; j++) {
+            p_temp[j] = p[i * 4 + j];
+            if (normals)
+                v_temp[j] = v[i * 4 + j];
+        }
+        dstInlineSkinFourVerticesM4x3RMP3P(palette, influences_temp, p_temp, v_temp,
+            p_result_temp, v_result_temp, normals);
+        for (int j = 0; j < (n - i) * 4; j++) {
+            p_result[i * 4 + j] = p_result_temp[j];
+            if (normals)
+                v_result[i * 4 + j] = v_result_temp[j];
+        }
+    }
+}
+
+static DST_INLINE_ONLY void dstInlineMatrixMultiplyVerticesIndexedM4x3RMP3P(int n,
+const float * DST_RESTRICT m, const float * DST_RESTRICT indices, const float * DST_RESTRICT p,
+const float * DST_RESTRICT v, float * DST_RESTRICT p_result, float * DST_RESTRICT v_result,
+const bool normals) {
+    int i = 0;
+    for (; i + 3 < n; i += 4)
+        dstInlineMatrixMultiplyFourVerticesIndexedM4x3RMP3P(m, &indices[i], &p[i * 4],
+            normals ? &v[i * 4] : NULL, &p_result[i * 4],
+            normals ? &v_result[i * 4] : NULL, normals);
+    if (i < n) {
+        uint32_t indices_temp[4] = { 0, 0, 0, 0 };
+        float p_temp[16] DST_ALIGNED(16);
+        float v_temp[16] DST_ALIGNED(16);
+        float p_result_temp[16] DST_ALIGNED(16);
+        float v_result_temp[16] DST_ALIGNED(16);
+        for (int j = 0; j < 16; j++) {
+            p_temp[j] = 0.0f;
+            v_temp[j] = 0.0f;
+        }
+        for (int j = 0; j < n - i; j++)
+            indices_temp[j] = ((const uint32_t *)indices)[i + j];
+        for (int j = 0; j < (n - i) * 4; j++) {
+            p_temp[j] = p[i * 4 + j];
+            if (normals)
+                v_temp[j] = v[i * 4 + j];
+        }
+        dstInlineMatrixMultiplyFourVerticesIndexedM4x3RMP3P(m, (const float *)indices_temp,
+            p_temp, v_temp, p_result_temp, v_result_temp, normals);
+        for (int j = 0; j < (n - i) * 4; j++) {
+            p_result[i * 4 + j] = p_result_temp[j];
+            if (normals)
+                v_result[i * 4 + j] = v_result_temp[j];
+        }
+    }
+}
+
 // Classes for using SIMD to multiply a specific matrix with one or more vertices.
 // Because these classes are inline and not exported, there is no problem when the
 // library code is compiled multiple times for different SIMD implementations.
 
 // The following class is for a 4x4 matrix and can be initialized with matrices
-// (float arrays) in both row-major or column-major format.
+// (float arrays) in both row-major or column-major format. The matrix is held as
+// four columns, and vectors are multiplied by replicating each vector component and
+// multiplying it with the corresponding column, so that no horizontal addition is
+// required.
 
 class SIMDMatrix4x4 {
 public :
-    __simd128_float m_row0;
-    __simd128_float m_row1;
-    __simd128_float m_row2;
-    __simd128_float m_row3;
+    __simd128_float m_column0;
+    __simd128_float m_column1;
+    __simd128_float m_column2;
+    __simd128_float m_column3;
 
     // Set row-major matrix data.
     DST_INLINE_ONLY void SetRM(const float *f) {
-        // Load rows.
-        m_row0 = simd128_load_float(&f[0]);
-        m_row1 = simd128_load_float(&f[4]);
-        m_row2 = simd128_load_float(&f[8]);
-        m_row3 = simd128_load_float(&f[12]);
+        // Load rows, then transpose to columns.
+        simd128_transpose4to4_float(
+            simd128_load_float(&f[0]), simd128_load_float(&f[4]),
+            simd128_load_float(&f[8]), simd128_load_float(&f[12]),
+            m_column0, m_column1, m_column2, m_column3);
     }
     // Set column-major matrix data.
     DST_INLINE_ONLY void SetCM(const float *f) {
-        // Load columns, then transpose to rows.
-        SetRM(f);
-        simd128_transpose4_float(m_row0, m_row1, m_row2, m_row3);
+        // Load columns.
+        m_column0 = simd128_load_float(&f[0]);
+        m_column1 = simd128_load_float(&f[4]);
+        m_column2 = simd128_load_float(&f[8]);
+        m_column3 = simd128_load_float(&f[12]);
     }
     // Multiply with a four-float SIMD vector.
-    // Note: This uses the inefficient horizontal addition primitive.
     DST_INLINE_ONLY void MultiplyVector4(const __simd128_float m_v, __simd128_float& m_result) const {
-        __simd128_float m_mul0  = simd128_mul_float(m_row0, m_v);
-        __simd128_float m_mul1  = simd128_mul_float(m_row1, m_v);
-        __simd128_float m_mul2  = simd128_mul_float(m_row2, m_v);
-        __simd128_float m_mul3  = simd128_mul_float(m_row3, m_v);
-        m_result =
-            simd128_horizontal_add2_float(
-                simd128_horizontal_add2_float(m_mul0, m_mul1),
-                simd128_horizontal_add2_float(m_mul2, m_mul3));
+        m_result = simd128_multiply_matrix4x4CM_vector4(m_column0, m_column1, m_column2,
+            m_column3, m_v);
     }
     DST_INLINE_ONLY void MultiplyVector4(const __simd128_float m_v, float &result_x,
     float &result_y, float &result_z, float& result_w) const {
@@ -476,7 +2048,7 @@ public :
         MultiplyVector4(m_v, m_result);
         simd128_store_float(result, m_result);
     }
-    DST_INLINE_ONLY void MultiplyVector4(const float *v, __simd128_float m_result) const {
+    DST_INLINE_ONLY void MultiplyVector4(const float *v, __simd128_float& m_result) const {
         __simd128_float m_v = simd128_load_float(&v[0]);
         MultiplyVector4(m_v, m_result);
     }
@@ -489,50 +2061,99 @@ public :
         __simd128_float m_v = simd128_load_float(&v[0]);
         MultiplyVector4(m_v, result);
     }
+    // Multiply four vectors stored in transposed form (similar coordinates in a single
+    // SIMD vector). The results are also in transposed form.
+    DST_INLINE_ONLY void MultiplyFourVectors4Transposed(const __simd128_float m_v_x,
+    const __simd128_float m_v_y, const __simd128_float m_v_z, const __simd128_float m_v_w,
+    __simd128_float& m_result_x, __simd128_float& m_result_y, __simd128_float& m_result_z,
+    __simd128_float& m_result_w) const {
+        simd128_multiply_matrix4x4CM_vectors4_transposed(m_column0, m_column1, m_column2,
+            m_column3, m_v_x, m_v_y, m_v_z, m_v_w,
+            m_result_x, m_result_y, m_result_z, m_result_w);
+    }
+    // Multiply four consecutive four-float vectors (16-byte aligned) and store the results
+    // in transposed form (four x coordinates, followed by four y, z and w coordinates).
+    DST_INLINE_ONLY void MultiplyFourVectors4(const float *v, float *result_transposed) const {
+        __simd128_float m_v_x = simd128_load_float(&v[0]);
+        __simd128_float m_v_y = simd128_load_float(&v[4]);
+        __simd128_float m_v_z = simd128_load_float(&v[8]);
+        __simd128_float m_v_w = simd128_load_float(&v[12]);
+        simd128_transpose4_float(m_v_x, m_v_y, m_v_z, m_v_w);
+        __simd128_float m_result_x, m_result_y, m_result_z, m_result_w;
+        MultiplyFourVectors4Transposed(m_v_x, m_v_y, m_v_z, m_v_w,
+            m_result_x, m_result_y, m_result_z, m_result_w);
+        simd128_store_float(&result_transposed[0], m_result_x);
+        simd128_store_float(&result_transposed[4], m_result_y);
+        simd128_store_float(&result_transposed[8], m_result_z);
+        simd128_store_float(&result_transposed[12], m_result_w);
+    }
+    // Multiply eight consecutive four-float vectors (16-byte aligned) and store the
+    // results in transposed form (eight x coordinates, followed by eight y, z and w
+    // coordinates). The two groups of four are independent, which helps to hide latency.
+    DST_INLINE_ONLY void MultiplyEightVectors4(const float *v, float *result_transposed) const {
+        __simd128_float m_v_x0 = simd128_load_float(&v[0]);
+        __simd128_float m_v_y0 = simd128_load_float(&v[4]);
+        __simd128_float m_v_z0 = simd128_load_float(&v[8]);
+        __simd128_float m_v_w0 = simd128_load_float(&v[12]);
+        __simd128_float m_v_x1 = simd128_load_float(&v[16]);
+        __simd128_float m_v_y1 = simd128_load_float(&v[20]);
+        __simd128_float m_v_z1 = simd128_load_float(&v[24]);
+        __simd128_float m_v_w1 = simd128_load_float(&v[28]);
+        simd128_transpose4_float(m_v_x0, m_v_y0, m_v_z0, m_v_w0);
+        simd128_transpose4_float(m_v_x1, m_v_y1, m_v_z1, m_v_w1);
+        __simd128_float m_result_x0, m_result_y0, m_result_z0, m_result_w0;
+        __simd128_float m_result_x1, m_result_y1, m_result_z1, m_result_w1;
+        MultiplyFourVectors4Transposed(m_v_x0, m_v_y0, m_v_z0, m_v_w0,
+            m_result_x0, m_result_y0, m_result_z0, m_result_w0);
+        MultiplyFourVectors4Transposed(m_v_x1, m_v_y1, m_v_z1, m_v_w1,
+            m_result_x1, m_result_y1, m_result_z1, m_result_w1);
+        simd128_store_float(&result_transposed[0], m_result_x0);
+        simd128_store_float(&result_transposed[4], m_result_x1);
+        simd128_store_float(&result_transposed[8], m_result_y0);
+        simd128_store_float(&result_transposed[12], m_result_y1);
+        simd128_store_float(&result_transposed[16], m_result_z0);
+        simd128_store_float(&result_transposed[20], m_result_z1);
+        simd128_store_float(&result_transposed[24], m_result_w0);
+        simd128_store_float(&result_transposed[28], m_result_w1);
+    }
 };
 
 #ifdef SIMD_HAVE_MATRIX4X3_VECTOR_MULTIPLICATION
 
 // The following class is for a 4x3 matrix and can be initialized with matrices
-// (float arrays) in both row-major or column-major format.
+// (float arrays) in both row-major or column-major format. The matrix is held as
+// four columns with the fourth component set to 0.0f, so that the fourth row is
+// implicitly (0.0f, 0.0f, 0.0f, 1.0f) when the w component is passed through.
 //
-// Requires simd128_transpose4to3_float and simd_transpose3to4_float.
+// Requires simd128_transpose3to4_float.
 
 class SIMDMatrix4x3 {
 public :
-    __simd128_float m_row0;
-    __simd128_float m_row1;
-    __simd128_float m_row2;
+    __simd128_float m_column0;
+    __simd128_float m_column1;
+    __simd128_float m_column2;
+    __simd128_float m_column3;
 
     // Set row-major matrix data.
     DST_INLINE_ONLY void SetRM(const float *f) {
-        // Load rows.
-        m_row0 = simd128_load_float(&f[0]);
-        m_row1 = simd128_load_float(&f[4]);
-        m_row2 = simd128_load_float(&f[8]);
+        // Load rows, then transpose to columns.
+        simd128_transpose3to4_float(simd128_load_float(&f[0]),
+            simd128_load_float(&f[4]), simd128_load_float(&f[8]),
+            m_column0, m_column1, m_column2, m_column3);
     }
     // Set column-major matrix data.
     DST_INLINE_ONLY void SetCM(const float *f) {
-        // Load columns, then transpose to rows.
-        __simd128_float m_col0 = simd128_load3_float(&f[0]);
-        __simd128_float m_col1 = simd128_load3_float(&f[3]);
-        __simd128_float m_col2 = simd128_load3_float(&f[6]);
-        __simd128_float m_col3 = simd128_load3_float(&f[9]);
-        simd128_transpose4to3_float(m_col0, m_col1, m_col2, m_col3,
-            m_row0, m_row1, m_row2);
-    }
-    // Multiply with a three-float SIMD vector.
-    // Note: This uses the inefficient horizontal addition primitive.
-    // The fourth component of m_v (0.0f or 1.0f) makes a difference.
+        // Load columns, making sure the fourth element is zero.
+        m_column0 = simd128_load3_float(&f[0]);
+        m_column1 = simd128_load3_float(&f[3]);
+        m_column2 = simd128_load3_float(&f[6]);
+        m_column3 = simd128_load3_float(&f[9]);
+    }
+    // Multiply with a three-float SIMD vector. The fourth component of m_v
+    // (0.0f or 1.0f) makes a difference. The fourth component of the result is 0.0f.
     DST_INLINE_ONLY void MultiplyVector3(const __simd128_float m_v, __simd128_float& m_result) const {
-        __simd128_float m_mul0  = simd128_mul_float(m_row0, m_v);
-        __simd128_float m_mul1  = simd128_mul_float(m_row1, m_v);
-        __simd128_float m_mul2  = simd128_mul_float(m_row2, m_v);
-        __simd128_float m_zeros = simd128_set_zero_float();
-        m_result =
-            simd128_horizontal_add2_float(
-                simd128_horizontal_add2_float(m_mul0, m_mul1),
-                simd128_horizontal_add2_float(m_mul2, m_zeros));
+        m_result = simd128_multiply_matrix4x4CM_vector4(m_column0, m_column1, m_column2,
+            m_column3, m_v);
     }
     // The fourth component of m_v (0.0f or 1.0f) makes a difference.
     DST_INLINE_ONLY void MultiplyVector3(const __simd128_float m_v, float &result_x,
@@ -551,7 +2172,7 @@ public :
         simd128_store_float(result, m_result);
     }
     // Unpacked three-float source vector (16-byte aligned, with four bytes padding).
-    DST_INLINE_ONLY void MultiplyVector3(const float *v, __simd128_float m_result) const {
+    DST_INLINE_ONLY void MultiplyVector3(const float *v, __simd128_float& m_result) const {
         // Make sure the fourth element is zero after loading.
         __simd128_float m_v = simd128_set_last_zero_float(simd128_load_float(&v[0]));
         MultiplyVector3(m_v, m_result);
@@ -559,7 +2180,7 @@ public :
     // Unpacked three-float source vector (16-byte aligned, with four bytes padding).
     DST_INLINE_ONLY void MultiplyVector3(const float *v, float &result_x,
     float &result_y, float &result_z) const {
-        __simd128_float m_v = simd128_load_float(&v[0]);
+        __simd128_float m_v = simd128_set_last_zero_float(simd128_load_float(&v[0]));
         MultiplyVector3(m_v, result_x, result_y, result_z);
     }
     // Unpacked three-float source and result vectors (16-byte aligned, with four bytes padding).
@@ -575,7 +2196,7 @@ public :
         simd128_store3_float(result, m_result);
     }
     // Packed three-float source vector (unaligned).
-    DST_INLINE_ONLY void MultiplyVector3Packed(const float *v, __simd128_float m_result) const {
+    DST_INLINE_ONLY void MultiplyVector3Packed(const float *v, __simd128_float& m_result) const {
         __simd128_float m_v = simd128_load3_float(&v[0]);
         MultiplyVector3(m_v, m_result);
     }
@@ -590,19 +2211,10 @@ public :
         __simd128_float m_v = simd128_load3_float(&v[0]);
         MultiplyVector3Packed(m_v, result);
     }
-    // Four-float vectors including (fourth) w component.
+    // Four-float vectors including (fourth) w component, which is passed through.
     DST_INLINE_ONLY void MultiplyVector4(const __simd128_float m_v, __simd128_float& m_result) const {
-        __simd128_float m_mul0  = simd128_mul_float(m_row0, m_v);
-        __simd128_float m_mul1  = simd128_mul_float(m_row1, m_v);
-        __simd128_float m_mul2  = simd128_mul_float(m_row2, m_v);
-        // Set m_mul3 to (0.0f, 0.0f, 0.0f, m_v.w)
-        __simd128_float m_mul3  = simd128_select_float(
-            simd128_merge_float(simd128_set_zero_float(), m_v, 0, 0, 3, 3),
-            0, 0, 0, 3);
-        m_result =
-            simd128_horizontal_add2_float(
-                simd128_horizontal_add2_float(m_mul0, m_mul1),
-                simd128_horizontal_add2_float(m_mul2, m_mul3));
+        m_result = simd128_multiply_matrix4x4CM_vector4(m_column0, m_column1, m_column2,
+            simd128_set_last_float(m_column3, 1.0f), m_v);
     }
     // Result is stored in three seperate floats.
     DST_INLINE_ONLY void MultiplyVector4(const __simd128_float m_v, float &result_x,
@@ -629,7 +2241,7 @@ public :
         MultiplyVector4(m_v, m_result);
         simd128_store_float(result, m_result);
     }
-    DST_INLINE_ONLY void MultiplyVector4(const float *v, __simd128_float m_result) const {
+    DST_INLINE_ONLY void MultiplyVector4(const float *v, __simd128_float& m_result) const {
         __simd128_float m_v = simd128_load_float(&v[0]);
         MultiplyVector4(m_v, m_result);
     }
@@ -645,7 +2257,7 @@ public :
     }
     // Unpacked three-float source point vector (16-byte aligned, with four bytes padding).
     // Point vector has implicit w component of 1.0f.
-    DST_INLINE_ONLY void MultiplyPoint3(const float *v, __simd128_float m_result) const {
+    DST_INLINE_ONLY void MultiplyPoint3(const float *v, __simd128_float& m_result) const {
         // Make sure the fourth element is 1.0f after loading.
         __simd128_float m_v = simd128_set_last_float(simd128_load_float(&v[0]), 1.0f);
         MultiplyVector3(m_v, m_result);
@@ -661,6 +2273,72 @@ public :
         __simd128_float m_v = simd128_set_last_float(simd128_load_float(&v[0]), 1.0f);
         MultiplyVector3(m_v, result);
     }
+    // Multiply four vectors stored in transposed form (similar coordinates in a single
+    // SIMD vector). When translate is true, the source vectors are regarded as points.
+    // The results are also in transposed form.
+    DST_INLINE_ONLY void MultiplyFourVectors3Transposed(const __simd128_float m_v_x,
+    const __simd128_float m_v_y, const __simd128_float m_v_z, const bool translate,
+    __simd128_float& m_result_x, __simd128_float& m_result_y,
+    __simd128_float& m_result_z) const {
+        m_result_x = simd128_add_float(
+            simd128_mul_float(simd128_replicate_float(m_column0, 0), m_v_x),
+            simd128_add_float(
+                simd128_mul_float(simd128_replicate_float(m_column1, 0), m_v_y),
+                simd128_mul_float(simd128_replicate_float(m_column2, 0), m_v_z)));
+        m_result_y = simd128_add_float(
+            simd128_mul_float(simd128_replicate_float(m_column0, 1), m_v_x),
+            simd128_add_float(
+                simd128_mul_float(simd128_replicate_float(m_column1, 1), m_v_y),
+                simd128_mul_float(simd128_replicate_float(m_column2, 1), m_v_z)));
+        m_result_z = simd128_add_float(
+            simd128_mul_float(simd128_replicate_float(m_column0, 2), m_v_x),
+            simd128_add_float(
+                simd128_mul_float(simd128_replicate_float(m_column1, 2), m_v_y),
+                simd128_mul_float(simd128_replicate_float(m_column2, 2), m_v_z)));
+        if (translate) {
+            m_result_x = simd128_add_float(m_result_x, simd128_replicate_float(m_column3, 0));
+            m_result_y = simd128_add_float(m_result_y, simd128_replicate_float(m_column3, 1));
+            m_result_z = simd128_add_float(m_result_z, simd128_replicate_float(m_column3, 2));
+        }
+    }
+    // Multiply four consecutive packed three-float vectors (12 floats, 16-byte aligned)
+    // and store the results in transposed form (four x coordinates, followed by four
+    // y and z coordinates).
+    DST_INLINE_ONLY void MultiplyFourVectors3Packed(const float *v, const bool translate,
+    float *result_transposed) const {
+        __simd128_float m_v_x, m_v_y, m_v_z;
+        simd128_unpack3to4_and_transpose4to3_float(simd128_load_float(&v[0]),
+            simd128_load_float(&v[4]), simd128_load_float(&v[8]), m_v_x, m_v_y, m_v_z);
+        __simd128_float m_result_x, m_result_y, m_result_z;
+        MultiplyFourVectors3Transposed(m_v_x, m_v_y, m_v_z, translate,
+            m_result_x, m_result_y, m_result_z);
+        simd128_store_float(&result_transposed[0], m_result_x);
+        simd128_store_float(&result_transposed[4], m_result_y);
+        simd128_store_float(&result_transposed[8], m_result_z);
+    }
+    // Multiply eight consecutive packed three-float vectors (24 floats, 16-byte aligned)
+    // and store the results in transposed form (eight x coordinates, followed by eight
+    // y and z coordinates).
+    DST_INLINE_ONLY void MultiplyEightVectors3Packed(const float *v, const bool translate,
+    float *result_transposed) const {
+        __simd128_float m_v_x0, m_v_y0, m_v_z0, m_v_x1, m_v_y1, m_v_z1;
+        simd128_unpack3to4_and_transpose4to3_float(simd128_load_float(&v[0]),
+            simd128_load_float(&v[4]), simd128_load_float(&v[8]), m_v_x0, m_v_y0, m_v_z0);
+        simd128_unpack3to4_and_transpose4to3_float(simd128_load_float(&v[12]),
+            simd128_load_float(&v[16]), simd128_load_float(&v[20]), m_v_x1, m_v_y1, m_v_z1);
+        __simd128_float m_result_x0, m_result_y0, m_result_z0;
+        __simd128_float m_result_x1, m_result_y1, m_result_z1;
+        MultiplyFourVectors3Transposed(m_v_x0, m_v_y0, m_v_z0, translate,
+            m_result_x0, m_result_y0, m_result_z0);
+        MultiplyFourVectors3Transposed(m_v_x1, m_v_y1, m_v_z1, translate,
+            m_result_x1, m_result_y1, m_result_z1);
+        simd128_store_float(&result_transposed[0], m_result_x0);
+        simd128_store_float(&result_transposed[4], m_result_x1);
+        simd128_store_float(&result_transposed[8], m_result_y0);
+        simd128_store_float(&result_transposed[12], m_result_y1);
+        simd128_store_float(&result_transposed[16], m_result_z0);
+        simd128_store_float(&result_transposed[20], m_result_z1);
+    }
 };
 
 #endif // defined(SIMD_HAVE_MATRIX4X3_VECTOR_MULTIPLICATION)
@@ -106,6 +106,18 @@ __simd128_float s2) {
     return _mm_unpackhi_ps(s1, s2);
 }
 
+// Interleave the 16-bit elements of the lower (or upper) half of s1 and s2.
+
+static DST_INLINE_ONLY __simd128_int simd128_interleave_low_int16(__simd128_int s1,
+__simd128_int s2) {
+    return _mm_unpacklo_epi16(s1, s2);
+}
+
+static DST_INLINE_ONLY __simd128_int simd128_interleave_high_int16(__simd128_int s1,
+__simd128_int s2) {
+    return _mm_unpackhi_epi16(s1, s2);
+}
+
 // Return 128-bit SSE register with the lowest order 32-bit float from s1 and the
 // remaining 32-bit floats from s2.
 
@@ -348,6 +360,10 @@ static DST_INLINE_ONLY __simd128_int simd128_or_int(__simd128_int s1, __simd128_
     return _mm_or_si128(s1, s2);
 }
 
+static DST_INLINE_ONLY __simd128_int simd128_xor_int(__simd128_int s1, __simd128_int s2) {
+    return _mm_xor_si128(s1, s2);
+}
+
 static DST_INLINE_ONLY __simd128_int simd128_not_int(__simd128_int s) {
     __simd128_int m_full_mask = simd128_set_same_int32(0xFFFFFFFF);
     return _mm_xor_si128(s, m_full_mask);
@@ -459,6 +475,14 @@ __simd128_int zerosi) {
     return _mm_packs_epi16(_mm_packs_epi32(s, zerosi), zerosi);
 }
 
+// Convert eight 32-bit signed integers (four in s1, four in s2) to eight 16-bit signed
+// integers using signed saturation. The elements from s1 are stored in the lower half.
+
+static DST_INLINE_ONLY __simd128_int simd128_convert_int32_int16_saturate(__simd128_int s1,
+__simd128_int s2) {
+    return _mm_packs_epi32(s1, s2);
+}
+
 // Convert four 32-bit integer masks (each either 0xFFFFFFFF or 0x00000000) to 1-bit
 // masks using the highest-order bit of each 32-bit value.
 
@@ -846,6 +870,37 @@ const __simd128_float m_v1, const __simd128_float m_v2, __simd128_float& m_resul
 		m_result_v0, m_result_v1, m_result_v2);
 }
 
+// Pack four three-float vectors (the fourth component is ignored) into packed format
+// (taking the space of three regular four-float vectors). This is the reverse of
+// simd128_unpack3to4_float.
+
+static DST_INLINE_ONLY void simd128_pack4to3_float(const __simd128_float m_v0,
+const __simd128_float m_v1, const __simd128_float m_v2, const __simd128_float m_v3,
+__simd128_float& m_result_v0, __simd128_float& m_result_v1, __simd128_float& m_result_v2) {
+	// m_tmp0 = v0[2], v0[2], v1[0], v1[0]
+	__simd128_float m_tmp0 = simd128_merge_float(m_v0, m_v1, 2, 2, 0, 0);
+	// m_tmp1 = v2[2], v2[2], v3[0], v3[0]
+	__simd128_float m_tmp1 = simd128_merge_float(m_v2, m_v3, 2, 2, 0, 0);
+	// result_v0 = v0[0], v0[1], v0[2], v1[0]
+	m_result_v0 = simd128_merge_float(m_v0, m_tmp0, 0, 1, 0, 2);
+	// result_v1 = v1[1], v1[2], v2[0], v2[1]
+	m_result_v1 = simd128_merge_float(m_v1, m_v2, 1, 2, 0, 1);
+	// result_v2 = v2[2], v3[0], v3[1], v3[2]
+	m_result_v2 = simd128_merge_float(m_tmp1, m_v3, 0, 2, 1, 2);
+}
+
+// Transpose three four-float vectors (holding the x, y and z coordinates of four vectors)
+// and store the result as four three-float vectors in packed format. This is the reverse
+// of simd128_unpack3to4_and_transpose4to3_float.
+
+static DST_INLINE_ONLY void simd128_transpose3to4_and_pack4to3_float(const __simd128_float m_v_x,
+const __simd128_float m_v_y, const __simd128_float m_v_z, __simd128_float& m_result_v0,
+__simd128_float& m_result_v1, __simd128_float& m_result_v2) {
+	__simd128_float m_v0, m_v1, m_v2, m_v3;
+	simd128_transpose3to4_float(m_v_x, m_v_y, m_v_z, m_v0, m_v1, m_v2, m_v3);
+	simd128_pack4to3_float(m_v0, m_v1, m_v2, m_v3, m_result_v0, m_result_v1, m_result_v2);
+}
+
 // Double precision functions.
 
 static DST_INLINE_ONLY __simd128_int simd128_cast_double_int(__simd128_double s) {
@@ -878,6 +933,36 @@ static DST_INLINE_ONLY double simd128_get_double(__simd128_double s) {
     return _mm_cvtsd_f64(s);
 }
 
+// Load and store two doubles (aligned and non-aligned).
+
+static DST_INLINE_ONLY __simd128_double simd128_load_double(const double *dp) {
+    return _mm_load_pd(dp);
+}
+
+static DST_INLINE_ONLY __simd128_double simd128_load_unaligned_double(const double *dp) {
+    return _mm_loadu_pd(dp);
+}
+
+static DST_INLINE_ONLY void simd128_store_double(double *dp, __simd128_double s) {
+    _mm_store_pd(dp, s);
+}
+
+static DST_INLINE_ONLY void simd128_store_unaligned_double(double *dp, __simd128_double s) {
+    _mm_storeu_pd(dp, s);
+}
+
+// Load a double into both halves of the return value.
+
+static DST_INLINE_ONLY __simd128_double simd128_load_same_double(const double *dp) {
+    return _mm_load1_pd(dp);
+}
+
+// Store the lower order double only.
+
+static DST_INLINE_ONLY void simd128_store_first_double(double *dp, __simd128_double s) {
+    _mm_store_sd(dp, s);
+}
+
 // Set lower and higher double to either existing lower or higher double.
 
 static DST_INLINE_ONLY __simd128_double simd128_select_double(__simd128_double s1,
@@ -890,6 +975,10 @@ static DST_INLINE_ONLY __simd128_double simd128_add_double(__simd128_double s1,
     return _mm_add_pd(s1, s2);
 }
 
+static DST_INLINE_ONLY __simd128_double simd128_sub_double(__simd128_double s1, __simd128_double s2) {
+    return _mm_sub_pd(s1, s2);
+}
+
 static DST_INLINE_ONLY __simd128_double simd128_mul_double(__simd128_double s1, __simd128_double s2) {
     return _mm_mul_pd(s1, s2);
 }
@@ -0,0 +1,159 @@
+/*
+
+Copyright (c) 2014 Harm Hanemaaijer <fgenfb@yahoo.com>
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted, provided that the above
+copyright notice and this permission notice appear in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "dstMisc.h"
+#include "dstTaskGraph.h"
+
+// Work item function of a chunk. Runs the task function (unless the subdivision is
+// empty) and resolves the dependencies of the successors.
+
+static void dstTaskGraphChunkFunc(dstThreadData *thread_data) {
+	dstTaskGraphChunk *chunk = (dstTaskGraphChunk *)thread_data->user_data;
+	if (chunk->thread_data.subdivision.nu_elements > 0)
+		chunk->node->task_func(&chunk->thread_data);
+	chunk->node->graph->FinishChunk(chunk);
+}
+
+dstTaskGraph::dstTaskGraph(dstTaskScheduler *_scheduler) {
+	if (_scheduler == NULL)
+		scheduler = dstGetContext()->task_scheduler;
+	else
+		scheduler = _scheduler;
+	nu_pending = 0;
+	task_flags = 0;
+}
+
+dstTaskGraph::~dstTaskGraph() {
+	Clear();
+}
+
+void dstTaskGraph::Clear() {
+	for (uint32_t i = 0; i < node_array.Size(); i++) {
+		dstTaskGraphNode *node = node_array.Get(i);
+		delete [] node->chunk;
+		delete node;
+	}
+	node_array.Truncate(0);
+}
+
+int dstTaskGraph::AddNode(dstTaskFunc func, const void *user_data,
+const dstTaskDivisionData& division) {
+	dstTaskGraphNode *node = new dstTaskGraphNode;
+	node->graph = this;
+	node->task_func = func;
+	// A division without subdivisions still gets a single (empty) chunk, so that the node
+	// resolves the dependencies of its successors.
+	uint32_t nu_chunks = (division.nu_subdivisions > 0) ? division.nu_subdivisions : 1;
+	node->nu_chunks = nu_chunks;
+	node->chunk = new dstTaskGraphChunk[nu_chunks];
+	node->nu_predecessors = 0;
+	for (uint32_t i = 0; i < nu_chunks; i++) {
+		dstTaskGraphChunk *chunk = &node->chunk[i];
+		uint32_t start_index, nu_elements;
+		if (division.nu_subdivisions == 0 ||
+		division.CalculateSubdivision(i, start_index, nu_elements) < 0) {
+			// Empty subdivisions still take part in dependency resolution.
+			start_index = 0;
+			nu_elements = 0;
+		}
+		chunk->thread_data.user_data = user_data;
+		chunk->thread_data.subdivision.start_index = start_index;
+		chunk->thread_data.subdivision.nu_elements = nu_elements;
+		chunk->thread_data.subdivision.index = i;
+		chunk->node = node;
+		chunk->index = i;
+	}
+	int node_index = node_array.Size();
+	node_array.Add(node);
+	return node_index;
+}
+
+int dstTaskGraph::AddNode(dstTaskFunc func, const void *user_data) {
+	dstTaskDivisionData division;
+	division.size = 1;
+	division.nu_subdivisions = 1;
+	division.alignment = 1;
+	return AddNode(func, user_data, division);
+}
+
+void dstTaskGraph::AddDependency(int predecessor, int successor, bool chunkwise) {
+	dstTaskGraphNode *p = node_array.Get(predecessor);
+	dstTaskGraphNode *s = node_array.Get(successor);
+	if (chunkwise && p->nu_chunks == s->nu_chunks)
+		p->chunkwise_successors.Add(successor);
+	else
+		p->successors.Add(successor);
+	s->nu_predecessors++;
+}
+
+void dstTaskGraph::Run() {
+	// Reset the counters before any chunk is queued.
+	int total_chunks = 0;
+	for (uint32_t i = 0; i < node_array.Size(); i++) {
+		dstTaskGraphNode *node = node_array.Get(i);
+		node->nu_remaining_chunks = node->nu_chunks;
+		for (int j = 0; j < node->nu_chunks; j++)
+			node->chunk[j].nu_unresolved = node->nu_predecessors;
+		total_chunks += node->nu_chunks;
+	}
+	nu_pending = total_chunks;
+	task_flags = dstGetContext()->GetTaskFlags();
+	__sync_synchronize();
+	for (uint32_t i = 0; i < node_array.Size(); i++) {
+		dstTaskGraphNode *node = node_array.Get(i);
+		if (node->nu_predecessors == 0)
+			for (int j = 0; j < node->nu_chunks; j++)
+				ResolveChunk(&node->chunk[j]);
+	}
+}
+
+// Queue a chunk of which all dependencies have been resolved.
+
+void dstTaskGraph::ResolveChunk(dstTaskGraphChunk *chunk) {
+	dstThreadData thread_data;
+	thread_data.user_data = chunk;
+	thread_data.subdivision = chunk->thread_data.subdivision;
+	scheduler->QueueWorkItem(task_flags, dstTaskGraphChunkFunc, thread_data, &nu_pending);
+}
+
+void dstTaskGraph::FinishChunk(dstTaskGraphChunk *chunk) {
+	dstTaskGraphNode *node = chunk->node;
+	// Chunk-wise successors only depend on the matching chunk.
+	for (uint32_t i = 0; i < node->chunkwise_successors.Size(); i++) {
+		dstTaskGraphChunk *successor_chunk =
+			&node_array.Get(node->chunkwise_successors.Get(i))->chunk[chunk->index];
+		if (__sync_sub_and_fetch(&successor_chunk->nu_unresolved, 1) == 0)
+			ResolveChunk(successor_chunk);
+	}
+	if (__sync_sub_and_fetch(&node->nu_remaining_chunks, 1) > 0)
+		return;
+	// This was the last chunk of the node.
+	for (uint32_t i = 0; i < node->successors.Size(); i++) {
+		dstTaskGraphNode *successor = node_array.Get(node->successors.Get(i));
+		for (int j = 0; j < successor->nu_chunks; j++)
+			if (__sync_sub_and_fetch(&successor->chunk[j].nu_unresolved, 1) == 0)
+				ResolveChunk(&successor->chunk[j]);
+	}
+}
+
+void dstTaskGraph::Wait() {
+	scheduler->WaitUntilZero(&nu_pending);
+}
@@ -0,0 +1,103 @@
+/*
+
+Copyright (c) 2014 Harm Hanemaaijer <fgenfb@yahoo.com>
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted, provided that the above
+copyright notice and this permission notice appear in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef __DST_TASK_GRAPH_H__
+#define __DST_TASK_GRAPH_H__
+
+// Task dependency graph. Every node is a (subdivided) task, split into chunks with
+// the same semantics as AddSubdividedTaskGroup(). Dependencies between nodes are
+// either full (every chunk of the successor waits until all chunks of the predecessor
+// have finished) or chunk-wise (chunk i of the successor only waits for chunk i of the
+// predecessor), so that a chain of stages operating on the same range is pipelined
+// without a barrier between stages. Chunks become runnable as soon as their
+// dependencies are resolved; a single Wait() at the end is sufficient.
+//
+// The graph must be acyclic. It can be run repeatedly, after Wait() has returned.
+
+#include <dstConfig.h>
+#include <dstDynamicArray.h>
+#include <dstThread.h>
+
+class dstTaskGraph;
+class dstTaskGraphNode;
+
+class DST_API dstTaskGraphChunk {
+public :
+	dstThreadData thread_data;
+	dstTaskGraphNode *node;
+	uint32_t index;
+	// The number of dependencies that have not yet been resolved.
+	volatile int nu_unresolved;
+};
+
+class DST_API dstTaskGraphNode {
+public :
+	dstTaskGraph *graph;
+	dstTaskFunc task_func;
+	int nu_chunks;
+	dstTaskGraphChunk *chunk;
+	// Successor nodes with chunk-wise and full dependencies.
+	dstIntArray chunkwise_successors;
+	dstIntArray successors;
+	int nu_predecessors;
+	// The number of chunks that have not yet finished.
+	volatile int nu_remaining_chunks;
+};
+
+typedef dstCastDynamicArray <dstTaskGraphNode *, void *, int, dstPointerArray>
+	dstTaskGraphNodePointerArray;
+
+class DST_API dstTaskGraph {
+private :
+	dstTaskScheduler *scheduler;
+	dstTaskGraphNodePointerArray node_array;
+	// The number of chunks of the graph that have not yet finished.
+	volatile int nu_pending;
+	// Task flags of the context that called Run().
+	int task_flags;
+
+	void ResolveChunk(dstTaskGraphChunk *chunk);
+
+public :
+	// Use the library task scheduler when scheduler is NULL.
+	dstTaskGraph(dstTaskScheduler *scheduler = NULL);
+	~dstTaskGraph();
+	// Add a node with the given division, returning the node index. The task function
+	// is called once for every non-empty subdivision. A node without subdivisions only
+	// takes part in dependency resolution.
+	int AddNode(dstTaskFunc func, const void *user_data, const dstTaskDivisionData& division);
+	// Add a node consisting of a single task.
+	int AddNode(dstTaskFunc func, const void *user_data);
+	// Make successor depend on predecessor. A chunk-wise dependency requires both nodes to
+	// have the same number of subdivisions; otherwise a full dependency is used.
+	void AddDependency(int predecessor, int successor, bool chunkwise);
+	// Queue the chunks that have no unresolved dependencies. The chunks are queued with
+	// high priority when DST_FLAG_HIGH_PRIORITY is set in the current context.
+	void Run();
+	// Wait until all chunks of the graph have finished, executing queued work in the meantime.
+	void Wait();
+	// Remove all nodes.
+	void Clear();
+	int GetNumberOfNodes() const {
+		return node_array.Size();
+	}
+	// Internal.
+	void FinishChunk(dstTaskGraphChunk *chunk);
+};
+
+#endif
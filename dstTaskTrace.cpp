@@ -0,0 +1,231 @@
+/*
+
+Copyright (c) 2014 Harm Hanemaaijer <fgenfb@yahoo.com>
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted, provided that the above
+copyright notice and this permission notice appear in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "dstMisc.h"
+#include "dstThread.h"
+#include "dstTaskTrace.h"
+
+// The trace buffer of the calling thread for the scheduler with the given trace id.
+static __thread dstTaskTraceBuffer *dst_trace_buffer = NULL;
+static __thread uint32_t dst_trace_buffer_id = 0;
+
+// Identifies a scheduler and its current set of trace buffers in the trace buffer
+// lookup of a thread.
+static volatile int dst_next_trace_id = 0;
+
+uint32_t dstNewTaskTraceID() {
+	return (uint32_t)__sync_add_and_fetch(&dst_next_trace_id, 1);
+}
+
+void dstTaskTraceBuffer::Reset() {
+	nu_events = 0;
+	wait_nesting = 0;
+	wait_start_time = 0;
+	int worker_index = summary.worker_index;
+	memset(&summary, 0, sizeof(summary));
+	summary.worker_index = worker_index;
+}
+
+// Return the trace buffer of the calling thread, creating it when the thread records
+// its first event. A thread that alternates between schedulers finds its buffer in
+// the list again.
+
+dstTaskTraceBuffer *dstTaskScheduler::GetTraceBuffer() {
+	if (dst_trace_buffer_id == trace_id)
+		return dst_trace_buffer;
+	pthread_t self = pthread_self();
+	pthread_mutex_lock(&trace_mutex);
+	dstTaskTraceBuffer *buffer = first_trace_buffer;
+	dstTaskTraceBuffer *last_buffer = NULL;
+	while (buffer != NULL && !pthread_equal(buffer->thread, self)) {
+		last_buffer = buffer;
+		buffer = buffer->next;
+	}
+	if (buffer == NULL) {
+		buffer = new dstTaskTraceBuffer;
+		buffer->events = new dstTaskTraceEvent[trace_buffer_size];
+		buffer->mask = trace_buffer_size - 1;
+		buffer->thread = self;
+		buffer->thread_index = nu_trace_buffers;
+		dstTaskWorker *w = GetCurrentWorker();
+		buffer->summary.worker_index = (w != NULL) ? w->index : - 1;
+		buffer->Reset();
+		buffer->next = NULL;
+		// Keep the buffers in order of thread index.
+		if (last_buffer == NULL)
+			first_trace_buffer = buffer;
+		else
+			last_buffer->next = buffer;
+		nu_trace_buffers++;
+	}
+	pthread_mutex_unlock(&trace_mutex);
+	dst_trace_buffer = buffer;
+	dst_trace_buffer_id = trace_id;
+	return buffer;
+}
+
+static void dstFreeTraceBuffers(dstTaskTraceBuffer *buffer) {
+	while (buffer != NULL) {
+		dstTaskTraceBuffer *next = buffer->next;
+		delete [] buffer->events;
+		delete buffer;
+		buffer = next;
+	}
+}
+
+void dstTaskScheduler::ClearTraceBuffers() {
+	dstFreeTraceBuffers(first_trace_buffer);
+	dstFreeTraceBuffers(retired_trace_buffers);
+	first_trace_buffer = NULL;
+	retired_trace_buffers = NULL;
+	nu_trace_buffers = 0;
+}
+
+void dstTaskScheduler::EnableTracing(uint32_t nu_events) {
+	uint32_t size = 1;
+	while (size < nu_events)
+		size *= 2;
+	pthread_mutex_lock(&trace_mutex);
+	tracing = false;
+	if (first_trace_buffer != NULL) {
+		// Other threads may still be recording in their buffer, so it is neither freed
+		// nor reset. Retire the buffers and change the trace id, so that each thread
+		// creates a new buffer when it records its next event.
+		dstTaskTraceBuffer *last_buffer = first_trace_buffer;
+		while (last_buffer->next != NULL)
+			last_buffer = last_buffer->next;
+		last_buffer->next = retired_trace_buffers;
+		retired_trace_buffers = first_trace_buffer;
+		first_trace_buffer = NULL;
+		nu_trace_buffers = 0;
+		trace_id = dstNewTaskTraceID();
+	}
+	trace_buffer_size = size;
+	trace_start_time = dstGetCurrentTimeNSec();
+	__sync_synchronize();
+	tracing = true;
+	pthread_mutex_unlock(&trace_mutex);
+}
+
+void dstTaskScheduler::DisableTracing() {
+	tracing = false;
+	__sync_synchronize();
+}
+
+int dstTaskScheduler::GetTraceSummary(dstTaskTraceSummary *summary, int max_threads) {
+	pthread_mutex_lock(&trace_mutex);
+	int n = 0;
+	for (dstTaskTraceBuffer *buffer = first_trace_buffer; buffer != NULL && n < max_threads;
+	buffer = buffer->next) {
+		summary[n] = buffer->summary;
+		n++;
+	}
+	pthread_mutex_unlock(&trace_mutex);
+	return n;
+}
+
+static void dstPrintTraceThreadName(char *s, const dstTaskTraceBuffer *buffer) {
+	if (buffer->summary.worker_index >= 0)
+		sprintf(s, "Worker %d", buffer->summary.worker_index);
+	else
+		sprintf(s, "Thread %d", buffer->thread_index);
+}
+
+void dstTaskScheduler::PrintTraceSummary() {
+	pthread_mutex_lock(&trace_mutex);
+	for (dstTaskTraceBuffer *buffer = first_trace_buffer; buffer != NULL;
+	buffer = buffer->next) {
+		const dstTaskTraceSummary *summary = &buffer->summary;
+		char name[32];
+		dstPrintTraceThreadName(name, buffer);
+		printf("%s: %llu items (%llu stolen), %llu queued, run %.3lf ms, "
+			"queue wait %.3lf ms (%.3lf us per item), idle %.3lf ms, wait %.3lf ms\n",
+			name, (unsigned long long)summary->nu_items,
+			(unsigned long long)summary->nu_steals,
+			(unsigned long long)summary->nu_enqueued,
+			(double)summary->run_time * 0.000001d,
+			(double)summary->queue_wait_time * 0.000001d,
+			summary->nu_items > 0 ? (double)summary->queue_wait_time * 0.001d /
+			summary->nu_items : 0.0d,
+			(double)summary->idle_time * 0.000001d,
+			(double)summary->wait_time * 0.000001d);
+	}
+	pthread_mutex_unlock(&trace_mutex);
+}
+
+// Chrome trace event format: begin/end pairs ("B"/"E") for work items, waits and
+// idle periods, instant events ("i") for queueing and stealing, and thread names as
+// metadata. Times are in microseconds.
+
+static const char *dst_trace_event_name[] = {
+	"enqueue", "task", "task", "steal", "wait", "wait", "idle", "idle"
+};
+
+static const char dst_trace_event_phase[] = { 'i', 'B', 'E', 'i', 'B', 'E', 'B', 'E' };
+
+bool dstTaskScheduler::WriteChromeTrace(const char *filename) {
+	FILE *f = fopen(filename, "w");
+	if (f == NULL)
+		return false;
+	pthread_mutex_lock(&trace_mutex);
+	fprintf(f, "{\"traceEvents\":[\n");
+	bool first = true;
+	for (dstTaskTraceBuffer *buffer = first_trace_buffer; buffer != NULL;
+	buffer = buffer->next) {
+		char name[32];
+		dstPrintTraceThreadName(name, buffer);
+		fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+			"\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n", buffer->thread_index, name);
+		first = false;
+		// Only the most recent events are still in the buffer.
+		uint32_t start = 0;
+		if (buffer->nu_events > buffer->mask + 1)
+			start = buffer->nu_events - (buffer->mask + 1);
+		for (uint32_t i = start; i != buffer->nu_events; i++) {
+			const dstTaskTraceEvent *event = &buffer->events[i & buffer->mask];
+			fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3lf,\"pid\":1,\"tid\":%d",
+				dst_trace_event_name[event->type], dst_trace_event_phase[event->type],
+				(double)event->time * 0.001d, buffer->thread_index);
+			switch (event->type) {
+			case DST_TASK_TRACE_ENQUEUE :
+				fprintf(f, ",\"s\":\"t\",\"args\":{\"items\":%llu}",
+					(unsigned long long)event->value);
+				break;
+			case DST_TASK_TRACE_STEAL :
+				fprintf(f, ",\"s\":\"t\",\"args\":{\"victim\":%llu}",
+					(unsigned long long)event->value);
+				break;
+			case DST_TASK_TRACE_START :
+				fprintf(f, ",\"args\":{\"func\":\"%p\",\"subdivision\":%u,"
+					"\"elements\":%u,\"queue_wait_us\":%.3lf}", event->func,
+					event->index, event->nu_elements, (double)event->value * 0.001d);
+				break;
+			}
+			fprintf(f, "}");
+		}
+	}
+	fprintf(f, "\n],\"displayTimeUnit\":\"ns\"}\n");
+	pthread_mutex_unlock(&trace_mutex);
+	return fclose(f) == 0;
+}
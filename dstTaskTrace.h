@@ -0,0 +1,113 @@
+/*
+
+Copyright (c) 2014 Harm Hanemaaijer <fgenfb@yahoo.com>
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted, provided that the above
+copyright notice and this permission notice appear in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+
+#ifndef __DST_TASK_TRACE_H__
+#define __DST_TASK_TRACE_H__
+
+// Scheduler tracing. While tracing is enabled on a dstTaskScheduler (EnableTracing()),
+// every thread that queues, executes or waits for work records timestamped events in
+// a ring buffer of its own, without locking; when a buffer is full, the oldest events
+// are overwritten. Per-thread summary counters are kept next to the buffers and do not
+// depend on the buffer size. After the traced work has finished, the events can be
+// written as Chrome trace JSON (WriteChromeTrace()), which can be loaded in
+// chrome://tracing or Perfetto, and the counters can be retrieved or printed.
+
+#include <pthread.h>
+
+#include <dstConfig.h>
+
+enum {
+	// Work items were queued (value is the number of items).
+	DST_TASK_TRACE_ENQUEUE = 0,
+	// A work item was started (value is the time it spent queued).
+	DST_TASK_TRACE_START,
+	DST_TASK_TRACE_END,
+	// A work item was taken from the queue of another worker (value is its index).
+	DST_TASK_TRACE_STEAL,
+	// The thread waits for a task or group, executing queued work in the meantime.
+	DST_TASK_TRACE_WAIT_BEGIN,
+	DST_TASK_TRACE_WAIT_END,
+	// A worker has no work and spins or sleeps.
+	DST_TASK_TRACE_IDLE_BEGIN,
+	DST_TASK_TRACE_IDLE_END
+};
+
+// Event times are in nanoseconds since tracing was enabled.
+
+class DST_API dstTaskTraceEvent {
+public :
+	uint64_t time;
+	uint64_t value;
+	// Task function and subdivision of START and END events.
+	const void *func;
+	uint32_t type;
+	uint32_t index;
+	uint32_t nu_elements;
+};
+
+// Summary counters of one thread. Times are in nanoseconds.
+
+class DST_API dstTaskTraceSummary {
+public :
+	// Worker index, or -1 for a thread outside the worker pool.
+	int worker_index;
+	uint64_t nu_items;
+	uint64_t nu_steals;
+	uint64_t nu_enqueued;
+	// Time between queueing and starting of the items executed by the thread.
+	uint64_t queue_wait_time;
+	uint64_t run_time;
+	// Time a worker had no work.
+	uint64_t idle_time;
+	// Time spent in waits for tasks or groups (including work executed meanwhile).
+	uint64_t wait_time;
+};
+
+class DST_API dstTaskTraceBuffer {
+public :
+	dstTaskTraceEvent *events;
+	uint32_t mask;
+	// The number of events recorded since tracing was enabled.
+	uint32_t nu_events;
+	// The thread that records in the buffer, and its number in the trace.
+	pthread_t thread;
+	int thread_index;
+	int wait_nesting;
+	uint64_t wait_start_time;
+	dstTaskTraceSummary summary;
+	dstTaskTraceBuffer *next;
+
+	inline dstTaskTraceEvent *Record(uint32_t type, uint64_t time) {
+		dstTaskTraceEvent *event = &events[nu_events & mask];
+		nu_events++;
+		event->time = time;
+		event->value = 0;
+		event->func = NULL;
+		event->type = type;
+		event->index = 0;
+		event->nu_elements = 0;
+		return event;
+	}
+	void Reset();
+};
+
+// Return a new identifier of a set of trace buffers (internal).
+DST_API uint32_t dstNewTaskTraceID();
+
+#endif
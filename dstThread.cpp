@@ -17,23 +17,748 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 
 #include <sched.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <alloca.h>
+#include <new>
+#include <limits.h>
+#include <fcntl.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#endif
 
 #include <dstThread.h>
+#include <dstTaskTrace.h>
+#include <dstAffinity.h>
 #include <dstMisc.h>
+#include <dstMemory.h>
+
+static void *dstInternalWorkerThreadFunc(void *);
+
+// The worker that the calling thread belongs to, or NULL for threads outside
+// of the pool.
+static __thread dstTaskWorker *dst_current_worker = NULL;
+
+// Futex and spin primitives. The callers always re-check the condition they wait
+// for, so spurious wake-ups are harmless; without futex support, waiting threads
+// just yield.
+
+#ifdef __linux__
+
+static void dstFutexWait(volatile int *address, int value) {
+	syscall(SYS_futex, (int *)address, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+static void dstFutexWake(volatile int *address, int n) {
+	syscall(SYS_futex, (int *)address, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+}
+
+#else
+
+static void dstFutexWait(volatile int *address, int value) {
+	sched_yield();
+}
+
+static void dstFutexWake(volatile int *address, int n) {
+}
+
+#endif
+
+static DST_INLINE_ONLY void dstCPURelax() {
+#if defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause();
+#else
+	__sync_synchronize();
+#endif
+}
+
+// Work item deque.
+
+void dstTaskDeque::Initialize() {
+	capacity = 64;
+	items = (dstTaskItem *)malloc(sizeof(dstTaskItem) * capacity);
+	top = 0;
+	bottom = 0;
+	pthread_mutex_init(&mutex, NULL);
+}
 
-static void *dstInternalThreadFunc(void *);
-static void *dstInternalGroupThreadFunc(void *);
+void dstTaskDeque::Destroy() {
+	free(items);
+	pthread_mutex_destroy(&mutex);
+}
+
+void dstTaskDeque::PushBottom(const dstTaskItem& item) {
+	pthread_mutex_lock(&mutex);
+	if (bottom - top == capacity) {
+		// Grow the ring buffer, keeping the items in order.
+		dstTaskItem *new_items = (dstTaskItem *)malloc(sizeof(dstTaskItem) * capacity * 2);
+		for (uint32_t i = top; i != bottom; i++)
+			new_items[i & (capacity * 2 - 1)] = items[i & (capacity - 1)];
+		free(items);
+		items = new_items;
+		capacity *= 2;
+	}
+	items[bottom & (capacity - 1)] = item;
+	bottom++;
+	pthread_mutex_unlock(&mutex);
+}
+
+bool dstTaskDeque::PopBottom(dstTaskItem& item) {
+	pthread_mutex_lock(&mutex);
+	if (bottom == top) {
+		pthread_mutex_unlock(&mutex);
+		return false;
+	}
+	bottom--;
+	item = items[bottom & (capacity - 1)];
+	pthread_mutex_unlock(&mutex);
+	return true;
+}
+
+bool dstTaskDeque::StealTop(dstTaskItem& item, int thief_node) {
+	pthread_mutex_lock(&mutex);
+	if (bottom == top) {
+		pthread_mutex_unlock(&mutex);
+		return false;
+	}
+	const dstTaskItem *top_item = &items[top & (capacity - 1)];
+	if ((top_item->flags & DST_TASK_FLAG_NODE_BOUND) && top_item->node != thief_node) {
+		pthread_mutex_unlock(&mutex);
+		return false;
+	}
+	item = *top_item;
+	top++;
+	pthread_mutex_unlock(&mutex);
+	return true;
+}
+
+// Priority queue of work items.
+
+void dstTaskPriorityQueue::Initialize() {
+	capacity = 64;
+	entries = (dstTaskPriorityQueueEntry *)malloc(sizeof(dstTaskPriorityQueueEntry) * capacity);
+	size = 0;
+	sequence = 0;
+	nu_items = 0;
+	nu_high_priority_items = 0;
+	pthread_mutex_init(&mutex, NULL);
+}
+
+void dstTaskPriorityQueue::Destroy() {
+	free(entries);
+	pthread_mutex_destroy(&mutex);
+}
+
+// Return whether entry a is taken before entry b.
+
+static bool dstTaskPriorityQueueEntryBefore(const dstTaskPriorityQueueEntry& a,
+const dstTaskPriorityQueueEntry& b) {
+	uint32_t a_high = a.item.flags & DST_TASK_FLAG_PRIORITY_HIGH;
+	uint32_t b_high = b.item.flags & DST_TASK_FLAG_PRIORITY_HIGH;
+	if (a_high != b_high)
+		return a_high != 0;
+	uint32_t a_deadline = a.item.flags & DST_TASK_FLAG_DEADLINE;
+	uint32_t b_deadline = b.item.flags & DST_TASK_FLAG_DEADLINE;
+	if (a_deadline != b_deadline)
+		return a_deadline != 0;
+	if (a_deadline != 0 && a.item.deadline != b.item.deadline)
+		return a.item.deadline < b.item.deadline;
+	if (a.item.duration != b.item.duration)
+		return a.item.duration > b.item.duration;
+	return a.sequence < b.sequence;
+}
+
+void dstTaskPriorityQueue::Push(const dstTaskItem& item) {
+	pthread_mutex_lock(&mutex);
+	if (size == capacity) {
+		capacity *= 2;
+		entries = (dstTaskPriorityQueueEntry *)realloc(entries,
+			sizeof(dstTaskPriorityQueueEntry) * capacity);
+	}
+	dstTaskPriorityQueueEntry entry;
+	entry.item = item;
+	entry.sequence = sequence;
+	sequence++;
+	// Sift up.
+	uint32_t i = size;
+	while (i > 0) {
+		uint32_t parent = (i - 1) / 2;
+		if (!dstTaskPriorityQueueEntryBefore(entry, entries[parent]))
+			break;
+		entries[i] = entries[parent];
+		i = parent;
+	}
+	entries[i] = entry;
+	size++;
+	if (item.flags & DST_TASK_FLAG_PRIORITY_HIGH)
+		__sync_fetch_and_add(&nu_high_priority_items, 1);
+	__sync_fetch_and_add(&nu_items, 1);
+	pthread_mutex_unlock(&mutex);
+}
+
+bool dstTaskPriorityQueue::Pop(dstTaskItem& item, bool high_priority_only) {
+	pthread_mutex_lock(&mutex);
+	if (size == 0 || (high_priority_only &&
+	(entries[0].item.flags & DST_TASK_FLAG_PRIORITY_HIGH) == 0)) {
+		pthread_mutex_unlock(&mutex);
+		return false;
+	}
+	item = entries[0].item;
+	size--;
+	// Sift down the last entry from the root.
+	const dstTaskPriorityQueueEntry& last = entries[size];
+	uint32_t i = 0;
+	for (;;) {
+		uint32_t child = i * 2 + 1;
+		if (child >= size)
+			break;
+		if (child + 1 < size && dstTaskPriorityQueueEntryBefore(entries[child + 1],
+		entries[child]))
+			child++;
+		if (!dstTaskPriorityQueueEntryBefore(entries[child], last))
+			break;
+		entries[i] = entries[child];
+		i = child;
+	}
+	entries[i] = last;
+	if (item.flags & DST_TASK_FLAG_PRIORITY_HIGH)
+		__sync_fetch_and_sub(&nu_high_priority_items, 1);
+	__sync_fetch_and_sub(&nu_items, 1);
+	pthread_mutex_unlock(&mutex);
+	return true;
+}
+
+// Task scheduler.
 
 dstTaskScheduler::dstTaskScheduler() {
 	pthread_mutex_init(&task_info_array_mutex, NULL);
 	pthread_mutex_init(&empty_slot_array_mutex, NULL);
+	pthread_mutex_init(&task_group_array_mutex, NULL);
+	pthread_mutex_init(&start_mutex, NULL);
+	pthread_mutex_init(&completion_queue_mutex, NULL);
+#ifdef __linux__
+	completion_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	completion_event_write_fd = completion_event_fd;
+#else
+	int pipe_fd[2];
+	if (pipe(pipe_fd) == 0) {
+		fcntl(pipe_fd[0], F_SETFL, O_NONBLOCK);
+		fcntl(pipe_fd[1], F_SETFL, O_NONBLOCK);
+		completion_event_fd = pipe_fd[0];
+		completion_event_write_fd = pipe_fd[1];
+	}
+	else {
+		completion_event_fd = - 1;
+		completion_event_write_fd = - 1;
+	}
+#endif
+	worker = NULL;
+	nu_workers = 0;
+	next_worker = 0;
+	nu_nodes = 1;
+	node_worker = NULL;
+	node_first_worker[0] = 0;
+	node_first_worker[1] = 0;
+	spin_count = 0;
+	spin_count_set = false;
+	nu_queued = 0;
+	nu_parallel_regions = 0;
+	complete_sequence = 0;
+	nu_complete_waiters = 0;
+	exit_signalled = false;
+	tracing = false;
+	trace_id = dstNewTaskTraceID();
+	trace_start_time = 0;
+	trace_buffer_size = 0;
+	first_trace_buffer = NULL;
+	nu_trace_buffers = 0;
+	retired_trace_buffers = NULL;
+	pthread_mutex_init(&trace_mutex, NULL);
+	priority_queue.Initialize();
+	overflow_deque.Initialize();
 	start_time = dstGetCurrentTimeUSec();
 }
 
 dstTaskScheduler::~dstTaskScheduler() {
+	Stop();
 	ClearTasks();
+	ClearGroups();
 	pthread_mutex_destroy(&task_info_array_mutex);
 	pthread_mutex_destroy(&empty_slot_array_mutex);
+	pthread_mutex_destroy(&task_group_array_mutex);
+	pthread_mutex_destroy(&start_mutex);
+	pthread_mutex_destroy(&completion_queue_mutex);
+	if (completion_event_write_fd != completion_event_fd)
+		close(completion_event_write_fd);
+	if (completion_event_fd >= 0)
+		close(completion_event_fd);
+	priority_queue.Destroy();
+	overflow_deque.Destroy();
+	ClearTraceBuffers();
+	pthread_mutex_destroy(&trace_mutex);
+}
+
+void dstTaskScheduler::Start(int nu_threads, int first_thread) {
+	// Several threads may try to start the pool at the same time when it is started
+	// on demand.
+	pthread_mutex_lock(&start_mutex);
+	if (nu_workers > 0) {
+		pthread_mutex_unlock(&start_mutex);
+		return;
+	}
+	int nu_cpus = dstGetNumberOfAffinityCPUs();
+	const dstNUMATopology *topology = dstGetNUMATopology();
+	nu_threads = maxi(nu_threads, 1);
+	worker = new dstTaskWorker *[nu_threads];
+	exit_signalled = false;
+	// Spinning only pays off when the threads run on different CPUs.
+	if (!spin_count_set)
+		spin_count = (nu_cpus > 1) ? DST_DEFAULT_SPIN_COUNT : 0;
+	// The CPUs of each node that are in the process mask. Workers that are not bound
+	// to a CPU are spread over the nodes that have any, and bound to all of them.
+	cpu_set_t *node_cpu_set = new cpu_set_t[topology->nu_nodes];
+	for (int node = 0; node < topology->nu_nodes; node++)
+		CPU_ZERO(&node_cpu_set[node]);
+	for (int cpu = 0; cpu < topology->nu_cpus && cpu < CPU_SETSIZE; cpu++)
+		if (dstIsCPUInProcessMask(cpu))
+			CPU_SET(cpu, &node_cpu_set[topology->GetNodeOfCPU(cpu)]);
+	int usable_node[DST_MAX_NUMA_NODES];
+	int nu_usable_nodes = 0;
+	for (int node = 0; node < topology->nu_nodes; node++)
+		if (CPU_COUNT(&node_cpu_set[node]) > 0) {
+			usable_node[nu_usable_nodes] = node;
+			nu_usable_nodes++;
+		}
+	if (nu_usable_nodes == 0) {
+		usable_node[0] = 0;
+		nu_usable_nodes = 1;
+	}
+	for (int i = 0; i < nu_threads; i++) {
+		// The worker has members with constructors, so construct it in the aligned
+		// memory.
+		worker[i] = new (dstNewAligned <dstTaskWorker>(1, DST_LINE_SIZE)) dstTaskWorker;
+		worker[i]->state = DST_TASK_WORKER_RUNNING;
+		worker[i]->index = i;
+		worker[i]->cpu = dstGetAffinityCPU(first_thread + i);
+		if (worker[i]->cpu >= 0)
+			worker[i]->node = topology->GetNodeOfCPU(worker[i]->cpu);
+		else
+			worker[i]->node = usable_node[i % nu_usable_nodes];
+		worker[i]->scheduler = this;
+		worker[i]->queue.Initialize(DST_TASK_QUEUE_CAPACITY);
+	}
+	// Group the workers by node.
+	nu_nodes = topology->nu_nodes;
+	node_worker = new int[nu_threads];
+	int n = 0;
+	for (int node = 0; node < nu_nodes; node++) {
+		node_first_worker[node] = n;
+		node_next_worker[node] = 0;
+		for (int i = 0; i < nu_threads; i++)
+			if (worker[i]->node == node) {
+				node_worker[n] = i;
+				n++;
+			}
+	}
+	node_first_worker[nu_nodes] = n;
+	// Make the workers visible to other threads only when they are fully initialized.
+	__sync_synchronize();
+	nu_workers = nu_threads;
+	for (int i = 0; i < nu_threads; i++) {
+		// Set CPU affinity so that each worker is on a different CPU.
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+		if (worker[i]->cpu >= 0) {
+			cpu_set_t cpuset;
+			CPU_ZERO(&cpuset);
+			CPU_SET(worker[i]->cpu, &cpuset);
+			pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpuset);
+		}
+		else if (nu_usable_nodes > 1)
+			// Keep the worker on its node.
+			pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t),
+				&node_cpu_set[worker[i]->node]);
+		pthread_create(&worker[i]->thread, &attr, dstInternalWorkerThreadFunc, worker[i]);
+		pthread_attr_destroy(&attr);
+	}
+	delete [] node_cpu_set;
+	pthread_mutex_unlock(&start_mutex);
+}
+
+void dstTaskScheduler::Stop() {
+	if (nu_workers == 0)
+		return;
+	exit_signalled = true;
+	__sync_synchronize();
+	WakeWorkers(nu_workers, - 1);
+	for (int i = 0; i < nu_workers; i++)
+		pthread_join(worker[i]->thread, NULL);
+	for (int i = 0; i < nu_workers; i++) {
+		worker[i]->~dstTaskWorker();
+		free(worker[i]);
+	}
+	delete [] worker;
+	delete [] node_worker;
+	worker = NULL;
+	node_worker = NULL;
+	nu_workers = 0;
+	next_worker = 0;
+	nu_nodes = 1;
+}
+
+dstTaskWorker *dstTaskScheduler::GetCurrentWorker() const {
+	if (dst_current_worker != NULL && dst_current_worker->scheduler == this)
+		return dst_current_worker;
+	return NULL;
+}
+
+// Queue work items. Prioritized items go to the priority queue. Items for a specific
+// NUMA node go to the workers of that node in round-robin fashion. Other items added
+// from within a worker go to the worker's own queue, and the remaining items are
+// distributed over all workers.
+
+void dstTaskScheduler::QueueItems(dstTaskItem *items, int n) {
+	if (nu_workers == 0)
+		Start(maxi(dst_config.nu_cpus - 1, 1), 1);
+	dstTaskWorker *current_worker = GetCurrentWorker();
+	uint64_t queue_time = 0;
+	if (tracing) {
+		queue_time = dstGetCurrentTimeNSec();
+		dstTaskTraceBuffer *buffer = GetTraceBuffer();
+		buffer->Record(DST_TASK_TRACE_ENQUEUE, queue_time - trace_start_time)->value = n;
+		buffer->summary.nu_enqueued += n;
+	}
+	for (int i = 0; i < n; i++)
+		items[i].queue_time = queue_time;
+	// Increase the queued count before the items are visible, so that it never
+	// drops below zero.
+	__sync_fetch_and_add(&nu_queued, n);
+	if (nu_nodes == 1) {
+		for (int i = 0; i < n; i++) {
+			if (dstTaskItemIsPrioritized(items[i]))
+				priority_queue.Push(items[i]);
+			else if (current_worker != NULL)
+				PushItem(current_worker, items[i]);
+			else {
+				// Several application threads may queue work at the same time.
+				uint32_t w = (uint32_t)__sync_fetch_and_add(&next_worker, 1) % nu_workers;
+				PushItem(worker[w], items[i]);
+			}
+		}
+		WakeWorkers(n, - 1);
+		return;
+	}
+	int nu_node_items[DST_MAX_NUMA_NODES];
+	for (int node = 0; node < nu_nodes; node++)
+		nu_node_items[node] = 0;
+	int nu_other_items = 0;
+	for (int i = 0; i < n; i++) {
+		int node = items[i].node;
+		if (dstTaskItemIsPrioritized(items[i])) {
+			priority_queue.Push(items[i]);
+			nu_other_items++;
+		}
+		else if (node >= 0 && GetNumberOfWorkers(node) > 0 &&
+		(current_worker == NULL || current_worker->node != node)) {
+			int j = (uint32_t)__sync_fetch_and_add(&node_next_worker[node], 1) %
+				GetNumberOfWorkers(node);
+			PushItem(worker[node_worker[node_first_worker[node] + j]], items[i]);
+			nu_node_items[node]++;
+		}
+		else if (current_worker != NULL) {
+			PushItem(current_worker, items[i]);
+			nu_other_items++;
+		}
+		else {
+			uint32_t w = (uint32_t)__sync_fetch_and_add(&next_worker, 1) % nu_workers;
+			PushItem(worker[w], items[i]);
+			nu_other_items++;
+		}
+	}
+	for (int node = 0; node < nu_nodes; node++)
+		if (nu_node_items[node] > 0)
+			WakeWorkers(nu_node_items[node], node);
+	if (nu_other_items > 0)
+		WakeWorkers(nu_other_items, - 1);
+}
+
+int dstTaskScheduler::GetSubdivisionNode(const dstTaskDivisionData& division,
+uint32_t start_index, uint32_t nu_elements) const {
+	if (nu_nodes == 1 || division.size == 0)
+		return - 1;
+	return dstGetNUMATopology()->GetNodeOfElement(start_index + nu_elements / 2,
+		division.size);
+}
+
+void dstTaskScheduler::QueueWorkItem(int flags, dstTaskFunc func,
+const dstThreadData& thread_data, volatile int *nu_pending, dstTaskCompleteFunc complete_func,
+void *complete_data) {
+	dstTaskItem item;
+	item.flags = flags;
+	item.node = - 1;
+	item.task_func = func;
+	item.thread_data = thread_data;
+	item.nu_pending = nu_pending;
+	item.complete_func = complete_func;
+	item.complete_data = complete_data;
+	item.duration = 0;
+	item.deadline = 0;
+	item.notify_index = - 1;
+	item.dynamic_division = NULL;
+	QueueItems(&item, 1);
+}
+
+void dstTaskScheduler::QueueWorkItemOnNode(int node, int flags, dstTaskFunc func,
+const dstThreadData& thread_data, volatile int *nu_pending) {
+	dstTaskItem item;
+	item.flags = flags;
+	item.node = node;
+	item.task_func = func;
+	item.thread_data = thread_data;
+	item.nu_pending = nu_pending;
+	item.complete_func = NULL;
+	item.duration = 0;
+	item.deadline = 0;
+	item.notify_index = - 1;
+	item.dynamic_division = NULL;
+	QueueItems(&item, 1);
+}
+
+// Wake up to n sleeping workers, preferably on the given node. A worker sets its state
+// to sleeping before checking the queued count a final time, and the queued count is
+// increased before the worker states are checked here, so a wake-up cannot be lost.
+
+void dstTaskScheduler::WakeWorkers(int n, int node) {
+	__sync_synchronize();
+	for (int pass = (node >= 0) ? 0 : 1; pass < 2; pass++)
+		for (int i = 0; i < nu_workers && n > 0; i++) {
+			dstTaskWorker *w = worker[i];
+			if (pass == 0 && w->node != node)
+				continue;
+			if (w->state == DST_TASK_WORKER_SLEEPING && __sync_bool_compare_and_swap(
+			&w->state, DST_TASK_WORKER_SLEEPING, DST_TASK_WORKER_RUNNING)) {
+				dstFutexWake(&w->state, 1);
+				n--;
+			}
+		}
+}
+
+void dstTaskScheduler::BeginParallelRegion() {
+	__sync_fetch_and_add(&nu_parallel_regions, 1);
+	// Get the workers spinning.
+	if (spin_count > 0)
+		WakeWorkers(nu_workers, - 1);
+}
+
+void dstTaskScheduler::EndParallelRegion() {
+	__sync_fetch_and_sub(&nu_parallel_regions, 1);
+}
+
+// Take a work item: first a high-priority item, then from the queue of the current
+// worker (if any), then another prioritized item, then by stealing from the queues of
+// the other workers, those on the same node first, and finally from the overflow
+// deque. A stolen item that is bound to another node is put back.
+
+bool dstTaskScheduler::TakeItem(dstTaskWorker *current_worker, dstTaskItem& item) {
+	if (nu_queued == 0)
+		return false;
+	if (priority_queue.nu_high_priority_items > 0 && priority_queue.Pop(item, true))
+		goto found;
+	int start;
+	int first_pass;
+	start = 0;
+	first_pass = 1;
+	int thief_node;
+	thief_node = (current_worker != NULL) ? current_worker->node : - 1;
+	if (current_worker != NULL) {
+		if (current_worker->queue.Dequeue(item))
+			goto found;
+		start = current_worker->index + 1;
+		if (nu_nodes > 1)
+			first_pass = 0;
+	}
+	if (priority_queue.nu_items > 0 && priority_queue.Pop(item, false))
+		goto found;
+	for (int pass = first_pass; pass < 2; pass++)
+		for (int i = 0; i < nu_workers; i++) {
+			int victim = (start + i) % nu_workers;
+			if (worker[victim] == current_worker)
+				continue;
+			if (pass == 0 && worker[victim]->node != current_worker->node)
+				continue;
+			if (worker[victim]->queue.Dequeue(item)) {
+				if ((item.flags & DST_TASK_FLAG_NODE_BOUND) == 0 ||
+				item.node == thief_node) {
+					if (tracing) {
+						dstTaskTraceBuffer *buffer = GetTraceBuffer();
+						buffer->Record(DST_TASK_TRACE_STEAL, GetTraceTime())->value =
+							victim;
+						buffer->summary.nu_steals++;
+					}
+					goto found;
+				}
+				PushItem(worker[victim], item);
+			}
+		}
+	if (overflow_deque.StealTop(item, thief_node))
+		goto found;
+	return false;
+found :
+	__sync_fetch_and_sub(&nu_queued, 1);
+	return true;
+}
+
+void dstTaskScheduler::RunItem(dstTaskItem& item) {
+	dstTaskTraceBuffer *buffer = NULL;
+	uint64_t start_time;
+	if (tracing) {
+		buffer = GetTraceBuffer();
+		start_time = GetTraceTime();
+		dstTaskTraceEvent *event = buffer->Record(DST_TASK_TRACE_START, start_time);
+		event->func = (const void *)item.task_func;
+		event->index = item.thread_data.subdivision.index;
+		event->nu_elements = item.thread_data.subdivision.nu_elements;
+		// Items queued before tracing was enabled have no queue time.
+		if (item.queue_time >= trace_start_time && item.queue_time != 0) {
+			event->value = start_time + trace_start_time - item.queue_time;
+			buffer->summary.queue_wait_time += event->value;
+		}
+	}
+	if (item.dynamic_division == NULL)
+		item.task_func(&item.thread_data);
+	else
+		while (item.dynamic_division->TakeChunk(item.thread_data.subdivision.start_index,
+		item.thread_data.subdivision.nu_elements))
+			item.task_func(&item.thread_data);
+	if (buffer != NULL) {
+		uint64_t end_time = GetTraceTime();
+		dstTaskTraceEvent *event = buffer->Record(DST_TASK_TRACE_END, end_time);
+		event->func = (const void *)item.task_func;
+		event->index = item.thread_data.subdivision.index;
+		buffer->summary.nu_items++;
+		buffer->summary.run_time += end_time - start_time;
+	}
+	// Waiting threads only check the pending counter, so the completion work of the
+	// last item has to be done before the counter reaches zero. The counter is only
+	// decremented while it is larger than one; the item that finds it at one is the
+	// last, because every other item has already decremented it.
+	int n = *item.nu_pending;
+	while (n > 1) {
+		int previous = __sync_val_compare_and_swap(item.nu_pending, n, n - 1);
+		if (previous == n)
+			return;
+		n = previous;
+	}
+	if (item.flags & DST_TASK_FLAG_FREE_USER_DATA)
+		free((void *)item.thread_data.user_data);
+	if (item.complete_func != NULL)
+		item.complete_func(item.complete_data);
+	if (item.notify_index >= 0)
+		PostCompletionNotification(item.notify_index);
+	if ((item.flags & DST_TASK_FLAG_COMPLETION_FREES_COUNTER) == 0)
+		__sync_sub_and_fetch(item.nu_pending, 1);
+	__sync_fetch_and_add(&complete_sequence, 1);
+	if (nu_complete_waiters > 0)
+		dstFutexWake(&complete_sequence, INT_MAX);
+}
+
+// Wait until a pending counter reaches zero, executing queued work in the meantime.
+
+void dstTaskScheduler::WaitForCompletion(volatile int *nu_pending) {
+	dstTaskWorker *current_worker = GetCurrentWorker();
+	dstTaskTraceBuffer *buffer = NULL;
+	if (tracing && *nu_pending > 0) {
+		buffer = GetTraceBuffer();
+		uint64_t time = GetTraceTime();
+		buffer->Record(DST_TASK_TRACE_WAIT_BEGIN, time);
+		// Work executed while waiting may wait itself; only the outer wait is counted.
+		if (buffer->wait_nesting == 0)
+			buffer->wait_start_time = time;
+		buffer->wait_nesting++;
+	}
+	int spin = 0;
+	while (*nu_pending > 0) {
+		dstTaskItem item;
+		if (TakeItem(current_worker, item)) {
+			RunItem(item);
+			continue;
+		}
+		// All remaining work is being executed by other threads. Spin for a while,
+		// then block until the next completion.
+		if (spin < spin_count) {
+			dstCPURelax();
+			spin++;
+			continue;
+		}
+		__sync_fetch_and_add(&nu_complete_waiters, 1);
+		int sequence = complete_sequence;
+		__sync_synchronize();
+		if (*nu_pending > 0)
+			dstFutexWait(&complete_sequence, sequence);
+		__sync_fetch_and_sub(&nu_complete_waiters, 1);
+	}
+	// Make sure the results written by other threads are visible.
+	__sync_synchronize();
+	if (buffer != NULL && buffer->wait_nesting > 0) {
+		uint64_t time = GetTraceTime();
+		buffer->Record(DST_TASK_TRACE_WAIT_END, time);
+		buffer->wait_nesting--;
+		if (buffer->wait_nesting == 0)
+			buffer->summary.wait_time += time - buffer->wait_start_time;
+	}
+}
+
+void dstTaskScheduler::RunWorker(dstTaskWorker *w) {
+	dst_current_worker = w;
+	// Start of the current period without work, while tracing.
+	bool idle = false;
+	uint64_t idle_start_time = 0;
+	for (;;) {
+		dstTaskItem item;
+		if (TakeItem(w, item)) {
+			if (idle) {
+				idle = false;
+				if (tracing) {
+					dstTaskTraceBuffer *buffer = GetTraceBuffer();
+					uint64_t time = GetTraceTime();
+					buffer->Record(DST_TASK_TRACE_IDLE_END, time);
+					if (time >= idle_start_time)
+						buffer->summary.idle_time += time - idle_start_time;
+				}
+			}
+			RunItem(item);
+			continue;
+		}
+		if (!idle && tracing) {
+			idle = true;
+			idle_start_time = GetTraceTime();
+			GetTraceBuffer()->Record(DST_TASK_TRACE_IDLE_BEGIN, idle_start_time);
+		}
+		// Spin for a while, or for as long as a parallel region is active.
+		int spin = 0;
+		while (nu_queued == 0 && !exit_signalled && (spin < spin_count ||
+		(spin_count > 0 && nu_parallel_regions > 0))) {
+			dstCPURelax();
+			spin++;
+		}
+		if (nu_queued > 0)
+			continue;
+		if (exit_signalled)
+			break;
+		// Block until woken by WakeWorkers().
+		w->state = DST_TASK_WORKER_SLEEPING;
+		__sync_synchronize();
+		if (nu_queued > 0 || exit_signalled) {
+			w->state = DST_TASK_WORKER_RUNNING;
+			continue;
+		}
+		while (w->state == DST_TASK_WORKER_SLEEPING)
+			dstFutexWait(&w->state, DST_TASK_WORKER_SLEEPING);
+	}
+	dst_current_worker = NULL;
 }
 
 int dstTaskDivisionData::CalculateSubdivision(uint32_t index, uint32_t &start_index, uint32_t &nu_elements) const {
@@ -56,9 +781,111 @@ int dstTaskDivisionData::CalculateSubdivision(uint32_t index, uint32_t &start_in
 	return 0;
 }
 
+void dstTaskDivisionData::SetDynamicMode(uint32_t m, uint32_t element_size,
+uint32_t cost_per_element) {
+	mode = m;
+	min_chunk_size = 1;
+	if (element_size > 0 && element_size < DST_LINE_SIZE)
+		min_chunk_size = DST_LINE_SIZE / element_size;
+	max_chunk_size = 0;
+	if (cost_per_element > 0) {
+		max_chunk_size = DST_TASK_CHUNK_COST_TARGET / cost_per_element;
+		if (max_chunk_size == 0)
+			max_chunk_size = 1;
+	}
+}
+
+uint32_t dstTaskDivisionData::CalculateChunkSize(uint32_t remaining) const {
+	uint32_t chunk_size;
+	if (mode == DST_TASK_DIVISION_GUIDED)
+		// Half of an equal share of the remaining elements.
+		chunk_size = remaining / (nu_subdivisions * 2);
+	else
+		chunk_size = size / (nu_subdivisions * DST_TASK_DYNAMIC_CHUNKS_PER_ITEM);
+	if (max_chunk_size != 0 && chunk_size > max_chunk_size)
+		chunk_size = max_chunk_size;
+	uint32_t min_size = GetMinimumChunkSize();
+	if (chunk_size < min_size)
+		chunk_size = min_size;
+	// Round up to the alignment, so that every chunk starts at an aligned index.
+	if (alignment > 1)
+		chunk_size = ((chunk_size + alignment - 1) / alignment) * alignment;
+	if (chunk_size > remaining)
+		chunk_size = remaining;
+	return chunk_size;
+}
+
+bool dstTaskDynamicDivision::TakeChunk(uint32_t& start_index, uint32_t& nu_elements) {
+	for (;;) {
+		uint32_t index = next_index;
+		if (index >= division.size)
+			return false;
+		uint32_t n = division.CalculateChunkSize(division.size - index);
+		if (__sync_bool_compare_and_swap(&next_index, index, index + n)) {
+			start_index = index;
+			nu_elements = n;
+			return true;
+		}
+	}
+}
+
+// Fill in the work items of a subdivided task group, returning the number of items.
+// Subdivisions without elements are left out. With a dynamic division, there is one
+// item per subdivision (as far as there are chunks of the minimum size) that takes
+// chunks from the given counter.
+
+int dstTaskScheduler::InitializeGroupItems(dstTaskItem *items, int flags, dstTaskFunc func,
+const void *user_data, const dstTaskDivisionData& division,
+dstTaskDynamicDivision *dynamic_division, volatile int *nu_pending,
+dstTaskCompleteFunc complete_func, void *complete_data, uint64_t deadline) {
+	uint32_t nu_subdivisions = division.nu_subdivisions;
+	if (division.mode == DST_TASK_DIVISION_STATIC)
+		dynamic_division = NULL;
+	else {
+		dynamic_division->division = division;
+		dynamic_division->next_index = 0;
+		uint32_t min_size = division.GetMinimumChunkSize();
+		uint32_t nu_chunks = division.size / min_size + (division.size % min_size != 0);
+		if (nu_chunks < nu_subdivisions)
+			nu_subdivisions = nu_chunks;
+	}
+	int nu_items = 0;
+	for (uint32_t i = 0; i < nu_subdivisions; i++) {
+		uint32_t start_index = 0;
+		uint32_t nu_elements = 0;
+		if (dynamic_division == NULL) {
+			int r = division.CalculateSubdivision(i, start_index, nu_elements);
+			if (r < 0)
+				// Subdivision operates on zero elements, and does not need to be queued.
+				continue;
+			items[nu_items].node = GetSubdivisionNode(division, start_index, nu_elements);
+		}
+		else
+			// The chunks are taken at run time, so the item may run on any node.
+			items[nu_items].node = - 1;
+		items[nu_items].flags = flags;
+		items[nu_items].task_func = func;
+		items[nu_items].thread_data.user_data = user_data;
+		items[nu_items].thread_data.subdivision.start_index = start_index;
+		items[nu_items].thread_data.subdivision.nu_elements = nu_elements;
+		items[nu_items].thread_data.subdivision.index = i;
+		items[nu_items].nu_pending = nu_pending;
+		items[nu_items].complete_func = complete_func;
+		items[nu_items].complete_data = complete_data;
+		items[nu_items].duration = 0;
+		items[nu_items].deadline = deadline;
+		items[nu_items].notify_index = - 1;
+		items[nu_items].dynamic_division = dynamic_division;
+		nu_items++;
+	}
+	return nu_items;
+}
+
 int dstTaskScheduler::AddTask(int flags, dstTaskFunc func, const void *_user_data,
-dstTaskDurationEstimate e, const dstTaskDivisionData& division, uint32_t division_index) {
-	uint32_t start_index, nu_elements;
+dstTaskDurationEstimate e, const dstTaskDivisionData& division, uint32_t division_index,
+uint64_t deadline, dstTaskCompleteFunc complete_func, void *complete_data) {
+	uint32_t start_index = 0;
+	uint32_t nu_elements = 0;
 	if (division.size != 0) {
 		int r = division.CalculateSubdivision(division_index, start_index, nu_elements);
 		if (r < 0)
@@ -67,16 +894,13 @@ dstTaskDurationEstimate e, const dstTaskDivisionData& division, uint32_t divisio
 	dstTaskInfo *task_info;
 	int array_index;
 	LockMutexEmptySlotArray();
-	bool new_thread;
 	if (empty_slot_array.Size() > 0) {
-		// Use an existing slot for which a thread already exists.
+		// Reuse the slot of a task that has finished and has been waited for.
 		int empty_slot_index = empty_slot_array.Pop();
 		UnlockMutexEmptySlotArray();
 		LockMutexTaskInfoArray();
 		task_info = task_info_array.Get(empty_slot_index);
 		array_index = empty_slot_index;
-		new_thread = false;
-//		printf("Empty slot = %d\n", index);
 	}
 	else {
 		UnlockMutexEmptySlotArray();
@@ -84,170 +908,76 @@ dstTaskDurationEstimate e, const dstTaskDivisionData& division, uint32_t divisio
 		LockMutexTaskInfoArray();
 		array_index = task_info_array.Size();
 		task_info_array.Add(task_info);
-		new_thread = true;
 	}
         task_info->flags = flags;
 	task_info->task_func = func;
 	task_info->duration_estimate = e;
+	task_info->deadline = deadline;
 	task_info->creation_time = dstGetCurrentTimeUSec() - start_time;
 	task_info->user_data = _user_data;
-	task_info->complete_signal = DST_TASK_THREAD_WAIT;
-	if (division.size != 0) {
-		task_info->subdivision.start_index = start_index;
-		task_info->subdivision.nu_elements = nu_elements;
-//		printf("AddTask: slot = %d, start_index = %d, nu_elements = %d.\n",
-//			array_index, start_index, nu_elements);
-//		fflush(stdout);
-	}
-	if (new_thread) {
-		// Create mutex and conditions for this thread.
-		pthread_mutex_init(&task_info->continue_mutex, NULL);
-		pthread_cond_init(&task_info->continue_condition, NULL);
-		task_info->continue_signal = DST_TASK_THREAD_WAIT;
-		pthread_mutex_init(&task_info->complete_mutex, NULL);
-		pthread_cond_init(&task_info->complete_condition, NULL);
-	}
+	task_info->subdivision.start_index = start_index;
+	task_info->subdivision.nu_elements = nu_elements;
+	task_info->subdivision.index = division_index;
+	task_info->nu_pending = 1;
 	UnlockMutexTaskInfoArray();
-	if (new_thread) {
-		// Create the thread.
-		pthread_create(&task_info->thread, NULL, dstInternalThreadFunc, task_info);
-	}
-	else {
-		// Signal the thread to continue and start working on the new
-		// task.
-		task_info->continue_signal = DST_TASK_THREAD_CONTINUE;
-		task_info->LockMutexContinue();
-		pthread_cond_signal(&task_info->continue_condition);
-		task_info->UnlockMutexContinue();
-	}
+
+	dstTaskItem item;
+	item.flags = flags;
+	item.task_func = func;
+	item.thread_data = *(dstThreadData *)task_info;
+	item.nu_pending = &task_info->nu_pending;
+	item.complete_func = complete_func;
+	item.complete_data = complete_data;
+	item.notify_index = (flags & DST_TASK_FLAG_NOTIFY_COMPLETION) ? array_index : - 1;
+	item.node = GetSubdivisionNode(division, start_index, nu_elements);
+	item.duration = 0;
+	if ((flags & DST_TASK_FLAG_DURATION_ESTIMATE) && e.unit_type == DST_TASK_DURATION_UNIT_USEC)
+		item.duration = e.duration;
+	item.deadline = deadline;
+	item.dynamic_division = NULL;
+	QueueItems(&item, 1);
 	return array_index;
 }
 
 
 int dstTaskScheduler::AddSubdividedTaskGroup(int flags, dstTaskFunc func, const void *user_data,
-dstTaskDivisionData& division) {
-	// Find an inactive task group of the right size.
-	int current_group_index = - 1;
-	for (uint32_t i = 0; i < task_group_array.Size(); i++) {
-		dstTaskGroup *group = task_group_array.Get(i);
-		if (group->member_array.Size() == division.nu_subdivisions) {
-			// The size matches.
-			pthread_mutex_lock(&group->complete_mutex);
-			bool inactive = (group->nu_active_members == 0);
-			pthread_mutex_unlock(&group->complete_mutex);
-			if (inactive) {
-				// All threads are inactive, so use it.
-				current_group_index = i;
-				break;
-			}
-		}
-	}
-	bool new_task_group = (current_group_index < 0);
-
+dstTaskDivisionData& division, uint64_t deadline, dstTaskCompleteFunc complete_func,
+void *complete_data) {
+	// Use the slot of a group that has been waited for, or create a new one.
+	int current_group_index;
 	dstTaskGroup *group;
-	if (new_task_group) {
+	LockMutexTaskGroupArray();
+	if (empty_group_array.Size() > 0) {
+		current_group_index = empty_group_array.Pop();
+		group = task_group_array.Get(current_group_index);
+	}
+	else {
 		group = new dstTaskGroup;
-		pthread_mutex_init(&group->continue_mutex, NULL);
-		pthread_cond_init(&group->continue_condition, NULL);
-		pthread_mutex_init(&group->complete_mutex, NULL);
-		pthread_cond_init(&group->complete_condition, NULL);
-		group->nu_active_members = 0;
 		current_group_index = task_group_array.Size();
 		task_group_array.Add(group);
-//		group->member_array.SetCapacity(division.nu_subdivisions);
 	}
-	else
-		group = task_group_array.Get(current_group_index);
+	group->released = false;
+	// Protect the group against WaitUntilFinished() until the items are queued.
+	group->nu_active_members = 1;
+	UnlockMutexTaskGroupArray();
 
-	// Set the number of active threads. It will take a little while for them to be really active,
-	// but we are only concerned about the value reaching zero.
-	group->nu_active_members = division.nu_subdivisions;
-
-	for (uint32_t i = 0; i < division.nu_subdivisions; i++) {
-		uint32_t start_index, nu_elements;
-		int r = division.CalculateSubdivision(i, start_index, nu_elements);
-		if (r < 0)
-			// Thread operates on zero elements, and does not need to do anything.
-			;
-		dstThreadData thread_data;
-		thread_data.user_data = user_data;
-		thread_data.subdivision.start_index = start_index;
-		thread_data.subdivision.nu_elements = nu_elements;
-
-		uint32_t current_member_index = i;
-		if (new_task_group) {
-			// Create a new task group member.
-#if 0
-			dstTaskGroupMember *member = new dstTaskGroupMember;
-			member->group = group;
-			member->flags = flags;
-			member->task_func = func;
-			member->continue_signal = DST_TASK_THREAD_WAIT;
-			dstThreadDataQueue queue;
-			member->thread_data_queue = queue;
-			member->thread_data_queue.Enqueue(thread_data);
-			group->member_array.Add((const dstTaskGroupMember &)*member);
-			delete member;
-#else
-			dstTaskGroupMember member;
-			member.group = group;
-			member.flags = flags;
-			member.task_func = func;
-			member.continue_signal = DST_TASK_THREAD_WAIT;
-			// Is thread_data_queue initialized properly?
-			dstThreadDataQueue thread_data_queue;
-			member.thread_data_queue = thread_data_queue;
-			member.thread_data_queue.Enqueue(thread_data);
-			group->member_array.Add((const dstTaskGroupMember &)member);
-#endif
-		}
-		else {
-			// Use the existing group member data. The mutex is still valid.
-			dstTaskGroupMember *member_p =
-				&group->member_array.DataPointer()[current_member_index];
-			// flags and task_func are expected to remain the unchanged.
-//			member_p->flags = flags;
-//			member_p->task_func = func;
-//			member_p->continue_signal = DST_TASK_THREAD_WAIT;
-			// When adding an additional task for an existing group thread, lock the mutex for
-			// the queue.
-			pthread_mutex_lock(&member_p->thread_data_queue_mutex);
-			member_p->thread_data_queue.Enqueue(thread_data);
-			pthread_mutex_unlock(&member_p->thread_data_queue_mutex);
-		}
-
-		dstThreadData temp;
-		temp = group->member_array.Get(current_member_index).thread_data_queue.Peek();
-//		printf("Thread data: user_data = %p, start_index = %u, nu_elements = %u\n",
-//			temp.user_data, temp.subdivision.start_index, temp.subdivision.nu_elements);
-
-		if (new_task_group) {
-			dstTaskGroupMember *member_p = &group->member_array.Get(current_member_index);
-			pthread_mutex_init(&member_p->thread_data_queue_mutex, NULL);
-			// Create the thread. For group threads, the task will not start until the
-			// continue signal is given. Set CPU affinity so that each thread is on a
-			// a different CPU. Start with the CPU the main library thread is on.
-			pthread_attr_t attr;
-			pthread_attr_init(&attr);
-			cpu_set_t cpuset;
-			CPU_ZERO(&cpuset);
-			CPU_SET((dst_config.main_thread_cpu + current_member_index)
-				% dst_config.nu_cpus, &cpuset);
-			pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpuset);
-			pthread_create(&member_p->thread, &attr, dstInternalGroupThreadFunc, member_p);
-			pthread_attr_destroy(&attr);
-		}
+	dstTaskItem *items = (dstTaskItem *)alloca(sizeof(dstTaskItem) * division.nu_subdivisions);
+	int nu_items = InitializeGroupItems(items, flags, func, user_data, division,
+		&group->dynamic_division, &group->nu_active_members, complete_func, complete_data,
+		deadline);
+	if (nu_items > 0) {
+		// Replace the guard by the number of items before they become visible.
+		group->nu_active_members = nu_items;
+		QueueItems(items, nu_items);
 	}
-
-	// Broadcast the continue signal.
-	for (uint32_t i = 0; i < division.nu_subdivisions; i++) {
-		dstTaskGroupMember *member = &group->member_array.DataPointer()[i];
-		member->continue_signal = DST_TASK_THREAD_CONTINUE;
+	else {
+		if (flags & DST_TASK_FLAG_FREE_USER_DATA)
+			free((void *)user_data);
+		if (complete_func != NULL)
+			complete_func(complete_data);
+		__sync_synchronize();
+		group->nu_active_members = 0;
 	}
-	pthread_mutex_lock(&group->continue_mutex);
-	pthread_cond_broadcast(&group->continue_condition);
-	pthread_mutex_unlock(&group->continue_mutex);
-
 	return current_group_index;
 }
 
@@ -263,18 +993,7 @@ void dstTaskScheduler::WaitUntilFinished(int task_index) {
 	}
 	UnlockMutexTaskInfoArray();
 
-	// Wait for completion.
-	pthread_mutex_lock(&task_info->complete_mutex);
-	int r = 0;
-	while (task_info->complete_signal == DST_TASK_THREAD_WAIT && r == 0) {
-		r = pthread_cond_wait(&task_info->complete_condition,
-			&task_info->complete_mutex);
-	}
-	if (r != 0) {
-		printf("pthread_cond_wait returned error.\n");
-		exit(1);
-	}
-	pthread_mutex_unlock(&task_info->complete_mutex);
+	WaitForCompletion(&task_info->nu_pending);
 
 	LockMutexTaskInfoArray();
 	task_info->flags |= DST_TASK_FLAG_COMPLETED;
@@ -285,88 +1004,77 @@ void dstTaskScheduler::WaitUntilFinished(int task_index) {
 }
 
 void dstTaskScheduler::WaitUntilGroupFinished(int group_index) {
+	LockMutexTaskGroupArray();
 	dstTaskGroup *group = task_group_array.Get(group_index);
-	if (group->member_array.Size() == 0)
-		return;
-	pthread_mutex_lock(&group->complete_mutex);
-	int r = 0;
-	while (group->nu_active_members > 0 && r == 0) {
-		r = pthread_cond_wait(&group->complete_condition,
-			&group->complete_mutex);
+	UnlockMutexTaskGroupArray();
+	WaitForCompletion(&group->nu_active_members);
+	LockMutexTaskGroupArray();
+	if (!group->released) {
+		group->released = true;
+		empty_group_array.Add(group_index);
 	}
-	if (r != 0) {
-		printf("pthread_cond_wait returned error.\n");
-		exit(1);
-	}
-	pthread_mutex_unlock(&group->complete_mutex);
+	UnlockMutexTaskGroupArray();
 }
 
 void dstTaskScheduler::WaitUntilFinished() {
-	for (uint32_t i = 0; i < task_info_array.Size(); i++)
+	LockMutexTaskInfoArray();
+	uint32_t nu_tasks = task_info_array.Size();
+	UnlockMutexTaskInfoArray();
+	for (uint32_t i = 0; i < nu_tasks; i++)
 		WaitUntilFinished(i);
-	for (uint32_t i = 0; i < task_group_array.Size(); i++)
+	LockMutexTaskGroupArray();
+	uint32_t nu_groups = task_group_array.Size();
+	UnlockMutexTaskGroupArray();
+	for (uint32_t i = 0; i < nu_groups; i++)
 		WaitUntilGroupFinished(i);
-//	ClearTasks();
-//	ClearGroups();
 }
 
 void dstTaskScheduler::ClearTasks() {
-	// Clear task info array, stopping each thread, assuming all tasks have finished
-	// already.
+	// Clear task info array, assuming all tasks have finished already.
 	uint32_t n = task_info_array.Size();
-	for (uint32_t i = 0; i < n; i++) {
-		dstTaskInfo *task_info = task_info_array.Get(i);
-		task_info->continue_signal = DST_TASK_THREAD_EXIT;
-		pthread_cond_signal(&task_info->continue_condition);
-		pthread_join(task_info->thread, NULL);
-		pthread_cond_destroy(&task_info->continue_condition);
-		pthread_mutex_destroy(&task_info->continue_mutex);
-		pthread_cond_destroy(&task_info->complete_condition);
-		pthread_mutex_destroy(&task_info->complete_mutex);
-		delete task_info;
-	}
+	for (uint32_t i = 0; i < n; i++)
+		delete task_info_array.Get(i);
 	task_info_array.Truncate(0);
 	empty_slot_array.Truncate(0);
 }
 
 void dstTaskScheduler::ClearGroups() {
-	// Clear task groups, stopping each thread, assuming all tasks have finished
-	// already.
+	// Clear task groups, assuming all tasks have finished already.
 	uint32_t n = task_group_array.Size();
-	for (uint32_t i = 0; i < n; i++) {
-		dstTaskGroup *group = task_group_array.Get(i);
-		if (group->member_array.Size() == 0)
-			continue;
-		for (uint32_t j = 0; j < group->member_array.Size(); j++) {
-			dstTaskGroupMember *member = &group->member_array.Get(i);
-			member->continue_signal = DST_TASK_THREAD_EXIT;
-		}
-		pthread_cond_signal(&group->continue_condition);
-		for (uint32_t j = 0; j < group->member_array.Size(); j++)
-			pthread_join(group->member_array.Get(j).thread, NULL);
-		pthread_cond_destroy(&group->continue_condition);
-		pthread_mutex_destroy(&group->continue_mutex);
-		pthread_cond_destroy(&group->complete_condition);
-		pthread_mutex_destroy(&group->complete_mutex);
-		group->member_array.FreeData();
-		delete group;
-	}
+	for (uint32_t i = 0; i < n; i++)
+		delete task_group_array.Get(i);
 	task_group_array.Truncate(0);
+	empty_group_array.Truncate(0);
+}
+
+// Called by the thread that finishes a task with DST_TASK_FLAG_NOTIFY_COMPLETION. The
+// event is only signalled when the queue becomes non-empty, so that a burst of
+// completions costs a single system call.
+
+void dstTaskScheduler::PostCompletionNotification(int task_index) {
+	pthread_mutex_lock(&completion_queue_mutex);
+	completion_queue.Add(task_index);
+	if (completion_queue.Size() == 1 && completion_event_write_fd >= 0) {
+		uint64_t value = 1;
+		ssize_t r = write(completion_event_write_fd, &value, sizeof(value));
+		(void)r;
+	}
+	pthread_mutex_unlock(&completion_queue_mutex);
 }
 
 const dstIntArray *dstTaskScheduler::GetCompletionNotifications() {
         completion_notification_array.Truncate(0);
-	LockMutexTaskInfoArray();
-	for (uint32_t i = 0; i < task_info_array.Size(); i++) {
-		dstTaskInfo *task_info = task_info_array.Get(i);
-		if ((task_info->flags & (DST_TASK_FLAG_NOTIFY_COMPLETION |
-                DST_TASK_FLAG_COMPLETED | DST_TASK_FLAG_COMPLETION_NOTIFIED))
-                == (DST_TASK_FLAG_NOTIFY_COMPLETION | DST_TASK_FLAG_COMPLETED)) {
-			completion_notification_array.Add(i);
-			task_info->flags |= DST_TASK_FLAG_COMPLETION_NOTIFIED;
-                }
+	pthread_mutex_lock(&completion_queue_mutex);
+	if (completion_queue.Size() > 0 && completion_event_fd >= 0) {
+		// Reset the event; the queue is emptied below while holding the same lock.
+		uint64_t value;
+		ssize_t r = read(completion_event_fd, &value, sizeof(value));
+		(void)r;
 	}
-	UnlockMutexTaskInfoArray();
+	for (uint32_t i = 0; i < completion_queue.Size(); i++)
+		completion_notification_array.Add(completion_queue.Get(i));
+	completion_queue.Truncate(0);
+	pthread_mutex_unlock(&completion_queue_mutex);
         return &completion_notification_array;
 }
 
@@ -375,112 +1083,176 @@ const dstIntArray *dstTaskScheduler::GetCompletionNotifications() {
 
 int dstTaskScheduler::StartTaskGroup(int n) {
 	dstTaskGroup *task_group = new dstTaskGroup;
-	// The group member array of task_group will be automatically initialized
-	// as an empty array by the constructor.
-	task_group->member_array.SetCapacity(n);
+	task_group->nu_active_members = 0;
+	task_group->released = false;
+	LockMutexTaskGroupArray();
 	int current_group = task_group_array.Size();
 	// Add the task group.
 	task_group_array.Add(task_group);
+	UnlockMutexTaskGroupArray();
 	return current_group;
 }
 
-// Thread functions.
+// Asynchronous task handles.
 
-static void *dstInternalThreadFunc(void *data) {
-	dstTaskInfo *task_info = (dstTaskInfo *)data;
-	bool exit_signalled = false;
-	while (!exit_signalled) {
-		// Run the task.
-		task_info->task_func(task_info);
-
-		task_info->complete_signal = DST_TASK_THREAD_CONTINUE;
-		pthread_mutex_lock(&task_info->complete_mutex);
-		pthread_cond_signal(&task_info->complete_condition);
-		pthread_mutex_unlock(&task_info->complete_mutex);
-
-		task_info->LockMutexContinue();
-		int r = 0;
-		while (task_info->continue_signal == DST_TASK_THREAD_WAIT && r == 0)
-			r = pthread_cond_wait(&task_info->continue_condition,
-				&task_info->continue_mutex);
-		if (r != 0) {
-			printf("pthread_cond_wait returned error.\n");
-			exit(1);
-		}
-		if (task_info->continue_signal == DST_TASK_THREAD_CONTINUE) {
-			// Will continue with new task.
-			// Reset signal code.
-			task_info->continue_signal = DST_TASK_THREAD_WAIT;
-		}
-		else if (task_info->continue_signal == DST_TASK_THREAD_EXIT)
-			exit_signalled = true;
-		task_info->UnlockMutexContinue();
+__thread dstTaskHandleState *dst_async_task_handle_state = NULL;
+static __thread int dst_async_nesting = 0;
+
+dstTaskHandleState::dstTaskHandleState(dstTaskScheduler *s, int _nu_pending, int _ref_count) {
+	scheduler = s;
+	nu_pending = _nu_pending;
+	ref_count = _ref_count;
+	done = false;
+	pthread_mutex_init(&mutex, NULL);
+	task_func = NULL;
+	user_data = NULL;
+	first_continuation = NULL;
+	next_continuation = NULL;
+}
+
+dstTaskHandleState::~dstTaskHandleState() {
+	pthread_mutex_destroy(&mutex);
+}
+
+void dstTaskHandleState::Release() {
+	if (__sync_sub_and_fetch(&ref_count, 1) == 0)
+		delete this;
+}
+
+// Completion record of a task group attached to a handle state. Each group has its
+// own counter, so that the parameter block of each group is freed as soon as that
+// group has finished. The record is deleted by its completion function, so the items
+// are queued with DST_TASK_FLAG_COMPLETION_FREES_COUNTER.
+
+class dstTaskHandleGroup {
+public :
+	volatile int nu_remaining;
+	dstTaskHandleState *state;
+	dstTaskDynamicDivision dynamic_division;
+};
+
+static void dstTaskHandleGroupComplete(void *complete_data) {
+	dstTaskHandleGroup *group = (dstTaskHandleGroup *)complete_data;
+	dstTaskHandleState *state = group->state;
+	delete group;
+	state->FinishGroup();
+}
+
+static void dstTaskHandleContinuationThread(dstThreadData *thread_data) {
+	dstTaskHandleState *state = (dstTaskHandleState *)thread_data->user_data;
+	dstThreadData continuation_data;
+	continuation_data.user_data = state->user_data;
+	continuation_data.subdivision.start_index = 0;
+	continuation_data.subdivision.nu_elements = 0;
+	continuation_data.subdivision.index = 0;
+	state->task_func(&continuation_data);
+}
+
+// Queue a continuation, which has a pending count of one and holds a work reference.
+
+static void dstQueueContinuation(dstTaskHandleState *state) {
+	dstTaskHandleGroup *group = new dstTaskHandleGroup;
+	group->nu_remaining = 1;
+	group->state = state;
+	dstThreadData thread_data;
+	thread_data.user_data = state;
+	thread_data.subdivision.start_index = 0;
+	thread_data.subdivision.nu_elements = 0;
+	thread_data.subdivision.index = 0;
+	state->scheduler->QueueWorkItem(DST_TASK_FLAG_COMPLETION_FREES_COUNTER,
+		dstTaskHandleContinuationThread, thread_data, &group->nu_remaining,
+		dstTaskHandleGroupComplete, group);
+}
+
+void dstTaskHandleState::FinishGroup() {
+	if (__sync_sub_and_fetch(&nu_pending, 1) > 0)
+		return;
+	pthread_mutex_lock(&mutex);
+	done = true;
+	dstTaskHandleState *continuation = first_continuation;
+	first_continuation = NULL;
+	pthread_mutex_unlock(&mutex);
+	while (continuation != NULL) {
+		dstTaskHandleState *next = continuation->next_continuation;
+		dstQueueContinuation(continuation);
+		continuation = next;
 	}
-	return NULL;
+	// Drop the reference held by the work.
+	Release();
 }
 
-static void *dstInternalGroupThreadFunc(void *data) {
-	dstTaskGroupMember *member = (dstTaskGroupMember *)data;
-	dstTaskGroup *group = member->group;
-	bool exit_signalled = false;
-	bool queue_is_empty;
-	pthread_mutex_lock(&member->thread_data_queue_mutex);
-	queue_is_empty = member->thread_data_queue.IsEmpty();
-	pthread_mutex_unlock(&member->thread_data_queue_mutex);
-	for (;;) {
-		while (queue_is_empty) {
-			// Wait for the continue signal.
-			pthread_mutex_lock(&group->continue_mutex);
-			int r = 0;
-			while (member->continue_signal == DST_TASK_THREAD_WAIT && r == 0)
-				r = pthread_cond_wait(&group->continue_condition,
-					&group->continue_mutex);
-			if (r != 0) {
-				printf("pthread_cond_wait returned error.\n");
-				exit(1);
-			}
-			if (member->continue_signal == DST_TASK_THREAD_CONTINUE) {
-				// Will continue with new task.
-				// Reset signal code.
-				member->continue_signal = DST_TASK_THREAD_WAIT;
-			}
-			else if (member->continue_signal == DST_TASK_THREAD_EXIT)
-				exit_signalled = true;
-			pthread_mutex_unlock(&group->continue_mutex);
-			if (exit_signalled)
-				break;
-			pthread_mutex_lock(&member->thread_data_queue_mutex);
-			queue_is_empty = member->thread_data_queue.IsEmpty();
-			pthread_mutex_unlock(&member->thread_data_queue_mutex);
+void dstTaskHandle::Wait() {
+	if (state != NULL)
+		state->scheduler->WaitUntilZero(&state->nu_pending);
+}
+
+dstTaskHandle dstTaskHandle::Then(dstTaskFunc func, const void *user_data) {
+	dstTaskScheduler *scheduler = (state != NULL) ? state->scheduler :
+		dstGetContext()->task_scheduler;
+	// One reference for the work, one for the returned handle.
+	dstTaskHandleState *continuation = new dstTaskHandleState(scheduler, 1, 2);
+	continuation->task_func = func;
+	continuation->user_data = user_data;
+	if (state != NULL) {
+		pthread_mutex_lock(&state->mutex);
+		if (!state->done) {
+			continuation->next_continuation = state->first_continuation;
+			state->first_continuation = continuation;
+			pthread_mutex_unlock(&state->mutex);
+			return dstTaskHandle(continuation);
 		}
+		pthread_mutex_unlock(&state->mutex);
+	}
+	dstQueueContinuation(continuation);
+	return dstTaskHandle(continuation);
+}
 
-		pthread_mutex_lock(&member->thread_data_queue_mutex);
-		dstThreadData thread_data = member->thread_data_queue.Dequeue();
-		pthread_mutex_unlock(&member->thread_data_queue_mutex);
-
-		// Run the task, but only if the number of elements it operates on is
-		// greater than zero.
-//		printf("dstInternalGroupThreadFunc: task_func: start_index = %d, nu_elements = %d.\n",
-//			thread_data.subdivision.start_index, thread_data.subdivision.nu_elements);
-//		fflush(stdout);
-		if (thread_data.subdivision.nu_elements > 0)
-			member->task_func(&thread_data);
-	
-		pthread_mutex_lock(&member->thread_data_queue_mutex);
-		queue_is_empty = member->thread_data_queue.IsEmpty();
-		pthread_mutex_unlock(&member->thread_data_queue_mutex);
-
-//		printf("queue is empty = %u\n", queue_is_empty);
-
-		if (queue_is_empty) {
-			pthread_mutex_lock(&group->complete_mutex);
-			group->nu_active_members--;
-			if (group->nu_active_members == 0)
-				pthread_cond_signal(&group->complete_condition);
-			pthread_mutex_unlock(&group->complete_mutex);
+void dstTaskScheduler::BeginAsync() {
+	dst_async_nesting++;
+	if (dst_async_nesting > 1)
+		return;
+	// The pending count of one guards against completion while groups are being
+	// attached. There is one reference for the work and one for the handle returned
+	// by EndAsync().
+	dst_async_task_handle_state = new dstTaskHandleState(this, 1, 2);
+}
 
-		}
+dstTaskHandle dstTaskScheduler::EndAsync() {
+	dstTaskHandleState *state = dst_async_task_handle_state;
+	dst_async_nesting--;
+	if (dst_async_nesting > 0) {
+		state->AddReference();
+		return dstTaskHandle(state);
 	}
-	return NULL;
+	dst_async_task_handle_state = NULL;
+	// Drop the guard; when all groups have already finished, this completes the work.
+	state->FinishGroup();
+	return dstTaskHandle(state);
 }
 
+void dstTaskScheduler::AddSubdividedTaskGroupAsync(dstTaskHandleState *state, int flags,
+dstTaskFunc func, const void *user_data, const dstTaskDivisionData& division) {
+	dstTaskHandleGroup *group = new dstTaskHandleGroup;
+	group->state = state;
+	dstTaskItem *items = (dstTaskItem *)alloca(sizeof(dstTaskItem) * division.nu_subdivisions);
+	int nu_items = InitializeGroupItems(items, flags | DST_TASK_FLAG_COMPLETION_FREES_COUNTER,
+		func, user_data, division, &group->dynamic_division, &group->nu_remaining,
+		dstTaskHandleGroupComplete, group, 0);
+	if (nu_items == 0) {
+		delete group;
+		if (flags & DST_TASK_FLAG_FREE_USER_DATA)
+			free((void *)user_data);
+		return;
+	}
+	group->nu_remaining = nu_items;
+	__sync_fetch_and_add(&state->nu_pending, 1);
+	QueueItems(items, nu_items);
+}
+
+// Thread functions.
+
+static void *dstInternalWorkerThreadFunc(void *data) {
+	dstTaskWorker *w = (dstTaskWorker *)data;
+	w->scheduler->RunWorker(w);
+	return NULL;
+}
@@ -19,13 +19,45 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #ifndef __DST_THREAD_H__
 #define __DST_THREAD_H__
 
-// Thread scheduler class. After a dstTaskScheduler is created, threads
-// are created as tasks are added. When a task is finished, the thread
-// is kept active, waiting for the signal to start with the next task.
-// The number of created threads is always equal to the maximum number
-// of tasks that has been concurrently active since the creation of
-// the dstTaskScheduler. When a dstTaskScheduler is destroyed, the threads
-// will exit.
+// Thread scheduler class. A fixed-size pool of worker threads is created
+// once (normally by dstInit()), after which tasks and subdivided task groups
+// are queued on per-worker lock-free ring queues (dstMPMCQueue). A worker takes
+// work from its own queue and, when that is empty, steals from the queue of
+// another worker. Items that do not fit in a full ring go to a shared overflow
+// deque. A thread that waits for a task or group to finish executes queued work
+// itself in the meantime. When a dstTaskScheduler is destroyed,
+// the worker threads will exit.
+//
+// Idle workers and waiting threads first spin for a configurable number of
+// iterations and then block on a futex. Each worker has its own sleep flag on a
+// separate cache line, so that queueing work only wakes as many sleeping workers
+// as there are new work items, and the system call is skipped entirely when all
+// workers are still spinning. Within a parallel region (BeginParallelRegion()),
+// idle workers keep spinning so that back-to-back calls avoid the wake-up latency.
+//
+// On NUMA systems, the workers are grouped by node. The subdivisions of a task group
+// are queued on the workers of the node that owns the corresponding part of the
+// element range (see dstNUMA.h), and idle workers steal from workers on the same
+// node before they steal from other nodes. Workers that are not bound to a CPU (with
+// DST_AFFINITY_NONE) are spread over the nodes round-robin and bound to the CPUs of
+// their node.
+//
+// Work can also be queued asynchronously (BeginAsync()/EndAsync()), in which case
+// the caller receives a dstTaskHandle to wait for or to chain continuations to.
+//
+// Tasks queued with DST_TASK_FLAG_NOTIFY_COMPLETION are added to a completion queue
+// when they finish. The queue has an event file descriptor (GetCompletionEventFD())
+// that is readable while notifications are pending, so that an event loop can
+// poll() or epoll() for finished tasks instead of blocking a thread per task. Tasks
+// and groups can also have a completion callback.
+//
+// Tracing of scheduler events can be enabled per scheduler (see dstTaskTrace.h).
+//
+// Work with DST_TASK_FLAG_PRIORITY_HIGH, a duration estimate or a deadline is kept in
+// a shared priority queue instead of the worker queues. High-priority work is taken before
+// any other work, so that it preempts running lower-priority task groups at the next
+// subdivision boundary. Other prioritized work is taken after the worker's own queue,
+// earliest deadline first and otherwise longest estimated duration first.
 
 
 #include <pthread.h>
@@ -34,6 +66,7 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include <dstDynamicArray.h>
 #include <dstQueue.h>
 #include <dstTimer.h>
+#include <dstNUMA.h>
 
 enum {
 	DST_TASK_DURATION_UNIT_NONE = 0,
@@ -44,11 +77,24 @@ enum {
 	// Specified flags.
 	DST_TASK_FLAG_PRIORITY_HIGH = 0x1,
 	DST_TASK_FLAG_DURATION_ESTIMATE = 0x2,
+	// Add the task to the completion queue when it has finished (see
+	// GetCompletionNotifications()). Not used for task groups.
 	DST_TASK_FLAG_NOTIFY_COMPLETION = 0x4,
+	// Free the user data (allocated with malloc()) when the task or group has finished.
+	DST_TASK_FLAG_FREE_USER_DATA = 0x8,
+	// Only execute the work on a worker of the node it was queued for.
+	DST_TASK_FLAG_NODE_BOUND = 0x10,
+	// The work has a deadline (in GetTime() units) and is started before work of the
+	// same priority with a later or no deadline.
+	DST_TASK_FLAG_DEADLINE = 0x20,
 
 	// Flags that are set after completion.
 	DST_TASK_FLAG_COMPLETED = 0x10000,
-	DST_TASK_FLAG_COMPLETION_NOTIFIED = 0x20000
+	DST_TASK_FLAG_COMPLETION_NOTIFIED = 0x20000,
+
+	// Internal flag of work items whose completion function frees the pending counter;
+	// the counter is not waited for and is left at one.
+	DST_TASK_FLAG_COMPLETION_FREES_COUNTER = 0x40000
 };
 
 class DST_API dstTaskDurationEstimate {
@@ -63,30 +109,68 @@ public :
 	}
 };
 
+enum {
+	// nu_subdivisions equal aligned parts, one work item each (the default).
+	DST_TASK_DIVISION_STATIC = 0,
+	// nu_subdivisions work items take chunks of a fixed size from a shared counter
+	// until the range is exhausted.
+	DST_TASK_DIVISION_DYNAMIC,
+	// As dynamic, but the chunk size decreases with the remaining size, so that the
+	// last chunks are small enough to even out differences in thread speed.
+	DST_TASK_DIVISION_GUIDED
+};
+
+// In the dynamic modes, a chunk is a multiple of the alignment (except for the last one)
+// and not smaller than min_chunk_size; a non-zero max_chunk_size limits the size of
+// the chunks. The subdivision index passed to the task function is the index of the
+// work item executing the chunk (smaller than nu_subdivisions), and a work item
+// executes its chunks in order, so that per-item partial results remain possible.
+// Dynamic modes apply to task groups; AddTask() always uses the static subdivision.
+
 class dstTaskDivisionData {
 public:
 	uint32_t size;
 	uint32_t nu_subdivisions;
 	uint32_t alignment;
-
+	uint32_t mode;
+	uint32_t min_chunk_size;
+	uint32_t max_chunk_size;
+
+	dstTaskDivisionData() {
+		mode = DST_TASK_DIVISION_STATIC;
+		min_chunk_size = 0;
+		max_chunk_size = 0;
+	}
 	int CalculateSubdivision(uint32_t index, uint32_t &start_index, uint32_t &nu_elements) const;
+	// Select a dynamic mode, with chunks of at least one cache line of output (with
+	// elements of element_size bytes) and at most DST_TASK_CHUNK_COST_TARGET in cost.
+	void SetDynamicMode(uint32_t m, uint32_t element_size, uint32_t cost_per_element);
+	inline uint32_t GetMinimumChunkSize() const {
+		return min_chunk_size > alignment ? min_chunk_size : alignment;
+	}
+	// The size of the next chunk in a dynamic mode, given the number of elements that
+	// have not been taken yet.
+	uint32_t CalculateChunkSize(uint32_t remaining) const;
 };
 
+// Upper limit on the cost (as in dstGetNumberOfThreadsHint()) of a chunk set by
+// SetDynamicMode(), one eighth of the cost at which a second thread is used.
+#define DST_TASK_CHUNK_COST_TARGET (1 << 18)
+// Number of chunks per work item in DST_TASK_DIVISION_DYNAMIC mode.
+#define DST_TASK_DYNAMIC_CHUNKS_PER_ITEM 4
+
 class dstTaskSubdivisionData {
 public :
 	uint32_t start_index;
 	uint32_t nu_elements;
+	// Index of the subdivision within the division.
+	uint32_t index;
 };
 
 class DST_API dstThreadData;
 
 typedef void (*dstTaskFunc)(dstThreadData *thread_data);
-
-enum dstTaskThreadSignal {
-	DST_TASK_THREAD_WAIT,
-	DST_TASK_THREAD_CONTINUE,
-	DST_TASK_THREAD_EXIT
-};
+typedef void (*dstTaskCompleteFunc)(void *complete_data);
 
 class DST_API dstThreadData {
 public :
@@ -100,72 +184,296 @@ public :
 	dstThreadDataQueue() : dstQueue(4) { }
 };
 
-class DST_API dstBaseTaskInfo : public dstThreadData {
+// Shared chunk counter of a task group with a dynamic division.
+
+class DST_API dstTaskDynamicDivision {
+public :
+	dstTaskDivisionData division;
+	volatile uint32_t next_index;
+
+	// Take the next chunk. Returns false when the range is exhausted.
+	bool TakeChunk(uint32_t& start_index, uint32_t& nu_elements);
+};
+
+// A single unit of work queued on a worker queue. When the task function
+// returns, the pending counter of the task or group the item belongs to is
+// decremented. The last item calls complete_func (when not NULL) before it sets
+// the counter to zero, so that its effects are visible to waiting threads. The item is preferably
+// executed on the given NUMA node (-1 for any node). The duration estimate (in
+// microseconds) and the deadline are only used with the corresponding flags.
+
+class DST_API dstTaskItem {
 public :
-	pthread_t thread;
 	uint32_t flags;
+	int node;
 	dstTaskFunc task_func;
+	dstThreadData thread_data;
+	volatile int *nu_pending;
+	dstTaskCompleteFunc complete_func;
+	void *complete_data;
+	uint32_t duration;
+	uint64_t deadline;
+	// Task index (with DST_TASK_FLAG_NOTIFY_COMPLETION).
+	int notify_index;
+	// The time the item was queued (dstGetCurrentTimeNSec()) while tracing, else zero.
+	uint64_t queue_time;
+	// Chunk counter of a group with a dynamic division, else NULL. The item then
+	// executes the task function for chunks taken from the counter.
+	dstTaskDynamicDivision *dynamic_division;
 };
 
-class DST_API dstTaskInfo : public dstBaseTaskInfo {
+static DST_INLINE_ONLY bool dstTaskItemIsPrioritized(const dstTaskItem& item) {
+	return (item.flags & (DST_TASK_FLAG_PRIORITY_HIGH | DST_TASK_FLAG_DURATION_ESTIMATE |
+		DST_TASK_FLAG_DEADLINE)) != 0 && (item.flags & DST_TASK_FLAG_NODE_BOUND) == 0;
+}
+
+// Double-ended queue of work items, used for the items that do not fit in the worker
+// queues. Items are pushed and popped at the bottom and stolen from the top. The
+// ring buffer grows as required.
+
+class DST_API dstTaskDeque {
+private :
+	dstTaskItem *items;
+	uint32_t capacity;
+	uint32_t top;
+	uint32_t bottom;
+	pthread_mutex_t mutex;
+
 public :
-	uint64_t creation_time;
-	dstTaskDurationEstimate duration_estimate;
-	pthread_mutex_t continue_mutex;
-	pthread_cond_t continue_condition;
-	dstTaskThreadSignal continue_signal;
-	pthread_mutex_t complete_mutex;
-	pthread_cond_t complete_condition;
-	dstTaskThreadSignal complete_signal;
+	void Initialize();
+	void Destroy();
+	void PushBottom(const dstTaskItem& item);
+	bool PopBottom(dstTaskItem& item);
+	// Steal the top item. Items bound to another node than the thief's are not taken.
+	bool StealTop(dstTaskItem& item, int thief_node);
+};
 
-	inline void LockMutexContinue() {
-		pthread_mutex_lock(&continue_mutex);
-	}
-	inline void UnlockMutexContinue() {
-		pthread_mutex_unlock(&continue_mutex);
-	}
+class DST_API dstTaskPriorityQueueEntry {
+public :
+	dstTaskItem item;
+	// Queueing order of items that are otherwise equal.
+	uint64_t sequence;
 };
 
-typedef dstCastDynamicArray <dstTaskInfo *, void *, uint32_t, dstPointerArray>
-	dstTaskInfoPointerArray;
+// Priority queue (binary heap) of work items. High-priority items come first, then
+// items with a deadline (earliest first), then items with the longest duration
+// estimate. The item counts may be read without locking.
 
-class dstTaskGroup;
+class DST_API dstTaskPriorityQueue {
+private :
+	dstTaskPriorityQueueEntry *entries;
+	uint32_t capacity;
+	uint32_t size;
+	uint64_t sequence;
+	pthread_mutex_t mutex;
 
-class DST_API dstTaskGroupMember {
+public :
+	volatile int nu_items;
+	volatile int nu_high_priority_items;
+
+	void Initialize();
+	void Destroy();
+	void Push(const dstTaskItem& item);
+	// Take the first item. When high_priority_only is set, only a high-priority
+	// item is taken.
+	bool Pop(dstTaskItem& item, bool high_priority_only);
+};
+
+class dstTaskScheduler;
+class dstTaskTraceBuffer;
+class dstTaskTraceSummary;
+
+enum {
+	DST_TASK_WORKER_RUNNING = 0,
+	DST_TASK_WORKER_SLEEPING = 1
+};
+
+// Workers are allocated with cache line alignment, so that the sleep state of
+// each worker is on its own cache line.
+
+class DST_API DST_ALIGNED(DST_LINE_SIZE) dstTaskWorker {
 public :
 	pthread_t thread;
+	int index;
+	int cpu;
+	int node;
+	dstTaskScheduler *scheduler;
+	dstMPMCQueue <dstTaskItem> queue;
+	volatile int state DST_ALIGNED(DST_LINE_SIZE);
+};
+
+// Capacity of the work item queue of each worker.
+#define DST_TASK_QUEUE_CAPACITY 256
+
+// Default number of spin iterations before an idle thread blocks.
+#define DST_DEFAULT_SPIN_COUNT 4096
+
+class DST_API dstTaskInfo : public dstThreadData {
+public :
 	uint32_t flags;
-	dstTaskGroup *group;
-	dstTaskThreadSignal continue_signal;
 	dstTaskFunc task_func;
-	pthread_mutex_t thread_data_queue_mutex;
-	dstThreadDataQueue thread_data_queue;
+	uint64_t creation_time;
+	dstTaskDurationEstimate duration_estimate;
+	// Deadline (with DST_TASK_FLAG_DEADLINE), in GetTime() units.
+	uint64_t deadline;
+	// Set to one when the task is queued, and to zero when it has finished.
+	volatile int nu_pending;
 };
 
-typedef dstDynamicArray <dstTaskGroupMember, uint8_t> dstTaskGroupMemberArray;
+typedef dstCastDynamicArray <dstTaskInfo *, void *, uint32_t, dstPointerArray>
+	dstTaskInfoPointerArray;
 
 class DST_API dstTaskGroup {
 public :
-	dstTaskGroupMemberArray member_array;
-	pthread_mutex_t continue_mutex;
-	pthread_cond_t continue_condition;
-	pthread_mutex_t complete_mutex;
-	pthread_cond_t complete_condition;
-	int nu_active_members;
+	// The number of subdivisions that have not yet finished.
+	volatile int nu_active_members;
+	// Set when the group has been waited for and its slot can be reused.
+	bool released;
+	dstTaskDynamicDivision dynamic_division;
 };
 
 typedef dstCastDynamicArray <dstTaskGroup *, void *, int, dstPointerArray>
 	dstTaskGroupPointerArray;
 
+// Shared state of an asynchronous task handle (see dstTaskHandle). The state is
+// reference counted; queued work holds a reference until it has completed.
+
+class DST_API dstTaskHandleState {
+public :
+	dstTaskScheduler *scheduler;
+	// The number of attached task groups that have not finished, plus one while
+	// groups are still being attached.
+	volatile int nu_pending;
+	volatile int ref_count;
+	bool done;
+	pthread_mutex_t mutex;
+	// Continuation function and user data (for states created by Then()).
+	dstTaskFunc task_func;
+	const void *user_data;
+	// Continuations that are queued when the work has completed.
+	dstTaskHandleState *first_continuation;
+	dstTaskHandleState *next_continuation;
+
+	dstTaskHandleState(dstTaskScheduler *s, int _nu_pending, int _ref_count);
+	~dstTaskHandleState();
+	inline void AddReference() {
+		__sync_fetch_and_add(&ref_count, 1);
+	}
+	void Release();
+	// Called when an attached group has finished.
+	void FinishGroup();
+};
+
+// Handle to work that was queued asynchronously. Handles can be copied freely;
+// the work itself is not affected when the last handle is destroyed. A default
+// constructed handle refers to no work and is always done.
+
+class DST_API dstTaskHandle {
+private :
+	dstTaskHandleState *state;
+
+public :
+	dstTaskHandle() {
+		state = NULL;
+	}
+	// Takes over a reference to the state.
+	explicit dstTaskHandle(dstTaskHandleState *s) {
+		state = s;
+	}
+	dstTaskHandle(const dstTaskHandle& h) {
+		state = h.state;
+		if (state != NULL)
+			state->AddReference();
+	}
+	~dstTaskHandle() {
+		if (state != NULL)
+			state->Release();
+	}
+	dstTaskHandle& operator =(const dstTaskHandle& h) {
+		if (h.state != NULL)
+			h.state->AddReference();
+		if (state != NULL)
+			state->Release();
+		state = h.state;
+		return *this;
+	}
+	inline bool IsValid() const {
+		return state != NULL;
+	}
+	inline bool IsDone() const {
+		return state == NULL || state->nu_pending == 0;
+	}
+	// Wait until the work has finished, executing queued work in the meantime.
+	void Wait();
+	// Queue func (with the given user data and an empty subdivision) when the work
+	// has finished. Returns a handle for the continuation.
+	dstTaskHandle Then(dstTaskFunc func, const void *user_data);
+};
+
+// The asynchronous handle state of the calling thread, when it is between
+// BeginAsync() and EndAsync().
+extern DST_API __thread dstTaskHandleState *dst_async_task_handle_state;
+
+static DST_INLINE_ONLY dstTaskHandleState *dstGetAsyncTaskHandleState() {
+	return dst_async_task_handle_state;
+}
+
 class DST_API dstTaskScheduler {
 private :
 	dstTaskInfoPointerArray task_info_array;
 	dstIntArray empty_slot_array;
         dstIntArray completion_notification_array;
+	// Indices of finished tasks with DST_TASK_FLAG_NOTIFY_COMPLETION that have not
+	// been returned by GetCompletionNotifications() yet.
+	dstIntArray completion_queue;
+	pthread_mutex_t completion_queue_mutex;
+	// Readable while the completion queue is not empty (an eventfd, or the read end of
+	// a pipe without eventfd support).
+	int completion_event_fd;
+	int completion_event_write_fd;
 	uint64_t start_time;
         pthread_mutex_t task_info_array_mutex;
 	pthread_mutex_t empty_slot_array_mutex;
 	dstTaskGroupPointerArray task_group_array;
+	dstIntArray empty_group_array;
+	pthread_mutex_t task_group_array_mutex;
+	// Worker pool.
+	pthread_mutex_t start_mutex;
+	dstTaskWorker **worker;
+	int nu_workers;
+	volatile int next_worker;
+	// Worker indices grouped by NUMA node; the workers of node i are
+	// node_worker[node_first_worker[i]] to node_worker[node_first_worker[i + 1] - 1].
+	int nu_nodes;
+	int *node_worker;
+	int node_first_worker[DST_MAX_NUMA_NODES + 1];
+	volatile int node_next_worker[DST_MAX_NUMA_NODES];
+	// Work with a priority, duration estimate or deadline.
+	dstTaskPriorityQueue priority_queue;
+	// Work that did not fit in the queue of the worker it was meant for.
+	dstTaskDeque overflow_deque;
+	int spin_count;
+	// Set when the spin count was configured with SetSpinCount(); Start() then keeps it.
+	bool spin_count_set;
+	volatile bool exit_signalled;
+	volatile int nu_parallel_regions;
+	// The number of work items that are queued but have not been taken yet.
+	volatile int nu_queued DST_ALIGNED(DST_LINE_SIZE);
+	// Incremented whenever a task or group finishes; threads waiting for completion
+	// block on it.
+	volatile int complete_sequence DST_ALIGNED(DST_LINE_SIZE);
+	volatile int nu_complete_waiters;
+	// Tracing (see dstTaskTrace.h).
+	volatile bool tracing;
+	volatile uint32_t trace_id;
+	uint64_t trace_start_time;
+	uint32_t trace_buffer_size;
+	dstTaskTraceBuffer *first_trace_buffer;
+	int nu_trace_buffers;
+	// Buffers of earlier traces. Threads may still be recording in them, so they are
+	// only freed when the scheduler is destroyed.
+	dstTaskTraceBuffer *retired_trace_buffers;
+	pthread_mutex_t trace_mutex;
 
 private :
 	inline void LockMutexTaskInfoArray() {
@@ -180,14 +488,100 @@ private :
 	inline void UnlockMutexEmptySlotArray() {
 		pthread_mutex_unlock(&empty_slot_array_mutex);
 	}
+	inline void LockMutexTaskGroupArray() {
+		pthread_mutex_lock(&task_group_array_mutex);
+	}
+	inline void UnlockMutexTaskGroupArray() {
+		pthread_mutex_unlock(&task_group_array_mutex);
+	}
 	void ClearTasks();
 	void ClearGroups();
+	void QueueItems(dstTaskItem *items, int n);
+	int InitializeGroupItems(dstTaskItem *items, int flags, dstTaskFunc func,
+		const void *user_data, const dstTaskDivisionData& division,
+		dstTaskDynamicDivision *dynamic_division, volatile int *nu_pending,
+		dstTaskCompleteFunc complete_func, void *complete_data, uint64_t deadline);
+	inline void PushItem(dstTaskWorker *w, const dstTaskItem& item) {
+		if (!w->queue.Enqueue(item))
+			overflow_deque.PushBottom(item);
+	}
+	bool TakeItem(dstTaskWorker *current_worker, dstTaskItem& item);
+	void RunItem(dstTaskItem& item);
+	void WaitForCompletion(volatile int *nu_pending);
+	void PostCompletionNotification(int task_index);
+	void WakeWorkers(int n, int node);
+	dstTaskWorker *GetCurrentWorker() const;
+	dstTaskTraceBuffer *GetTraceBuffer();
+	inline uint64_t GetTraceTime() const {
+		return dstGetCurrentTimeNSec() - trace_start_time;
+	}
+	void ClearTraceBuffers();
 
 public :
 	dstTaskScheduler();
 	~dstTaskScheduler();
+	// Create the worker pool with the given number of threads. Worker i is
+	// bound to the CPU of library thread first_thread + i under the affinity
+	// policy (see dstAffinity.h), or not bound with DST_AFFINITY_NONE. When the
+	// pool has not been started when the first task is added, it is started
+	// with a default size.
+	void Start(int nu_threads, int first_thread);
+	// Stop the worker pool after all queued work has been executed.
+	void Stop();
+	inline int GetNumberOfWorkers() const {
+		return nu_workers;
+	}
+	inline int GetNumberOfNodes() const {
+		return nu_nodes;
+	}
+	// The number of workers on a NUMA node.
+	inline int GetNumberOfWorkers(int node) const {
+		return node_first_worker[node + 1] - node_first_worker[node];
+	}
+	// The NUMA node on which a subdivision is preferably executed (-1 for any node).
+	int GetSubdivisionNode(const dstTaskDivisionData& division, uint32_t start_index,
+		uint32_t nu_elements) const;
+	// Set the number of spin iterations before an idle worker or a waiting thread
+	// blocks. Zero blocks immediately (the default on single-CPU systems). The value
+	// may be set before the worker pool is started.
+	inline void SetSpinCount(int n) {
+		spin_count = n;
+		spin_count_set = true;
+	}
+	inline int GetSpinCount() const {
+		return spin_count;
+	}
+	// Keep idle workers spinning (instead of blocking) until the matching
+	// EndParallelRegion(). Regions may be nested. Has no effect when the spin
+	// count is zero.
+	void BeginParallelRegion();
+	void EndParallelRegion();
+	// The time in microseconds since the scheduler was created, in which task
+	// deadlines are specified.
+	inline uint64_t GetTime() const {
+		return dstGetCurrentTimeUSec() - start_time;
+	}
+	// Worker thread main loop (internal).
+	void RunWorker(dstTaskWorker *w);
+	// Queue a single work item that decrements *nu_pending when it has finished, and
+	// wait (executing queued work) until such a counter is zero. These are the building
+	// blocks for higher-level constructs such as dstTaskGraph.
+	void QueueWorkItem(int flags, dstTaskFunc func, const dstThreadData& thread_data,
+		volatile int *nu_pending, dstTaskCompleteFunc complete_func = NULL,
+		void *complete_data = NULL);
+	// Queue a single work item on a worker of the given NUMA node.
+	void QueueWorkItemOnNode(int node, int flags, dstTaskFunc func,
+		const dstThreadData& thread_data, volatile int *nu_pending);
+	void WaitUntilZero(volatile int *nu_pending) {
+		WaitForCompletion(nu_pending);
+	}
+	// The deadline is only used with DST_TASK_FLAG_DEADLINE, and the duration estimate
+	// only with DST_TASK_FLAG_DURATION_ESTIMATE. When complete_func is not NULL, it is
+	// called with complete_data by the thread that finishes the task, before threads
+	// waiting for the task are woken up.
 	int AddTask(int flags, dstTaskFunc func, const void *user_data, dstTaskDurationEstimate e,
-		const dstTaskDivisionData& division, uint32_t division_index);
+		const dstTaskDivisionData& division, uint32_t division_index, uint64_t deadline = 0,
+		dstTaskCompleteFunc complete_func = NULL, void *complete_data = NULL);
 	inline int AddTask(int flags, dstTaskFunc func, const void *user_data) {
 		dstTaskDivisionData division;
 		division.size = 0;
@@ -199,6 +593,20 @@ public :
 		division.size = 0;
 		return AddTask(flags, func, user_data, e, division, 0);
 	}
+	inline int AddTask(int flags, dstTaskFunc func, const void *user_data, dstTaskDurationEstimate e,
+	uint64_t deadline) {
+		dstTaskDivisionData division;
+		division.size = 0;
+		return AddTask(flags, func, user_data, e, division, 0, deadline);
+	}
+	inline int AddTask(int flags, dstTaskFunc func, const void *user_data,
+	dstTaskCompleteFunc complete_func, void *complete_data) {
+		dstTaskDivisionData division;
+		division.size = 0;
+		return AddTask(flags, func, user_data,
+			dstTaskDurationEstimate(DST_TASK_DURATION_UNIT_NONE, 0), division, 0, 0,
+			complete_func, complete_data);
+	}
 	inline int AddTask(int flags, dstTaskFunc func, const void *user_data,
 	const dstTaskDivisionData& division, uint32_t division_index) {
 		return AddTask(flags, func, user_data,
@@ -210,13 +618,49 @@ public :
 		for (uint32_t i = 0; i < division.nu_subdivisions; i++)
 			AddTask(flags, func, user_data, division, i);
 	}
+	// The completion callback of a group is called when its last subdivision has finished.
 	int AddSubdividedTaskGroup(int flags, dstTaskFunc func, const void *user_data,
-		dstTaskDivisionData& division);
+		dstTaskDivisionData& division, uint64_t deadline = 0,
+		dstTaskCompleteFunc complete_func = NULL, void *complete_data = NULL);
 	void WaitUntilFinished(int task_index);
 	void WaitUntilGroupFinished(int group_index);
 	void WaitUntilFinished();
+	// Return the indices of the tasks with DST_TASK_FLAG_NOTIFY_COMPLETION that have
+	// finished since the previous call, and reset the completion event. The returned
+	// tasks must still be released with WaitUntilFinished(), which returns immediately;
+	// they should not be waited for before their notification has been received.
 	const dstIntArray *GetCompletionNotifications();
+	// File descriptor that is readable while completion notifications are pending.
+	// It should only be polled, not read.
+	inline int GetCompletionEventFD() const {
+		return completion_event_fd;
+	}
 	int StartTaskGroup(int n);
+	// Start recording events in a ring buffer of nu_events events (rounded up to a power
+	// of two) for every thread that uses the scheduler, discarding the events and
+	// counters of an earlier trace. Work that is running meanwhile may be traced
+	// partially. The buffers of earlier traces are kept until the scheduler is destroyed.
+	void EnableTracing(uint32_t nu_events);
+	void DisableTracing();
+	inline bool IsTracing() const {
+		return tracing;
+	}
+	// Copy the counters of up to max_threads traced threads, returning the number of
+	// threads copied.
+	int GetTraceSummary(dstTaskTraceSummary *summary, int max_threads);
+	void PrintTraceSummary();
+	// Write the recorded events as Chrome trace JSON. Returns false when the file
+	// cannot be written.
+	bool WriteChromeTrace(const char *filename);
+	// Asynchronous mode. Between BeginAsync() and EndAsync(), task groups that
+	// multi-threaded library functions called from the same thread would otherwise
+	// wait for are attached to a task handle instead, which is returned by EndAsync().
+	// Calls may be nested; the inner calls return a handle to the same work.
+	void BeginAsync();
+	dstTaskHandle EndAsync();
+	// Queue a subdivided task group that is attached to an asynchronous handle state.
+	void AddSubdividedTaskGroupAsync(dstTaskHandleState *state, int flags, dstTaskFunc func,
+		const void *user_data, const dstTaskDivisionData& division);
 };
 
 #endif
@@ -0,0 +1,157 @@
+/*
+
+Copyright (c) 2014 Harm Hanemaaijer <fgenfb@yahoo.com>
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted, provided that the above
+copyright notice and this permission notice appear in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "dstMisc.h"
+#include "dstThreadingModel.h"
+
+dstThreadingModel dst_threading_model;
+
+void dstThreadingModel::Initialize(int max_threads) {
+	max_threads = maxi(max_threads, 1);
+	nu_candidates = 0;
+	int t = 1;
+	while (t <= max_threads && nu_candidates < DST_THREADING_MODEL_MAX_CANDIDATES) {
+		candidate_nu_threads[nu_candidates] = t;
+		nu_candidates++;
+		if (t < 8)
+			t++;
+		else
+			t = t * 3 / 2;
+	}
+	// Always include the maximum.
+	if (candidate_nu_threads[nu_candidates - 1] != max_threads) {
+		if (nu_candidates == DST_THREADING_MODEL_MAX_CANDIDATES)
+			nu_candidates--;
+		candidate_nu_threads[nu_candidates] = max_threads;
+		nu_candidates++;
+	}
+	Reset();
+}
+
+static void dstResetThreadingModelKernel(dstThreadingModelKernel *k) {
+	memset(k->bucket, 0, sizeof(k->bucket));
+}
+
+void dstThreadingModel::Reset() {
+	for (int i = 0; i < DST_THREADING_MODEL_MAX_KERNELS; i++)
+		if (kernel[i] != NULL)
+			dstResetThreadingModelKernel(kernel[i]);
+}
+
+static int dstThreadingModelHash(const void *kernel) {
+	return (int)((((uintptr_t)kernel >> 4) * 2654435761u) % DST_THREADING_MODEL_MAX_KERNELS);
+}
+
+dstThreadingModelKernel *dstThreadingModel::GetKernel(const void *_kernel, uint32_t cost) {
+	int h = dstThreadingModelHash(_kernel);
+	for (int i = 0; i < DST_THREADING_MODEL_MAX_KERNELS; i++) {
+		int slot = (h + i) % DST_THREADING_MODEL_MAX_KERNELS;
+		dstThreadingModelKernel *k = kernel[slot];
+		if (k == NULL) {
+			// Add the kernel. Another thread may fill the slot at the same time.
+			dstThreadingModelKernel *new_k = new dstThreadingModelKernel;
+			new_k->kernel = _kernel;
+			new_k->cost = cost;
+			dstResetThreadingModelKernel(new_k);
+			if (__sync_bool_compare_and_swap(&kernel[slot], NULL, new_k))
+				return new_k;
+			delete new_k;
+			k = kernel[slot];
+		}
+		if (k->kernel == _kernel)
+			return k;
+	}
+	return NULL;
+}
+
+int dstThreadingModel::GetPreferredNumberOfThreads(const void *_kernel, uint32_t n) {
+	int h = dstThreadingModelHash(_kernel);
+	for (int i = 0; i < DST_THREADING_MODEL_MAX_KERNELS; i++) {
+		dstThreadingModelKernel *k = kernel[(h + i) % DST_THREADING_MODEL_MAX_KERNELS];
+		if (k == NULL)
+			return 0;
+		if (k->kernel != _kernel)
+			continue;
+		const dstThreadingModelBucket *b = &k->bucket[dstGetThreadingModelBucket(n)];
+		int best = - 1;
+		for (int j = 0; j < nu_candidates; j++)
+			if (b->nu_samples[j] > 0 && (best < 0 ||
+			b->time_per_element[j] < b->time_per_element[best]))
+				best = j;
+		return best < 0 ? 0 : candidate_nu_threads[best];
+	}
+	return 0;
+}
+
+int dstThreadingModelKernel::ChooseCandidate(uint32_t n, int max_threads) const {
+	const dstThreadingModel *model = &dst_threading_model;
+	const dstThreadingModelBucket *b = &bucket[dstGetThreadingModelBucket(n)];
+	// Determine the candidates that are allowed and sensible for the size.
+	int nu = 1;
+	while (nu < model->nu_candidates && model->candidate_nu_threads[nu] <= max_threads &&
+	n / model->candidate_nu_threads[nu] >= DST_THREADING_MODEL_MIN_ELEMENTS_PER_THREAD)
+		nu++;
+	if (nu == 1)
+		return 0;
+	// During calibration, try the untried candidate that is closest to the static
+	// estimate.
+	int estimate = 1 + (uint64_t)n * cost / DST_TWO_THREADS_COST_THRESHOLD;
+	int untried = - 1;
+	int untried_distance = INT_MAX;
+	for (int i = 0; i < nu; i++)
+		if (b->nu_samples[i] == 0 &&
+		abs(model->candidate_nu_threads[i] - estimate) < untried_distance) {
+			untried = i;
+			untried_distance = abs(model->candidate_nu_threads[i] - estimate);
+		}
+	if (untried >= 0)
+		return untried;
+	int best = 0;
+	for (int i = 1; i < nu; i++)
+		if (b->time_per_element[i] < b->time_per_element[best])
+			best = i;
+	// Regularly try a neighbouring candidate, alternating between fewer and more threads.
+	if (b->nu_calls % DST_THREADING_MODEL_EXPLORE_INTERVAL ==
+	DST_THREADING_MODEL_EXPLORE_INTERVAL - 1) {
+		int neighbour = ((b->nu_calls / DST_THREADING_MODEL_EXPLORE_INTERVAL) & 1) ?
+			best + 1 : best - 1;
+		if (neighbour < 0)
+			neighbour = best + 1;
+		if (neighbour >= nu)
+			neighbour = best - 1;
+		if (neighbour >= 0 && neighbour < nu)
+			return neighbour;
+	}
+	return best;
+}
+
+void dstThreadingModelKernel::Update(uint32_t n, int candidate, uint64_t duration_nsec) {
+	dstThreadingModelBucket *b = &bucket[dstGetThreadingModelBucket(n)];
+	float t = (float)duration_nsec / n;
+	if (b->nu_samples[candidate] == 0)
+		b->time_per_element[candidate] = t;
+	else
+		// Exponentially weighted moving average with a weight of 1/8 for the new sample.
+		b->time_per_element[candidate] += (t - b->time_per_element[candidate]) * 0.125f;
+	b->nu_samples[candidate]++;
+	b->nu_calls++;
+}
@@ -0,0 +1,97 @@
+/*
+
+Copyright (c) 2014 Harm Hanemaaijer <fgenfb@yahoo.com>
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted, provided that the above
+copyright notice and this permission notice appear in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef __DST_THREADING_MODEL_H__
+#define __DST_THREADING_MODEL_H__
+
+// Self-calibrating threading cost model. For every multi-threaded kernel (identified
+// by the function that is executed for each subdivision) and every power-of-two size
+// bucket, the model keeps an exponentially weighted moving average of the measured
+// duration per element for each candidate thread count. The candidates are all
+// counts up to eight, followed by steps of roughly 1.5 times, up to the maximum
+// number of threads per function.
+//
+// The first calls of a kernel in a size bucket calibrate the model by trying every
+// candidate that is sensible for the size, starting at the count predicted by the
+// static cost estimate. After that, the candidate with the lowest average is used,
+// and one call in DST_THREADING_MODEL_EXPLORE_INTERVAL tries a neighbouring count, so
+// that the model keeps adapting to the actual machine and load.
+//
+// The model is used when the DST_FLAG_ADAPTIVE_THREADING flag is set (the default
+// when threading is enabled), no fixed number of threads is set, and the call is
+// waited for (maximum number of tasks of one, no asynchronous mode). Updates from
+// concurrent calls are not synchronized; a lost update only affects the averages.
+
+#include <dstConfig.h>
+
+#define DST_THREADING_MODEL_NU_BUCKETS 32
+#define DST_THREADING_MODEL_MAX_CANDIDATES 16
+#define DST_THREADING_MODEL_MAX_KERNELS 256
+// Calls on fewer elements are always executed by the calling thread without timing.
+#define DST_THREADING_MODEL_MIN_SIZE 4096
+// Minimum number of elements per thread for a candidate to be considered.
+#define DST_THREADING_MODEL_MIN_ELEMENTS_PER_THREAD 1024
+#define DST_THREADING_MODEL_EXPLORE_INTERVAL 64
+
+class DST_API dstThreadingModelBucket {
+public :
+	// Average duration per element in nanoseconds, per candidate.
+	float time_per_element[DST_THREADING_MODEL_MAX_CANDIDATES];
+	uint32_t nu_samples[DST_THREADING_MODEL_MAX_CANDIDATES];
+	uint32_t nu_calls;
+};
+
+class DST_API dstThreadingModelKernel {
+public :
+	const void *kernel;
+	// Static cost estimate per element, used as the starting point of calibration.
+	uint32_t cost;
+	dstThreadingModelBucket bucket[DST_THREADING_MODEL_NU_BUCKETS];
+
+	// Choose the candidate (index) for a call on n elements.
+	int ChooseCandidate(uint32_t n, int max_threads) const;
+	// Record the duration of a call.
+	void Update(uint32_t n, int candidate, uint64_t duration_nsec);
+};
+
+class DST_API dstThreadingModel {
+public :
+	int nu_candidates;
+	int candidate_nu_threads[DST_THREADING_MODEL_MAX_CANDIDATES];
+	dstThreadingModelKernel * volatile kernel[DST_THREADING_MODEL_MAX_KERNELS];
+
+	// Set up the candidate thread counts for the given maximum.
+	void Initialize(int max_threads);
+	// Discard all measurements.
+	void Reset();
+	// Return the model of a kernel, creating it when required. Returns NULL when the
+	// table is full.
+	dstThreadingModelKernel *GetKernel(const void *kernel, uint32_t cost);
+	// Return the number of threads the model currently prefers for a kernel and size
+	// (for diagnostics), or zero when the kernel has not been used.
+	int GetPreferredNumberOfThreads(const void *kernel, uint32_t n);
+};
+
+extern DST_API dstThreadingModel dst_threading_model;
+
+static DST_INLINE_ONLY int dstGetThreadingModelBucket(uint32_t n) {
+	return 31 - __builtin_clz(n | 1);
+}
+
+#endif
+
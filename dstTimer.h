@@ -23,6 +23,7 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
 #include <unistd.h>
 #include <sys/time.h>
+#include <time.h>
 #include <pthread.h>
 
 #ifdef _WIN32
@@ -37,6 +38,18 @@ DST_API inline uint64_t dstGetCurrentTimeUSec() {
     return tv.tv_sec * 1000000 + tv.tv_usec;
 }
 
+// Return a monotonic time stamp in nanoseconds, for measuring short durations.
+
+DST_API inline uint64_t dstGetCurrentTimeNSec() {
+#ifdef _WIN32
+    return dstGetCurrentTimeUSec() * 1000;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
 // Return current system time/date in seconds (double floating point format)
 
 DST_API inline double dstGetCurrentTime() {
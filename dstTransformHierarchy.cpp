@@ -0,0 +1,201 @@
+/*
+
+Copyright (c) 2014 Harm Hanemaaijer <fgenfb@yahoo.com>
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted, provided that the above
+copyright notice and this permission notice appear in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dstMisc.h"
+#include "dstMemory.h"
+#include "dstTransformHierarchy.h"
+
+dstTransformHierarchy::dstTransformHierarchy() {
+	nu_nodes = 0;
+	nu_levels = 0;
+	max_level_size = 0;
+	level_start = NULL;
+	sorted_node = NULL;
+	sorted_index = NULL;
+	sorted_parent = NULL;
+	local_matrix = NULL;
+	world_matrix = NULL;
+	dirty = NULL;
+	changed_index = NULL;
+	temp_parent_matrix = NULL;
+	temp_local_matrix = NULL;
+	temp_world_matrix = NULL;
+}
+
+dstTransformHierarchy::~dstTransformHierarchy() {
+	Free();
+}
+
+void dstTransformHierarchy::Free() {
+	delete [] level_start;
+	delete [] sorted_node;
+	delete [] sorted_index;
+	delete [] sorted_parent;
+	delete [] dirty;
+	delete [] changed_index;
+	// Matrix arrays are allocated with posix_memalign.
+	free(local_matrix);
+	free(world_matrix);
+	free(temp_parent_matrix);
+	free(temp_local_matrix);
+	free(temp_world_matrix);
+	level_start = NULL;
+	sorted_node = NULL;
+	sorted_index = NULL;
+	sorted_parent = NULL;
+	dirty = NULL;
+	changed_index = NULL;
+	local_matrix = NULL;
+	world_matrix = NULL;
+	temp_parent_matrix = NULL;
+	temp_local_matrix = NULL;
+	temp_world_matrix = NULL;
+	nu_nodes = 0;
+	nu_levels = 0;
+	max_level_size = 0;
+}
+
+void dstTransformHierarchy::Initialize(int n, const int *parent) {
+	Free();
+	nu_nodes = n;
+	// Calculate the depth of every node. Ancestors are followed until a node with
+	// known depth is found, so that the total work is linear in the number of nodes.
+	int *depth = new int[n];
+	int *path = new int[n];
+	for (int i = 0; i < n; i++)
+		depth[i] = - 1;
+	for (int i = 0; i < n; i++) {
+		int path_length = 0;
+		int j = i;
+		while (j >= 0 && depth[j] < 0) {
+			path[path_length++] = j;
+			j = parent[j];
+		}
+		int d = j >= 0 ? depth[j] + 1 : 0;
+		for (int k = path_length - 1; k >= 0; k--) {
+			depth[path[k]] = d;
+			d++;
+		}
+	}
+	delete [] path;
+	nu_levels = 0;
+	for (int i = 0; i < n; i++)
+		if (depth[i] + 1 > nu_levels)
+			nu_levels = depth[i] + 1;
+	// Stable counting sort by depth.
+	level_start = new int[nu_levels + 1];
+	for (int l = 0; l <= nu_levels; l++)
+		level_start[l] = 0;
+	for (int i = 0; i < n; i++)
+		level_start[depth[i] + 1]++;
+	max_level_size = 0;
+	for (int l = 0; l < nu_levels; l++) {
+		if (level_start[l + 1] > max_level_size)
+			max_level_size = level_start[l + 1];
+		level_start[l + 1] += level_start[l];
+	}
+	sorted_node = new int[n];
+	sorted_index = new int[n];
+	int *next = new int[nu_levels];
+	for (int l = 0; l < nu_levels; l++)
+		next[l] = level_start[l];
+	for (int i = 0; i < n; i++) {
+		int j = next[depth[i]]++;
+		sorted_node[j] = i;
+		sorted_index[i] = j;
+	}
+	delete [] next;
+	delete [] depth;
+	sorted_parent = new int[n];
+	for (int j = 0; j < n; j++) {
+		int p = parent[sorted_node[j]];
+		sorted_parent[j] = p >= 0 ? sorted_index[p] : - 1;
+	}
+	local_matrix = dstNewAligned <Matrix4x3RM>(n, 16);
+	world_matrix = dstNewAligned <Matrix4x3RM>(n, 16);
+	dirty = new unsigned char[n];
+	for (int j = 0; j < n; j++) {
+		local_matrix[j].SetIdentity();
+		world_matrix[j].SetIdentity();
+		dirty[j] = 0;
+	}
+	changed_index = new int[max_level_size];
+	temp_parent_matrix = dstNewAligned <Matrix4x3RM>(max_level_size, 16);
+	temp_local_matrix = dstNewAligned <Matrix4x3RM>(max_level_size, 16);
+	temp_world_matrix = dstNewAligned <Matrix4x3RM>(max_level_size, 16);
+}
+
+// Update a level other than the root level. A node is recalculated when it is
+// dirty itself or when its parent was recalculated; in the latter case the node is
+// marked dirty so that the change propagates to the next level.
+
+void dstTransformHierarchy::UpdateLevel(int level, bool force) {
+	int start = level_start[level];
+	int end = level_start[level + 1];
+	int nu_changed = 0;
+	for (int j = start; j < end; j++) {
+		if (force || dirty[j] || dirty[sorted_parent[j]]) {
+			dirty[j] = 1;
+			changed_index[nu_changed] = j;
+			temp_parent_matrix[nu_changed] = world_matrix[sorted_parent[j]];
+			nu_changed++;
+		}
+	}
+	if (nu_changed == 0)
+		return;
+	if (nu_changed == end - start) {
+		// The whole level has changed; the local and world matrices of the level
+		// are contiguous.
+		dstMatrixMultiplyMatrices(nu_changed, temp_parent_matrix, &local_matrix[start],
+			&world_matrix[start]);
+		dstSyncTasks();
+		return;
+	}
+	for (int k = 0; k < nu_changed; k++)
+		temp_local_matrix[k] = local_matrix[changed_index[k]];
+	dstMatrixMultiplyMatrices(nu_changed, temp_parent_matrix, temp_local_matrix,
+		temp_world_matrix);
+	dstSyncTasks();
+	for (int k = 0; k < nu_changed; k++)
+		world_matrix[changed_index[k]] = temp_world_matrix[k];
+}
+
+void dstTransformHierarchy::Update() {
+	if (nu_levels == 0)
+		return;
+	for (int j = level_start[0]; j < level_start[1]; j++)
+		if (dirty[j])
+			world_matrix[j] = local_matrix[j];
+	for (int l = 1; l < nu_levels; l++)
+		UpdateLevel(l, false);
+	memset(dirty, 0, nu_nodes);
+}
+
+void dstTransformHierarchy::UpdateAll() {
+	if (nu_levels == 0)
+		return;
+	for (int j = level_start[0]; j < level_start[1]; j++)
+		world_matrix[j] = local_matrix[j];
+	for (int l = 1; l < nu_levels; l++)
+		UpdateLevel(l, true);
+	memset(dirty, 0, nu_nodes);
+}
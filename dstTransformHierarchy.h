@@ -0,0 +1,98 @@
+/*
+
+Copyright (c) 2014 Harm Hanemaaijer <fgenfb@yahoo.com>
+
+Permission to use, copy, modify, and/or distribute this software for any
+purpose with or without fee is hereby granted, provided that the above
+copyright notice and this permission notice appear in all copies.
+
+THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef __DST_TRANSFORM_HIERARCHY_H__
+#define __DST_TRANSFORM_HIERARCHY_H__
+
+// Transform hierarchy class. Every node has a local Matrix4x3RM transformation
+// relative to its parent; the world transformation of a node is equal to
+// the world transformation of its parent multiplied by its local transformation.
+// Nodes are sorted by depth so that all nodes at the same depth (a level) can
+// be updated with a single call to the batch matrix multiplication function,
+// which is dispatched to SIMD code and split over threads for wide levels.
+// Only nodes whose local transformation has changed, and their descendants, are
+// recalculated by Update().
+
+#include <dstConfig.h>
+#include <dstMatrixMath.h>
+
+class DST_API dstTransformHierarchy {
+private :
+	int nu_nodes;
+	int nu_levels;
+	int max_level_size;
+	// Start of each level in sorted order; level_start[nu_levels] == nu_nodes.
+	int *level_start;
+	// Node index at each sorted position and sorted position of each node.
+	int *sorted_node;
+	int *sorted_index;
+	// Sorted position of the parent of each sorted node (-1 for roots).
+	int *sorted_parent;
+	// Local and world matrices, stored in sorted order.
+	Matrix4x3RM *local_matrix;
+	Matrix4x3RM *world_matrix;
+	// Dirty flags, stored in sorted order.
+	unsigned char *dirty;
+	// Temporary arrays with room for the largest level.
+	int *changed_index;
+	Matrix4x3RM *temp_parent_matrix;
+	Matrix4x3RM *temp_local_matrix;
+	Matrix4x3RM *temp_world_matrix;
+
+	void Free();
+	void UpdateLevel(int level, bool force);
+
+public :
+	dstTransformHierarchy();
+	~dstTransformHierarchy();
+	// Initialize the hierarchy with the given number of nodes. parent[i] is the
+	// index of the parent of node i, or -1 for a root node. Every node must have a
+	// path to a root node. All local transformations are set to the identity matrix.
+	void Initialize(int n, const int *parent);
+	void SetLocalMatrix(int i, const Matrix4x3RM& m) {
+		int j = sorted_index[i];
+		local_matrix[j] = m;
+		dirty[j] = 1;
+	}
+	const Matrix4x3RM& GetLocalMatrix(int i) const {
+		return local_matrix[sorted_index[i]];
+	}
+	// Mark a node as changed after its local matrix has been modified directly.
+	void MarkDirty(int i) {
+		dirty[sorted_index[i]] = 1;
+	}
+	// The world matrix is valid after Update() or UpdateAll() has been called.
+	const Matrix4x3RM& GetWorldMatrix(int i) const {
+		return world_matrix[sorted_index[i]];
+	}
+	int GetNumberOfNodes() const {
+		return nu_nodes;
+	}
+	int GetNumberOfLevels() const {
+		return nu_levels;
+	}
+	int GetLevelSize(int level) const {
+		return level_start[level + 1] - level_start[level];
+	}
+	// Recalculate the world matrices of changed nodes and their descendants.
+	void Update();
+	// Recalculate all world matrices.
+	void UpdateAll();
+};
+
+#endif
@@ -194,6 +194,45 @@ public:
 typedef Point2DBase <float> Point2D;
 typedef Point2DBase <double> PointDouble2D;
 
+// Four two-float vectors or points in SoA (structure of arrays) form, for use with
+// the batch 2D transformation functions. The array for n vectors consists of
+// (n + 3) / 4 elements.
+
+class Vector2DSoA4 {
+public:
+	float x[4];
+	float y[4];
+
+	Vector2D Get(int i) const {
+		return (Vector2D(x[i], y[i]));
+	}
+
+	Vector2DSoA4& Set(int i, const Vector2D& v) {
+		x[i] = v.x;
+		y[i] = v.y;
+		return (*this);
+	}
+} DST_ALIGNED(16);
+
+class Point2DSoA4 : public Vector2DSoA4 {
+public:
+	Point2D Get(int i) const {
+		return (Point2D(x[i], y[i]));
+	}
+} DST_ALIGNED(16);
+
+DST_INLINE_ONLY void dstConvertVectorsToSoA(int n, const Vector2D * DST_RESTRICT v,
+Vector2DSoA4 * DST_RESTRICT v_soa) {
+	for (int i = 0; i < n; i++)
+		v_soa[i >> 2].Set(i & 3, v[i]);
+}
+
+DST_INLINE_ONLY void dstConvertVectorsFromSoA(int n, const Vector2DSoA4 * DST_RESTRICT v_soa,
+Vector2D * DST_RESTRICT v) {
+	for (int i = 0; i < n; i++)
+		v[i] = v_soa[i >> 2].Get(i & 3);
+}
+
 
 template <class T>
 class DST_API Vector3DBase {
@@ -1102,6 +1141,25 @@ const T * DST_RESTRICT v1, const U& DST_RESTRICT v2, float * DST_RESTRICT dot) {
 					(const float *)v1, (const float *)&v2, dot);
 }
 
+// Asynchronous versions of the dot product functions. They return as soon as the work
+// has been queued; v1, v2 and dot must remain valid until the returned handle is done.
+
+template <class T>
+DST_INLINE_ONLY dstTaskHandle dstCalculateDotProductsNxNAsync(int n, const T * DST_RESTRICT v1,
+const T * DST_RESTRICT v2, float * DST_RESTRICT dot) {
+	dstBeginAsync();
+	dstCalculateDotProductsNxN(n, v1, v2, dot);
+	return dstEndAsync();
+}
+
+template <class T, class U>
+DST_INLINE_ONLY dstTaskHandle dstCalculateDotProductsNx1Async(int n,
+const T * DST_RESTRICT v1, const U& DST_RESTRICT v2, float * DST_RESTRICT dot) {
+	dstBeginAsync();
+	dstCalculateDotProductsNx1(n, v1, v2, dot);
+	return dstEndAsync();
+}
+
 // Calculate array of dot products of point vector array p1 with constant vector v2,
 // and count the number of dot products < 0. p1 must be aligned on a 16-byte
 // boundary.
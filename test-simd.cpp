@@ -20,6 +20,8 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#include <sched.h>
+#include <poll.h>
 #include <sys/time.h>
 #include <stdint.h>
 #include <unistd.h>
@@ -31,7 +33,14 @@ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include <dstMemory.h>
 #include <dstVectorMath.h>
 #include <dstThread.h>
+#include <dstParallel.h>
+#include <dstTaskGraph.h>
+#include <dstTaskTrace.h>
+#include <dstAffinity.h>
+#include <dstThreadingModel.h>
 #include <dstMatrixMath.h>
+#include <dstMatrixMathSIMD.h>
+#include <dstTransformHierarchy.h>
 
 
 // Duration of each test in seconds.
@@ -103,10 +112,18 @@ enum {
 
 Vector4D *vector4D_array[3];
 Vector3DPadded *vector3D_padded_array[3];
-Vector3D *vector3D_array[2];
+Vector3D *vector3D_array[3];
 float *dot_product_array[2][MAX_MAX_NU_TASKS];
 Matrix4D *matrix4D_array[4];
 Matrix4x3RM *matrix4x3RM_array[4];
+Matrix3D *matrix3D_array[4];
+Vector2D *vector2D_array[3];
+Vector2DSoA4 *vector2D_soa_array[3];
+PointDouble3D *point_double_array[3];
+dstSkinInfluences *skin_influence_array;
+uint32_t *matrix_index_array;
+Quaternion *quaternion_array[4];
+QuaternionSoA4 *quaternion_soa_array[4];
 dstRNG *rng;
 int simd_type;
 int vector_array_size;
@@ -348,6 +365,80 @@ static Matrix4x3RM RandomMatrix4x3RM() {
 	return m;
 }
 
+// Random matrices with a dominant diagonal, so that they are well-conditioned.
+
+static void SetRandomInvertibleMatrixArrays() {
+	for (int i = 0; i < matrix_array_size; i++) {
+		matrix4D_array[0][i] = RandomMatrix4D();
+		matrix4x3RM_array[0][i] = RandomMatrix4x3RM();
+		for (int j = 0; j < 3; j++)
+			for (int k = 0; k < 3; k++)
+				matrix3D_array[0][i](j, k) = rng->RandomFloat(1.0f);
+		for (int j = 0; j < 4; j++)
+			matrix4D_array[0][i].n[j][j] += 4.0f;
+		for (int j = 0; j < 3; j++) {
+			matrix4x3RM_array[0][i].n[j][j] += 4.0f;
+			matrix3D_array[0][i](j, j) += 4.0f;
+		}
+		// Set the result arrays to the same value, so that unused elements compare equal.
+		for (int j = 1; j < 3; j++) {
+			matrix4D_array[j][i] = matrix4D_array[0][i];
+			matrix4x3RM_array[j][i] = matrix4x3RM_array[0][i];
+			matrix3D_array[j][i] = matrix3D_array[0][i];
+		}
+	}
+}
+
+static void SetRandomMatrix3DArrays() {
+	for (int i = 0; i < matrix_array_size; i++) {
+		for (int j = 0; j < 4; j++)
+			for (int k = 0; k < 3; k++)
+				for (int l = 0; l < 3; l++)
+					matrix3D_array[j][i](k, l) = rng->RandomFloat(1.0f);
+	}
+}
+
+// Random 2D vectors in array 0, with the result arrays 1 and 2 set to the same random
+// value. The SoA arrays are set to the same values.
+
+static void SetRandomVector2DArrays() {
+	for (int i = 0; i < vector_array_size; i++) {
+		vector2D_array[0][i] = Vector2D(rng->RandomFloat(2.0f) - 1.0f,
+			rng->RandomFloat(2.0f) - 1.0f);
+		vector2D_array[1][i] = Vector2D(rng->RandomFloat(2.0f) - 1.0f,
+			rng->RandomFloat(2.0f) - 1.0f);
+		vector2D_array[2][i] = vector2D_array[1][i];
+	}
+	for (int j = 0; j < 3; j++)
+		dstConvertVectorsToSoA(vector_array_size, vector2D_array[j], vector2D_soa_array[j]);
+}
+
+// Random double-precision points in array 0, far away from the origin, with the result
+// arrays 1 and 2 set to the same value.
+
+static void SetRandomPointDoubleArrays() {
+	for (int i = 0; i < vector_array_size; i++) {
+		point_double_array[0][i] = PointDouble3D(
+			1.0E7d + rng->RandomFloat(2.0f) - 1.0f,
+			- 1.0E7d + rng->RandomFloat(2.0f) - 1.0f,
+			5.0E6d + rng->RandomFloat(2.0f) - 1.0f);
+		point_double_array[1][i] = PointDouble3D(0, 0, 0);
+		point_double_array[2][i] = point_double_array[1][i];
+	}
+}
+
+// Random double-precision affine transformation with a large translation.
+
+static MatrixDouble4D RandomMatrixDouble4D() {
+	Matrix4x3RM m = RandomMatrix4x3RM();
+	MatrixDouble4D md;
+	md.Set(m.n[0][0], m.n[0][1], m.n[0][2], 1.0E5d + m.n[0][3],
+		m.n[1][0], m.n[1][1], m.n[1][2], 2.0E5d + m.n[1][3],
+		m.n[2][0], m.n[2][1], m.n[2][2], - 1.0E5d + m.n[2][3],
+		0, 0, 0, 1.0d);
+	return md;
+}
+
 static void SetRandomMatrix4x3RMArrays() {
 	for (int i = 0; i < matrix_array_size; i++) {
 		for (int j = 0; j < 4; j++)
@@ -390,6 +481,43 @@ static double Matrix4x3RMArraysDeviation(int i1, int i2) {
 	return deviation / (matrix_array_size * 16);
 }
 
+static double Matrix3DArraysDeviation(int i1, int i2) {
+	double deviation = 0.0d;
+	for (int i = 0; i < matrix_array_size; i++)
+		for (int j = 0; j < 3; j++)
+			for (int k = 0; k < 3; k++)
+				deviation += fabs(matrix3D_array[i1][i](j, k) -
+					matrix3D_array[i2][i](j, k));
+	return deviation / (matrix_array_size * 9);
+}
+
+static double Vector2DArraysDeviation(int i1, int i2) {
+	double deviation = 0.0d;
+	for (int i = 0; i < vector_array_size; i++)
+		deviation += fabs(vector2D_array[i1][i].x - vector2D_array[i2][i].x) +
+			fabs(vector2D_array[i1][i].y - vector2D_array[i2][i].y);
+	return deviation / vector_array_size;
+}
+
+static double PointDoubleArraysDeviation(int i1, int i2) {
+	double deviation = 0.0d;
+	for (int i = 0; i < vector_array_size; i++)
+		deviation += fabs(point_double_array[i1][i].x - point_double_array[i2][i].x) +
+			fabs(point_double_array[i1][i].y - point_double_array[i2][i].y) +
+			fabs(point_double_array[i1][i].z - point_double_array[i2][i].z);
+	return deviation / vector_array_size;
+}
+
+static double Vector2DSoAArraysDeviation(int i1, int i2) {
+	double deviation = 0.0d;
+	for (int i = 0; i < vector_array_size; i++) {
+		Vector2D v1 = vector2D_soa_array[i1][i >> 2].Get(i & 3);
+		Vector2D v2 = vector2D_soa_array[i2][i >> 2].Get(i & 3);
+		deviation += fabs(v1.x - v2.x) + fabs(v1.y - v2.y);
+	}
+	return deviation / vector_array_size;
+}
+
 static double Vector4DArraysDeviation(int i1, int i2) {
 	double deviation = 0.0d;
 	for (int i = 0; i < vector_array_size; i++)
@@ -398,6 +526,14 @@ static double Vector4DArraysDeviation(int i1, int i2) {
 	return deviation / vector_array_size;
 }
 
+static double Vector3DArraysDeviation(int i1, int i2) {
+	double deviation = 0.0d;
+	for (int i = 0; i < vector_array_size; i++)
+		for (int j = 0; j < 3; j++)
+			deviation += fabs(vector3D_array[i1][i][j] - vector3D_array[i2][i][j]);
+	return deviation / vector_array_size;
+}
+
 static double Vector3DPaddedArraysDeviation(int i1, int i2) {
 	double deviation = 0.0d;
 	for (int i = 0; i < vector_array_size; i++)
@@ -407,6 +543,116 @@ static double Vector3DPaddedArraysDeviation(int i1, int i2) {
 	return deviation / vector_array_size;
 }
 
+// Random unit quaternions, with the quaternion arrays 2 and 3 (results) set to the
+// same value.
+
+static void SetRandomQuaternionArrays() {
+	for (int i = 0; i < vector_array_size; i++) {
+		for (int j = 0; j < 2; j++) {
+			Quaternion q(rng->RandomFloat(2.0f) - 1.0f, rng->RandomFloat(2.0f) - 1.0f,
+				rng->RandomFloat(2.0f) - 1.0f, rng->RandomFloat(2.0f) - 1.0f);
+			quaternion_array[j][i] = q.Normalize();
+		}
+		quaternion_array[2][i] = quaternion_array[0][i];
+		quaternion_array[3][i] = quaternion_array[0][i];
+		dot_product_array[1][0][i] = rng->RandomFloat(1.0f);
+	}
+	for (int j = 0; j < 4; j++)
+		dstConvertQuaternionsToSoA(vector_array_size, quaternion_array[j],
+			quaternion_soa_array[j]);
+}
+
+// Random rigid transformations (rotation and translation) in matrix array 0, so that
+// products along a transform hierarchy stay well-scaled. Uses quaternion array 0.
+
+static void SetRandomRigidMatrix4x3RMArrays() {
+	SetRandomQuaternionArrays();
+	for (int i = 0; i < matrix_array_size; i++) {
+		matrix4x3RM_array[0][i] = quaternion_array[0][i % vector_array_size].GetRotationMatrix4x3RM();
+		for (int j = 0; j < 3; j++)
+			matrix4x3RM_array[0][i].n[j][3] = rng->RandomFloat(2.0f) - 1.0f;
+	}
+}
+
+// Random bone influences (one to four bones with weights adding up to 1.0f) and
+// matrix indices, selecting from the first matrix_array_size matrices.
+
+static void SetRandomSkinInfluenceArrays() {
+	for (int i = 0; i < vector_array_size; i++) {
+		int nu_bones = rng->RandomInt(4) + 1;
+		float sum = 0.0f;
+		for (int j = 0; j < 4; j++) {
+			skin_influence_array[i].index[j] = 0;
+			skin_influence_array[i].weight[j] = 0.0f;
+			if (j < nu_bones) {
+				skin_influence_array[i].index[j] = rng->RandomInt(matrix_array_size);
+				skin_influence_array[i].weight[j] = rng->RandomFloat(1.0f) + 0.1f;
+				sum += skin_influence_array[i].weight[j];
+			}
+		}
+		for (int j = 0; j < nu_bones; j++)
+			skin_influence_array[i].weight[j] /= sum;
+		matrix_index_array[i] = rng->RandomInt(matrix_array_size);
+	}
+}
+
+static double QuaternionArraysDeviation(int i1, int i2) {
+	double deviation = 0.0d;
+	for (int i = 0; i < vector_array_size; i++) {
+		deviation += fabs(quaternion_array[i1][i].x - quaternion_array[i2][i].x) +
+			fabs(quaternion_array[i1][i].y - quaternion_array[i2][i].y) +
+			fabs(quaternion_array[i1][i].z - quaternion_array[i2][i].z) +
+			fabs(quaternion_array[i1][i].w - quaternion_array[i2][i].w);
+	}
+	return deviation / vector_array_size;
+}
+
+static double QuaternionSoAArraysDeviation(int i1, int i2) {
+	double deviation = 0.0d;
+	for (int i = 0; i < vector_array_size; i++) {
+		Quaternion q1 = quaternion_soa_array[i1][i >> 2].Get(i & 3);
+		Quaternion q2 = quaternion_soa_array[i2][i >> 2].Get(i & 3);
+		deviation += fabs(q1.x - q2.x) + fabs(q1.y - q2.y) + fabs(q1.z - q2.z) +
+			fabs(q1.w - q2.w);
+	}
+	return deviation / vector_array_size;
+}
+
+// Deviation of projected vertices stored in vector4D_array (as dstScreenVertex), with
+// each clip flags mismatch counted as a deviation of 1.0.
+
+static double ScreenVertexArraysDeviation(int i1, int i2) {
+	double deviation = 0.0d;
+	for (int i = 0; i < vector_array_size; i++) {
+		const dstScreenVertex *v1 = (const dstScreenVertex *)&vector4D_array[i1][i];
+		const dstScreenVertex *v2 = (const dstScreenVertex *)&vector4D_array[i2][i];
+		deviation += fabs(v1->x - v2->x) + fabs(v1->y - v2->y) + fabs(v1->z - v2->z);
+		if (v1->clip_flags != v2->clip_flags)
+			deviation += 1.0d;
+	}
+	return deviation / vector_array_size;
+}
+
+// Similar, for dstScreenVertexInt16. Rounding differences of one unit are ignored.
+
+static double ScreenVertexInt16ArraysDeviation(int i1, int i2) {
+	double deviation = 0.0d;
+	const dstScreenVertexInt16 *v1 = (const dstScreenVertexInt16 *)vector4D_array[i1];
+	const dstScreenVertexInt16 *v2 = (const dstScreenVertexInt16 *)vector4D_array[i2];
+	for (int i = 0; i < vector_array_size; i++) {
+		int d[3];
+		d[0] = abs(v1[i].x - v2[i].x);
+		d[1] = abs(v1[i].y - v2[i].y);
+		d[2] = abs(v1[i].z - v2[i].z);
+		for (int j = 0; j < 3; j++)
+			if (d[j] > 1)
+				deviation += d[j];
+		if (v1[i].clip_flags != v2[i].clip_flags)
+			deviation += 1.0d;
+	}
+	return deviation / vector_array_size;
+}
+
 // Matrix multiplication tests.
 
 static void Matrix4DMultiplicationTest() {
@@ -424,18 +670,16 @@ static void Matrix4DMultiplicationTest() {
 		    m3[i] = m1 * m2[i];
 	}
 	double elapsed = timer.Elapsed();
-        printf("SIMD accelerated Matrix4D multiplication (n = 10240000) took %.3gs\n",
+        printf("SIMD accelerated Matrix4D multiplication (operator *) (n = 10240000) took %.3gs\n",
 		elapsed);
-	dstSetSIMDType(DST_SIMD_NONE);
         timer.Start();
 	for (int j = 0; j < 10000; j++) {
 		for (int i = 0; i < 1024; i++)
-		    m3[i] = m1 * m2[i];
+		    dstMatrixMultiply(m1, m2[i], m3[i]);
 	}
 	elapsed = timer.Elapsed();
-        printf("Non-SIMD accelerated Matrix4D multiplication (n = 10240000) took %.3gs\n",
-		elapsed);
-	dstSetSIMDType(simd_type);
+        printf("SIMD accelerated Matrix4D multiplication (explicit using dstMatrixMultiply) "
+		"(n = 10240000) took %.3gs\n", elapsed);
         timer.Start();
 	for (int j = 0; j < 10000; j++) {
 		for (int i = 0; i < 1024; i++)
@@ -468,18 +712,16 @@ static void Matrix4x3RMMultiplicationTest() {
 		    m3[i] = m1 * m2[i];
 	}
 	double elapsed = timer.Elapsed();
-        printf("SIMD accelerated Matrix3x4RM multiplication (n = 10240000) took %.3gs\n",
+        printf("SIMD accelerated Matrix3x4RM multiplication (operator *) (n = 10240000) took %.3gs\n",
 		elapsed);
-	dstSetSIMDType(DST_SIMD_NONE);
         timer.Start();
 	for (int j = 0; j < 10000; j++) {
 		for (int i = 0; i < 1024; i++)
-		    m3[i] = m1 * m2[i];
+		    dstMatrixMultiply(m1, m2[i], m3[i]);
 	}
 	elapsed = timer.Elapsed();
-        printf("Non-SIMD accelerated Matrix3x4RM multiplication (n = 10240000) took %.3gs\n",
-		elapsed);
-	dstSetSIMDType(simd_type);
+        printf("SIMD accelerated Matrix3x4RM multiplication (explicit using dstMatrixMultiply) "
+		"(n = 10240000) took %.3gs\n", elapsed);
         timer.Start();
 	for (int j = 0; j < 10000; j++) {
 		for (int i = 0; i < 1024; i++)
@@ -497,6 +739,226 @@ static void Matrix4x3RMMultiplicationTest() {
 	printf("Sum = %f.\n", sum);
 }
 
+// Stages of the task graph test: a = v . v, b = 0.5 * a + 1 (chunk-wise dependency on the
+// first stage), sum of b (single task depending on the whole second stage).
+
+class TaskGraphTestData {
+public :
+	const Vector4D *v;
+	float *a;
+	float *b;
+	uint32_t n;
+	double sum;
+};
+
+static void TaskGraphTestStage1(dstThreadData *thread_data) {
+	TaskGraphTestData *data = (TaskGraphTestData *)thread_data->user_data;
+	uint32_t start = thread_data->subdivision.start_index;
+	uint32_t end = start + thread_data->subdivision.nu_elements;
+	for (uint32_t j = start; j < end; j++)
+		data->a[j] = Dot(data->v[j], data->v[j]);
+}
+
+static void TaskGraphTestStage2(dstThreadData *thread_data) {
+	TaskGraphTestData *data = (TaskGraphTestData *)thread_data->user_data;
+	uint32_t start = thread_data->subdivision.start_index;
+	uint32_t end = start + thread_data->subdivision.nu_elements;
+	for (uint32_t j = start; j < end; j++)
+		data->b[j] = 0.5f * data->a[j] + 1.0f;
+}
+
+static void TaskGraphTestStage3(dstThreadData *thread_data) {
+	TaskGraphTestData *data = (TaskGraphTestData *)thread_data->user_data;
+	double sum = 0.0d;
+	for (uint32_t j = 0; j < data->n; j++)
+		sum += data->b[j];
+	data->sum = sum;
+}
+
+// Continuation of the asynchronous dot product test: sum of a.
+
+static void AsyncTestSum(dstThreadData *thread_data) {
+	TaskGraphTestData *data = (TaskGraphTestData *)thread_data->user_data;
+	double sum = 0.0d;
+	for (uint32_t j = 0; j < data->n; j++)
+		sum += data->a[j];
+	data->sum = sum;
+}
+
+// Concurrent use of the library by several application threads, each with its own
+// context settings.
+
+#define NU_CONTEXT_TEST_THREADS 2
+
+class ContextTestData {
+public :
+	const Vector4D *v1;
+	const Vector4D *v2;
+	float *dot;
+	int n;
+	int nu_threads;
+	double deviation;
+};
+
+static void *ContextTestThread(void *user_data) {
+	ContextTestData *data = (ContextTestData *)user_data;
+	dstSetFixedNumberOfThreads(data->nu_threads);
+	dstSetFlag(DST_FLAG_THREADING | DST_FLAG_FIXED_NU_THREADS);
+	dstSetMaxNumberOfTasks(2);
+	data->deviation = 0.0d;
+	for (int i = 0; i < 20; i++) {
+		dstCalculateDotProductsNxN(data->n, data->v1, data->v2, data->dot);
+		dstSyncTasks();
+		for (int j = 0; j < data->n; j++)
+			data->deviation += fabs(data->dot[j] - Dot(data->v1[j], data->v2[j])) / data->n;
+	}
+	return NULL;
+}
+
+// Scheduler priority test. A single worker is kept busy by a blocking task while the
+// other tasks are queued, after which the order in which they are started is recorded.
+
+#define NU_PRIORITY_TEST_TASKS 6
+
+class PriorityTestData {
+public :
+	volatile int blocker_started;
+	volatile int blocker_released;
+	volatile int nu_started;
+	int order[NU_PRIORITY_TEST_TASKS];
+};
+
+static PriorityTestData priority_test_data;
+
+static void PriorityTestBlocker(dstThreadData *thread_data) {
+	priority_test_data.blocker_started = 1;
+	while (!priority_test_data.blocker_released)
+		sched_yield();
+}
+
+static void PriorityTestTask(dstThreadData *thread_data) {
+	int i = __sync_fetch_and_add(&priority_test_data.nu_started, 1);
+	priority_test_data.order[i] = (int)(uintptr_t)thread_data->user_data;
+}
+
+// Completion notification test. Each task calculates the dot products of one part of
+// the arrays; the completion callback counts the finished tasks.
+
+#define NU_COMPLETION_TEST_TASKS 8
+
+class CompletionTestData {
+public :
+	const Vector4D *v1;
+	const Vector4D *v2;
+	float *dot;
+	int n;
+	volatile int nu_callbacks;
+};
+
+static CompletionTestData completion_test_data;
+
+static void CompletionTestTask(dstThreadData *thread_data) {
+	int i = (int)(uintptr_t)thread_data->user_data;
+	int start = completion_test_data.n * i / NU_COMPLETION_TEST_TASKS;
+	int end = completion_test_data.n * (i + 1) / NU_COMPLETION_TEST_TASKS;
+	for (int j = start; j < end; j++)
+		completion_test_data.dot[j] = Dot(completion_test_data.v1[j],
+			completion_test_data.v2[j]);
+}
+
+static void CompletionTestCallback(void *complete_data) {
+	__sync_fetch_and_add((volatile int *)complete_data, 1);
+}
+
+// Completion callback visibility test. The callback delays before recording that it
+// has run, so that a thread that returned from waiting before the callback finished
+// would see the old value.
+
+#define NU_CALLBACK_TEST_ITERATIONS 16
+
+static void CallbackTestTask(dstThreadData *thread_data) {
+	usleep(100);
+}
+
+static void CallbackTestCallback(void *complete_data) {
+	usleep(1000);
+	*(int *)complete_data = 1;
+}
+
+// Lock-free queue test. Producers enqueue the numbers 1 to NU_QUEUE_TEST_ELEMENTS,
+// consumers add up what they dequeue.
+
+#define NU_QUEUE_TEST_ELEMENTS 100000
+#define NU_QUEUE_TEST_PRODUCERS 2
+
+class QueueTestData {
+public :
+	dstSPSCQueue <uint32_t> *spsc_queue;
+	dstMPMCQueue <uint32_t> *mpmc_queue;
+	// The number of elements still to be dequeued by all consumers.
+	volatile int nu_remaining;
+	uint64_t sum;
+};
+
+static void *QueueTestSPSCProducer(void *user_data) {
+	QueueTestData *data = (QueueTestData *)user_data;
+	for (uint32_t i = 1; i <= NU_QUEUE_TEST_ELEMENTS; i++)
+		while (!data->spsc_queue->Enqueue(i))
+			sched_yield();
+	return NULL;
+}
+
+static void *QueueTestMPMCProducer(void *user_data) {
+	QueueTestData *data = (QueueTestData *)user_data;
+	for (uint32_t i = 1; i <= NU_QUEUE_TEST_ELEMENTS; i++)
+		while (!data->mpmc_queue->Enqueue(i))
+			sched_yield();
+	return NULL;
+}
+
+static void *QueueTestMPMCConsumer(void *user_data) {
+	QueueTestData *data = (QueueTestData *)user_data;
+	uint64_t sum = 0;
+	while (data->nu_remaining > 0) {
+		uint32_t v;
+		if (data->mpmc_queue->Dequeue(v)) {
+			sum += v;
+			__sync_fetch_and_sub(&data->nu_remaining, 1);
+		}
+		else
+			sched_yield();
+	}
+	__sync_fetch_and_add(&data->sum, sum);
+	return NULL;
+}
+
+// Dynamic division test. Each chunk increments the counters of its elements and checks
+// the chunk bounds.
+
+#define NU_DIVISION_TEST_ELEMENTS 100003
+
+class DivisionTestData {
+public :
+	const dstTaskDivisionData *division;
+	volatile int count[NU_DIVISION_TEST_ELEMENTS];
+	volatile int nu_errors;
+};
+
+static DivisionTestData division_test_data;
+
+static void DivisionTestTask(dstThreadData *thread_data) {
+	const dstTaskDivisionData *division = division_test_data.division;
+	uint32_t start_index = thread_data->subdivision.start_index;
+	uint32_t nu_elements = thread_data->subdivision.nu_elements;
+	bool last = (start_index + nu_elements == division->size);
+	if (start_index % division->alignment != 0 || thread_data->subdivision.index >=
+	division->nu_subdivisions || nu_elements > division->max_chunk_size ||
+	(nu_elements < division->GetMinimumChunkSize() && !last))
+		__sync_fetch_and_add(&division_test_data.nu_errors, 1);
+	for (uint32_t i = start_index; i < start_index + nu_elements; i++)
+		__sync_fetch_and_add(&division_test_data.count[i], 1);
+}
+
 static const char *CorrectString(double deviation) {
 	if (deviation == 0.0d)
 		return "100% correct";
@@ -619,6 +1081,7 @@ int main(int argc, char *argv[]) {
 	vector4D_array[2] = dstNewAligned <Vector4D>(vector_array_size, page_size);
 	vector3D_array[0] = dstNewAligned <Vector3D>(vector_array_size, page_size);
 	vector3D_array[1] = dstNewAligned <Vector3D>(vector_array_size, page_size);
+	vector3D_array[2] = dstNewAligned <Vector3D>(vector_array_size, page_size);
         for (int i = 0; i < 3; i++)
 		vector3D_padded_array[i] = dstNewAligned <Vector3DPadded>(vector_array_size, page_size);
 	for (int i = 0; i < max_nu_tasks; i++) {
@@ -629,6 +1092,21 @@ int main(int argc, char *argv[]) {
 		matrix4D_array[i] = dstNewAligned <Matrix4D>(matrix_array_size, page_size);
 		matrix4x3RM_array[i] = dstNewAligned <Matrix4x3RM>(matrix_array_size, page_size);
 	}
+	for (int i = 0; i < 4; i++)
+		matrix3D_array[i] = dstNewAligned <Matrix3D>(matrix_array_size, page_size);
+	for (int i = 0; i < 3; i++) {
+		vector2D_array[i] = dstNewAligned <Vector2D>(vector_array_size, page_size);
+		vector2D_soa_array[i] = dstNewAligned <Vector2DSoA4>((vector_array_size + 3) / 4,
+			page_size);
+		point_double_array[i] = dstNewAligned <PointDouble3D>(vector_array_size, page_size);
+	}
+	skin_influence_array = dstNewAligned <dstSkinInfluences>(vector_array_size, page_size);
+	matrix_index_array = dstNewAligned <uint32_t>(vector_array_size, page_size);
+	for (int i = 0; i < 4; i++) {
+		quaternion_array[i] = dstNewAligned <Quaternion>(vector_array_size, page_size);
+		quaternion_soa_array[i] = dstNewAligned <QuaternionSoA4>((vector_array_size + 3) / 4,
+			page_size);
+	}
 #endif
 
 	TypeSizeReport();
@@ -838,85 +1316,268 @@ int main(int argc, char *argv[]) {
         printf("dstMatrixMultiplyMatrix4DMatrix4x3RM: average deviation = %lE (%s)\n",
 		avg_deviation, CorrectString(avg_deviation));
 
-	Matrix4DMultiplicationTest();
-	Matrix4x3RMMultiplicationTest();
-
-	// Correctness of matrix x vector multiplication functions.
+	// The matrix operators use inline SIMD functions regardless of the SIMD type;
+	// compare them with the non-SIMD dstMultiply functions.
 	deviation = 0.0d;
 	for (int i = 0; i < nu_correctness_iterations; i++) {
 		SetRandomMatrix4DArrays();
-		SetRandomVector4DArrays();
-		dstSetSIMDType(simd_type);
-		for (int j = 0; j < vector_array_size / 4; j++)
-			dstMatrixMultiplyVectors1x4(matrix4D_array[0][0],
-				(const Vector4D *)&vector4D_array[0][j * 4],
-				(Vector4D *)&vector4D_array[1][j * 4]);
-		dstSetSIMDType(DST_SIMD_NONE);
-		for (int j = 0; j < vector_array_size / 4; j++)
-			dstMatrixMultiplyVectors1x4(matrix4D_array[0][0],
-				(const Vector4D *)&vector4D_array[0][j * 4],
-				(Vector4D *)&vector4D_array[2][j * 4]);
-		deviation += Vector4DArraysDeviation(1, 2);
+		for (int j = 0; j < matrix_array_size; j++) {
+			matrix4D_array[2][j] = matrix4D_array[0][j] * matrix4D_array[1][j];
+			matrix4D_array[3][j] = dstMultiply(matrix4D_array[0][j], matrix4D_array[1][j]);
+		}
+		deviation += Matrix4DArraysDeviation(2, 3);
+		for (int j = 0; j < matrix_array_size; j++)
+			matrix4D_array[0][j] *= matrix4D_array[1][j];
+		deviation += Matrix4DArraysDeviation(0, 3);
 	}
-	avg_deviation = deviation / nu_correctness_iterations;
-        printf("dstMatrixMultiplyVectors1x4Matrix4DVector4D: average deviation = %lE (%s)\n",
+	avg_deviation = deviation / (nu_correctness_iterations * 2);
+        printf("Matrix4D operators: average deviation = %lE (%s)\n",
 		avg_deviation, CorrectString(avg_deviation));
-#if 0
-	for (int i = 0; i < 16; i++) {
-		char *s1, *s2;
-		s1 = vector4D_array[2][i].GetString();
-		s2 = vector4D_array[1][i].GetString();
-		printf("NonSIMD result: %s, SIMD result: %s\n", s1, s2);
-		delete s1;
-		delete s2;
-	}
-#endif
 
 	deviation = 0.0d;
 	for (int i = 0; i < nu_correctness_iterations; i++) {
-		SetRandomMatrix4DArrays();
-		SetRandomVector4DArrays();
-		dstSetSIMDType(simd_type);
-		dstMatrixMultiplyVectors1xN(vector_array_size,
-			matrix4D_array[0][0],
-			(const Vector4D *)vector4D_array[0],
-			(Vector4D *)vector4D_array[1]);
-		dstSetSIMDType(DST_SIMD_NONE);
-		dstMatrixMultiplyVectors1xN(vector_array_size,
-			matrix4D_array[0][0],
-			(const Vector4D *)vector4D_array[0],
-			(Vector4D *)vector4D_array[2]);
-		deviation += Vector4DArraysDeviation(1, 2);
+		SetRandomMatrix4x3RMArrays();
+		for (int j = 0; j < matrix_array_size; j++) {
+			matrix4x3RM_array[2][j] = matrix4x3RM_array[0][j] * matrix4x3RM_array[1][j];
+			matrix4x3RM_array[3][j] = dstMultiply(matrix4x3RM_array[0][j],
+				matrix4x3RM_array[1][j]);
+		}
+		deviation += Matrix4x3RMArraysDeviation(2, 3);
+		for (int j = 0; j < matrix_array_size; j++)
+			matrix4x3RM_array[0][j] *= matrix4x3RM_array[1][j];
+		deviation += Matrix4x3RMArraysDeviation(0, 3);
 	}
-	avg_deviation = deviation / nu_correctness_iterations;
-        printf("dstMatrixMultiplyVectors1xNMatrix4DVector4D: average deviation = %lE (%s)\n",
+	avg_deviation = deviation / (nu_correctness_iterations * 2);
+        printf("Matrix4x3RM operators: average deviation = %lE (%s)\n",
 		avg_deviation, CorrectString(avg_deviation));
 
 	deviation = 0.0d;
 	for (int i = 0; i < nu_correctness_iterations; i++) {
-		SetRandomMatrix4DArrays();
-		SetRandomVector3DPaddedArrays();
-		dstSetSIMDType(simd_type);
-		for (int j = 0; j < vector_array_size / 4; j++)
-			dstMatrixMultiplyVectors1x4(matrix4D_array[0][0],
-				(const Point3DPadded *)&vector3D_padded_array[0][j * 4],
-				(Point3DPadded *)&vector3D_padded_array[1][j * 4]);
-		dstSetSIMDType(DST_SIMD_NONE);
-		for (int j = 0; j < vector_array_size / 4; j++)
-			dstMatrixMultiplyVectors1x4(matrix4D_array[0][0],
-				(const Point3DPadded *)&vector3D_padded_array[0][j * 4],
-				(Point3DPadded *)&vector3D_padded_array[2][j * 4]);
-		deviation += Vector3DPaddedArraysDeviation(1, 2);
+		SetRandomMatrix3DArrays();
+		for (int j = 0; j < matrix_array_size; j++) {
+			matrix3D_array[2][j] = matrix3D_array[0][j] * matrix3D_array[1][j];
+			matrix3D_array[3][j] = dstMultiply(matrix3D_array[0][j], matrix3D_array[1][j]);
+		}
+		deviation += Matrix3DArraysDeviation(2, 3);
+		for (int j = 0; j < matrix_array_size; j++)
+			matrix3D_array[0][j] *= matrix3D_array[1][j];
+		deviation += Matrix3DArraysDeviation(0, 3);
 	}
-	avg_deviation = deviation / nu_correctness_iterations;
-        printf("dstMatrixMultiplyVectors1x4Matrix4DPoint3DPadded: average deviation = %lE (%s)\n",
+	avg_deviation = deviation / (nu_correctness_iterations * 2);
+        printf("Matrix3D operators: average deviation = %lE (%s)\n",
 		avg_deviation, CorrectString(avg_deviation));
 
+	// Vector * Matrix operators are not SIMD-accelerated, multiply with the transpose
+	// for comparison.
 	deviation = 0.0d;
 	for (int i = 0; i < nu_correctness_iterations; i++) {
 		SetRandomMatrix4DArrays();
-		SetRandomVector3DPaddedArrays();
-		dstSetSIMDType(simd_type);
+		SetRandomMatrix4x3RMArrays();
+		SetRandomVector4DArrays();
+		for (int j = 0; j < vector_array_size; j++) {
+			const Matrix4D& m = matrix4D_array[0][j % matrix_array_size];
+			vector4D_array[1][j] = m * vector4D_array[0][j];
+			vector4D_array[2][j] = vector4D_array[0][j] * Transpose(m);
+		}
+		deviation += Vector4DArraysDeviation(1, 2);
+		for (int j = 0; j < vector_array_size; j++) {
+			const Matrix4x3RM& m = matrix4x3RM_array[0][j % matrix_array_size];
+			vector4D_array[1][j] = m * vector4D_array[0][j];
+			vector4D_array[2][j] = vector4D_array[0][j] * Transpose(m);
+		}
+		deviation += Vector4DArraysDeviation(1, 2);
+		for (int j = 0; j < vector_array_size; j++) {
+			const Matrix4x3RM& m = matrix4x3RM_array[0][j % matrix_array_size];
+			Point3D p = vector4D_array[0][j].GetPoint3D();
+			vector4D_array[1][j] = m * p;
+			vector4D_array[2][j] = p * Transpose(m);
+		}
+		deviation += Vector4DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / (nu_correctness_iterations * 3);
+        printf("Matrix * vector operators: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	// Use array sizes that are not a multiple of four.
+	int n = matrix_array_size - 1;
+	int n_solve = (vector_array_size < matrix_array_size ?
+		vector_array_size : matrix_array_size) - 1;
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomInvertibleMatrixArrays();
+		dstSetSIMDType(simd_type);
+		dstInvertMatrices(n, matrix4D_array[0], matrix4D_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstInvertMatrices(n, matrix4D_array[0], matrix4D_array[2]);
+		deviation += Matrix4DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstInvertMatricesMatrix4D: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomInvertibleMatrixArrays();
+		dstSetSIMDType(simd_type);
+		dstInvertMatrices(n, matrix3D_array[0], matrix3D_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstInvertMatrices(n, matrix3D_array[0], matrix3D_array[2]);
+		deviation += Matrix3DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstInvertMatricesMatrix3D: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomInvertibleMatrixArrays();
+		dstSetSIMDType(simd_type);
+		dstInvertMatrices(n, matrix4x3RM_array[0], matrix4x3RM_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstInvertMatrices(n, matrix4x3RM_array[0], matrix4x3RM_array[2]);
+		deviation += Matrix4x3RMArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstInvertMatricesMatrix4x3RM: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		for (int j = 0; j < matrix_array_size; j++) {
+			Matrix4x3RM m;
+			matrix4x3RM_array[0][j].AssignRotationAlongXAxis(rng->RandomFloat(2.0f * M_PI));
+			m.AssignRotationAlongYAxis(rng->RandomFloat(2.0f * M_PI));
+			matrix4x3RM_array[0][j] *= m;
+			m.AssignTranslation(RandomVector3D());
+			matrix4x3RM_array[0][j] = m * matrix4x3RM_array[0][j];
+			matrix4x3RM_array[1][j] = matrix4x3RM_array[0][j];
+			matrix4x3RM_array[2][j] = matrix4x3RM_array[0][j];
+		}
+		dstSetSIMDType(simd_type);
+		dstInvertRigidMatrices(n, matrix4x3RM_array[0], matrix4x3RM_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstInvertMatrices(n, matrix4x3RM_array[0], matrix4x3RM_array[2]);
+		deviation += Matrix4x3RMArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstInvertRigidMatricesMatrix4x3RM: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomInvertibleMatrixArrays();
+		SetRandomVector3DArrays();
+		for (int j = 0; j < vector_array_size; j++)
+			vector3D_array[2][j] = vector3D_array[1][j];
+		dstSetSIMDType(simd_type);
+		dstSolveLinearSystems(n_solve, matrix3D_array[0], vector3D_array[0],
+			vector3D_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstSolveLinearSystems(n_solve, matrix3D_array[0], vector3D_array[0],
+			vector3D_array[2]);
+		deviation += Vector3DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstSolveLinearSystemsMatrix3D: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomInvertibleMatrixArrays();
+		SetRandomVector4DArrays();
+		for (int j = 0; j < vector_array_size; j++)
+			vector4D_array[2][j] = vector4D_array[1][j];
+		dstSetSIMDType(simd_type);
+		dstSolveLinearSystems(n_solve, matrix4D_array[0], vector4D_array[0],
+			vector4D_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstSolveLinearSystems(n_solve, matrix4D_array[0], vector4D_array[0],
+			vector4D_array[2]);
+		deviation += Vector4DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstSolveLinearSystemsMatrix4D: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	Matrix4DMultiplicationTest();
+	Matrix4x3RMMultiplicationTest();
+
+	// Correctness of matrix x vector multiplication functions.
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix4DArrays();
+		SetRandomVector4DArrays();
+		dstSetSIMDType(simd_type);
+		for (int j = 0; j < vector_array_size / 4; j++)
+			dstMatrixMultiplyVectors1x4(matrix4D_array[0][0],
+				(const Vector4D *)&vector4D_array[0][j * 4],
+				(Vector4D *)&vector4D_array[1][j * 4]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		for (int j = 0; j < vector_array_size / 4; j++)
+			dstMatrixMultiplyVectors1x4(matrix4D_array[0][0],
+				(const Vector4D *)&vector4D_array[0][j * 4],
+				(Vector4D *)&vector4D_array[2][j * 4]);
+		deviation += Vector4DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMatrixMultiplyVectors1x4Matrix4DVector4D: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+#if 0
+	for (int i = 0; i < 16; i++) {
+		char *s1, *s2;
+		s1 = vector4D_array[2][i].GetString();
+		s2 = vector4D_array[1][i].GetString();
+		printf("NonSIMD result: %s, SIMD result: %s\n", s1, s2);
+		delete s1;
+		delete s2;
+	}
+#endif
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix4DArrays();
+		SetRandomVector4DArrays();
+		dstSetSIMDType(simd_type);
+		dstMatrixMultiplyVectors1xN(vector_array_size,
+			matrix4D_array[0][0],
+			(const Vector4D *)vector4D_array[0],
+			(Vector4D *)vector4D_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyVectors1xN(vector_array_size,
+			matrix4D_array[0][0],
+			(const Vector4D *)vector4D_array[0],
+			(Vector4D *)vector4D_array[2]);
+		deviation += Vector4DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMatrixMultiplyVectors1xNMatrix4DVector4D: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix4DArrays();
+		SetRandomVector3DPaddedArrays();
+		dstSetSIMDType(simd_type);
+		for (int j = 0; j < vector_array_size / 4; j++)
+			dstMatrixMultiplyVectors1x4(matrix4D_array[0][0],
+				(const Point3DPadded *)&vector3D_padded_array[0][j * 4],
+				(Point3DPadded *)&vector3D_padded_array[1][j * 4]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		for (int j = 0; j < vector_array_size / 4; j++)
+			dstMatrixMultiplyVectors1x4(matrix4D_array[0][0],
+				(const Point3DPadded *)&vector3D_padded_array[0][j * 4],
+				(Point3DPadded *)&vector3D_padded_array[2][j * 4]);
+		deviation += Vector3DPaddedArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMatrixMultiplyVectors1x4Matrix4DPoint3DPadded: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix4DArrays();
+		SetRandomVector3DPaddedArrays();
+		dstSetSIMDType(simd_type);
 		dstMatrixMultiplyVectors1xN(vector_array_size,
 			matrix4D_array[0][0],
 			(const Point3DPadded *)vector3D_padded_array[0],
@@ -932,6 +1593,1219 @@ int main(int argc, char *argv[]) {
         printf("dstMatrixMultiplyVectors1xNMatrix4DPoint3DPadded: average deviation = %lE (%s)\n",
 		avg_deviation, CorrectString(avg_deviation));
 
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix4DArrays();
+		SetRandomVector3DArrays();
+		dstSetSIMDType(simd_type);
+		dstMatrixMultiplyVectors1xN(vector_array_size,
+			matrix4D_array[0][0],
+			(const Vector3D *)vector3D_array[0],
+			(Vector3D *)vector3D_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyVectors1xN(vector_array_size,
+			matrix4D_array[0][0],
+			(const Vector3D *)vector3D_array[0],
+			(Vector3D *)vector3D_array[2]);
+		deviation += Vector3DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMatrixMultiplyVectors1xNMatrix4DVector3D: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix4DArrays();
+		SetRandomVector3DArrays();
+		dstSetSIMDType(simd_type);
+		dstMatrixMultiplyVectors1xN(vector_array_size,
+			matrix4D_array[0][0],
+			(const Point3D *)vector3D_array[0],
+			(Point3D *)vector3D_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyVectors1xN(vector_array_size,
+			matrix4D_array[0][0],
+			(const Point3D *)vector3D_array[0],
+			(Point3D *)vector3D_array[2]);
+		deviation += Vector3DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMatrixMultiplyVectors1xNMatrix4DPoint3D: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix4x3RMArrays();
+		SetRandomVector3DArrays();
+		dstSetSIMDType(simd_type);
+		dstMatrixMultiplyVectors1xN(vector_array_size,
+			matrix4x3RM_array[0][0],
+			(const Point3D *)vector3D_array[0],
+			(Point3D *)vector3D_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyVectors1xN(vector_array_size,
+			matrix4x3RM_array[0][0],
+			(const Point3D *)vector3D_array[0],
+			(Point3D *)vector3D_array[2]);
+		deviation += Vector3DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMatrixMultiplyVectors1xNMatrix4x3RMPoint3D: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix4x3RMArrays();
+		SetRandomVector3DPaddedArrays();
+		dstSetSIMDType(simd_type);
+		dstMatrixMultiplyVectors1xN(vector_array_size,
+			matrix4x3RM_array[0][0],
+			(const Point3DPadded *)vector3D_padded_array[0],
+			(Point3DPadded *)vector3D_padded_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyVectors1xN(vector_array_size,
+			matrix4x3RM_array[0][0],
+			(const Point3DPadded *)vector3D_padded_array[0],
+			(Point3DPadded *)vector3D_padded_array[2]);
+		deviation += Vector3DPaddedArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMatrixMultiplyVectors1xNMatrix4x3RMPoint3DPadded: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+#ifndef DST_NO_SIMD
+	// The inline SIMD matrix classes, which store the results of four or eight vectors
+	// in transposed form. Vectors beyond the last multiple of eight keep the result of
+	// the non-SIMD function.
+	int n8 = vector_array_size & ~7;
+	float result_transposed[32] DST_ALIGNED(16);
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix4DArrays();
+		SetRandomVector4DArrays();
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyVectors1xN(vector_array_size,
+			matrix4D_array[0][0],
+			(const Vector4D *)vector4D_array[0],
+			(Vector4D *)vector4D_array[2]);
+		for (int j = 0; j < vector_array_size; j++)
+			vector4D_array[1][j] = vector4D_array[2][j];
+		Matrix4DSIMD m_simd;
+		m_simd.Set(matrix4D_array[0][0]);
+		for (int j = 0; j < n8; j += 4) {
+			m_simd.MultiplyFourVectors4((const float *)&vector4D_array[0][j],
+				result_transposed);
+			for (int k = 0; k < 4; k++)
+				vector4D_array[1][j + k] = Vector4D(result_transposed[k],
+					result_transposed[4 + k], result_transposed[8 + k],
+					result_transposed[12 + k]);
+		}
+		deviation += Vector4DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("SIMDMatrix4x4::MultiplyFourVectors4: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix4DArrays();
+		SetRandomVector4DArrays();
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyVectors1xN(vector_array_size,
+			matrix4D_array[0][0],
+			(const Vector4D *)vector4D_array[0],
+			(Vector4D *)vector4D_array[2]);
+		for (int j = 0; j < vector_array_size; j++)
+			vector4D_array[1][j] = vector4D_array[2][j];
+		Matrix4DSIMD m_simd;
+		m_simd.Set(matrix4D_array[0][0]);
+		for (int j = 0; j < n8; j += 8) {
+			m_simd.MultiplyEightVectors4((const float *)&vector4D_array[0][j],
+				result_transposed);
+			for (int k = 0; k < 8; k++)
+				vector4D_array[1][j + k] = Vector4D(result_transposed[k],
+					result_transposed[8 + k], result_transposed[16 + k],
+					result_transposed[24 + k]);
+		}
+		deviation += Vector4DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("SIMDMatrix4x4::MultiplyEightVectors4: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+#ifdef SIMD_HAVE_MATRIX4X3_VECTOR_MULTIPLICATION
+	// MultiplyFourVectors3Packed and MultiplyEightVectors3Packed use
+	// MultiplyFourVectors3Transposed with translation, so the vectors are points.
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix4x3RMArrays();
+		SetRandomVector3DArrays();
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyVectors1xN(vector_array_size,
+			matrix4x3RM_array[0][0],
+			(const Point3D *)vector3D_array[0],
+			(Point3D *)vector3D_array[2]);
+		for (int j = 0; j < vector_array_size; j++)
+			vector3D_array[1][j] = vector3D_array[2][j];
+		MatrixTransformSIMD m_simd;
+		m_simd.Set(matrix4x3RM_array[0][0]);
+		for (int j = 0; j < n8; j += 4) {
+			m_simd.MultiplyFourVectors3Packed((const float *)&vector3D_array[0][j], true,
+				result_transposed);
+			for (int k = 0; k < 4; k++)
+				vector3D_array[1][j + k] = Vector3D(result_transposed[k],
+					result_transposed[4 + k], result_transposed[8 + k]);
+		}
+		deviation += Vector3DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("SIMDMatrix4x3::MultiplyFourVectors3Packed: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix4x3RMArrays();
+		SetRandomVector3DArrays();
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyVectors1xN(vector_array_size,
+			matrix4x3RM_array[0][0],
+			(const Point3D *)vector3D_array[0],
+			(Point3D *)vector3D_array[2]);
+		for (int j = 0; j < vector_array_size; j++)
+			vector3D_array[1][j] = vector3D_array[2][j];
+		MatrixTransformSIMD m_simd;
+		m_simd.Set(matrix4x3RM_array[0][0]);
+		for (int j = 0; j < n8; j += 8) {
+			m_simd.MultiplyEightVectors3Packed((const float *)&vector3D_array[0][j], true,
+				result_transposed);
+			for (int k = 0; k < 8; k++)
+				vector3D_array[1][j + k] = Vector3D(result_transposed[k],
+					result_transposed[8 + k], result_transposed[16 + k]);
+		}
+		deviation += Vector3DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("SIMDMatrix4x3::MultiplyEightVectors3Packed: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+#endif
+#endif
+
+	// Projection that maps the random points (coordinates within [0, 1]) to w within
+	// [1, 1.5], with part of the points outside the view volume.
+	dstProjectionViewport pv;
+	pv.projection.Set(
+		Vector4D(3.0f, 0.0f, 0.0f, 0.0f), Vector4D(0.0f, 3.0f, 0.0f, 0.0f),
+		Vector4D(0.0f, 0.0f, 5.0f, 0.5f), Vector4D(- 1.5f, - 1.5f, - 2.5f, 1.0f));
+	// Use a small viewport for floating point output so that the deviation is not
+	// dominated by the magnitude of the screen coordinates.
+	pv.SetViewport(0.5f, 0.25f, 2.0f, 1.5f);
+	for (int k = 0; k < 4; k++) {
+		const char *s = "";
+		bool int16 = (k >= 2);
+		if (int16)
+			pv.SetViewport(16.0f, 8.0f, 640.0f, 480.0f, 0.0f, 65535.0f);
+		deviation = 0.0d;
+		for (int i = 0; i < nu_correctness_iterations; i++) {
+			if (k == 0 || k == 2)
+				SetRandomVector3DArrays();
+			else
+				SetRandomVector3DPaddedArrays();
+			for (int j = 0; j < 2; j++) {
+				dstSetSIMDType(j == 0 ? simd_type : DST_SIMD_NONE);
+				if (k == 0) {
+					s = "dstTransformAndProjectPointsPoint3D";
+					dstTransformAndProjectPoints(vector_array_size, pv,
+						(const Point3D *)vector3D_array[0],
+						(dstScreenVertex *)vector4D_array[j + 1]);
+				}
+				else if (k == 1) {
+					s = "dstTransformAndProjectPointsPoint3DPadded";
+					dstTransformAndProjectPoints(vector_array_size, pv,
+						(const Point3DPadded *)vector3D_padded_array[0],
+						(dstScreenVertex *)vector4D_array[j + 1]);
+				}
+				else if (k == 2) {
+					s = "dstTransformAndProjectPointsPoint3DInt16";
+					dstTransformAndProjectPoints(vector_array_size, pv,
+						(const Point3D *)vector3D_array[0],
+						(dstScreenVertexInt16 *)vector4D_array[j + 1]);
+				}
+				else {
+					s = "dstTransformAndProjectPointsPoint3DPaddedInt16";
+					dstTransformAndProjectPoints(vector_array_size, pv,
+						(const Point3DPadded *)vector3D_padded_array[0],
+						(dstScreenVertexInt16 *)vector4D_array[j + 1]);
+				}
+			}
+			if (int16)
+				deviation += ScreenVertexInt16ArraysDeviation(1, 2);
+			else
+				deviation += ScreenVertexArraysDeviation(1, 2);
+		}
+		avg_deviation = deviation / nu_correctness_iterations;
+		printf("%s: average deviation = %lE (%s)\n", s, avg_deviation,
+			CorrectString(avg_deviation));
+	}
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomQuaternionArrays();
+		dstSetSIMDType(simd_type);
+		dstMultiplyQuaternions(vector_array_size, quaternion_array[0], quaternion_array[1],
+			quaternion_array[2]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMultiplyQuaternions(vector_array_size, quaternion_array[0], quaternion_array[1],
+			quaternion_array[3]);
+		deviation += QuaternionArraysDeviation(2, 3);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMultiplyQuaternions: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomQuaternionArrays();
+		dstSetSIMDType(simd_type);
+		dstMultiplyQuaternions(vector_array_size, quaternion_soa_array[0],
+			quaternion_soa_array[1], quaternion_soa_array[2]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMultiplyQuaternions(vector_array_size, quaternion_soa_array[0],
+			quaternion_soa_array[1], quaternion_soa_array[3]);
+		deviation += QuaternionSoAArraysDeviation(2, 3);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMultiplyQuaternionsSoA: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomQuaternionArrays();
+		dstSetSIMDType(simd_type);
+		dstNormalizeQuaternions(vector_array_size, quaternion_array[0], quaternion_array[2]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstNormalizeQuaternions(vector_array_size, quaternion_array[0], quaternion_array[3]);
+		deviation += QuaternionArraysDeviation(2, 3);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstNormalizeQuaternions: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomQuaternionArrays();
+		dstSetSIMDType(simd_type);
+		dstNlerpQuaternions(vector_array_size, quaternion_array[0], quaternion_array[1],
+			dot_product_array[1][0], quaternion_array[2]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstNlerpQuaternions(vector_array_size, quaternion_array[0], quaternion_array[1],
+			dot_product_array[1][0], quaternion_array[3]);
+		deviation += QuaternionArraysDeviation(2, 3);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstNlerpQuaternions: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomQuaternionArrays();
+		dstSetSIMDType(simd_type);
+		dstSlerpQuaternions(vector_array_size, quaternion_array[0], quaternion_array[1],
+			dot_product_array[1][0], quaternion_array[2]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstSlerpQuaternions(vector_array_size, quaternion_array[0], quaternion_array[1],
+			dot_product_array[1][0], quaternion_array[3]);
+		deviation += QuaternionArraysDeviation(2, 3);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstSlerpQuaternions: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomQuaternionArrays();
+		dstSetSIMDType(simd_type);
+		dstSlerpQuaternions(vector_array_size, quaternion_soa_array[0],
+			quaternion_soa_array[1], dot_product_array[1][0], quaternion_soa_array[2]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstSlerpQuaternions(vector_array_size, quaternion_soa_array[0],
+			quaternion_soa_array[1], dot_product_array[1][0], quaternion_soa_array[3]);
+		deviation += QuaternionSoAArraysDeviation(2, 3);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstSlerpQuaternionsSoA: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomQuaternionArrays();
+		SetRandomVector3DArrays();
+		dstSetSIMDType(simd_type);
+		dstRotateVectors(vector_array_size, quaternion_array[0], vector3D_array[0],
+			vector3D_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstRotateVectors(vector_array_size, quaternion_array[0], vector3D_array[0],
+			vector3D_array[2]);
+		deviation += Vector3DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstRotateVectorsVector3D: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomQuaternionArrays();
+		SetRandomVector3DPaddedArrays();
+		dstSetSIMDType(simd_type);
+		dstRotateVectors(vector_array_size, quaternion_array[0], vector3D_padded_array[0],
+			vector3D_padded_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstRotateVectors(vector_array_size, quaternion_array[0], vector3D_padded_array[0],
+			vector3D_padded_array[2]);
+		deviation += Vector3DPaddedArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstRotateVectorsVector3DPadded: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomQuaternionArrays();
+		SetRandomInvertibleMatrixArrays();
+		dstSetSIMDType(simd_type);
+		dstConvertQuaternionsToMatrices(n_solve, quaternion_array[0], matrix3D_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstConvertQuaternionsToMatrices(n_solve, quaternion_array[0], matrix3D_array[2]);
+		deviation += Matrix3DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstConvertQuaternionsToMatricesMatrix3D: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomQuaternionArrays();
+		SetRandomInvertibleMatrixArrays();
+		dstSetSIMDType(simd_type);
+		dstConvertQuaternionsToMatrices(n_solve, quaternion_array[0], matrix4x3RM_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstConvertQuaternionsToMatrices(n_solve, quaternion_array[0], matrix4x3RM_array[2]);
+		deviation += Matrix4x3RMArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstConvertQuaternionsToMatricesMatrix4x3RM: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix4x3RMArrays();
+		dstSetSIMDType(simd_type);
+		dstMatrixMultiplyMatrices(matrix_array_size, matrix4x3RM_array[0], matrix4x3RM_array[1],
+			matrix4x3RM_array[2]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyMatrices(matrix_array_size, matrix4x3RM_array[0], matrix4x3RM_array[1],
+			matrix4x3RM_array[3]);
+		deviation += Matrix4x3RMArraysDeviation(2, 3);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMatrixMultiplyMatrices4x3RM: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix3DArrays();
+		dstSetSIMDType(simd_type);
+		dstMatrixMultiplyMatrices(matrix_array_size, matrix3D_array[0], matrix3D_array[1],
+			matrix3D_array[2]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyMatrices(matrix_array_size, matrix3D_array[0], matrix3D_array[1],
+			matrix3D_array[3]);
+		deviation += Matrix3DArraysDeviation(2, 3);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMatrixMultiplyMatrices3x3CM: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	// 2D affine transformations. Use an array size that is not a multiple of four; for
+	// the SoA versions, the last block is written in full, so it is compared in full.
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix3DArrays();
+		SetRandomVector2DArrays();
+		dstSetSIMDType(simd_type);
+		dstMatrixMultiplyVectors1xN(vector_array_size - 1, matrix3D_array[0][0],
+			vector2D_array[0], vector2D_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyVectors1xN(vector_array_size - 1, matrix3D_array[0][0],
+			vector2D_array[0], vector2D_array[2]);
+		deviation += Vector2DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMatrixMultiplyVectors1xNMatrix3DVector2D: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix3DArrays();
+		SetRandomVector2DArrays();
+		dstSetSIMDType(simd_type);
+		dstMatrixMultiplyVectors1xN(vector_array_size - 1, matrix3D_array[0][0],
+			(const Point2D *)vector2D_array[0], (Point2D *)vector2D_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyVectors1xN(vector_array_size - 1, matrix3D_array[0][0],
+			(const Point2D *)vector2D_array[0], (Point2D *)vector2D_array[2]);
+		deviation += Vector2DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMatrixMultiplyVectors1xNMatrix3DPoint2D: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix3DArrays();
+		SetRandomVector2DArrays();
+		dstSetSIMDType(simd_type);
+		dstMatrixMultiplyVectors1xN(vector_array_size - 1, matrix3D_array[0][0],
+			vector2D_soa_array[0], vector2D_soa_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyVectors1xN(vector_array_size, matrix3D_array[0][0],
+			vector2D_soa_array[0], vector2D_soa_array[2]);
+		deviation += Vector2DSoAArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMatrixMultiplyVectors1xNMatrix3DVector2DSoA: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomMatrix3DArrays();
+		SetRandomVector2DArrays();
+		dstSetSIMDType(simd_type);
+		dstMatrixMultiplyVectors1xN(vector_array_size - 1, matrix3D_array[0][0],
+			(const Point2DSoA4 *)vector2D_soa_array[0], (Point2DSoA4 *)vector2D_soa_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyVectors1xN(vector_array_size, matrix3D_array[0][0],
+			(const Point2DSoA4 *)vector2D_soa_array[0], (Point2DSoA4 *)vector2D_soa_array[2]);
+		deviation += Vector2DSoAArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMatrixMultiplyVectors1xNMatrix3DPoint2DSoA: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	// Double-precision transformation of points with large coordinates, and the mixed
+	// precision version that writes camera-relative single-precision points.
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		MatrixDouble4D m = RandomMatrixDouble4D();
+		SetRandomPointDoubleArrays();
+		dstSetSIMDType(simd_type);
+		dstMatrixMultiplyVectors1xN(vector_array_size, m, point_double_array[0],
+			point_double_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyVectors1xN(vector_array_size, m, point_double_array[0],
+			point_double_array[2]);
+		deviation += PointDoubleArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMatrixMultiplyVectors1xNMatrixDouble4DPointDouble3D: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		MatrixDouble4D m = RandomMatrixDouble4D();
+		SetRandomPointDoubleArrays();
+		PointDouble3D origin = (m * point_double_array[0][0]).GetPoint3D();
+		dstSetSIMDType(simd_type);
+		dstMatrixMultiplyVectors1xN(vector_array_size, m, origin, point_double_array[0],
+			(Point3D *)vector3D_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyVectors1xN(vector_array_size, m, origin, point_double_array[0],
+			(Point3D *)vector3D_array[2]);
+		deviation += Vector3DArraysDeviation(1, 2);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMatrixMultiplyVectors1xNMatrixDouble4DPointDouble3DRelative: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	// Compare the transform hierarchy (SIMD batch multiplication per level) with
+	// straightforward propagation in node order; every parent has a lower index than
+	// its children. After the full update, a subset of the local matrices is changed
+	// and only the incremental update is performed.
+	int *parent = new int[matrix_array_size];
+	dstTransformHierarchy hierarchy;
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		for (int j = 0; j < matrix_array_size; j++)
+			if (j < 4 || rng->RandomInt(64) == 0)
+				parent[j] = - 1;
+			else
+				parent[j] = rng->RandomInt(j);
+		hierarchy.Initialize(matrix_array_size, parent);
+		SetRandomRigidMatrix4x3RMArrays();
+		dstSetSIMDType(simd_type);
+		for (int j = 0; j < matrix_array_size; j++)
+			hierarchy.SetLocalMatrix(j, matrix4x3RM_array[0][j]);
+		hierarchy.UpdateAll();
+		for (int k = 0; k < 2; k++) {
+			for (int j = 0; j < matrix_array_size; j++) {
+				if (parent[j] < 0)
+					matrix4x3RM_array[2][j] = matrix4x3RM_array[0][j];
+				else
+					matrix4x3RM_array[2][j] = dstMultiply(
+						matrix4x3RM_array[2][parent[j]], matrix4x3RM_array[0][j]);
+				matrix4x3RM_array[1][j] = hierarchy.GetWorldMatrix(j);
+			}
+			deviation += Matrix4x3RMArraysDeviation(1, 2) * 0.5d;
+			if (k == 1)
+				break;
+			// Change the local matrices of a small number of nodes.
+			for (int j = 0; j < matrix_array_size / 16; j++) {
+				int node = rng->RandomInt(matrix_array_size);
+				matrix4x3RM_array[0][node] = quaternion_array[1][j % vector_array_size].
+					GetRotationMatrix4x3RM();
+				hierarchy.SetLocalMatrix(node, matrix4x3RM_array[0][node]);
+			}
+			hierarchy.Update();
+		}
+	}
+	delete [] parent;
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstTransformHierarchy: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	// Normal transformation, using a normal matrix cache for the SIMD version (the second
+	// call with the same matrix hits the cache). Use an array size that is not a multiple
+	// of four; the last element of the result arrays is set to the same value.
+	dstNormalMatrixCache normal_matrix_cache;
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomInvertibleMatrixArrays();
+		SetRandomVector3DArrays();
+		vector3D_array[2][vector_array_size - 1] = vector3D_array[1][vector_array_size - 1];
+		for (int j = 0; j < 2; j++) {
+			dstSetSIMDType(simd_type);
+			dstTransformNormals(vector_array_size - 1, matrix4x3RM_array[0][0],
+				vector3D_array[0], vector3D_array[1], &normal_matrix_cache);
+			dstSetSIMDType(DST_SIMD_NONE);
+			dstTransformNormals(vector_array_size - 1, matrix4x3RM_array[0][0],
+				vector3D_array[0], vector3D_array[2]);
+			deviation += Vector3DArraysDeviation(1, 2) * 0.5d;
+		}
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstTransformNormalsMatrix4x3RMVector3D: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomInvertibleMatrixArrays();
+		SetRandomVector3DPaddedArrays();
+		vector3D_padded_array[2][vector_array_size - 1] =
+			vector3D_padded_array[1][vector_array_size - 1];
+		for (int j = 0; j < 2; j++) {
+			dstSetSIMDType(simd_type);
+			dstTransformNormals(vector_array_size - 1, matrix4D_array[0][0],
+				vector3D_padded_array[0], vector3D_padded_array[1], &normal_matrix_cache);
+			dstSetSIMDType(DST_SIMD_NONE);
+			dstTransformNormals(vector_array_size - 1, matrix4D_array[0][0],
+				vector3D_padded_array[0], vector3D_padded_array[2]);
+			deviation += Vector3DPaddedArraysDeviation(1, 2) * 0.5d;
+		}
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstTransformNormalsMatrix4DVector3DPadded: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	// Skinning and per-vertex matrix selection, with positions in the padded vector
+	// arrays and normals in the four-component vector arrays. The last element is not
+	// processed and is set to the same value in both result arrays.
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomRigidMatrix4x3RMArrays();
+		SetRandomSkinInfluenceArrays();
+		SetRandomVector3DPaddedArrays();
+		SetRandomVector4DArrays();
+		vector3D_padded_array[2][vector_array_size - 1] =
+			vector3D_padded_array[1][vector_array_size - 1];
+		vector4D_array[2][vector_array_size - 1] = vector4D_array[1][vector_array_size - 1];
+		dstSetSIMDType(simd_type);
+		dstSkinVertices(vector_array_size - 1, matrix4x3RM_array[0], skin_influence_array,
+			(const Point3DPadded *)vector3D_padded_array[0],
+			(Point3DPadded *)vector3D_padded_array[1],
+			(const Vector3DPadded *)vector4D_array[0], (Vector3DPadded *)vector4D_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstSkinVertices(vector_array_size - 1, matrix4x3RM_array[0], skin_influence_array,
+			(const Point3DPadded *)vector3D_padded_array[0],
+			(Point3DPadded *)vector3D_padded_array[2],
+			(const Vector3DPadded *)vector4D_array[0], (Vector3DPadded *)vector4D_array[2]);
+		deviation += (Vector3DPaddedArraysDeviation(1, 2) + Vector4DArraysDeviation(1, 2)) *
+			0.5d;
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstSkinVertices: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomRigidMatrix4x3RMArrays();
+		SetRandomSkinInfluenceArrays();
+		SetRandomVector3DPaddedArrays();
+		SetRandomVector4DArrays();
+		vector3D_padded_array[2][vector_array_size - 1] =
+			vector3D_padded_array[1][vector_array_size - 1];
+		vector4D_array[2][vector_array_size - 1] = vector4D_array[1][vector_array_size - 1];
+		dstSetSIMDType(simd_type);
+		dstMatrixMultiplyVerticesIndexed(vector_array_size - 1, matrix4x3RM_array[0],
+			matrix_index_array, (const Point3DPadded *)vector3D_padded_array[0],
+			(Point3DPadded *)vector3D_padded_array[1],
+			(const Vector3DPadded *)vector4D_array[0], (Vector3DPadded *)vector4D_array[1]);
+		dstSetSIMDType(DST_SIMD_NONE);
+		dstMatrixMultiplyVerticesIndexed(vector_array_size - 1, matrix4x3RM_array[0],
+			matrix_index_array, (const Point3DPadded *)vector3D_padded_array[0],
+			(Point3DPadded *)vector3D_padded_array[2],
+			(const Vector3DPadded *)vector4D_array[0], (Vector3DPadded *)vector4D_array[2]);
+		deviation += (Vector3DPaddedArraysDeviation(1, 2) + Vector4DArraysDeviation(1, 2)) *
+			0.5d;
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstMatrixMultiplyVerticesIndexed: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	// Force multi-threading with a fixed number of threads, so that the parallel loop
+	// templates are also exercised on single-CPU systems.
+	uint32_t saved_flags = dstGetFlags();
+	dstSetFixedNumberOfThreads(4);
+	dstSetFlag(DST_FLAG_THREADING | DST_FLAG_FIXED_NU_THREADS);
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomVector4DArrays();
+		const Vector4D *v = vector4D_array[0];
+		float *dot = dot_product_array[0][0];
+		dstParallelFor(vector_array_size - 1, 64, 4, [=](uint32_t start, uint32_t end) {
+			for (uint32_t j = start; j < end; j++)
+				dot[j] = Dot(v[j], v[j]);
+		});
+		double sum = dstParallelReduce(vector_array_size - 1, 64, 1, 0.0d,
+			[=](uint32_t start, uint32_t end) {
+				double partial_sum = 0.0d;
+				for (uint32_t j = start; j < end; j++)
+					partial_sum += v[j].x;
+				return partial_sum;
+			},
+			[](double a, double b) {
+				return a + b;
+			});
+		double reference_sum = 0.0d;
+		for (int j = 0; j < vector_array_size - 1; j++) {
+			deviation += fabs(dot[j] - Dot(v[j], v[j])) / (vector_array_size - 1);
+			reference_sum += v[j].x;
+		}
+		deviation += fabs(sum - reference_sum);
+	}
+	dstSetFlags(saved_flags);
+	dstSetFixedNumberOfThreads(fixed_nu_threads);
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstParallelFor/dstParallelReduce: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	TaskGraphTestData graph_data;
+	graph_data.v = vector4D_array[0];
+	graph_data.a = dot_product_array[0][0];
+	graph_data.b = dot_product_array[1][0];
+	graph_data.n = vector_array_size - 1;
+	dstTaskDivisionData division;
+	division.size = vector_array_size - 1;
+	division.nu_subdivisions = 8;
+	division.alignment = 4;
+	dstTaskGraph graph;
+	int stage1 = graph.AddNode(TaskGraphTestStage1, &graph_data, division);
+	int stage2 = graph.AddNode(TaskGraphTestStage2, &graph_data, division);
+	int stage3 = graph.AddNode(TaskGraphTestStage3, &graph_data);
+	graph.AddDependency(stage1, stage2, true);
+	graph.AddDependency(stage2, stage3, false);
+	// The same stages behind a node without subdivisions, which must still release
+	// its successors.
+	dstTaskDivisionData empty_division;
+	empty_division.size = 0;
+	empty_division.nu_subdivisions = 0;
+	empty_division.alignment = 1;
+	dstTaskGraph empty_graph;
+	int empty_stage = empty_graph.AddNode(TaskGraphTestStage1, &graph_data, empty_division);
+	stage1 = empty_graph.AddNode(TaskGraphTestStage1, &graph_data, division);
+	stage2 = empty_graph.AddNode(TaskGraphTestStage2, &graph_data, division);
+	stage3 = empty_graph.AddNode(TaskGraphTestStage3, &graph_data);
+	empty_graph.AddDependency(empty_stage, stage1, false);
+	empty_graph.AddDependency(stage1, stage2, true);
+	empty_graph.AddDependency(stage2, stage3, false);
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomVector4DArrays();
+		double reference_sum = 0.0d;
+		for (int j = 0; j < vector_array_size - 1; j++)
+			reference_sum += 0.5f * Dot(vector4D_array[0][j], vector4D_array[0][j]) + 1.0f;
+		graph.Run();
+		graph.Wait();
+		deviation += fabs(graph_data.sum - reference_sum) / (vector_array_size - 1);
+		graph_data.sum = 0.0d;
+		empty_graph.Run();
+		empty_graph.Wait();
+		deviation += fabs(graph_data.sum - reference_sum) / (vector_array_size - 1);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("dstTaskGraph: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	// Asynchronous dot products, overlapped with the calculation of the reference values,
+	// with a continuation that sums the results of the first call.
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomVector4DArrays();
+		dstTaskHandle h1 = dstCalculateDotProductsNxNAsync(vector_array_size - 1,
+			vector4D_array[0], vector4D_array[1], dot_product_array[0][0]);
+		dstTaskHandle h2 = dstCalculateDotProductsNx1Async(vector_array_size - 1,
+			vector4D_array[0], vector4D_array[1][0], dot_product_array[1][0]);
+		graph_data.a = dot_product_array[0][0];
+		dstTaskHandle h3 = h1.Then(AsyncTestSum, &graph_data);
+		double reference_sum = 0.0d;
+		for (int j = 0; j < vector_array_size - 1; j++)
+			reference_sum += Dot(vector4D_array[0][j], vector4D_array[1][j]);
+		h2.Wait();
+		h3.Wait();
+		if (!h1.IsDone() || !h2.IsDone() || !h3.IsDone())
+			deviation += 1.0d;
+		for (int j = 0; j < vector_array_size - 1; j++)
+			deviation += fabs(dot_product_array[1][0][j] -
+				Dot(vector4D_array[0][j], vector4D_array[1][0])) / (vector_array_size - 1);
+		deviation += fabs(graph_data.sum - reference_sum) / (vector_array_size - 1);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("Asynchronous dot products: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	SetRandomVector4DArrays();
+	pthread_t context_test_thread[NU_CONTEXT_TEST_THREADS];
+	ContextTestData context_test_data[NU_CONTEXT_TEST_THREADS];
+	for (int i = 0; i < NU_CONTEXT_TEST_THREADS; i++) {
+		context_test_data[i].v1 = vector4D_array[0];
+		context_test_data[i].v2 = vector4D_array[1];
+		context_test_data[i].dot = dot_product_array[i][0];
+		context_test_data[i].n = vector_array_size - 1;
+		context_test_data[i].nu_threads = i + 2;
+		pthread_create(&context_test_thread[i], NULL, ContextTestThread, &context_test_data[i]);
+	}
+	deviation = 0.0d;
+	for (int i = 0; i < NU_CONTEXT_TEST_THREADS; i++) {
+		pthread_join(context_test_thread[i], NULL);
+		deviation += context_test_data[i].deviation;
+	}
+	// The settings of the other threads must not have affected this thread.
+	if (dstGetFlags() != saved_flags)
+		deviation += 1.0d;
+	avg_deviation = deviation / (NU_CONTEXT_TEST_THREADS * 20);
+        printf("Concurrent contexts: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	// Tasks 0 to 2 have duration estimates of 10, 30 and 20 us, task 3 has a deadline,
+	// task 4 has high priority and task 5 has none of these. The high-priority task must
+	// be started first, then the plain task from the worker's own deque, then the task
+	// with a deadline and then the others, longest first.
+	dstTaskScheduler *priority_scheduler = new dstTaskScheduler;
+	priority_scheduler->Start(1, 0);
+	priority_test_data.blocker_started = 0;
+	priority_test_data.blocker_released = 0;
+	priority_test_data.nu_started = 0;
+	int priority_task[NU_PRIORITY_TEST_TASKS + 1];
+	priority_task[NU_PRIORITY_TEST_TASKS] = priority_scheduler->AddTask(0,
+		PriorityTestBlocker, NULL);
+	while (!priority_test_data.blocker_started)
+		sched_yield();
+	priority_task[5] = priority_scheduler->AddTask(0, PriorityTestTask, (void *)5);
+	const uint32_t priority_test_duration[3] = { 10, 30, 20 };
+	for (int i = 0; i < 3; i++)
+		priority_task[i] = priority_scheduler->AddTask(DST_TASK_FLAG_DURATION_ESTIMATE,
+			PriorityTestTask, (void *)(uintptr_t)i, dstTaskDurationEstimate(
+			DST_TASK_DURATION_UNIT_USEC, priority_test_duration[i]));
+	priority_task[3] = priority_scheduler->AddTask(DST_TASK_FLAG_DEADLINE, PriorityTestTask,
+		(void *)3, dstTaskDurationEstimate(DST_TASK_DURATION_UNIT_NONE, 0),
+		priority_scheduler->GetTime() + 1000000);
+	priority_task[4] = priority_scheduler->AddTask(DST_TASK_FLAG_PRIORITY_HIGH,
+		PriorityTestTask, (void *)4);
+	priority_test_data.blocker_released = 1;
+	// Let the worker run all tasks, without taking any in this thread.
+	while (priority_test_data.nu_started < NU_PRIORITY_TEST_TASKS)
+		sched_yield();
+	for (int i = 0; i <= NU_PRIORITY_TEST_TASKS; i++)
+		priority_scheduler->WaitUntilFinished(priority_task[i]);
+	delete priority_scheduler;
+	const int priority_test_order[NU_PRIORITY_TEST_TASKS] = { 4, 5, 3, 1, 2, 0 };
+	deviation = 0.0d;
+	for (int i = 0; i < NU_PRIORITY_TEST_TASKS; i++)
+		if (priority_test_data.order[i] != priority_test_order[i])
+			deviation += 1.0d;
+	// Multi-threaded calls with high priority. The correctness tests above leave the SIMD
+	// type at DST_SIMD_NONE, whose functions are not multi-threaded.
+	dstSetStreamingSIMDType(simd_type);
+	dstSetFixedNumberOfThreads(4);
+	dstSetFlag(DST_FLAG_THREADING | DST_FLAG_FIXED_NU_THREADS | DST_FLAG_HIGH_PRIORITY);
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomVector4DArrays();
+		dstCalculateDotProductsNxN(vector_array_size - 1, vector4D_array[0],
+			vector4D_array[1], dot_product_array[0][0]);
+		dstSyncTasks();
+		for (int j = 0; j < vector_array_size - 1; j++)
+			deviation += fabs(dot_product_array[0][0][j] - Dot(vector4D_array[0][j],
+				vector4D_array[1][j])) / (vector_array_size - 1);
+	}
+	dstSetFlags(saved_flags);
+	dstSetFixedNumberOfThreads(fixed_nu_threads);
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("Task priorities: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	// Wait for tasks with completion notification by polling the completion event, as
+	// an event loop would.
+	dstTaskScheduler *scheduler = dstGetContext()->task_scheduler;
+	completion_test_data.v1 = vector4D_array[0];
+	completion_test_data.v2 = vector4D_array[1];
+	completion_test_data.dot = dot_product_array[0][0];
+	completion_test_data.n = vector_array_size - 1;
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomVector4DArrays();
+		completion_test_data.nu_callbacks = 0;
+		int completion_task[NU_COMPLETION_TEST_TASKS];
+		for (int j = 0; j < NU_COMPLETION_TEST_TASKS; j++)
+			completion_task[j] = scheduler->AddTask(DST_TASK_FLAG_NOTIFY_COMPLETION,
+				CompletionTestTask, (void *)(uintptr_t)j, CompletionTestCallback,
+				(void *)&completion_test_data.nu_callbacks);
+		bool notified[NU_COMPLETION_TEST_TASKS];
+		for (int j = 0; j < NU_COMPLETION_TEST_TASKS; j++)
+			notified[j] = false;
+		int nu_notified = 0;
+		while (nu_notified < NU_COMPLETION_TEST_TASKS) {
+			struct pollfd pfd;
+			pfd.fd = scheduler->GetCompletionEventFD();
+			pfd.events = POLLIN;
+			if (poll(&pfd, 1, 10000) <= 0) {
+				deviation += 1.0d;
+				break;
+			}
+			const dstIntArray *completed = scheduler->GetCompletionNotifications();
+			for (uint32_t k = 0; k < completed->Size(); k++)
+				for (int j = 0; j < NU_COMPLETION_TEST_TASKS; j++)
+					if (completion_task[j] == completed->Get(k) && !notified[j]) {
+						notified[j] = true;
+						nu_notified++;
+					}
+		}
+		for (int j = 0; j < NU_COMPLETION_TEST_TASKS; j++)
+			scheduler->WaitUntilFinished(completion_task[j]);
+		// The event must have been reset.
+		struct pollfd pfd;
+		pfd.fd = scheduler->GetCompletionEventFD();
+		pfd.events = POLLIN;
+		if (poll(&pfd, 1, 0) != 0 || completion_test_data.nu_callbacks !=
+		NU_COMPLETION_TEST_TASKS)
+			deviation += 1.0d;
+		for (int j = 0; j < vector_array_size - 1; j++)
+			deviation += fabs(dot_product_array[0][0][j] - Dot(vector4D_array[0][j],
+				vector4D_array[1][j])) / (vector_array_size - 1);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("Completion notification: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	// The effects of completion callbacks must be visible as soon as waiting for the
+	// task or group returns.
+	deviation = 0.0d;
+	for (int i = 0; i < NU_CALLBACK_TEST_ITERATIONS; i++) {
+		int task_callback_done = 0;
+		int group_callback_done = 0;
+		int task_index = scheduler->AddTask(0, CallbackTestTask, NULL,
+			CallbackTestCallback, &task_callback_done);
+		// Let a worker take the task, so that the callback runs on another thread.
+		usleep(500);
+		scheduler->WaitUntilFinished(task_index);
+		if (task_callback_done != 1)
+			deviation += 1.0d;
+		dstTaskDivisionData division;
+		division.size = 4;
+		division.nu_subdivisions = 4;
+		division.alignment = 1;
+		scheduler->AddSubdividedTaskGroup(0, CallbackTestTask, NULL, division, 0,
+			CallbackTestCallback, &group_callback_done);
+		usleep(500);
+		scheduler->WaitUntilFinished();
+		if (group_callback_done != 1)
+			deviation += 1.0d;
+	}
+	avg_deviation = deviation / NU_CALLBACK_TEST_ITERATIONS;
+        printf("Completion callback: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	// Producer/consumer pipelines through small lock-free queues, so that they are
+	// frequently full and empty.
+	QueueTestData queue_test_data;
+	const uint64_t queue_test_sum = (uint64_t)NU_QUEUE_TEST_ELEMENTS *
+		(NU_QUEUE_TEST_ELEMENTS + 1) / 2;
+	queue_test_data.spsc_queue = new dstSPSCQueue <uint32_t>(60);
+	queue_test_data.mpmc_queue = new dstMPMCQueue <uint32_t>(60);
+	deviation = 0.0d;
+	if (queue_test_data.spsc_queue->Capacity() != 64 ||
+	queue_test_data.mpmc_queue->Capacity() != 64)
+		deviation += 1.0d;
+	pthread_t queue_test_thread[NU_QUEUE_TEST_PRODUCERS + 1];
+	pthread_create(&queue_test_thread[0], NULL, QueueTestSPSCProducer, &queue_test_data);
+	uint64_t sum = 0;
+	for (int i = 0; i < NU_QUEUE_TEST_ELEMENTS;) {
+		uint32_t v;
+		if (queue_test_data.spsc_queue->Dequeue(v)) {
+			// Elements must arrive in order.
+			if (v != (uint32_t)i + 1)
+				deviation += 1.0d;
+			sum += v;
+			i++;
+		}
+		else
+			sched_yield();
+	}
+	pthread_join(queue_test_thread[0], NULL);
+	if (sum != queue_test_sum || !queue_test_data.spsc_queue->IsEmpty())
+		deviation += 1.0d;
+	queue_test_data.nu_remaining = NU_QUEUE_TEST_ELEMENTS * NU_QUEUE_TEST_PRODUCERS;
+	queue_test_data.sum = 0;
+	for (int i = 0; i < NU_QUEUE_TEST_PRODUCERS; i++)
+		pthread_create(&queue_test_thread[i], NULL, QueueTestMPMCProducer, &queue_test_data);
+	pthread_create(&queue_test_thread[NU_QUEUE_TEST_PRODUCERS], NULL, QueueTestMPMCConsumer,
+		&queue_test_data);
+	QueueTestMPMCConsumer(&queue_test_data);
+	for (int i = 0; i <= NU_QUEUE_TEST_PRODUCERS; i++)
+		pthread_join(queue_test_thread[i], NULL);
+	if (queue_test_data.sum != queue_test_sum * NU_QUEUE_TEST_PRODUCERS ||
+	!queue_test_data.mpmc_queue->IsEmpty())
+		deviation += 1.0d;
+	delete queue_test_data.spsc_queue;
+	delete queue_test_data.mpmc_queue;
+	avg_deviation = deviation;
+        printf("Lock-free queues: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	// Trace multi-threaded calls; every subdivision must have been counted once, and the
+	// trace must have been written. An earlier trace is recorded first, so that the
+	// buffers the threads have been using are replaced.
+	dstTaskScheduler *traced_scheduler = dstGetContext()->task_scheduler;
+	traced_scheduler->EnableTracing(1024);
+	dstSetFixedNumberOfThreads(4);
+	dstSetFlag(DST_FLAG_THREADING | DST_FLAG_FIXED_NU_THREADS);
+	dstCalculateDotProductsNxN(vector_array_size - 1, vector4D_array[0],
+		vector4D_array[1], dot_product_array[0][0]);
+	dstSyncTasks();
+	traced_scheduler->EnableTracing(4096);
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomVector4DArrays();
+		dstCalculateDotProductsNxN(vector_array_size - 1, vector4D_array[0],
+			vector4D_array[1], dot_product_array[0][0]);
+		dstSyncTasks();
+		for (int j = 0; j < vector_array_size - 1; j++)
+			deviation += fabs(dot_product_array[0][0][j] - Dot(vector4D_array[0][j],
+				vector4D_array[1][j])) / (vector_array_size - 1);
+	}
+	traced_scheduler->DisableTracing();
+	dstSetFlags(saved_flags);
+	dstSetFixedNumberOfThreads(fixed_nu_threads);
+	dstTaskTraceSummary trace_summary[64];
+	int nu_traced_threads = traced_scheduler->GetTraceSummary(trace_summary, 64);
+	uint64_t nu_traced_items = 0;
+	uint64_t nu_traced_enqueued = 0;
+	for (int i = 0; i < nu_traced_threads; i++) {
+		nu_traced_items += trace_summary[i].nu_items;
+		nu_traced_enqueued += trace_summary[i].nu_enqueued;
+	}
+	if (nu_traced_items != (uint64_t)nu_correctness_iterations * 4 ||
+	nu_traced_enqueued != nu_traced_items)
+		deviation += 1.0d;
+	char trace_filename[] = "/tmp/test-simd-trace-XXXXXX";
+	int trace_fd = mkstemp(trace_filename);
+	if (trace_fd >= 0) {
+		close(trace_fd);
+		if (!traced_scheduler->WriteChromeTrace(trace_filename))
+			deviation += 1.0d;
+		FILE *trace_file = fopen(trace_filename, "r");
+		char trace_header[16];
+		if (trace_file == NULL || fread(trace_header, 1, 15, trace_file) != 15 ||
+		strncmp(trace_header, "{\"traceEvents\"", 14) != 0)
+			deviation += 1.0d;
+		if (trace_file != NULL)
+			fclose(trace_file);
+		unlink(trace_filename);
+	}
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("Scheduler tracing: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	// Let the threading cost model calibrate itself (with up to four threads) on a larger
+	// array, and check the results of every chosen thread count.
+	const int model_array_size = 65536;
+	Vector4D *model_v1 = dstNewAligned <Vector4D>(model_array_size, 16);
+	Vector4D *model_v2 = dstNewAligned <Vector4D>(model_array_size, 16);
+	float *model_dot = dstNewAligned <float>(model_array_size, 16);
+	for (int j = 0; j < model_array_size; j++) {
+		model_v1[j] = Vector4D(j * 0.001f, 1.0f, - j * 0.002f, 0.5f);
+		model_v2[j] = Vector4D(0.5f, j * 0.003f, 2.0f, - 1.0f);
+	}
+	dstSetMaxNumberOfThreadsPerFunction(4);
+	dst_threading_model.Initialize(4);
+	dstSetFlags((saved_flags | DST_FLAG_THREADING | DST_FLAG_ADAPTIVE_THREADING) &
+		~DST_FLAG_FIXED_NU_THREADS);
+	deviation = 0.0d;
+	for (int i = 0; i < 100; i++) {
+		dstCalculateDotProductsNxN(model_array_size, model_v1, model_v2, model_dot);
+		for (int j = 0; j < model_array_size; j++)
+			deviation += fabs(model_dot[j] - Dot(model_v1[j], model_v2[j])) / model_array_size;
+	}
+	dstSetFlags(saved_flags);
+	dstSetMaxNumberOfThreadsPerFunction(dst_config.max_threads_per_function);
+	dst_threading_model.Initialize(dst_config.max_threads_per_function);
+	free(model_v1);
+	free(model_v2);
+	free(model_dot);
+	avg_deviation = deviation / 100;
+        printf("Threading cost model: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	// Dynamic and guided divisions must execute every element once, in aligned chunks
+	// within the bounds. Then compare multi-threaded dot products in guided mode.
+	dstTaskScheduler *division_scheduler = dstGetContext()->task_scheduler;
+	deviation = 0.0d;
+	for (int mode = DST_TASK_DIVISION_DYNAMIC; mode <= DST_TASK_DIVISION_GUIDED; mode++) {
+		dstTaskDivisionData division;
+		division.size = NU_DIVISION_TEST_ELEMENTS;
+		division.nu_subdivisions = 4;
+		division.alignment = 4;
+		division.SetDynamicMode(mode, 16, 64);
+		division_test_data.division = &division;
+		division_test_data.nu_errors = 0;
+		for (int j = 0; j < NU_DIVISION_TEST_ELEMENTS; j++)
+			division_test_data.count[j] = 0;
+		int group_index = division_scheduler->AddSubdividedTaskGroup(0, DivisionTestTask,
+			NULL, division);
+		division_scheduler->WaitUntilGroupFinished(group_index);
+		if (division_test_data.nu_errors > 0)
+			deviation += 1.0d;
+		for (int j = 0; j < NU_DIVISION_TEST_ELEMENTS; j++)
+			if (division_test_data.count[j] != 1) {
+				deviation += 1.0d;
+				break;
+			}
+	}
+	dstSetFixedNumberOfThreads(4);
+	dstSetFlag(DST_FLAG_THREADING | DST_FLAG_FIXED_NU_THREADS | DST_FLAG_DYNAMIC_SCHEDULING);
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomVector4DArrays();
+		dstCalculateDotProductsNxN(vector_array_size - 1, vector4D_array[0],
+			vector4D_array[1], dot_product_array[0][0]);
+		dstSyncTasks();
+		for (int j = 0; j < vector_array_size - 1; j++)
+			deviation += fabs(dot_product_array[0][0][j] - Dot(vector4D_array[0][j],
+				vector4D_array[1][j])) / (vector_array_size - 1);
+	}
+	dstSetFlags(saved_flags);
+	dstSetFixedNumberOfThreads(fixed_nu_threads);
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("Dynamic task division: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	// Every affinity policy must order distinct CPUs of the process mask; scatter uses the
+	// same CPUs as compact, and physical no more. CPUs of an explicit list that are not in
+	// the mask are left out. The policy only affects worker pools started afterwards.
+	// Without DST_AFFINITY, threads are not bound by default.
+	deviation = 0.0d;
+	if (getenv("DST_AFFINITY") == NULL) {
+		int saved_affinity_policy = dstGetAffinityPolicy();
+		if (saved_affinity_policy != DST_AFFINITY_NONE)
+			deviation += 1.0d;
+		int nu_policy_cpus[DST_AFFINITY_CPU_LIST];
+		uint64_t policy_cpu_sum[DST_AFFINITY_CPU_LIST];
+		for (int policy = DST_AFFINITY_COMPACT; policy <= DST_AFFINITY_PHYSICAL_CORES;
+		policy++) {
+			dstSetAffinityPolicy(policy);
+			int n = dstGetNumberOfAffinityCPUs();
+			nu_policy_cpus[policy] = n;
+			policy_cpu_sum[policy] = 0;
+			for (int i = 0; i < n; i++) {
+				int cpu = dstGetAffinityCPU(i);
+				policy_cpu_sum[policy] += cpu;
+				if (cpu < 0 || dstGetAffinityCPU(i + n) != cpu)
+					deviation += 1.0d;
+				for (int j = 0; j < i; j++)
+					if (dstGetAffinityCPU(j) == cpu)
+						deviation += 1.0d;
+			}
+		}
+		if (nu_policy_cpus[DST_AFFINITY_SCATTER] != nu_policy_cpus[DST_AFFINITY_COMPACT] ||
+		policy_cpu_sum[DST_AFFINITY_SCATTER] != policy_cpu_sum[DST_AFFINITY_COMPACT] ||
+		nu_policy_cpus[DST_AFFINITY_PHYSICAL_CORES] > nu_policy_cpus[DST_AFFINITY_COMPACT])
+			deviation += 1.0d;
+		dstSetAffinityPolicy(DST_AFFINITY_COMPACT);
+		int cpu_list[3] = { - 1, dstGetAffinityCPU(0), 100000 };
+		dstSetAffinityPolicy(DST_AFFINITY_CPU_LIST, cpu_list, 3);
+		if (dstGetNumberOfAffinityCPUs() != 1 || dstGetAffinityCPU(1) != cpu_list[1])
+			deviation += 1.0d;
+		if (!dstSetAffinityPolicyString("none") || dstGetAffinityCPU(0) != - 1 ||
+		dstSetAffinityPolicyString("0-3,x") || dstGetAffinityPolicy() != DST_AFFINITY_NONE)
+			deviation += 1.0d;
+		dstSetAffinityPolicy(saved_affinity_policy);
+	}
+	avg_deviation = deviation;
+        printf("Affinity policies: average deviation = %lE (%s)\n",
+		avg_deviation, CorrectString(avg_deviation));
+
+	// Multi-threaded dot products on arrays allocated with first-touch NUMA placement.
+	Vector4D *numa_v = dstNewNUMALocal <Vector4D>(vector_array_size);
+	float *numa_dot = dstNewNUMALocal <float>(vector_array_size);
+	dstSetFixedNumberOfThreads(4);
+	dstSetFlag(DST_FLAG_THREADING | DST_FLAG_FIXED_NU_THREADS);
+	deviation = 0.0d;
+	for (int i = 0; i < nu_correctness_iterations; i++) {
+		SetRandomVector4DArrays();
+		for (int j = 0; j < vector_array_size; j++)
+			numa_v[j] = vector4D_array[0][j];
+		dstCalculateDotProductsNx1(vector_array_size, numa_v, vector4D_array[1][0], numa_dot);
+		for (int j = 0; j < vector_array_size; j++)
+			deviation += fabs(numa_dot[j] - Dot(numa_v[j], vector4D_array[1][0])) /
+				vector_array_size;
+	}
+	dstSetFlags(saved_flags);
+	dstSetFixedNumberOfThreads(fixed_nu_threads);
+	dstDeleteNUMALocal(numa_v, vector_array_size);
+	dstDeleteNUMALocal(numa_dot, vector_array_size);
+	// Every node with CPUs in the process mask has workers when there are enough of
+	// them, whether or not the workers are bound to CPUs.
+	dstTaskScheduler *numa_scheduler = dstGetContext()->task_scheduler;
+	const dstNUMATopology *numa_topology = dstGetNUMATopology();
+	bool usable_node[DST_MAX_NUMA_NODES];
+	int nu_usable_nodes = 0;
+	for (int node = 0; node < numa_topology->nu_nodes; node++) {
+		usable_node[node] = false;
+		for (int cpu = 0; cpu < numa_topology->nu_cpus; cpu++)
+			if (numa_topology->GetNodeOfCPU(cpu) == node && dstIsCPUInProcessMask(cpu))
+				usable_node[node] = true;
+		if (usable_node[node])
+			nu_usable_nodes++;
+	}
+	int nu_node_workers = 0;
+	for (int node = 0; node < numa_scheduler->GetNumberOfNodes(); node++) {
+		nu_node_workers += numa_scheduler->GetNumberOfWorkers(node);
+		if (usable_node[node] && numa_scheduler->GetNumberOfWorkers(node) == 0 &&
+		numa_scheduler->GetNumberOfWorkers() >= nu_usable_nodes)
+			deviation += 1.0d;
+	}
+	if (nu_node_workers != numa_scheduler->GetNumberOfWorkers())
+		deviation += 1.0d;
+	avg_deviation = deviation / nu_correctness_iterations;
+        printf("NUMA-local arrays (%d nodes): average deviation = %lE (%s)\n",
+		dstGetNUMATopology()->nu_nodes, avg_deviation, CorrectString(avg_deviation));
+
 	printf("Array size %d\n", vector_array_size);
 	printf("Number of threads for multi-threading: ");
 	if (fixed_nu_threads > 0)
@@ -985,6 +2859,8 @@ int main(int argc, char *argv[]) {
 		double rate_streaming = count / elapsed_time;
 
 		dstSetFlag(DST_FLAG_THREADING);
+		// Keep the workers spinning between the back-to-back calls.
+		dstBeginParallelRegion();
 
 		// Warm-up for 0.1s.
 		tt->Start((uint64_t)(timeout_secs * 100000));
@@ -1009,6 +2885,7 @@ int main(int argc, char *argv[]) {
 		dstSyncTasks();
 		elapsed_time = timer.Elapsed();
 		double rate_streaming_threaded = count / elapsed_time;
+		dstEndParallelRegion();
 
 		double rate_non_simd_threaded = 0.0d;
 		printf("Test: %s\n"